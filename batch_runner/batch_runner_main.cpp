@@ -0,0 +1,280 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+// Runs many independent game sessions without any rendering or audio output,
+// spread across all available CPU cores. Sessions are described in a JSON
+// file (see parseSessionSpecs() in batch_session.hpp), results are written
+// out as JSON.
+
+#include "batch_session.hpp"
+
+#include "base/clock.hpp"
+#include "base/warnings.hpp"
+#include "engine/sprite_factory.hpp"
+#include "game_logic/world_state.hpp"
+#include "loader/resource_loader.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <boost/program_options.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+
+using namespace rigel;
+
+namespace po = boost::program_options;
+
+
+namespace {
+
+struct Options {
+  std::string mGamePath;
+  std::string mSessionsFile;
+  std::string mOutputFile;
+  unsigned mNumThreads = 0;
+};
+
+
+nlohmann::json loadJson(const std::string& path) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  return nlohmann::json::parse(file);
+}
+
+
+std::vector<batch_runner::SessionResult> runAllSessions(
+  const std::vector<batch_runner::SessionSpec>& specs,
+  const batch_runner::SharedAssets& assets,
+  const unsigned numThreads
+) {
+  std::vector<batch_runner::SessionResult> results(specs.size());
+  std::atomic<std::size_t> nextSession = 0;
+
+  auto workerFunc = [&]() {
+    batch_runner::SessionWorker worker{assets};
+
+    for (;;) {
+      const auto index = nextSession.fetch_add(1);
+      if (index >= specs.size()) {
+        break;
+      }
+
+      results[index] = worker.run(specs[index]);
+    }
+  };
+
+  std::vector<std::thread> threads;
+  threads.reserve(numThreads);
+  for (auto i = 0u; i < numThreads; ++i) {
+    threads.emplace_back(workerFunc);
+  }
+
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  return results;
+}
+
+
+nlohmann::json makeSummary(
+  const std::vector<batch_runner::SessionResult>& results
+) {
+  auto totalFrames = 0;
+  auto numFinished = 0;
+  auto numFailed = 0;
+  auto numStateHashMismatches = 0;
+  auto totalFrameTimeMs = 0.0;
+
+  for (const auto& result : results) {
+    totalFrames += result.mFramesSimulated;
+    totalFrameTimeMs += result.mMeanFrameTimeMs * result.mFramesSimulated;
+
+    if (result.mLevelFinished) {
+      ++numFinished;
+    }
+
+    if (result.mError) {
+      ++numFailed;
+    }
+
+    if (result.mStateHashMismatch) {
+      ++numStateHashMismatches;
+    }
+  }
+
+  auto summary = nlohmann::json::object();
+  summary["numSessions"] = results.size();
+  summary["numLevelsFinished"] = numFinished;
+  summary["numErrors"] = numFailed;
+  summary["numStateHashMismatches"] = numStateHashMismatches;
+  summary["totalFrames"] = totalFrames;
+  summary["meanFrameTimeMs"] =
+    totalFrames > 0 ? totalFrameTimeMs / totalFrames : 0.0;
+  return summary;
+}
+
+
+/** Returns false if any session didn't match its golden state hash trace */
+bool runBatch(const Options& options) {
+  const auto specs =
+    batch_runner::parseSessionSpecs(loadJson(options.mSessionsFile));
+
+  loader::ResourceLoader resources{options.mGamePath};
+
+  // All component types need to be known before any worlds are created on
+  // worker threads, see registerAllComponentTypes().
+  game_logic::registerAllComponentTypes();
+
+  // The sprite factory's texture atlas is created once up front, and only
+  // read from afterwards. All workers can therefore share it. Since the
+  // renderer is headless, no textures are actually created.
+  renderer::Renderer sharedRenderer{nullptr};
+  engine::SpriteFactory spriteFactory{
+    &sharedRenderer, &resources.mActorImagePackage};
+  const auto uiSpriteSheetImage =
+    resources.loadTiledFullscreenImage("STATUS.MNI");
+  const auto isSharewareVersion =
+    !(resources.hasFile("LCR.MNI") && resources.hasFile("O1.MNI"));
+
+  const auto assets = batch_runner::SharedAssets{
+    &resources, &spriteFactory, &uiSpriteSheetImage, isSharewareVersion};
+
+  // Event types are also assigned their IDs lazily, when first subscribed to
+  // or emitted. Running a short session here on the main thread makes sure
+  // that all of this happens before going multi-threaded.
+  {
+    auto warmUpSpec = batch_runner::SessionSpec{};
+    warmUpSpec.mMaxFrames = 1;
+    batch_runner::SessionWorker{assets}.run(warmUpSpec);
+  }
+
+  const auto numThreads = std::clamp(
+    options.mNumThreads > 0
+      ? options.mNumThreads
+      : std::max(std::thread::hardware_concurrency(), 1u),
+    1u,
+    static_cast<unsigned>(std::max(specs.size(), std::size_t{1})));
+
+  std::cout << "Running " << specs.size() << " sessions on " << numThreads
+    << " threads\n";
+
+  const auto startTime = base::Clock::now();
+  const auto results = runAllSessions(specs, assets, numThreads);
+  const auto elapsedSeconds = std::chrono::duration<double>(
+    base::Clock::now() - startTime).count();
+
+  auto output = nlohmann::json::object();
+  output["sessions"] = nlohmann::json::array();
+  for (auto i = 0u; i < specs.size(); ++i) {
+    output["sessions"].push_back(batch_runner::toJson(specs[i], results[i]));
+  }
+
+  output["summary"] = makeSummary(results);
+  output["summary"]["numThreads"] = numThreads;
+  output["summary"]["wallClockTimeSeconds"] = elapsedSeconds;
+
+  if (options.mOutputFile.empty()) {
+    std::cout << output.dump(2) << '\n';
+  } else {
+    std::ofstream outputFile(options.mOutputFile);
+    outputFile << output.dump(2) << '\n';
+
+    std::cout << "Results written to " << options.mOutputFile << '\n';
+  }
+
+  return output["summary"]["numStateHashMismatches"] == 0;
+}
+
+}
+
+
+int main(int argc, char** argv) {
+  Options config;
+
+  po::options_description optionsDescription("Options");
+  optionsDescription.add_options()
+    ("help,h", "Show command line help message")
+    ("sessions",
+     po::value<std::string>(&config.mSessionsFile)->required(),
+     "JSON file describing the sessions to run")
+    ("output,o",
+     po::value<std::string>(&config.mOutputFile)->default_value(""),
+     "File to write results to. Results are printed to stdout if not given")
+    ("threads,j",
+     po::value<unsigned>(&config.mNumThreads)->default_value(0),
+     "Number of worker threads. Defaults to the number of CPU cores")
+    ("game-path",
+     po::value<std::string>(&config.mGamePath)->required(),
+     "Path to original game's installation. Can also be given as positional "
+     "argument");
+
+  po::positional_options_description positionalArgsDescription;
+  positionalArgsDescription.add("game-path", -1);
+
+  try
+  {
+    po::variables_map options;
+    po::store(
+      po::command_line_parser(argc, argv)
+        .options(optionsDescription)
+        .positional(positionalArgsDescription)
+        .run(),
+      options);
+
+    if (options.count("help")) {
+      std::cout << optionsDescription << '\n';
+      return 0;
+    }
+
+    po::notify(options);
+
+    if (config.mGamePath.back() != '/') {
+      config.mGamePath += "/";
+    }
+
+    if (!runBatch(config)) {
+      std::cerr << "ERROR: State hashes don't match the golden trace\n";
+      return 1;
+    }
+  }
+  catch (const po::error& err)
+  {
+    std::cerr << "ERROR: " << err.what() << "\n\n";
+    std::cerr << optionsDescription << '\n';
+    return -1;
+  }
+  catch (const std::exception& ex)
+  {
+    std::cerr << "ERROR: " << ex.what() << '\n';
+    return -2;
+  }
+
+  return 0;
+}
@@ -0,0 +1,450 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "batch_session.hpp"
+
+#include "base/clock.hpp"
+#include "data/player_model.hpp"
+#include "game_logic/demo_player.hpp"
+#include "game_logic/game_world.hpp"
+#include "game_logic/input.hpp"
+#include "loader/file_utils.hpp"
+#include "loader/resource_loader.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+
+
+namespace rigel::batch_runner {
+
+using game_logic::PlayerInput;
+
+
+namespace {
+
+const auto DEMO_SESSION_ID =
+  data::GameSessionId{0, 0, data::Difficulty::Hard};
+
+// Nothing is rendered in batch sessions, so hardly any temporary data
+// is needed
+constexpr auto FRAME_ARENA_SIZE = std::size_t{4 * 1024};
+
+
+data::Difficulty parseDifficulty(const std::string& name) {
+  if (name == "easy") {
+    return data::Difficulty::Easy;
+  } else if (name == "medium") {
+    return data::Difficulty::Medium;
+  } else if (name == "hard") {
+    return data::Difficulty::Hard;
+  }
+
+  throw std::invalid_argument("Unknown difficulty: " + name);
+}
+
+
+const char* difficultyName(const data::Difficulty difficulty) {
+  switch (difficulty) {
+    case data::Difficulty::Easy: return "easy";
+    case data::Difficulty::Medium: return "medium";
+    case data::Difficulty::Hard: return "hard";
+  }
+
+  return "";
+}
+
+
+const char* inputTypeName(const SessionSpec::InputType type) {
+  using IT = SessionSpec::InputType;
+
+  switch (type) {
+    case IT::RecordedFile: return "file";
+    case IT::Demo: return "demo";
+    case IT::Random: return "random";
+  }
+
+  return "";
+}
+
+
+/** Produces plausible-looking random input
+ *
+ * Purely random input per frame would mostly result in the player jittering
+ * in place, so instead, each randomly chosen input state is held for a
+ * random number of frames.
+ */
+class RandomInputGenerator {
+public:
+  explicit RandomInputGenerator(const std::uint32_t seed)
+    : mRandomGenerator(seed)
+  {
+  }
+
+  PlayerInput next() {
+    if (mFramesRemaining == 0) {
+      mFramesRemaining = std::uniform_int_distribution<int>{1, 30}(
+        mRandomGenerator);
+
+      const auto bits = mRandomGenerator();
+
+      const auto horizontal = bits % 3;
+      mHeldInput.mLeft = horizontal == 1;
+      mHeldInput.mRight = horizontal == 2;
+
+      const auto vertical = (bits >> 2) % 6;
+      mHeldInput.mUp = vertical == 1;
+      mHeldInput.mDown = vertical == 2;
+
+      mHeldInput.mJump.mIsPressed = (bits & 0b10000) != 0;
+      mHeldInput.mFire.mIsPressed = (bits & 0b100000) != 0;
+      mHeldInput.mInteract.mIsPressed = (bits & 0b1000000) != 0;
+    }
+
+    --mFramesRemaining;
+
+    auto result = mHeldInput;
+    result.mJump.mWasTriggered =
+      result.mJump.mIsPressed && !mPreviousInput.mJump.mIsPressed;
+    result.mFire.mWasTriggered =
+      result.mFire.mIsPressed && !mPreviousInput.mFire.mIsPressed;
+    result.mInteract.mWasTriggered =
+      result.mInteract.mIsPressed && !mPreviousInput.mInteract.mIsPressed;
+
+    mPreviousInput = result;
+    return result;
+  }
+
+private:
+  std::mt19937 mRandomGenerator;
+  PlayerInput mHeldInput;
+  PlayerInput mPreviousInput;
+  int mFramesRemaining = 0;
+};
+
+
+/** Unified access to the different input sources
+ *
+ * Returns std::nullopt once there's no more input.
+ */
+class InputSource {
+public:
+  InputSource(const SessionSpec& spec, const loader::ResourceLoader& resources)
+    : mRandomInput(spec.mRandomSeed)
+    , mIsRandom(spec.mInputType == SessionSpec::InputType::Random)
+  {
+    using IT = SessionSpec::InputType;
+
+    if (spec.mInputType == IT::RecordedFile) {
+      mRecordedInput =
+        game_logic::parseDemoInput(loader::loadFile(spec.mInputFilePath));
+    } else if (spec.mInputType == IT::Demo) {
+      mRecordedInput =
+        game_logic::parseDemoInput(resources.file("NUKEM2.MNI"));
+    }
+  }
+
+  std::optional<PlayerInput> next() {
+    if (mIsRandom) {
+      return mRandomInput.next();
+    }
+
+    // Recorded input only covers a single level, we stop when reaching the
+    // marker for switching to the next one.
+    if (
+      mNextFrame >= mRecordedInput.size() ||
+      mRecordedInput[mNextFrame].mNextLevel
+    ) {
+      return std::nullopt;
+    }
+
+    return mRecordedInput[mNextFrame++].mInput;
+  }
+
+private:
+  std::vector<game_logic::DemoInput> mRecordedInput;
+  std::size_t mNextFrame = 0;
+  RandomInputGenerator mRandomInput;
+  bool mIsRandom;
+};
+
+
+std::vector<game_logic::StateHash> loadStateHashTrace(
+  const std::string& path
+) {
+  std::ifstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path);
+  }
+
+  return game_logic::readStateHashTrace(file);
+}
+
+
+void saveStateHashTrace(
+  const std::string& path,
+  const std::vector<game_logic::StateHash>& trace
+) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error("Failed to open " + path + " for writing");
+  }
+
+  game_logic::writeStateHashTrace(file, trace);
+}
+
+
+double toMilliseconds(const base::Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+}
+
+
+std::vector<SessionSpec> parseSessionSpecs(const nlohmann::json& json) {
+  using IT = SessionSpec::InputType;
+
+  if (!json.is_array()) {
+    throw std::invalid_argument("Session list must be a JSON array");
+  }
+
+  std::vector<SessionSpec> result;
+  result.reserve(json.size());
+
+  for (const auto& item : json) {
+    SessionSpec spec;
+
+    const auto episode = item.value("episode", 1);
+    const auto level = item.value("level", 1);
+    if (
+      episode < 1 || episode > data::NUM_EPISODES ||
+      level < 1 || level > data::NUM_LEVELS_PER_EPISODE
+    ) {
+      throw std::invalid_argument(
+        "Invalid episode/level: " + std::to_string(episode) + "/" +
+        std::to_string(level));
+    }
+
+    spec.mSessionId = data::GameSessionId{
+      episode - 1,
+      level - 1,
+      parseDifficulty(item.value("difficulty", std::string{"medium"}))};
+    spec.mMaxFrames = item.value("maxFrames", DEFAULT_MAX_FRAMES);
+    spec.mWriteStateHashesPath =
+      item.value("writeStateHashes", std::string{});
+    spec.mCheckStateHashesPath =
+      item.value("checkStateHashes", std::string{});
+
+    if (item.contains("input")) {
+      const auto& input = item["input"];
+      const auto type = input.value("type", std::string{"random"});
+
+      if (type == "random") {
+        spec.mInputType = IT::Random;
+        spec.mRandomSeed = input.value("seed", std::uint32_t{0});
+      } else if (type == "file") {
+        spec.mInputType = IT::RecordedFile;
+        spec.mInputFilePath = input.at("path").get<std::string>();
+      } else if (type == "demo") {
+        spec.mInputType = IT::Demo;
+        spec.mSessionId = DEMO_SESSION_ID;
+      } else {
+        throw std::invalid_argument("Unknown input type: " + type);
+      }
+    }
+
+    result.push_back(spec);
+  }
+
+  return result;
+}
+
+
+nlohmann::json toJson(const SessionSpec& spec, const SessionResult& result) {
+  auto input = nlohmann::json::object();
+  input["type"] = inputTypeName(spec.mInputType);
+
+  switch (spec.mInputType) {
+    case SessionSpec::InputType::RecordedFile:
+      input["path"] = spec.mInputFilePath;
+      break;
+
+    case SessionSpec::InputType::Random:
+      input["seed"] = spec.mRandomSeed;
+      break;
+
+    case SessionSpec::InputType::Demo:
+      break;
+  }
+
+  auto json = nlohmann::json::object();
+  json["episode"] = spec.mSessionId.mEpisode + 1;
+  json["level"] = spec.mSessionId.mLevel + 1;
+  json["difficulty"] = difficultyName(spec.mSessionId.mDifficulty);
+  json["input"] = input;
+  json["framesSimulated"] = result.mFramesSimulated;
+  json["score"] = result.mScore;
+  json["numDeaths"] = result.mNumDeaths;
+  json["firstDeathFrame"] = result.mFirstDeathFrame
+    ? nlohmann::json(*result.mFirstDeathFrame)
+    : nlohmann::json();
+  json["levelFinished"] = result.mLevelFinished;
+  json["meanFrameTimeMs"] = result.mMeanFrameTimeMs;
+  json["maxFrameTimeMs"] = result.mMaxFrameTimeMs;
+
+  if (!spec.mCheckStateHashesPath.empty()) {
+    auto mismatch = nlohmann::json();
+    if (result.mStateHashMismatch) {
+      mismatch["frame"] = result.mStateHashMismatch->mFrame;
+      mismatch["components"] = result.mStateHashMismatch->mComponents;
+    }
+
+    json["stateHashMismatch"] = mismatch;
+  }
+
+  if (result.mError) {
+    json["error"] = *result.mError;
+  }
+
+  return json;
+}
+
+
+HeadlessServiceProvider::HeadlessServiceProvider(
+  const bool isSharewareVersion
+)
+  : mIsSharewareVersion(isSharewareVersion)
+{
+}
+
+
+SessionWorker::SessionWorker(const SharedAssets& assets)
+  : mAssets(assets)
+  , mRenderer(nullptr)
+  , mServiceProvider(assets.mIsSharewareVersion)
+  , mUiSpriteSheet(
+      renderer::Texture{&mRenderer, *assets.mpUiSpriteSheetImage},
+      &mRenderer)
+  , mTextRenderer(&mUiSpriteSheet, &mRenderer, *assets.mpResources)
+  , mFrameArena(FRAME_ARENA_SIZE)
+{
+}
+
+
+SessionResult SessionWorker::run(const SessionSpec& spec) {
+  SessionResult result;
+
+  auto context = GameMode::Context{
+    mAssets.mpResources,
+    &mRenderer,
+    &mServiceProvider,
+    nullptr,
+    nullptr,
+    &mTextRenderer,
+    &mUiSpriteSheet,
+    mAssets.mpSpriteFactory,
+    &mUserProfile,
+    &mFrameArena};
+
+  auto totalFrameTime = base::Clock::duration{};
+  auto maxFrameTime = base::Clock::duration{};
+
+  try {
+    if (mServiceProvider.isSharewareVersion() &&
+        spec.mSessionId.needsRegisteredVersion()) {
+      throw std::invalid_argument(
+        "Episode not available in the shareware version");
+    }
+
+    InputSource inputSource{spec, *mAssets.mpResources};
+
+    // Loaded up front, so that a missing file is reported before spending
+    // time on running the session
+    const auto goldenStateHashes = !spec.mCheckStateHashesPath.empty()
+      ? loadStateHashTrace(spec.mCheckStateHashesPath)
+      : std::vector<game_logic::StateHash>{};
+    const auto needsStateHashes = !spec.mWriteStateHashesPath.empty() ||
+      !spec.mCheckStateHashesPath.empty();
+    std::vector<game_logic::StateHash> stateHashes;
+
+    data::PlayerModel playerModel;
+    game_logic::GameWorld world{&playerModel, spec.mSessionId, context};
+
+    while (result.mFramesSimulated < spec.mMaxFrames) {
+      const auto maybeInput = inputSource.next();
+      if (!maybeInput) {
+        break;
+      }
+
+      const auto startTime = base::Clock::now();
+
+      world.updateGameLogic(*maybeInput);
+
+      if (world.playerDied()) {
+        ++result.mNumDeaths;
+        if (!result.mFirstDeathFrame) {
+          result.mFirstDeathFrame = result.mFramesSimulated;
+        }
+      }
+
+      world.processEndOfFrameActions();
+      mFrameArena.reset();
+
+      const auto frameTime = base::Clock::now() - startTime;
+      totalFrameTime += frameTime;
+      maxFrameTime = std::max(maxFrameTime, frameTime);
+
+      // Not included in the frame time, since hashing the entire state is
+      // fairly expensive compared to a logic update
+      if (needsStateHashes) {
+        stateHashes.push_back(world.stateHash());
+      }
+
+      ++result.mFramesSimulated;
+
+      if (world.levelFinished()) {
+        result.mLevelFinished = true;
+        break;
+      }
+    }
+
+    result.mScore = playerModel.score();
+
+    if (!spec.mWriteStateHashesPath.empty()) {
+      saveStateHashTrace(spec.mWriteStateHashesPath, stateHashes);
+    }
+
+    if (!spec.mCheckStateHashesPath.empty()) {
+      result.mStateHashMismatch =
+        game_logic::findFirstMismatch(goldenStateHashes, stateHashes);
+    }
+  } catch (const std::exception& ex) {
+    result.mError = ex.what();
+  }
+
+  if (result.mFramesSimulated > 0) {
+    result.mMeanFrameTimeMs =
+      toMilliseconds(totalFrameTime) / result.mFramesSimulated;
+    result.mMaxFrameTimeMs = toMilliseconds(maxFrameTime);
+  }
+
+  return result;
+}
+
+}
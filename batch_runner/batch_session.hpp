@@ -0,0 +1,181 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/frame_arena.hpp"
+#include "base/warnings.hpp"
+#include "common/command_line_options.hpp"
+#include "common/game_service_provider.hpp"
+#include "common/user_profile.hpp"
+#include "data/game_session_data.hpp"
+#include "engine/tiled_texture.hpp"
+#include "game_logic/state_hash.hpp"
+#include "renderer/renderer.hpp"
+#include "ui/menu_element_renderer.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <nlohmann/json.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace rigel::data { class Image; }
+namespace rigel::engine { class SpriteFactory; }
+namespace rigel::loader { class ResourceLoader; }
+
+
+namespace rigel::batch_runner {
+
+constexpr auto DEFAULT_MAX_FRAMES = 15 * 60 * 10;
+
+
+struct SessionSpec {
+  enum class InputType {
+    /** Input recorded in the original game's demo format */
+    RecordedFile,
+
+    /** The original game's demo (first level only) */
+    Demo,
+
+    /** Pseudo-random input generated from a seed */
+    Random
+  };
+
+  data::GameSessionId mSessionId;
+  InputType mInputType = InputType::Random;
+  std::string mInputFilePath;
+  std::uint32_t mRandomSeed = 0;
+  int mMaxFrames = DEFAULT_MAX_FRAMES;
+
+  /** If not empty, a state hash trace is written to this file */
+  std::string mWriteStateHashesPath;
+
+  /** If not empty, state hashes are compared to the trace in this file */
+  std::string mCheckStateHashesPath;
+};
+
+
+struct SessionResult {
+  int mFramesSimulated = 0;
+  int mScore = 0;
+  int mNumDeaths = 0;
+  std::optional<int> mFirstDeathFrame;
+  bool mLevelFinished = false;
+  double mMeanFrameTimeMs = 0.0;
+  double mMaxFrameTimeMs = 0.0;
+  std::optional<game_logic::StateHashMismatch> mStateHashMismatch;
+  std::optional<std::string> mError;
+};
+
+
+/** Loaded assets which are shared between all workers
+ *
+ * These are only ever read from while sessions are running, so they can be
+ * used from multiple threads at once.
+ */
+struct SharedAssets {
+  const loader::ResourceLoader* mpResources;
+  engine::SpriteFactory* mpSpriteFactory;
+  const data::IndexedImage* mpUiSpriteSheetImage;
+  bool mIsSharewareVersion;
+};
+
+
+/** Parse a list of sessions from JSON
+ *
+ * Expects an array of objects like this:
+ *
+ *   {
+ *     "episode": 1,
+ *     "level": 3,
+ *     "difficulty": "hard",
+ *     "input": {"type": "random", "seed": 42},
+ *     "maxFrames": 9000,
+ *     "checkStateHashes": "golden/e1l3.txt"
+ *   }
+ *
+ * Episode and level are 1-based. Input type can be "random" (with a seed),
+ * "file" (with a "path" to a recording in demo format), or "demo". For
+ * "demo", episode, level and difficulty are ignored, since the demo always
+ * starts on the first level of episode 1 on hard.
+ *
+ * "writeStateHashes" records a hash of the game state after each frame (see
+ * StateHash), "checkStateHashes" compares these hashes against a previously
+ * recorded trace. The latter reports the first frame where the two differ,
+ * and which parts of the state are affected. All keys are optional.
+ */
+std::vector<SessionSpec> parseSessionSpecs(const nlohmann::json& json);
+
+nlohmann::json toJson(const SessionSpec& spec, const SessionResult& result);
+
+
+class HeadlessServiceProvider : public IGameServiceProvider {
+public:
+  explicit HeadlessServiceProvider(bool isSharewareVersion);
+
+  void fadeOutScreen() override {}
+  void fadeInScreen() override {}
+
+  void playSound(data::SoundId) override {}
+  void stopSound(data::SoundId) override {}
+  void playMusic(const std::string&) override {}
+  void stopMusic() override {}
+  void scheduleGameQuit() override {}
+  void switchGamePath(const std::filesystem::path&) override {}
+  void markCurrentFrameAsWidescreen() override {}
+
+  bool isSharewareVersion() const override {
+    return mIsSharewareVersion;
+  }
+
+  const CommandLineOptions& commandLineOptions() const override {
+    return mCommandLineOptions;
+  }
+
+private:
+  CommandLineOptions mCommandLineOptions;
+  bool mIsSharewareVersion;
+};
+
+
+/** Runs sessions without rendering or audio
+ *
+ * Each worker has its own (headless) renderer and service provider, so
+ * different workers can run on different threads.
+ */
+class SessionWorker {
+public:
+  explicit SessionWorker(const SharedAssets& assets);
+
+  SessionResult run(const SessionSpec& spec);
+
+private:
+  SharedAssets mAssets;
+  renderer::Renderer mRenderer;
+  HeadlessServiceProvider mServiceProvider;
+  engine::TiledTexture mUiSpriteSheet;
+  ui::MenuElementRenderer mTextRenderer;
+  UserProfile mUserProfile;
+  base::FrameArena mFrameArena;
+};
+
+}
@@ -0,0 +1,113 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+
+#include <cstddef>
+
+
+/* Minimal micro-benchmark harness
+ *
+ * Benchmarks are defined with the RIGEL_BENCHMARK macro, and are run by
+ * the rigel_benchmarks executable. Each benchmark receives a State object,
+ * and runs the code to be measured in a `while (state.keepRunning())` loop.
+ * The harness determines a suitable number of iterations automatically.
+ * Code before the loop is not included in the measurement.
+ */
+
+namespace rigel::benchmark {
+
+class State {
+public:
+  explicit State(std::size_t iterations);
+
+  /** Returns true as long as another iteration should be run
+   *
+   * Starts the timer on the first call, and stops it once all iterations are
+   * done.
+   */
+  bool keepRunning() {
+    if (!mStarted) {
+      mStarted = true;
+      mStartTime = base::Clock::now();
+    }
+
+    if (mIterationsLeft == 0) {
+      mEndTime = base::Clock::now();
+      return false;
+    }
+
+    --mIterationsLeft;
+    return true;
+  }
+
+  /** Number of items (e.g. samples, entities) processed by each iteration
+   *
+   * Optional, used to report throughput.
+   */
+  void setItemsPerIteration(const std::size_t items) {
+    mItemsPerIteration = items;
+  }
+
+  std::size_t iterations() const { return mIterations; }
+  std::size_t itemsPerIteration() const { return mItemsPerIteration; }
+  base::Clock::duration elapsed() const { return mEndTime - mStartTime; }
+
+private:
+  base::Clock::time_point mStartTime;
+  base::Clock::time_point mEndTime;
+  std::size_t mIterations;
+  std::size_t mIterationsLeft;
+  std::size_t mItemsPerIteration = 0;
+  bool mStarted = false;
+};
+
+
+using BenchmarkFunction = void (*)(State&);
+
+
+struct Registration {
+  Registration(const char* name, BenchmarkFunction function);
+};
+
+
+namespace detail {
+
+void escape(const void* pValue);
+
+}
+
+
+/** Prevent the compiler from optimizing away the computation of value */
+template <typename T>
+void doNotOptimize(const T& value) {
+#if defined(__GNUC__)
+  asm volatile("" : : "r"(&value) : "memory");
+#else
+  detail::escape(&value);
+#endif
+}
+
+}
+
+
+#define RIGEL_BENCHMARK(name) \
+  static void name(::rigel::benchmark::State&); \
+  static const ::rigel::benchmark::Registration name##Registration{ \
+    #name, &name}; \
+  static void name(::rigel::benchmark::State& state)
@@ -0,0 +1,99 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "loader/adlib_emulator.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace {
+
+constexpr auto BLOCK_SIZE = std::size_t{1024};
+constexpr auto SAMPLE_RATE = 44100;
+
+
+std::vector<std::int32_t> makeInputSamples() {
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<std::int32_t> distribution{-20000, 20000};
+
+  std::vector<std::int32_t> samples(BLOCK_SIZE);
+  for (auto& sample : samples) {
+    sample = distribution(generator);
+  }
+
+  return samples;
+}
+
+
+void startTone(loader::AdlibEmulator& emulator) {
+  emulator.writeRegister(0x20, 0x01);
+  emulator.writeRegister(0x40, 0x10);
+  emulator.writeRegister(0x60, 0xF0);
+  emulator.writeRegister(0x80, 0x77);
+  emulator.writeRegister(0xA0, 0x98);
+  emulator.writeRegister(0x23, 0x01);
+  emulator.writeRegister(0x63, 0xF0);
+  emulator.writeRegister(0x83, 0x77);
+  emulator.writeRegister(0xB0, 0x31);
+}
+
+}
+
+
+RIGEL_BENCHMARK(AdlibConvertSamplesScalar) {
+  const auto input = makeInputSamples();
+  std::vector<std::int16_t> output(BLOCK_SIZE);
+
+  state.setItemsPerIteration(BLOCK_SIZE);
+  while (state.keepRunning()) {
+    loader::convertSamplesScalar(
+      input.data(), output.data(), BLOCK_SIZE, 0.75f);
+    benchmark::doNotOptimize(output);
+  }
+}
+
+
+RIGEL_BENCHMARK(AdlibConvertSamplesSimd) {
+  const auto input = makeInputSamples();
+  std::vector<std::int16_t> output(BLOCK_SIZE);
+
+  state.setItemsPerIteration(BLOCK_SIZE);
+  while (state.keepRunning()) {
+    loader::convertSamples(input.data(), output.data(), BLOCK_SIZE, 0.75f);
+    benchmark::doNotOptimize(output);
+  }
+}
+
+
+RIGEL_BENCHMARK(AdlibEmulatorRender) {
+  loader::AdlibEmulator emulator{SAMPLE_RATE};
+  startTone(emulator);
+
+  std::vector<std::int16_t> output(SAMPLE_RATE);
+
+  state.setItemsPerIteration(output.size());
+  while (state.keepRunning()) {
+    emulator.render(output.size(), output.data(), 0.75f);
+    benchmark::doNotOptimize(output);
+  }
+}
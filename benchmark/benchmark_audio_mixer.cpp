@@ -0,0 +1,58 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "engine/audio_mixer.hpp"
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace {
+
+constexpr auto BUFFER_SIZE = std::size_t{2048};
+constexpr auto NUM_ACTIVE_VOICES = 16;
+
+}
+
+
+RIGEL_BENCHMARK(AudioMixerMixVoices) {
+  engine::AudioMixer::SoundData sounds;
+  for (auto i = 0; i < NUM_ACTIVE_VOICES; ++i) {
+    sounds[i] =
+      std::vector<data::Sample>(BUFFER_SIZE, static_cast<data::Sample>(i));
+  }
+
+  engine::AudioMixer mixer{std::move(sounds), nullptr, 44100};
+  std::vector<data::Sample> output(BUFFER_SIZE);
+
+  state.setItemsPerIteration(BUFFER_SIZE * NUM_ACTIVE_VOICES);
+  while (state.keepRunning()) {
+    // Each sound is exactly one buffer long, so restarting them all keeps
+    // the number of active voices constant
+    for (auto i = 0; i < NUM_ACTIVE_VOICES; ++i) {
+      mixer.playSound(static_cast<data::SoundId>(i));
+    }
+
+    mixer.mix(output.data(), output.size());
+    benchmark::doNotOptimize(output);
+  }
+}
@@ -0,0 +1,118 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "game_logic/behavior_controller.hpp"
+#include "game_logic/behavior_controller_system.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace {
+
+constexpr auto NUM_ENTITIES_PER_TYPE = 1000;
+
+
+// Stand-ins for simple enemy behaviors, which typically do a little bit of
+// state machine work each frame
+template <int Id>
+struct SimpleBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    const bool isOnScreen,
+    entityx::Entity
+  ) {
+    if (isOnScreen) {
+      mFramesElapsed += Id;
+    }
+
+    if (mFramesElapsed > 1000) {
+      mFramesElapsed = 0;
+      ++mCyclesCompleted;
+    }
+  }
+
+  int mFramesElapsed = 0;
+  int mCyclesCompleted = 0;
+};
+
+
+void runBehaviorUpdate(
+  benchmark::State& state,
+  const BehaviorControllerSystem::UpdateMode mode
+) {
+  entityx::EntityX entityx;
+
+  BehaviorControllerSystem system{
+    GlobalDependencies{
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      &entityx.entities,
+      &entityx.events},
+    nullptr,
+    nullptr,
+    nullptr};
+  system.setUpdateMode(mode);
+
+  // Interleave types, like enemies of different kinds placed throughout
+  // a level
+  auto addEntity = [&](auto behavior) {
+    auto entity = entityx.entities.create();
+    entity.assign<components::BehaviorController>(behavior);
+    entity.assign<engine::components::Active>();
+  };
+
+  for (auto i = 0; i < NUM_ENTITIES_PER_TYPE; ++i) {
+    addEntity(SimpleBehavior<1>{});
+    addEntity(SimpleBehavior<2>{});
+    addEntity(SimpleBehavior<3>{});
+    addEntity(SimpleBehavior<4>{});
+  }
+
+  const auto perFrameState = PerFrameState{};
+
+  state.setItemsPerIteration(NUM_ENTITIES_PER_TYPE * 4);
+  while (state.keepRunning()) {
+    system.update(entityx.entities, perFrameState);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(BehaviorControllerUpdateInEntityOrder) {
+  runBehaviorUpdate(
+    state, BehaviorControllerSystem::UpdateMode::InEntityOrder);
+}
+
+
+RIGEL_BENCHMARK(BehaviorControllerUpdateGroupedByType) {
+  runBehaviorUpdate(
+    state, BehaviorControllerSystem::UpdateMode::GroupedByType);
+}
@@ -0,0 +1,123 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+
+#include "base/warnings.hpp"
+#include "data/map.hpp"
+#include "engine/base_components.hpp"
+#include "engine/collision_checker.hpp"
+#include "engine/physical_components.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace {
+
+constexpr auto NUM_QUERIES = 1024;
+
+
+// World-space bounding boxes of typical actor sizes, spread out over the
+// whole map
+std::vector<BoundingBox> makeQueryBoxes() {
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> size{1, 5};
+  std::uniform_int_distribution<int> x{1, benchmark::SYNTHETIC_MAP_WIDTH - 7};
+  std::uniform_int_distribution<int> y{6, benchmark::SYNTHETIC_MAP_HEIGHT - 2};
+
+  std::vector<BoundingBox> boxes;
+  boxes.reserve(NUM_QUERIES);
+
+  for (auto i = 0; i < NUM_QUERIES; ++i) {
+    const auto width = size(generator);
+    const auto height = size(generator);
+    boxes.push_back(
+      BoundingBox{{x(generator), y(generator) - height + 1}, {width, height}});
+  }
+
+  return boxes;
+}
+
+
+void runSpanTests(benchmark::State& state, const int numSolidBodies) {
+  entityx::EntityX entityx;
+  const auto map = benchmark::makeSyntheticMap();
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+
+  // Stand-ins for things like elevators and force fields
+  for (auto i = 0; i < numSolidBodies; ++i) {
+    auto entity = entityx.entities.create();
+    entity.assign<WorldPosition>(WorldPosition{i * 5 % 250, i * 7 % 120 + 2});
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {4, 2}});
+    entity.assign<SolidBody>();
+  }
+
+  const auto boxes = makeQueryBoxes();
+
+  state.setItemsPerIteration(boxes.size() * 4);
+  while (state.keepRunning()) {
+    auto numCollisions = 0;
+    for (const auto& box : boxes) {
+      numCollisions += collisionChecker.isOnSolidGround(box);
+      numCollisions += collisionChecker.isTouchingCeiling(box);
+      numCollisions += collisionChecker.isTouchingLeftWall(box);
+      numCollisions += collisionChecker.isTouchingRightWall(box);
+    }
+
+    benchmark::doNotOptimize(numCollisions);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(CollisionCheckerSpans) {
+  runSpanTests(state, 0);
+}
+
+
+RIGEL_BENCHMARK(CollisionCheckerSpans20SolidBodies) {
+  runSpanTests(state, 20);
+}
+
+
+RIGEL_BENCHMARK(MapCollisionData) {
+  const auto map = benchmark::makeSyntheticMap();
+
+  state.setItemsPerIteration(map.width() * map.height());
+  while (state.keepRunning()) {
+    auto numSolidTiles = 0;
+    for (auto y = 0; y < map.height(); ++y) {
+      for (auto x = 0; x < map.width(); ++x) {
+        numSolidTiles += map.collisionData(x, y).isSolidOn(
+          data::map::SolidEdge::top());
+      }
+    }
+
+    benchmark::doNotOptimize(numSolidTiles);
+  }
+}
@@ -0,0 +1,92 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "engine/event_queue.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/damage_infliction_system.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+
+
+using namespace rigel;
+using namespace engine::components;
+using namespace game_logic;
+using namespace game_logic::components;
+
+
+namespace {
+
+// Every inflictor is tested against every shootable, so this measures the
+// cost of the pairwise tests. Shootables are invincible, so that the set of
+// entities stays the same across iterations. This also means that the
+// player model and service provider are never used.
+void runDamageInfliction(
+  benchmark::State& state,
+  const int numInflictors,
+  const int numShootables
+) {
+  entityx::EntityX entityx;
+  engine::EventQueue eventQueue{&entityx.events};
+  DamageInflictionSystem damageInflictionSystem{
+    nullptr, nullptr, &eventQueue};
+
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> x{0, 255};
+  std::uniform_int_distribution<int> y{0, 127};
+
+  for (auto i = 0; i < numShootables; ++i) {
+    auto entity = entityx.entities.create();
+    entity.assign<WorldPosition>(WorldPosition{x(generator), y(generator)});
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {3, 3}});
+    entity.assign<Active>();
+
+    auto shootable = Shootable{10};
+    shootable.mInvincible = true;
+    entity.assign<Shootable>(shootable);
+  }
+
+  for (auto i = 0; i < numInflictors; ++i) {
+    auto entity = entityx.entities.create();
+    entity.assign<WorldPosition>(WorldPosition{x(generator), y(generator)});
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 1}});
+    entity.assign<DamageInflicting>(DamageInflicting{1});
+  }
+
+  state.setItemsPerIteration(numInflictors * numShootables);
+  while (state.keepRunning()) {
+    damageInflictionSystem.update(entityx.entities);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(DamageInfliction10x200) {
+  runDamageInfliction(state, 10, 200);
+}
+
+
+RIGEL_BENCHMARK(DamageInfliction100x500) {
+  runDamageInfliction(state, 100, 500);
+}
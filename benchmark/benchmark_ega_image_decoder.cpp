@@ -0,0 +1,96 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "data/game_traits.hpp"
+#include "loader/byte_buffer.hpp"
+#include "loader/ega_image_decoder.hpp"
+#include "loader/palette.hpp"
+
+#include <random>
+
+
+using namespace rigel;
+using data::GameTraits;
+using data::TileImageType;
+
+
+namespace {
+
+constexpr auto FULL_SCREEN_IMAGE_DATA_SIZE =
+  GameTraits::viewPortWidthPx * GameTraits::viewPortHeightPx /
+  GameTraits::pixelsPerEgaByte * GameTraits::egaPlanes;
+
+
+loader::ByteBuffer makeRandomData(const std::size_t size) {
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> distribution{0, 255};
+
+  loader::ByteBuffer data(size);
+  for (auto& byte : data) {
+    byte = static_cast<std::uint8_t>(distribution(generator));
+  }
+
+  return data;
+}
+
+
+void runTiledImageDecoding(
+  benchmark::State& state,
+  const std::size_t numTiles,
+  const TileImageType type
+) {
+  const auto data = makeRandomData(numTiles * GameTraits::bytesPerTile(type));
+
+  state.setItemsPerIteration(numTiles * GameTraits::tileSizeSquared);
+  while (state.keepRunning()) {
+    const auto image = loader::loadTiledImage(
+      data.begin(),
+      data.end(),
+      GameTraits::CZone::tileSetImageWidth,
+      loader::INGAME_PALETTE,
+      type);
+    benchmark::doNotOptimize(image);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(EgaDecodeFullScreenImage) {
+  const auto data = makeRandomData(FULL_SCREEN_IMAGE_DATA_SIZE);
+
+  state.setItemsPerIteration(
+    GameTraits::viewPortWidthPx * GameTraits::viewPortHeightPx);
+  while (state.keepRunning()) {
+    const auto pixels =
+      loader::decodeSimplePlanarEgaBuffer(data.begin(), data.end());
+    benchmark::doNotOptimize(pixels);
+  }
+}
+
+
+RIGEL_BENCHMARK(EgaDecodeSolidTiles) {
+  runTiledImageDecoding(
+    state, GameTraits::CZone::numSolidTiles, TileImageType::Unmasked);
+}
+
+
+RIGEL_BENCHMARK(EgaDecodeMaskedTiles) {
+  runTiledImageDecoding(
+    state, GameTraits::CZone::numMaskedTiles, TileImageType::Masked);
+}
@@ -0,0 +1,175 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+#include "common/game_service_provider.hpp"
+#include "data/game_options.hpp"
+#include "data/map.hpp"
+#include "engine/random_number_generator.hpp"
+#include "engine/sprite_factory.hpp"
+#include "game_logic/entity_factory.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+namespace {
+
+constexpr auto NUM_LEVEL_ACTORS = 1000;
+constexpr auto NUM_SPAWNED_ACTORS = 100;
+
+
+// A typical mix of enemies, items and decoration found in levels
+constexpr auto LEVEL_ACTOR_IDS = std::array{
+  data::ActorID::Hoverbot,
+  data::ActorID::Green_box_rocket_launcher,
+  data::ActorID::Blue_box_health_molecule,
+  data::ActorID::Big_green_cat_LEFT,
+  data::ActorID::Watchbot,
+  data::ActorID::White_box_rapid_fire,
+  data::ActorID::Rocket_launcher_turret,
+  data::ActorID::Bouncing_spike_ball,
+  data::ActorID::Nuclear_waste_can_empty,
+  data::ActorID::Snake};
+
+
+struct NullServiceProvider : public IGameServiceProvider {
+  void fadeOutScreen() override {}
+  void fadeInScreen() override {}
+  void playSound(data::SoundId) override {}
+  void stopSound(data::SoundId) override {}
+  void playMusic(const std::string&) override {}
+  void stopMusic() override {}
+  void scheduleGameQuit() override {}
+  void switchGamePath(const std::filesystem::path&) override {}
+  void markCurrentFrameAsWidescreen() override {}
+  bool isSharewareVersion() const override { return false; }
+
+  const CommandLineOptions& commandLineOptions() const override {
+    static auto dummyOptions = CommandLineOptions{};
+    return dummyOptions;
+  }
+};
+
+
+struct DummySpriteFactory : public engine::ISpriteFactory {
+  engine::components::Sprite createSprite(data::ActorID) override {
+    static const auto dummyDrawData = []() {
+      engine::SpriteDrawData drawData;
+      drawData.mFrames.resize(32);
+      return drawData;
+    }();
+    return {&dummyDrawData, {0}};
+  }
+
+  base::Rect<int> actorFrameRect(data::ActorID, int) const override {
+    return {{}, {2, 2}};
+  }
+};
+
+
+struct FactoryDependencies {
+  entityx::EntityX mEntityx;
+  NullServiceProvider mServiceProvider;
+  engine::RandomNumberGenerator mRandomGenerator;
+  DummySpriteFactory mSpriteFactory;
+  data::GameOptions mOptions;
+};
+
+
+// Returns a prvalue, since EntityFactory can't be copied or moved
+EntityFactory makeFactory(FactoryDependencies& dependencies) {
+  return EntityFactory{
+    &dependencies.mSpriteFactory,
+    &dependencies.mEntityx.entities,
+    &dependencies.mServiceProvider,
+    &dependencies.mRandomGenerator,
+    &dependencies.mOptions,
+    data::Difficulty::Medium};
+}
+
+
+// Like loading a level: A new factory is created each time, so prototypes
+// are created from scratch as well.
+void runLevelLoad(benchmark::State& state, const bool useActorPrototypes) {
+  FactoryDependencies dependencies;
+
+  data::map::ActorDescriptionList actors;
+  for (auto i = 0; i < NUM_LEVEL_ACTORS; ++i) {
+    const auto id = LEVEL_ACTOR_IDS[i % LEVEL_ACTOR_IDS.size()];
+    actors.push_back({{i % 256, 10 + i / 256 * 16}, id, std::nullopt});
+  }
+
+  state.setItemsPerIteration(NUM_LEVEL_ACTORS);
+  while (state.keepRunning()) {
+    dependencies.mEntityx.entities.reset();
+
+    auto factory = makeFactory(dependencies);
+    factory.setActorPrototypesEnabled(useActorPrototypes);
+    factory.createEntitiesForLevel(actors);
+  }
+}
+
+
+// Like spawning actors during gameplay. The factory stays the same, so
+// prototypes only need to be created once. Includes the cost of destroying
+// the spawned entities again.
+void runActorSpawn(benchmark::State& state, const bool useActorPrototypes) {
+  FactoryDependencies dependencies;
+  auto factory = makeFactory(dependencies);
+  factory.setActorPrototypesEnabled(useActorPrototypes);
+
+  state.setItemsPerIteration(NUM_SPAWNED_ACTORS);
+  while (state.keepRunning()) {
+    for (auto i = 0; i < NUM_SPAWNED_ACTORS; ++i) {
+      factory.spawnActor(data::ActorID::Enemy_rocket_left, {i, 10});
+    }
+
+    dependencies.mEntityx.entities.reset();
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(EntityFactoryLevelLoadWithPrototypes) {
+  runLevelLoad(state, true);
+}
+
+
+RIGEL_BENCHMARK(EntityFactoryLevelLoadWithoutPrototypes) {
+  runLevelLoad(state, false);
+}
+
+
+RIGEL_BENCHMARK(EntityFactoryActorSpawnWithPrototypes) {
+  runActorSpawn(state, true);
+}
+
+
+RIGEL_BENCHMARK(EntityFactoryActorSpawnWithoutPrototypes) {
+  runActorSpawn(state, false);
+}
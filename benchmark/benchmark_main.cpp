@@ -0,0 +1,220 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <nlohmann/json.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+
+namespace rigel::benchmark {
+
+namespace {
+
+struct RegisteredBenchmark {
+  std::string mName;
+  BenchmarkFunction mFunction;
+};
+
+
+struct Result {
+  std::string mName;
+  std::size_t mIterations;
+  double mNanosecondsPerIteration;
+  double mItemsPerSecond;
+};
+
+
+struct Options {
+  std::string mFilter;
+  double mMinTimeInSeconds = 0.5;
+  bool mJsonOutput = false;
+};
+
+
+constexpr auto MAX_ITERATIONS = std::size_t{1'000'000'000};
+
+
+std::vector<RegisteredBenchmark>& registry() {
+  static std::vector<RegisteredBenchmark> benchmarks;
+  return benchmarks;
+}
+
+
+double toSeconds(const base::Clock::duration duration) {
+  return std::chrono::duration<double>(duration).count();
+}
+
+
+Result run(const RegisteredBenchmark& benchmark, const Options& options) {
+  auto iterations = std::size_t{1};
+
+  for (;;) {
+    State state{iterations};
+    benchmark.mFunction(state);
+
+    const auto elapsed = toSeconds(state.elapsed());
+    if (elapsed >= options.mMinTimeInSeconds || iterations >= MAX_ITERATIONS) {
+      const auto numIterations = static_cast<double>(iterations);
+      return Result{
+        benchmark.mName,
+        iterations,
+        elapsed * 1e9 / numIterations,
+        elapsed > 0.0
+          ? static_cast<double>(state.itemsPerIteration()) * numIterations /
+            elapsed
+          : 0.0};
+    }
+
+    // Estimate the required number of iterations, with some headroom. Grow by
+    // at least a factor of 2 to quickly get out of the noise for very short
+    // initial timings.
+    const auto estimate = elapsed > 0.0
+      ? static_cast<double>(iterations) * options.mMinTimeInSeconds * 1.4 /
+        elapsed
+      : 0.0;
+    iterations = std::min(
+      MAX_ITERATIONS,
+      std::max(iterations * 2, static_cast<std::size_t>(estimate)));
+  }
+}
+
+
+void printResult(const Result& result) {
+  std::cout << std::left << std::setw(48) << result.mName << std::right
+            << std::setw(14) << std::fixed << std::setprecision(1)
+            << result.mNanosecondsPerIteration << " ns" << std::setw(12)
+            << result.mIterations;
+
+  if (result.mItemsPerSecond > 0.0) {
+    std::cout << std::setw(14) << std::setprecision(2)
+              << result.mItemsPerSecond / 1e6 << " M items/s";
+  }
+
+  std::cout << '\n';
+}
+
+
+nlohmann::json toJson(const Result& result) {
+  auto json = nlohmann::json::object();
+  json["name"] = result.mName;
+  json["iterations"] = result.mIterations;
+  json["nsPerIteration"] = result.mNanosecondsPerIteration;
+  if (result.mItemsPerSecond > 0.0) {
+    json["itemsPerSecond"] = result.mItemsPerSecond;
+  }
+  return json;
+}
+
+
+void printUsage(const char* programName) {
+  std::cerr
+    << "Usage: " << programName << " [options]\n\n"
+    << "  --filter <text>     Only run benchmarks whose name contains text\n"
+    << "  --min-time <secs>   Minimum measurement time per benchmark\n"
+    << "  --json              Print results as JSON\n"
+    << "  --list              List all benchmarks\n";
+}
+
+}
+
+
+State::State(const std::size_t iterations)
+  : mIterations(iterations)
+  , mIterationsLeft(iterations)
+{
+}
+
+
+Registration::Registration(const char* name, BenchmarkFunction function) {
+  registry().push_back({name, function});
+}
+
+
+void detail::escape(const void*) {
+}
+
+}
+
+
+int main(int argc, char** argv) {
+  using namespace rigel::benchmark;
+
+  Options options;
+  auto listOnly = false;
+
+  for (int i = 1; i < argc; ++i) {
+    const auto hasValue = i + 1 < argc;
+
+    if (std::strcmp(argv[i], "--filter") == 0 && hasValue) {
+      options.mFilter = argv[++i];
+    } else if (std::strcmp(argv[i], "--min-time") == 0 && hasValue) {
+      options.mMinTimeInSeconds = std::atof(argv[++i]);
+    } else if (std::strcmp(argv[i], "--json") == 0) {
+      options.mJsonOutput = true;
+    } else if (std::strcmp(argv[i], "--list") == 0) {
+      listOnly = true;
+    } else {
+      printUsage(argv[0]);
+      return -1;
+    }
+  }
+
+  auto benchmarks = registry();
+  std::sort(
+    benchmarks.begin(), benchmarks.end(), [](const auto& lhs, const auto& rhs) {
+      return lhs.mName < rhs.mName;
+    });
+
+  auto jsonResults = nlohmann::json::array();
+
+  for (const auto& benchmark : benchmarks) {
+    if (benchmark.mName.find(options.mFilter) == std::string::npos) {
+      continue;
+    }
+
+    if (listOnly) {
+      std::cout << benchmark.mName << '\n';
+      continue;
+    }
+
+    const auto result = run(benchmark, options);
+
+    if (options.mJsonOutput) {
+      jsonResults.push_back(toJson(result));
+    } else {
+      printResult(result);
+    }
+  }
+
+  if (options.mJsonOutput && !listOnly) {
+    std::cout << jsonResults.dump(2) << '\n';
+  }
+
+  return 0;
+}
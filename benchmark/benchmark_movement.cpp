@@ -0,0 +1,109 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+#include "fixtures.hpp"
+
+#include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "engine/collision_checker.hpp"
+#include "engine/movement.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace {
+
+constexpr auto NUM_ENTITIES = 500;
+constexpr auto MOVEMENT_AMOUNT = 3;
+
+
+template <typename MoveFunc>
+void runMovement(benchmark::State& state, MoveFunc move) {
+  entityx::EntityX entityx;
+  const auto map = benchmark::makeSyntheticMap();
+  CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
+
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> x{1, benchmark::SYNTHETIC_MAP_WIDTH - 4};
+  std::uniform_int_distribution<int> floorIndex{
+    1,
+    benchmark::SYNTHETIC_MAP_HEIGHT / benchmark::SYNTHETIC_MAP_FLOOR_SPACING};
+
+  // Actors standing on one of the floors
+  std::vector<entityx::Entity> entities;
+  std::vector<WorldPosition> initialPositions;
+  for (auto i = 0; i < NUM_ENTITIES; ++i) {
+    const auto position = WorldPosition{
+      x(generator),
+      floorIndex(generator) * benchmark::SYNTHETIC_MAP_FLOOR_SPACING - 2};
+
+    auto entity = entityx.entities.create();
+    entity.assign<WorldPosition>(position);
+    entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 3}});
+    entities.push_back(entity);
+    initialPositions.push_back(position);
+  }
+
+  state.setItemsPerIteration(entities.size());
+  while (state.keepRunning()) {
+    auto numCompleted = 0;
+    for (auto i = 0u; i < entities.size(); ++i) {
+      auto& entity = entities[i];
+      numCompleted += move(collisionChecker, entity) ==
+        MovementResult::Completed;
+
+      // Reset so that each iteration does the same amount of work
+      *entity.component<WorldPosition>() = initialPositions[i];
+    }
+
+    benchmark::doNotOptimize(numCompleted);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(MoveHorizontally) {
+  runMovement(state, [](const auto& collisionChecker, auto entity) {
+    return moveHorizontally(collisionChecker, entity, MOVEMENT_AMOUNT);
+  });
+}
+
+
+RIGEL_BENCHMARK(MoveHorizontallyWithStairStepping) {
+  runMovement(state, [](const auto& collisionChecker, auto entity) {
+    return moveHorizontallyWithStairStepping(
+      collisionChecker, entity, MOVEMENT_AMOUNT);
+  });
+}
+
+
+RIGEL_BENCHMARK(MoveVertically) {
+  runMovement(state, [](const auto& collisionChecker, auto entity) {
+    return moveVertically(collisionChecker, entity, -MOVEMENT_AMOUNT);
+  });
+}
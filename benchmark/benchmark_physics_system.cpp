@@ -0,0 +1,97 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+#include "data/map.hpp"
+#include "engine/base_components.hpp"
+#include "engine/collision_checker.hpp"
+#include "engine/event_queue.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/physics_system.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace {
+
+// Simulates a big explosion: Lots of debris pieces are spawned between
+// physics phase 1 and 2, and many of them disappear again in the same frame.
+void runDebrisSpawning(benchmark::State& state, const int numPiecesPerFrame) {
+  entityx::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  data::map::Map map{200, 200, data::map::TileAttributeDict{{0x0, 0xF}}};
+  CollisionChecker collisionChecker{&map, entities, entityx.events};
+  EventQueue eventQueue{&entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &eventQueue};
+
+  std::vector<entityx::Entity> debris;
+  debris.reserve(numPiecesPerFrame);
+
+  state.setItemsPerIteration(numPiecesPerFrame);
+  while (state.keepRunning()) {
+    physicsSystem.updatePhase1(entities);
+
+    for (auto i = 0; i < numPiecesPerFrame; ++i) {
+      auto entity = entities.create();
+      entity.assign<BoundingBox>(BoundingBox{{0, 0}, {1, 1}});
+      entity.assign<MovingBody>(
+        MovingBody{{static_cast<float>(i % 3 - 1), -2.0f}, true});
+      entity.assign<WorldPosition>(WorldPosition{i % 150 + 10, 100});
+      entity.assign<Active>();
+      debris.push_back(entity);
+    }
+
+    // Destroy every other piece, latest first. This is the worst case for
+    // removal from a linear list.
+    for (auto i = numPiecesPerFrame - 1; i >= 0; i -= 2) {
+      debris[i].destroy();
+    }
+
+    physicsSystem.updatePhase2(entities);
+
+    for (auto& entity : debris) {
+      if (entity.valid()) {
+        entity.destroy();
+      }
+    }
+    debris.clear();
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(PhysicsPhase2Spawn100) {
+  runDebrisSpawning(state, 100);
+}
+
+
+RIGEL_BENCHMARK(PhysicsPhase2Spawn1000) {
+  runDebrisSpawning(state, 1000);
+}
@@ -0,0 +1,91 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "loader/byte_buffer.hpp"
+#include "loader/file_utils.hpp"
+#include "loader/rle_compression.hpp"
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace {
+
+constexpr auto NUM_RLE_WORDS = 4096;
+
+
+struct CompressedData {
+  loader::ByteBuffer mData;
+  std::size_t mDecompressedSize;
+};
+
+
+// Mix of repeated and literal runs of random lengths, terminated by a 0
+// marker
+CompressedData makeCompressedData() {
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> runLength{1, 127};
+  std::uniform_int_distribution<int> byteValue{0, 255};
+
+  CompressedData result{{}, 0};
+  auto& data = result.mData;
+
+  for (auto i = 0; i < NUM_RLE_WORDS; ++i) {
+    const auto length = runLength(generator);
+    result.mDecompressedSize += length;
+
+    if (i % 2 == 0) {
+      data.push_back(static_cast<std::uint8_t>(length));
+      data.push_back(static_cast<std::uint8_t>(byteValue(generator)));
+    } else {
+      data.push_back(static_cast<std::uint8_t>(-length));
+      for (auto j = 0; j < length; ++j) {
+        data.push_back(static_cast<std::uint8_t>(byteValue(generator)));
+      }
+    }
+  }
+
+  data.push_back(0);
+  return result;
+}
+
+}
+
+
+RIGEL_BENCHMARK(RleDecompression) {
+  const auto compressed = makeCompressedData();
+
+  std::vector<std::uint8_t> output;
+  output.reserve(compressed.mDecompressedSize);
+
+  state.setItemsPerIteration(compressed.mDecompressedSize);
+  while (state.keepRunning()) {
+    output.clear();
+
+    loader::LeStreamReader reader{compressed.mData};
+    loader::decompressRle(reader, [&](const std::uint8_t byte) {
+      output.push_back(byte);
+    });
+
+    benchmark::doNotOptimize(output);
+  }
+}
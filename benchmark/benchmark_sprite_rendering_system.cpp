@@ -0,0 +1,102 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "base/warnings.hpp"
+#include "engine/base_components.hpp"
+#include "engine/sprite_rendering_system.hpp"
+#include "engine/visual_components.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <random>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace {
+
+constexpr auto VIEW_PORT_SIZE = base::Extents{32, 20};
+constexpr auto CAMERA_POSITION = base::Vector{100, 50};
+
+
+SpriteDrawData makeDrawData(const int drawOrder) {
+  SpriteDrawData drawData;
+  drawData.mFrames = {
+    SpriteFrame{0, {0, 0}, {2, 2}},
+    SpriteFrame{1, {0, 0}, {3, 2}},
+    SpriteFrame{2, {1, 0}, {2, 4}}};
+  drawData.mDrawOrder = drawOrder;
+  return drawData;
+}
+
+
+// Collects sprites from numEntities entities, placed randomly inside the
+// given area. Only entities within view of the camera end up being drawn.
+void runSpriteCollection(
+  benchmark::State& state,
+  const int numEntities,
+  const base::Rect<int>& area
+) {
+  entityx::EntityX entityx;
+
+  const auto drawData = std::array<SpriteDrawData, 4>{
+    makeDrawData(2), makeDrawData(5), makeDrawData(1), makeDrawData(9)};
+
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<int> x{area.left(), area.right()};
+  std::uniform_int_distribution<int> y{area.top(), area.bottom()};
+
+  for (auto i = 0; i < numEntities; ++i) {
+    auto entity = entityx.entities.create();
+    entity.assign<WorldPosition>(WorldPosition{x(generator), y(generator)});
+    entity.assign<Sprite>(
+      Sprite{&drawData[i % drawData.size()], {i % 3}});
+
+    // A few sprites with multiple render slots, like most enemies
+    if (i % 4 == 0) {
+      entity.component<Sprite>()->mFramesToRender[1] = 1;
+    }
+  }
+
+  SpriteRenderingSystem spriteRenderingSystem{nullptr, nullptr};
+
+  state.setItemsPerIteration(numEntities);
+  while (state.keepRunning()) {
+    spriteRenderingSystem.update(
+      entityx.entities, VIEW_PORT_SIZE, CAMERA_POSITION, false);
+  }
+}
+
+}
+
+
+RIGEL_BENCHMARK(SpriteCollection2000SpreadOut) {
+  runSpriteCollection(state, 2000, base::Rect<int>{{0, 0}, {256, 128}});
+}
+
+
+RIGEL_BENCHMARK(SpriteCollection500OnScreen) {
+  runSpriteCollection(
+    state, 500, base::Rect<int>{CAMERA_POSITION, VIEW_PORT_SIZE});
+}
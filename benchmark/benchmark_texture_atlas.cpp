@@ -0,0 +1,61 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "benchmark.hpp"
+
+#include "data/image.hpp"
+#include "renderer/texture_atlas.hpp"
+
+#include <random>
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace {
+
+constexpr auto NUM_IMAGES = 600;
+
+
+// Roughly resembles the sprites that go into the in-game sprite atlas: Lots
+// of small to medium images of varying sizes
+std::vector<data::Image> makeImages() {
+  std::mt19937 generator{1234};
+  std::uniform_int_distribution<std::size_t> size{1, 6};
+
+  std::vector<data::Image> images;
+  images.reserve(NUM_IMAGES);
+
+  for (auto i = 0; i < NUM_IMAGES; ++i) {
+    images.emplace_back(size(generator) * 8, size(generator) * 8);
+  }
+
+  return images;
+}
+
+}
+
+
+RIGEL_BENCHMARK(TextureAtlasPacking) {
+  const auto images = makeImages();
+
+  state.setItemsPerIteration(images.size());
+  while (state.keepRunning()) {
+    const auto packedAtlas = renderer::packIntoAtlas(images);
+    benchmark::doNotOptimize(packedAtlas);
+  }
+}
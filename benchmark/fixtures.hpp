@@ -0,0 +1,65 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "data/map.hpp"
+
+#include <random>
+
+
+/* Synthetic data shared by several benchmarks
+ *
+ * Everything here is generated with fixed seeds, so that results can be
+ * compared across runs and commits.
+ */
+
+namespace rigel::benchmark {
+
+constexpr auto SYNTHETIC_MAP_WIDTH = 256;
+constexpr auto SYNTHETIC_MAP_HEIGHT = 128;
+constexpr auto SYNTHETIC_MAP_FLOOR_SPACING = 16;
+
+
+/** Map with a floor every few rows and randomly placed solid blocks
+ *
+ * Tile 0 is empty, tile 1 is solid on all edges. Floors are at rows which
+ * are a multiple of SYNTHETIC_MAP_FLOOR_SPACING minus one.
+ */
+inline data::map::Map makeSyntheticMap() {
+  data::map::Map map{
+    SYNTHETIC_MAP_WIDTH,
+    SYNTHETIC_MAP_HEIGHT,
+    data::map::TileAttributeDict{{0x0, 0xF}}};
+
+  std::mt19937 generator{42};
+  std::uniform_int_distribution<int> percentage{0, 99};
+
+  for (auto y = 0; y < SYNTHETIC_MAP_HEIGHT; ++y) {
+    const auto isFloor =
+      y % SYNTHETIC_MAP_FLOOR_SPACING == SYNTHETIC_MAP_FLOOR_SPACING - 1;
+
+    for (auto x = 0; x < SYNTHETIC_MAP_WIDTH; ++x) {
+      if (isFloor || percentage(generator) < 8) {
+        map.setTileAt(0, x, y, 1);
+      }
+    }
+  }
+
+  return map;
+}
+
+}
@@ -8,10 +8,6 @@ function(rigel_define_wasm_targets_for_dependencies)
     target_compile_options(SDL2::Core INTERFACE "SHELL:-s USE_SDL=2")
     target_link_options(SDL2::Core INTERFACE "SHELL:-s USE_SDL=2")
 
-    add_library(SDL2::Mixer INTERFACE IMPORTED)
-    target_compile_options(SDL2::Mixer INTERFACE "SHELL:-s USE_SDL_MIXER=2")
-    target_link_options(SDL2::Mixer INTERFACE "SHELL:-s USE_SDL_MIXER=2")
-
     add_library(Boost::boost INTERFACE IMPORTED)
     target_compile_options(Boost::boost INTERFACE
         "SHELL:-s USE_BOOST_HEADERS=1"
@@ -77,6 +77,14 @@ public:
   {
   }
 
+  // implicit on purpose
+  template <typename Allocator>
+  ArrayView(const std::vector<T, Allocator>& vec) noexcept // NOLINT
+    : mpData(vec.data())
+    , mSize(static_cast<size_type>(vec.size()))
+  {
+  }
+
   const_iterator begin() const {
     return mpData;
   }
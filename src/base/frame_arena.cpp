@@ -0,0 +1,77 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "frame_arena.hpp"
+
+#include <cassert>
+
+
+namespace rigel::base {
+
+namespace {
+
+std::size_t alignUp(const std::size_t value, const std::size_t alignment) {
+  return (value + alignment - 1) & ~(alignment - 1);
+}
+
+}
+
+
+FrameArena::FrameArena(const std::size_t initialCapacity)
+  : mpBuffer(std::make_unique<std::byte[]>(initialCapacity))
+  , mCapacity(initialCapacity)
+{
+}
+
+
+void* FrameArena::allocate(
+  const std::size_t size,
+  const std::size_t alignment
+) {
+  // Both the buffer and the overflow blocks come from operator new[], which
+  // gives us this alignment. Offsets are therefore aligned relative to the
+  // start of the buffer.
+  assert(alignment <= alignof(std::max_align_t));
+
+  const auto alignedOffset = alignUp(mOffset, alignment);
+  if (alignedOffset + size <= mCapacity) {
+    mOffset = alignedOffset + size;
+    return mpBuffer.get() + alignedOffset;
+  }
+
+  auto& block = mOverflowBlocks.emplace_back(
+    std::make_unique<std::byte[]>(size));
+  mOverflowBytes += size;
+  return block.get();
+}
+
+
+void FrameArena::reset() {
+  if (!mOverflowBlocks.empty()) {
+    // Leave some headroom, so that we don't need to grow again right away if
+    // the next frame needs slightly more
+    const auto requiredCapacity = mOffset + mOverflowBytes;
+    mCapacity = requiredCapacity + requiredCapacity / 2;
+    mpBuffer = std::make_unique<std::byte[]>(mCapacity);
+
+    mOverflowBlocks.clear();
+    mOverflowBytes = 0;
+  }
+
+  mOffset = 0;
+}
+
+}
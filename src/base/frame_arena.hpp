@@ -0,0 +1,133 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+
+namespace rigel::base {
+
+/** Bump allocator for short-lived data
+ *
+ * Meant for temporary containers which are needed while producing a single
+ * frame. Allocating is just a matter of advancing an offset into a
+ * pre-allocated buffer, and individual deallocations are ignored. Instead,
+ * all memory is reclaimed at once by calling reset() at the end of the frame.
+ *
+ * If an allocation doesn't fit into the buffer, it's served from the heap
+ * instead. The buffer is then enlarged on the next reset(), so that
+ * subsequent frames with similar memory needs don't require any heap
+ * allocations.
+ *
+ * Not thread-safe.
+ */
+class FrameArena {
+public:
+  explicit FrameArena(std::size_t initialCapacity);
+
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+
+  void* allocate(std::size_t size, std::size_t alignment);
+
+  /** Make the entire buffer available again
+   *
+   * Invalidates all memory handed out since the previous reset.
+   */
+  void reset();
+
+  std::size_t capacity() const {
+    return mCapacity;
+  }
+
+  /** Bytes allocated since the last reset, including heap fallbacks */
+  std::size_t bytesUsed() const {
+    return mOffset + mOverflowBytes;
+  }
+
+private:
+  std::unique_ptr<std::byte[]> mpBuffer;
+  std::size_t mCapacity;
+  std::size_t mOffset = 0;
+
+  std::vector<std::unique_ptr<std::byte[]>> mOverflowBlocks;
+  std::size_t mOverflowBytes = 0;
+};
+
+
+/** Standard allocator interface for FrameArena
+ *
+ * Allows using standard containers with arena memory, see ArenaVector.
+ * Containers using this must not outlive the next reset() of the arena.
+ */
+template <typename T>
+class ArenaAllocator {
+public:
+  using value_type = T;
+
+  explicit ArenaAllocator(FrameArena* pArena) noexcept
+    : mpArena(pArena)
+  {
+  }
+
+  template <typename U>
+  ArenaAllocator(const ArenaAllocator<U>& other) noexcept // NOLINT
+    : mpArena(other.arena())
+  {
+  }
+
+  T* allocate(const std::size_t count) {
+    return static_cast<T*>(mpArena->allocate(count * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T*, std::size_t) noexcept {
+    // Memory is reclaimed all at once by FrameArena::reset()
+  }
+
+  FrameArena* arena() const noexcept {
+    return mpArena;
+  }
+
+private:
+  FrameArena* mpArena;
+};
+
+
+template <typename T, typename U>
+bool operator==(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return lhs.arena() == rhs.arena();
+}
+
+
+template <typename T, typename U>
+bool operator!=(const ArenaAllocator<T>& lhs, const ArenaAllocator<U>& rhs) {
+  return !(lhs == rhs);
+}
+
+
+template <typename T>
+using ArenaVector = std::vector<T, ArenaAllocator<T>>;
+
+
+template <typename T>
+ArenaVector<T> makeArenaVector(FrameArena* pArena) {
+  return ArenaVector<T>{ArenaAllocator<T>{pArena}};
+}
+
+}
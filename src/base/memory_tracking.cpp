@@ -0,0 +1,251 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_tracking.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <ostream>
+
+
+namespace rigel::base {
+
+namespace {
+
+class Counter {
+public:
+  void add(const std::size_t bytes) {
+    const auto newValue =
+      mCurrent.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+
+    auto peak = mPeak.load(std::memory_order_relaxed);
+    while (
+      newValue > peak &&
+      !mPeak.compare_exchange_weak(peak, newValue, std::memory_order_relaxed)
+    ) {
+    }
+  }
+
+  void remove(const std::size_t bytes) {
+    mCurrent.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  MemoryStatistics statistics() const {
+    return {
+      mCurrent.load(std::memory_order_relaxed),
+      mPeak.load(std::memory_order_relaxed)};
+  }
+
+private:
+  std::atomic<std::size_t> mCurrent{0};
+  std::atomic<std::size_t> mPeak{0};
+};
+
+
+std::atomic<std::uint64_t> gHeapAllocationCount{0};
+Counter gHeapMemory;
+std::array<Counter, NUM_MEMORY_TAGS> gTrackedMemory;
+
+
+Counter& counterFor(const MemoryTag tag) {
+  return gTrackedMemory[static_cast<std::size_t>(tag)];
+}
+
+
+void printRow(
+  std::ostream& stream,
+  const char* name,
+  const MemoryStatistics& statistics
+) {
+  constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+
+  stream
+    << "  " << std::left << std::setw(20) << name << std::right
+    << std::setw(10) << statistics.mCurrentBytes / BYTES_PER_MB << " MB"
+    << std::setw(10) << statistics.mPeakBytes / BYTES_PER_MB << " MB\n";
+}
+
+}
+
+
+std::uint64_t heapAllocationCount() {
+  return gHeapAllocationCount.load(std::memory_order_relaxed);
+}
+
+
+MemoryStatistics heapMemoryUsage() {
+  return gHeapMemory.statistics();
+}
+
+
+const char* memoryTagName(const MemoryTag tag) {
+  switch (tag) {
+    case MemoryTag::GameData: return "Game data";
+    case MemoryTag::TextureStaging: return "Texture staging";
+    case MemoryTag::WorldState: return "World state";
+    case MemoryTag::SavedWorldState: return "Saved world state";
+    case MemoryTag::AudioSamples: return "Audio samples";
+    case MemoryTag::Movies: return "Movies";
+  }
+
+  return "";
+}
+
+
+MemoryStatistics trackedMemoryUsage(const MemoryTag tag) {
+  return counterFor(tag).statistics();
+}
+
+
+TrackedMemory::TrackedMemory(const MemoryTag tag, const std::size_t bytes)
+  : mTag(tag)
+  , mBytes(bytes)
+{
+  counterFor(mTag).add(mBytes);
+}
+
+
+TrackedMemory::~TrackedMemory() {
+  counterFor(mTag).remove(mBytes);
+}
+
+
+TrackedMemory::TrackedMemory(const TrackedMemory& other)
+  : TrackedMemory(other.mTag, other.mBytes)
+{
+}
+
+
+TrackedMemory::TrackedMemory(TrackedMemory&& other) noexcept
+  : mTag(other.mTag)
+  , mBytes(other.mBytes)
+{
+  other.mBytes = 0;
+}
+
+
+TrackedMemory& TrackedMemory::operator=(const TrackedMemory& other) {
+  if (this != &other) {
+    counterFor(mTag).remove(mBytes);
+    mTag = other.mTag;
+    mBytes = other.mBytes;
+    counterFor(mTag).add(mBytes);
+  }
+
+  return *this;
+}
+
+
+TrackedMemory& TrackedMemory::operator=(TrackedMemory&& other) noexcept {
+  if (this != &other) {
+    counterFor(mTag).remove(mBytes);
+    mTag = other.mTag;
+    mBytes = other.mBytes;
+    other.mBytes = 0;
+  }
+
+  return *this;
+}
+
+
+void TrackedMemory::setSize(const std::size_t bytes) {
+  if (bytes > mBytes) {
+    counterFor(mTag).add(bytes - mBytes);
+  } else {
+    counterFor(mTag).remove(mBytes - bytes);
+  }
+
+  mBytes = bytes;
+}
+
+
+void printMemoryReport(std::ostream& stream) {
+  const auto savedFlags = stream.flags();
+  const auto savedPrecision = stream.precision();
+
+  stream
+    << std::left << std::setw(22) << "Memory usage" << std::right
+    << std::setw(13) << "current" << std::setw(13) << "peak" << '\n'
+    << std::fixed << std::setprecision(2);
+
+  for (auto i = 0; i < NUM_MEMORY_TAGS; ++i) {
+    const auto tag = static_cast<MemoryTag>(i);
+    printRow(stream, memoryTagName(tag), trackedMemoryUsage(tag));
+  }
+
+  if constexpr (HEAP_ALLOCATION_TRACKING_ENABLED) {
+    printRow(stream, "Heap (total)", heapMemoryUsage());
+  }
+
+  stream.flags(savedFlags);
+  stream.precision(savedPrecision);
+}
+
+}
+
+
+#ifdef RIGEL_TRACK_HEAP_ALLOCATIONS
+
+// The array and nothrow versions of these forward to the ones below, so it's
+// enough to only replace these. Over-aligned allocations aren't counted.
+//
+// Each allocation is prefixed with a header storing its size, so that the
+// size is known again when deallocating.
+
+namespace {
+
+constexpr auto ALLOCATION_HEADER_SIZE = alignof(std::max_align_t);
+
+}
+
+
+void* operator new(const std::size_t size) {
+  auto pMemory =
+    static_cast<unsigned char*>(std::malloc(size + ALLOCATION_HEADER_SIZE));
+  if (!pMemory) {
+    throw std::bad_alloc{};
+  }
+
+  *reinterpret_cast<std::size_t*>(pMemory) = size;
+
+  rigel::base::gHeapAllocationCount.fetch_add(1, std::memory_order_relaxed);
+  rigel::base::gHeapMemory.add(size);
+
+  return pMemory + ALLOCATION_HEADER_SIZE;
+}
+
+
+void operator delete(void* pMemory) noexcept {
+  if (!pMemory) {
+    return;
+  }
+
+  auto pAllocation =
+    static_cast<unsigned char*>(pMemory) - ALLOCATION_HEADER_SIZE;
+  rigel::base::gHeapMemory.remove(
+    *reinterpret_cast<std::size_t*>(pAllocation));
+  std::free(pAllocation);
+}
+
+
+void operator delete(void* pMemory, std::size_t) noexcept {
+  operator delete(pMemory);
+}
+
+#endif
@@ -0,0 +1,121 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+
+
+namespace rigel::base {
+
+#ifdef RIGEL_TRACK_HEAP_ALLOCATIONS
+constexpr auto HEAP_ALLOCATION_TRACKING_ENABLED = true;
+#else
+constexpr auto HEAP_ALLOCATION_TRACKING_ENABLED = false;
+#endif
+
+
+/** Number of heap allocations made through operator new so far
+ *
+ * Counting requires replacing the global operator new, which is only done
+ * when building with the TRACK_HEAP_ALLOCATIONS CMake option. Without that,
+ * this always returns 0.
+ */
+std::uint64_t heapAllocationCount();
+
+
+struct MemoryStatistics {
+  std::size_t mCurrentBytes = 0;
+  std::size_t mPeakBytes = 0;
+};
+
+
+/** Total size of all heap allocations made through operator new
+ *
+ * Like heapAllocationCount(), this requires TRACK_HEAP_ALLOCATIONS. Without
+ * that, both values are always 0.
+ */
+MemoryStatistics heapMemoryUsage();
+
+
+/** Categories for explicit memory accounting, see TrackedMemory */
+enum class MemoryTag {
+  /** Game files kept in memory as a whole (the CMP package) */
+  GameData,
+
+  /** Images on the CPU side waiting to be uploaded to textures */
+  TextureStaging,
+
+  /** The world state of the currently running level */
+  WorldState,
+
+  /** Copies of the world state kept for quick saves and rewinding */
+  SavedWorldState,
+
+  /** Decoded and resampled sound effects */
+  AudioSamples,
+
+  /** Movie data and decoding state */
+  Movies
+};
+
+constexpr auto NUM_MEMORY_TAGS = 6;
+
+
+const char* memoryTagName(MemoryTag tag);
+
+/** Bytes currently accounted for under the given tag, and the peak value */
+MemoryStatistics trackedMemoryUsage(MemoryTag tag);
+
+
+/** Accounts a number of bytes to a memory tag for as long as it exists
+ *
+ * Meant to be added as a member to classes owning large buffers, or used
+ * as a local for temporary buffers. Copies account for the same amount of
+ * memory again, since the object holding them is usually copied along with
+ * its buffers.
+ *
+ * Thread-safe, different instances can be used from different threads.
+ */
+class TrackedMemory {
+public:
+  TrackedMemory(MemoryTag tag, std::size_t bytes = 0);
+  ~TrackedMemory();
+
+  TrackedMemory(const TrackedMemory& other);
+  TrackedMemory(TrackedMemory&& other) noexcept;
+  TrackedMemory& operator=(const TrackedMemory& other);
+  TrackedMemory& operator=(TrackedMemory&& other) noexcept;
+
+  /** Change the number of bytes accounted for, e.g. after a buffer grew */
+  void setSize(std::size_t bytes);
+
+  std::size_t size() const {
+    return mBytes;
+  }
+
+private:
+  MemoryTag mTag;
+  std::size_t mBytes;
+};
+
+
+/** Print a table of the current and peak values of all memory statistics */
+void printMemoryReport(std::ostream& stream);
+
+}
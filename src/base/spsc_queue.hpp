@@ -0,0 +1,98 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <utility>
+
+
+namespace rigel::base {
+
+/** Lock-free single-producer/single-consumer queue with fixed capacity
+ *
+ * Meant for passing data to and from real-time threads like the audio
+ * callback. Exactly one thread may call the producer functions (tryPush(),
+ * full()), and exactly one other thread may call the consumer functions
+ * (front(), pop(), empty()). None of these block, and none of them allocate
+ * memory by themselves.
+ *
+ * pop() resets the slot to a default-constructed T. This way, any resources
+ * owned by a popped element are released on the consumer thread, not at some
+ * later point when the producer reuses the slot.
+ */
+template<typename T, std::size_t Capacity>
+class SpscQueue {
+public:
+  static_assert(Capacity > 0);
+
+  /** Add an element at the back. Returns false if the queue is full. */
+  bool tryPush(T&& value) {
+    const auto writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    const auto nextWriteIndex = next(writeIndex);
+    if (nextWriteIndex == mReadIndex.load(std::memory_order_acquire)) {
+      return false;
+    }
+
+    mSlots[writeIndex] = std::move(value);
+    mWriteIndex.store(nextWriteIndex, std::memory_order_release);
+    return true;
+  }
+
+  bool full() const {
+    const auto writeIndex = mWriteIndex.load(std::memory_order_relaxed);
+    return next(writeIndex) == mReadIndex.load(std::memory_order_acquire);
+  }
+
+  /** Access the oldest element, or nullptr if the queue is empty */
+  T* front() {
+    const auto readIndex = mReadIndex.load(std::memory_order_relaxed);
+    if (readIndex == mWriteIndex.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+
+    return &mSlots[readIndex];
+  }
+
+  /** Remove the oldest element. Must only be called if front() != nullptr */
+  void pop() {
+    const auto readIndex = mReadIndex.load(std::memory_order_relaxed);
+    mSlots[readIndex] = T{};
+    mReadIndex.store(next(readIndex), std::memory_order_release);
+  }
+
+  bool empty() const {
+    return mReadIndex.load(std::memory_order_relaxed) ==
+      mWriteIndex.load(std::memory_order_acquire);
+  }
+
+private:
+  // One slot is always left unused, to tell a full queue apart from an empty
+  // one without needing an additional counter.
+  static constexpr auto NUM_SLOTS = Capacity + 1;
+
+  static std::size_t next(const std::size_t index) {
+    return (index + 1) % NUM_SLOTS;
+  }
+
+  std::array<T, NUM_SLOTS> mSlots;
+  std::atomic<std::size_t> mReadIndex{0};
+  std::atomic<std::size_t> mWriteIndex{0};
+};
+
+}
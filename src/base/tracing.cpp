@@ -0,0 +1,246 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "tracing.hpp"
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <vector>
+
+
+namespace rigel::base::tracing {
+
+namespace {
+
+using Nanoseconds = std::chrono::duration<std::int64_t, std::nano>;
+
+constexpr auto EVENTS_PER_CHUNK = std::size_t{16384};
+constexpr auto MAX_CHUNKS_PER_THREAD = std::size_t{256};
+
+
+struct Event {
+  const char* mName;
+  std::int64_t mStartTime;
+  std::int64_t mDuration;
+};
+
+
+using Chunk = std::array<Event, EVENTS_PER_CHUNK>;
+
+
+/** Events recorded by a single thread
+ *
+ * Only the owning thread appends events. Chunks are allocated on demand and
+ * never freed or moved, so the writer can safely read all events up to
+ * mNumEvents while recording continues. Once all chunks are full, further
+ * events are dropped.
+ */
+struct ThreadBuffer {
+  explicit ThreadBuffer(const int threadId)
+    : mThreadId(threadId)
+  {
+  }
+
+  void append(const Event& event) {
+    const auto index = mNumEvents.load(std::memory_order_relaxed);
+    const auto chunkIndex = index / EVENTS_PER_CHUNK;
+    if (chunkIndex >= MAX_CHUNKS_PER_THREAD) {
+      mNumDroppedEvents.fetch_add(1, std::memory_order_relaxed);
+      return;
+    }
+
+    auto& pChunk = mChunks[chunkIndex];
+    if (!pChunk) {
+      pChunk = std::make_unique<Chunk>();
+    }
+
+    (*pChunk)[index % EVENTS_PER_CHUNK] = event;
+    mNumEvents.store(index + 1, std::memory_order_release);
+  }
+
+  const Event& operator[](const std::size_t index) const {
+    return (*mChunks[index / EVENTS_PER_CHUNK])[index % EVENTS_PER_CHUNK];
+  }
+
+  const int mThreadId;
+
+  // Guarded by Registry::mMutex
+  std::string mThreadName;
+
+  std::array<std::unique_ptr<Chunk>, MAX_CHUNKS_PER_THREAD> mChunks;
+  std::atomic<std::size_t> mNumEvents{0};
+  std::atomic<std::size_t> mNumDroppedEvents{0};
+};
+
+
+struct Registry {
+  std::mutex mMutex;
+  Clock::time_point mStartTime;
+
+  // Buffers are kept alive after their thread ends, so that the events are
+  // still available when writing the trace file.
+  std::vector<std::unique_ptr<ThreadBuffer>> mThreadBuffers;
+};
+
+
+Registry& registry() {
+  static Registry instance;
+  return instance;
+}
+
+
+ThreadBuffer& currentThreadBuffer() {
+  thread_local ThreadBuffer* pBuffer = nullptr;
+
+  if (!pBuffer) {
+    auto& reg = registry();
+    std::lock_guard lock{reg.mMutex};
+
+    const auto threadId = static_cast<int>(reg.mThreadBuffers.size()) + 1;
+    reg.mThreadBuffers.push_back(std::make_unique<ThreadBuffer>(threadId));
+    pBuffer = reg.mThreadBuffers.back().get();
+  }
+
+  return *pBuffer;
+}
+
+
+std::int64_t toNanoseconds(const Clock::duration duration) {
+  return std::chrono::duration_cast<Nanoseconds>(duration).count();
+}
+
+
+double toMicroseconds(const std::int64_t nanoseconds) {
+  return nanoseconds / 1000.0;
+}
+
+}
+
+
+namespace detail {
+
+std::atomic<bool> gTracingEnabled{false};
+
+
+void recordEvent(
+  const char* name,
+  const Clock::time_point startTime,
+  const Clock::time_point endTime
+) {
+  currentThreadBuffer().append(Event{
+    name,
+    toNanoseconds(startTime.time_since_epoch()),
+    toNanoseconds(endTime - startTime)});
+}
+
+}
+
+
+void enable() {
+  auto& reg = registry();
+
+  {
+    std::lock_guard lock{reg.mMutex};
+    if (isEnabled()) {
+      return;
+    }
+
+    reg.mStartTime = Clock::now();
+  }
+
+  detail::gTracingEnabled.store(true, std::memory_order_relaxed);
+}
+
+
+void setCurrentThreadName(std::string name) {
+  auto& buffer = currentThreadBuffer();
+
+  std::lock_guard lock{registry().mMutex};
+  buffer.mThreadName = std::move(name);
+}
+
+
+void writeTraceFile(const std::filesystem::path& path) {
+  std::ofstream file(path);
+  if (!file.is_open()) {
+    throw std::runtime_error(
+      "Cannot open trace file for writing: " + path.u8string());
+  }
+
+  auto& reg = registry();
+  std::lock_guard lock{reg.mMutex};
+
+  const auto startTime = toNanoseconds(reg.mStartTime.time_since_epoch());
+  auto numDroppedEvents = std::size_t{0};
+
+  file << std::fixed << std::setprecision(3);
+  file << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+
+  auto isFirstEvent = true;
+  auto beginEvent = [&]() -> std::ostream& {
+    if (!isFirstEvent) {
+      file << ",\n";
+    }
+
+    isFirstEvent = false;
+    return file;
+  };
+
+  for (const auto& pBuffer : reg.mThreadBuffers) {
+    const auto& buffer = *pBuffer;
+
+    if (!buffer.mThreadName.empty()) {
+      beginEvent()
+        << R"({"name":"thread_name","ph":"M","pid":1,"tid":)"
+        << buffer.mThreadId
+        << R"(,"args":{"name":")" << buffer.mThreadName << "\"}}";
+    }
+
+    const auto numEvents = buffer.mNumEvents.load(std::memory_order_acquire);
+    for (auto i = std::size_t{0}; i < numEvents; ++i) {
+      const auto& event = buffer[i];
+      beginEvent()
+        << R"({"name":")" << event.mName
+        << R"(","ph":"X","pid":1,"tid":)" << buffer.mThreadId
+        << ",\"ts\":" << toMicroseconds(event.mStartTime - startTime)
+        << ",\"dur\":" << toMicroseconds(event.mDuration) << '}';
+    }
+
+    numDroppedEvents +=
+      buffer.mNumDroppedEvents.load(std::memory_order_relaxed);
+  }
+
+  file << "\n]}\n";
+
+  if (!file.good()) {
+    throw std::runtime_error(
+      "Failed to write trace file: " + path.u8string());
+  }
+
+  if (numDroppedEvents > 0) {
+    std::cerr << "WARNING: Trace buffers were full, " << numDroppedEvents
+      << " events are missing from the trace\n";
+  }
+}
+
+}
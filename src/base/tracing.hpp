@@ -0,0 +1,112 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/clock.hpp"
+
+#include <atomic>
+#include <filesystem>
+#include <string>
+
+
+namespace rigel::base::tracing {
+
+/** Lightweight recording of timed events, for viewing in a trace viewer
+ *
+ * Once tracing is enabled, each RIGEL_TRACE_SCOPE() records an event covering
+ * the time from its construction until the end of the enclosing scope. Events
+ * are stored in per-thread buffers which don't require any locking, so
+ * recording is cheap enough to instrument each frame. When tracing is not
+ * enabled, a trace scope costs a single relaxed atomic load.
+ *
+ * writeTraceFile() produces a JSON file in the Trace Event Format, which can
+ * be opened in chrome://tracing or the Perfetto UI (https://ui.perfetto.dev).
+ */
+
+namespace detail {
+
+extern std::atomic<bool> gTracingEnabled;
+
+void recordEvent(
+  const char* name,
+  Clock::time_point startTime,
+  Clock::time_point endTime);
+
+}
+
+
+/** Start recording events. Events can't be discarded once recorded */
+void enable();
+
+inline bool isEnabled() {
+  return detail::gTracingEnabled.load(std::memory_order_relaxed);
+}
+
+
+/** Set the name shown for the calling thread in the trace viewer */
+void setCurrentThreadName(std::string name);
+
+
+/** Write all events recorded so far to the given file
+ *
+ * Threads may continue recording events while this is running, but events
+ * that are still in progress won't appear in the output. Throws if the file
+ * can't be written.
+ */
+void writeTraceFile(const std::filesystem::path& path);
+
+
+/** Records an event for its own life time, see RIGEL_TRACE_SCOPE() */
+class ScopedEvent {
+public:
+  /** The name needs to outlive the tracing system, i.e. should be a string
+   * literal. It's written to the trace file as is, without any escaping.
+   */
+  explicit ScopedEvent(const char* name)
+    : mName(name)
+    , mIsActive(isEnabled())
+  {
+    if (mIsActive) {
+      mStartTime = Clock::now();
+    }
+  }
+
+  ~ScopedEvent() {
+    if (mIsActive) {
+      detail::recordEvent(mName, mStartTime, Clock::now());
+    }
+  }
+
+  ScopedEvent(const ScopedEvent&) = delete;
+  ScopedEvent& operator=(const ScopedEvent&) = delete;
+
+private:
+  const char* mName;
+  Clock::time_point mStartTime;
+  bool mIsActive;
+};
+
+}
+
+
+#define RIGEL_TRACE_CONCAT_IMPL(a, b) a##b
+#define RIGEL_TRACE_CONCAT(a, b) RIGEL_TRACE_CONCAT_IMPL(a, b)
+
+/** Record an event spanning the rest of the current scope */
+#define RIGEL_TRACE_SCOPE(name) \
+  const ::rigel::base::tracing::ScopedEvent \
+    RIGEL_TRACE_CONCAT(rigelTraceEvent, __LINE__){name}
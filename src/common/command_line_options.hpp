@@ -42,7 +42,15 @@ struct CommandLineOptions {
   bool mSkipIntro = false;
   bool mDebugModeEnabled = false;
   bool mPlayDemo = false;
+  bool mNullAudioOutput = false;
   std::optional<base::Vector> mPlayerPosition;
+  int mRewindHistorySeconds = 30;
+  std::optional<int> mFastForwardMultiplier;
+  bool mThreadedSimulation = false;
+  bool mGroupedBehaviorUpdates = false;
+  bool mDeferredGameEvents = false;
+  std::optional<std::string> mTraceFile;
+  bool mMemoryReport = false;
 };
 
 }
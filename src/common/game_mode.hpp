@@ -34,6 +34,10 @@ namespace rigel {
 struct IGameServiceProvider;
 class UserProfile;
 
+namespace base {
+  class FrameArena;
+}
+
 namespace engine {
   class SpriteFactory;
   class TiledTexture;
@@ -61,6 +65,9 @@ struct GameMode {
     engine::TiledTexture* mpUiSpriteSheet;
     engine::SpriteFactory* mpSpriteFactory;
     UserProfile* mpUserProfile;
+
+    /** For temporary data, reset at the end of each frame */
+    base::FrameArena* mpFrameArena;
   };
 
   virtual ~GameMode() = default;
@@ -96,6 +96,7 @@ constexpr auto PREF_PATH_ORG_NAME = "lethal-guitar";
 constexpr auto PREF_PATH_APP_NAME = "Rigel Engine";
 constexpr auto USER_PROFILE_FILENAME_V1 = "UserProfile.rigel";
 constexpr auto OPTIONS_FILENAME = "Options.json";
+constexpr auto QUICK_SAVE_FILE_EXTENSION = ".rigelqs";
 
 constexpr auto DOS_SCANCODE_TO_SDL_MAP = std::array<SDL_Scancode, 89>{
   SDL_SCANCODE_UNKNOWN,
@@ -326,11 +327,13 @@ nlohmann::ordered_json serialize(const data::GameOptions& options) {
   serialized["enableVsync"] = options.mEnableVsync;
   serialized["enableFpsLimit"] = options.mEnableFpsLimit;
   serialized["maxFps"] = options.mMaxFps;
+  serialized["preciseFpsLimit"] = options.mPreciseFpsLimit;
   serialized["showFpsCounter"] = options.mShowFpsCounter;
   serialized["musicVolume"] = options.mMusicVolume;
   serialized["soundVolume"] = options.mSoundVolume;
   serialized["musicOn"] = options.mMusicOn;
   serialized["soundOn"] = options.mSoundOn;
+  serialized["prerenderMusic"] = options.mPrerenderMusic;
 
   serialized["upKeybinding"] = SDL_GetKeyName(options.mUpKeybinding);
   serialized["downKeybinding"] = SDL_GetKeyName(options.mDownKeybinding);
@@ -349,6 +352,7 @@ nlohmann::ordered_json serialize(const data::GameOptions& options) {
 
   serialized["widescreenModeOn"] = options.mWidescreenModeOn;
   serialized["quickSavingEnabled"] = options.mQuickSavingEnabled;
+  serialized["motionSmoothingOn"] = options.mMotionSmoothingOn;
   return serialized;
 }
 
@@ -504,11 +508,13 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json) {
   extractValueIfExists("enableVsync", result.mEnableVsync, json);
   extractValueIfExists("enableFpsLimit", result.mEnableFpsLimit, json);
   extractValueIfExists("maxFps", result.mMaxFps, json);
+  extractValueIfExists("preciseFpsLimit", result.mPreciseFpsLimit, json);
   extractValueIfExists("showFpsCounter", result.mShowFpsCounter, json);
   extractValueIfExists("musicVolume", result.mMusicVolume, json);
   extractValueIfExists("soundVolume", result.mSoundVolume, json);
   extractValueIfExists("musicOn", result.mMusicOn, json);
   extractValueIfExists("soundOn", result.mSoundOn, json);
+  extractValueIfExists("prerenderMusic", result.mPrerenderMusic, json);
   extractKeyBindingIfExists("upKeybinding", result.mUpKeybinding, json);
   extractKeyBindingIfExists("downKeybinding", result.mDownKeybinding, json);
   extractKeyBindingIfExists("leftKeybinding", result.mLeftKeybinding, json);
@@ -520,6 +526,7 @@ data::GameOptions deserialize<data::GameOptions>(const nlohmann::json& json) {
   extractValueIfExists("compatibilityModeOn", result.mCompatibilityModeOn, json);
   extractValueIfExists("widescreenModeOn", result.mWidescreenModeOn, json);
   extractValueIfExists("quickSavingEnabled", result.mQuickSavingEnabled, json);
+  extractValueIfExists("motionSmoothingOn", result.mMotionSmoothingOn, json);
 
   removeInvalidKeybindings(result);
 
@@ -705,6 +712,25 @@ bool UserProfile::hasProgressData() const
 }
 
 
+std::optional<std::filesystem::path> UserProfile::quickSaveFilePath() const {
+  if (!mProfilePath) {
+    return std::nullopt;
+  }
+
+  auto path = *mProfilePath;
+  path.replace_filename(std::string{"QuickSave"} + QUICK_SAVE_FILE_EXTENSION);
+  return path;
+}
+
+
+void UserProfile::deleteQuickSave() const {
+  if (const auto path = quickSaveFilePath()) {
+    std::error_code ec;
+    std::filesystem::remove(*path, ec);
+  }
+}
+
+
 std::optional<std::filesystem::path> createOrGetPreferencesPath() {
   namespace fs = std::filesystem;
 
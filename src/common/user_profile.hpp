@@ -60,6 +60,16 @@ public:
   /** Returns true if the profile contains saved games and/or high scores */
   bool hasProgressData() const;
 
+  /** Location of the persistent quick save
+   *
+   * There is only one, belonging to the game session that was played last.
+   * Returns an empty optional if this profile isn't stored on disk.
+   */
+  std::optional<std::filesystem::path> quickSaveFilePath() const;
+
+  /** Delete the persistent quick save, if there is one */
+  void deleteQuickSave() const;
+
   data::SaveSlotArray mSaveSlots;
   data::HighScoreListArray mHighScoreLists;
   data::GameOptions mOptions;
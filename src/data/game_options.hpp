@@ -83,6 +83,7 @@ struct GameOptions {
   bool mEnableVsync = ENABLE_VSYNC_DEFAULT;
   bool mEnableFpsLimit = true; // Only relevant when mEnableVsync == false
   int mMaxFps = 60; // Only relevant when mEnableFpsLimit == true
+  bool mPreciseFpsLimit = false; // Only relevant when mEnableFpsLimit == true
   bool mShowFpsCounter = false;
 
   // Sound
@@ -91,6 +92,10 @@ struct GameOptions {
   bool mMusicOn = true;
   bool mSoundOn = true;
 
+  // Renders each song to PCM in the background the first time it's played.
+  // Uses more memory, but saves a lot of CPU time on slower systems.
+  bool mPrerenderMusic = false;
+
   // Keyboard controls
   SDL_Keycode mUpKeybinding = SDLK_UP;
   SDL_Keycode mDownKeybinding = SDLK_DOWN;
@@ -108,6 +113,11 @@ struct GameOptions {
   bool mWidescreenModeOn = false;
   bool mQuickSavingEnabled = false;
 
+  // Interpolate sprite and camera positions between game logic updates when
+  // rendering. Makes motion appear smoother at frame rates above 15 FPS, at
+  // the cost of one logic update (~66 ms) of added display latency.
+  bool mMotionSmoothingOn = false;
+
   // Internal options
   //
   // The following options are used internally to control various behavior, but
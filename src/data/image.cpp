@@ -16,6 +16,7 @@
 
 #include "image.hpp"
 
+#include <algorithm>
 #include <stdexcept>
 
 
@@ -83,4 +84,78 @@ void Image::insertImage(
 }
 
 
+IndexedImage::IndexedImage(
+  IndexedPixelBuffer&& pixels,
+  const std::size_t width,
+  const std::size_t height,
+  Palette palette
+)
+  : mPixels(std::move(pixels))
+  , mPalette(std::move(palette))
+  , mWidth(width)
+  , mHeight(height)
+{
+  if (mPixels.size() != mWidth * mHeight) {
+    throw invalid_argument("Pixel data doesn't match image size");
+  }
+
+  const auto maxIndex = mPixels.empty()
+    ? 0u
+    : *max_element(mPixels.begin(), mPixels.end());
+  if (maxIndex >= mPalette.size()) {
+    throw invalid_argument("Pixel data refers to color not in palette");
+  }
+}
+
+
+IndexedImage::IndexedImage(
+  const std::size_t width,
+  const std::size_t height,
+  Palette palette
+)
+  : IndexedImage(
+      IndexedPixelBuffer(width*height, 0), width, height, std::move(palette))
+{
+}
+
+
+void IndexedImage::insertImage(
+  const size_t x,
+  const size_t y,
+  const IndexedImage& image
+) {
+  if (x + image.width() > mWidth || y + image.height() > mHeight) {
+    throw invalid_argument("Source image doesn't fit");
+  }
+
+  const auto& sourcePalette = image.palette();
+  const auto palettesMatch =
+    sourcePalette.size() <= mPalette.size() &&
+    equal(sourcePalette.begin(), sourcePalette.end(), mPalette.begin());
+  if (!palettesMatch) {
+    throw invalid_argument("Source image uses a different palette");
+  }
+
+  auto sourceIter = image.pixelData().begin();
+  for (size_t row=0; row<image.height(); ++row) {
+    const auto targetOffset = x + (y+row)*mWidth;
+    copy(
+      sourceIter,
+      sourceIter + image.width(),
+      mPixels.begin() + targetOffset);
+    sourceIter += image.width();
+  }
+}
+
+
+Image IndexedImage::toRgbaImage() const {
+  PixelBuffer pixels;
+  pixels.reserve(mPixels.size());
+  for (const auto index : mPixels) {
+    pixels.push_back(mPalette[index]);
+  }
+
+  return Image(std::move(pixels), mWidth, mHeight);
+}
+
 }
@@ -27,6 +27,9 @@ namespace rigel::data {
 using Pixel = rigel::base::Color;
 using PixelBuffer = std::vector<Pixel>;
 
+using IndexedPixelBuffer = std::vector<std::uint8_t>;
+using Palette = std::vector<Pixel>;
+
 
 /** Simple technology-agnostic image data holder.
  *
@@ -50,6 +53,11 @@ public:
     return mHeight;
   }
 
+  /** Size of the pixel data in bytes */
+  std::size_t memoryUsage() const {
+    return mPixels.size() * sizeof(Pixel);
+  }
+
   void insertImage(std::size_t x, std::size_t y, const Image& image);
   void insertImage(
     std::size_t x,
@@ -64,4 +72,63 @@ private:
 };
 
 
+/** Image made up of palette indices, as found in the game's files
+ *
+ * The original assets use 16 colors (or 256 for one VGA image), so keeping
+ * them in this form takes a quarter of the memory needed by an Image. The
+ * palette can contain entries with an alpha value of 0 to represent
+ * transparency. Use toRgbaImage() or Renderer::createTexture() to expand
+ * the indices into actual colors.
+ */
+class IndexedImage {
+public:
+  IndexedImage(
+    IndexedPixelBuffer&& pixels,
+    std::size_t width,
+    std::size_t height,
+    Palette palette);
+  IndexedImage(std::size_t width, std::size_t height, Palette palette);
+
+  const IndexedPixelBuffer& pixelData() const {
+    return mPixels;
+  }
+
+  const Palette& palette() const {
+    return mPalette;
+  }
+
+  std::size_t width() const {
+    return mWidth;
+  }
+
+  std::size_t height() const {
+    return mHeight;
+  }
+
+  /** Size of the pixel data and palette in bytes */
+  std::size_t memoryUsage() const {
+    return mPixels.size() + mPalette.size() * sizeof(Pixel);
+  }
+
+  Pixel pixelAt(const std::size_t x, const std::size_t y) const {
+    return mPalette[mPixels[x + y * mWidth]];
+  }
+
+  /** Copy the given image into this one at the given position
+   *
+   * The source image's palette must match the beginning of this image's
+   * palette, so that its indices refer to the same colors.
+   */
+  void insertImage(std::size_t x, std::size_t y, const IndexedImage& image);
+
+  Image toRgbaImage() const;
+
+private:
+  IndexedPixelBuffer mPixels;
+  Palette mPalette;
+  std::size_t mWidth;
+  std::size_t mHeight;
+};
+
+
 }
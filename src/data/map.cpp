@@ -68,6 +68,43 @@ void Map::setTileAt(
 }
 
 
+base::ArrayView<TileIndex> Map::tileRow(
+  const int layer,
+  const int y,
+  const int x0,
+  const int x1
+) const {
+  if (static_cast<size_t>(layer) >= mLayers.size()) {
+    throw invalid_argument("Layer index out of bounds");
+  }
+  if (static_cast<size_t>(y) >= mHeightInTiles) {
+    throw invalid_argument("Y coord out of bounds");
+  }
+  if (x0 < 0 || x0 > x1 || static_cast<size_t>(x1) > mWidthInTiles) {
+    throw invalid_argument("X range out of bounds");
+  }
+
+  const auto& tiles = mLayers[layer];
+  return base::ArrayView<TileIndex>{
+    tiles.data() + x0 + y*mWidthInTiles,
+    static_cast<base::ArrayView<TileIndex>::size_type>(x1 - x0)};
+}
+
+
+base::Rect<int> Map::clipToMap(const base::Rect<int>& section) const {
+  const auto left = std::clamp(section.left(), 0, width());
+  const auto top = std::clamp(section.top(), 0, height());
+  const auto right =
+    std::min(section.left() + section.size.width, width());
+  const auto bottom =
+    std::min(section.top() + section.size.height, height());
+
+  return base::Rect<int>{
+    {left, top},
+    {std::max(right - left, 0), std::max(bottom - top, 0)}};
+}
+
+
 void Map::clearSection(
   const int x,
   const int y,
@@ -97,17 +134,22 @@ TileAttributes Map::attributes(const int x, const int y) const {
     return TileAttributes{};
   }
 
-  if (tileAt(0, x, y) != 0 && tileAt(1, x, y) != 0) {
+  // Coordinates have been checked above, so unchecked access is safe from
+  // here on
+  const auto tile0 = tileAtUnchecked(0, x, y);
+  const auto tile1 = tileAtUnchecked(1, x, y);
+
+  if (tile0 != 0 && tile1 != 0) {
     // "Composite" tiles (content on both layers) are ignored for attribute
     // checking
     return TileAttributes{};
   }
 
-  if (tileAt(1, x, y) != 0) {
-    return TileAttributes{mAttributes.attributes(tileAt(1, x, y))};
+  if (tile1 != 0) {
+    return TileAttributes{mAttributes.attributes(tile1)};
   }
 
-  return TileAttributes{mAttributes.attributes(tileAt(0, x, y))};
+  return TileAttributes{mAttributes.attributes(tile0)};
 }
 
 
@@ -122,14 +164,17 @@ CollisionData Map::collisionData(const int x, const int y) const {
     return CollisionData{};
   }
 
-  if (tileAt(0, x, y) != 0 && tileAt(1, x, y) != 0) {
+  const auto tile0 = tileAtUnchecked(0, x, y);
+  const auto tile1 = tileAtUnchecked(1, x, y);
+
+  if (tile0 != 0 && tile1 != 0) {
     // "Composite" tiles (content on both layers) are ignored for collision
     // checking
     return CollisionData{};
   }
 
-  const auto data1 = mAttributes.collisionData(tileAt(0, x, y));
-  const auto data2 = mAttributes.collisionData(tileAt(1, x, y));
+  const auto data1 = mAttributes.collisionData(tile0);
+  const auto data2 = mAttributes.collisionData(tile1);
   return CollisionData{data1, data2};
 }
 
@@ -16,11 +16,13 @@
 
 #pragma once
 
+#include "base/array_view.hpp"
 #include "base/spatial_types.hpp"
 #include "data/actor_ids.hpp"
 #include "data/tile_attributes.hpp"
 
 #include <array>
+#include <cassert>
 #include <cstddef>
 #include <optional>
 #include <string>
@@ -54,6 +56,38 @@ public:
 
   void setTileAt(int layer, int x, int y, TileIndex index);
 
+  /** Like tileAt(), but without bounds checking
+   *
+   * For loops over a part of the map which has already been clipped to the
+   * map's bounds, see clipToMap(). The coordinates must be valid.
+   */
+  TileIndex tileAtUnchecked(const int layer, const int x, const int y) const {
+    assert(layer >= 0 && layer < 2);
+    assert(x >= 0 && x < width());
+    assert(y >= 0 && y < height());
+    return mLayers[layer][x + y*mWidthInTiles];
+  }
+
+  /** Tiles in the range [x0, x1) of row y on the given layer
+   *
+   * The range is bounds checked once, throwing std::invalid_argument if it's
+   * not fully inside the map. Accessing the individual tiles is unchecked.
+   */
+  base::ArrayView<TileIndex> tileRow(int layer, int y, int x0, int x1) const;
+
+  /** All tiles of row y on the given layer, see above */
+  base::ArrayView<TileIndex> tileRow(const int layer, const int y) const {
+    return tileRow(layer, y, 0, width());
+  }
+
+  /** The part of the given section that lies within the map
+   *
+   * The result has a size of 0 if the section is completely outside. Its
+   * position is always clamped to the map's bounds, so the result can be
+   * passed to tileRow() even when empty.
+   */
+  base::Rect<int> clipToMap(const base::Rect<int>& section) const;
+
   int width() const {
     return static_cast<int>(mWidthInTiles);
   }
@@ -91,9 +125,9 @@ struct LevelData {
     std::optional<base::Rect<int>> mAssignedArea;
   };
 
-  Image mTileSetImage;
-  Image mBackdropImage;
-  std::optional<Image> mSecondaryBackdropImage;
+  IndexedImage mTileSetImage;
+  IndexedImage mBackdropImage;
+  std::optional<IndexedImage> mSecondaryBackdropImage;
 
   data::map::Map mMap;
   std::vector<Actor> mActors;
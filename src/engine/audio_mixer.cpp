@@ -0,0 +1,303 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "audio_mixer.hpp"
+
+#include "base/clock.hpp"
+#include "base/math_tools.hpp"
+#include "engine/imf_player.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define RIGEL_AUDIO_MIXER_SSE2
+  #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define RIGEL_AUDIO_MIXER_NEON
+  #include <arm_neon.h>
+#endif
+
+
+namespace rigel::engine {
+
+namespace {
+
+constexpr auto FIXED_POINT_SHIFT = 8;
+constexpr auto FULL_VOLUME = std::int32_t{1 << FIXED_POINT_SHIFT};
+constexpr auto CPU_LOAD_FILTER_WEIGHT = 0.95f;
+
+#if defined(RIGEL_AUDIO_MIXER_SSE2) || defined(RIGEL_AUDIO_MIXER_NEON)
+constexpr auto SAMPLES_PER_ITERATION = std::size_t{8};
+#endif
+
+
+std::size_t accumulateSamplesSimd(
+  std::int32_t* pAccumulator,
+  const data::Sample* pSamples,
+  const std::size_t numSamples,
+  const std::int32_t volume
+) {
+  auto i = std::size_t{0};
+
+#if defined(RIGEL_AUDIO_MIXER_SSE2)
+  // SSE2 has no 32-bit multiply, but madd gives us 16x16 -> 32 bit products.
+  // Interleaving the samples with zeroes turns each pair sum into a single
+  // product.
+  const auto volumePairs = _mm_set1_epi32(volume);
+  const auto zero = _mm_setzero_si128();
+
+  for (; i + SAMPLES_PER_ITERATION <= numSamples; i += SAMPLES_PER_ITERATION) {
+    const auto samples =
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSamples + i));
+    const auto pLow = reinterpret_cast<__m128i*>(pAccumulator + i);
+    const auto pHigh = reinterpret_cast<__m128i*>(pAccumulator + i + 4);
+
+    _mm_storeu_si128(
+      pLow,
+      _mm_add_epi32(
+        _mm_loadu_si128(pLow),
+        _mm_madd_epi16(_mm_unpacklo_epi16(samples, zero), volumePairs)));
+    _mm_storeu_si128(
+      pHigh,
+      _mm_add_epi32(
+        _mm_loadu_si128(pHigh),
+        _mm_madd_epi16(_mm_unpackhi_epi16(samples, zero), volumePairs)));
+  }
+#elif defined(RIGEL_AUDIO_MIXER_NEON)
+  const auto volume16 = vdup_n_s16(static_cast<std::int16_t>(volume));
+
+  for (; i + SAMPLES_PER_ITERATION <= numSamples; i += SAMPLES_PER_ITERATION) {
+    const auto samples = vld1q_s16(pSamples + i);
+    vst1q_s32(
+      pAccumulator + i,
+      vmlal_s16(vld1q_s32(pAccumulator + i), vget_low_s16(samples), volume16));
+    vst1q_s32(
+      pAccumulator + i + 4,
+      vmlal_s16(
+        vld1q_s32(pAccumulator + i + 4), vget_high_s16(samples), volume16));
+  }
+#endif
+
+  return i;
+}
+
+
+std::size_t storeAccumulatedSamplesSimd(
+  const std::int32_t* pAccumulator,
+  data::Sample* pDestination,
+  const std::size_t numSamples
+) {
+  auto i = std::size_t{0};
+
+#if defined(RIGEL_AUDIO_MIXER_SSE2)
+  for (; i + SAMPLES_PER_ITERATION <= numSamples; i += SAMPLES_PER_ITERATION) {
+    const auto low = _mm_srai_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pAccumulator + i)),
+      FIXED_POINT_SHIFT);
+    const auto high = _mm_srai_epi32(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pAccumulator + i + 4)),
+      FIXED_POINT_SHIFT);
+
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(pDestination + i),
+      _mm_packs_epi32(low, high));
+  }
+#elif defined(RIGEL_AUDIO_MIXER_NEON)
+  for (; i + SAMPLES_PER_ITERATION <= numSamples; i += SAMPLES_PER_ITERATION) {
+    vst1q_s16(
+      pDestination + i,
+      vcombine_s16(
+        vqshrn_n_s32(vld1q_s32(pAccumulator + i), FIXED_POINT_SHIFT),
+        vqshrn_n_s32(vld1q_s32(pAccumulator + i + 4), FIXED_POINT_SHIFT)));
+  }
+#endif
+
+  return i;
+}
+
+}
+
+
+void accumulateSamples(
+  std::int32_t* pAccumulator,
+  const data::Sample* pSamples,
+  const std::size_t numSamples,
+  const std::int32_t volume
+) {
+  assert(volume >= 0 && volume <= 32767);
+
+  const auto samplesDone =
+    accumulateSamplesSimd(pAccumulator, pSamples, numSamples, volume);
+
+  for (auto i = samplesDone; i < numSamples; ++i) {
+    pAccumulator[i] += pSamples[i] * volume;
+  }
+}
+
+
+void storeAccumulatedSamples(
+  const std::int32_t* pAccumulator,
+  data::Sample* pDestination,
+  const std::size_t numSamples
+) {
+  const auto samplesDone =
+    storeAccumulatedSamplesSimd(pAccumulator, pDestination, numSamples);
+
+  for (auto i = samplesDone; i < numSamples; ++i) {
+    pDestination[i] = static_cast<data::Sample>(
+      std::clamp(pAccumulator[i] >> FIXED_POINT_SHIFT, -32768, 32767));
+  }
+}
+
+
+AudioMixer::AudioMixer(
+  SoundData sounds,
+  ImfPlayer* pMusicPlayer,
+  const int sampleRate
+)
+  : mSounds(std::move(sounds))
+  , mpMusicPlayer(pMusicPlayer)
+  , mSampleRate(sampleRate)
+  , mSoundVolume(FULL_VOLUME)
+{
+}
+
+
+void AudioMixer::playSound(const data::SoundId id) {
+  submitCommand({Command::Type::Play, static_cast<std::uint8_t>(id)});
+}
+
+
+void AudioMixer::stopSound(const data::SoundId id) {
+  submitCommand({Command::Type::Stop, static_cast<std::uint8_t>(id)});
+}
+
+
+void AudioMixer::setSoundVolume(const float volume) {
+  mSoundVolume.store(
+    base::round(std::clamp(volume, 0.0f, 1.0f) * FULL_VOLUME),
+    std::memory_order_relaxed);
+}
+
+
+float AudioMixer::cpuLoad() const {
+  return mCpuLoad.load(std::memory_order_relaxed);
+}
+
+
+void AudioMixer::submitCommand(const Command command) {
+  // Unlike music commands, we never wait here. The queue can only run full if
+  // the audio thread stalls, and dropping a sound effect is preferable to
+  // stalling the game in that case.
+  mCommands.tryPush(Command{command});
+}
+
+
+void AudioMixer::mix(data::Sample* pBuffer, const std::size_t numSamples) {
+  if (numSamples == 0) {
+    return;
+  }
+
+  const auto startTime = base::Clock::now();
+
+  processCommands();
+
+  for (auto offset = std::size_t{0}; offset < numSamples;) {
+    const auto samplesForBlock = std::min(MIX_BLOCK_SIZE, numSamples - offset);
+    mixBlock(pBuffer + offset, samplesForBlock);
+    offset += samplesForBlock;
+  }
+
+  const auto timeTaken =
+    std::chrono::duration<double>(base::Clock::now() - startTime).count();
+  const auto audioDuration = static_cast<double>(numSamples) / mSampleRate;
+  const auto load = static_cast<float>(timeTaken / audioDuration);
+
+  mCpuLoad.store(
+    base::lerp(
+      load,
+      mCpuLoad.load(std::memory_order_relaxed),
+      CPU_LOAD_FILTER_WEIGHT),
+    std::memory_order_relaxed);
+}
+
+
+void AudioMixer::processCommands() {
+  while (const auto pCommand = mCommands.front()) {
+    auto& voice = mVoices[pCommand->mSoundIndex];
+
+    switch (pCommand->mType) {
+      case Command::Type::Play:
+        // Restarts the sound if it's already playing
+        voice.mPosition = 0;
+        voice.mIsActive = !mSounds[pCommand->mSoundIndex].empty();
+        break;
+
+      case Command::Type::Stop:
+        voice.mIsActive = false;
+        break;
+
+      case Command::Type::None:
+        break;
+    }
+
+    mCommands.pop();
+  }
+}
+
+
+void AudioMixer::mixBlock(data::Sample* pBuffer, const std::size_t numSamples) {
+  std::fill_n(mAccumulator.begin(), numSamples, 0);
+
+  if (mpMusicPlayer) {
+    // Music volume is applied by the player itself
+    mpMusicPlayer->render(mMusicBuffer.data(), numSamples);
+    accumulateSamples(
+      mAccumulator.data(), mMusicBuffer.data(), numSamples, FULL_VOLUME);
+  }
+
+  const auto volume = mSoundVolume.load(std::memory_order_relaxed);
+
+  for (auto i = std::size_t{0}; i < mVoices.size(); ++i) {
+    auto& voice = mVoices[i];
+    if (!voice.mIsActive) {
+      continue;
+    }
+
+    const auto& sound = mSounds[i];
+    const auto samplesToMix =
+      std::min(numSamples, sound.size() - voice.mPosition);
+
+    if (volume > 0) {
+      accumulateSamples(
+        mAccumulator.data(),
+        sound.data() + voice.mPosition,
+        samplesToMix,
+        volume);
+    }
+
+    voice.mPosition += samplesToMix;
+    voice.mIsActive = voice.mPosition < sound.size();
+  }
+
+  storeAccumulatedSamples(mAccumulator.data(), pBuffer, numSamples);
+}
+
+}
@@ -0,0 +1,127 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/spsc_queue.hpp"
+#include "data/audio_buffer.hpp"
+#include "data/sound_ids.hpp"
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+
+namespace rigel::engine {
+
+class ImfPlayer;
+
+
+/** Add samples scaled by volume to a 32-bit accumulation buffer
+ *
+ * volume is in 24.8 fixed point, i.e. 256 means unchanged volume. Uses SIMD
+ * instructions where available.
+ */
+void accumulateSamples(
+  std::int32_t* pAccumulator,
+  const data::Sample* pSamples,
+  std::size_t numSamples,
+  std::int32_t volume);
+
+
+/** Convert accumulated 24.8 fixed point samples to 16-bit, saturating */
+void storeAccumulatedSamples(
+  const std::int32_t* pAccumulator,
+  data::Sample* pDestination,
+  std::size_t numSamples);
+
+
+/** Mixes music and sound effects into a single mono 16-bit stream
+ *
+ * Each sound ID has a voice of its own, so all sound effects can play
+ * simultaneously. Playing a sound whose voice is already active cuts it off
+ * and restarts it from the beginning, like in the original game.
+ *
+ * mix() is meant to be called from the audio thread, all other functions
+ * from the main thread. Like in ImfPlayer, requests are passed to the audio
+ * thread via a lock-free queue, so mix() never blocks or allocates.
+ */
+class AudioMixer {
+public:
+  using SoundData = std::array<std::vector<data::Sample>, data::NUM_SOUND_IDS>;
+
+  /** Create a mixer for the given sounds
+   *
+   * Sounds must already be at the output sample rate. pMusicPlayer is
+   * optional, without it, only sound effects are mixed.
+   */
+  AudioMixer(SoundData sounds, ImfPlayer* pMusicPlayer, int sampleRate);
+  AudioMixer(const AudioMixer&) = delete;
+  AudioMixer& operator=(const AudioMixer&) = delete;
+
+  void playSound(data::SoundId id);
+  void stopSound(data::SoundId id);
+  void setSoundVolume(float volume);
+
+  /** Fraction of real time spent in mix(), smoothed over recent calls
+   *
+   * A value of 0.01 means that producing one second of audio took 10 ms.
+   */
+  float cpuLoad() const;
+
+  void mix(data::Sample* pBuffer, std::size_t numSamples);
+
+private:
+  struct Command {
+    enum class Type : std::uint8_t {
+      None,
+      Play,
+      Stop
+    };
+
+    Type mType = Type::None;
+    std::uint8_t mSoundIndex = 0;
+  };
+
+  struct Voice {
+    std::size_t mPosition = 0;
+    bool mIsActive = false;
+  };
+
+  static constexpr auto COMMAND_QUEUE_CAPACITY = 256;
+  static constexpr auto MIX_BLOCK_SIZE = std::size_t{512};
+
+  void submitCommand(Command command);
+  void processCommands();
+  void mixBlock(data::Sample* pBuffer, std::size_t numSamples);
+
+  const SoundData mSounds;
+  ImfPlayer* mpMusicPlayer;
+  double mSampleRate;
+
+  base::SpscQueue<Command, COMMAND_QUEUE_CAPACITY> mCommands;
+  std::atomic<std::int32_t> mSoundVolume;
+  std::atomic<float> mCpuLoad{0.0f};
+
+  // Only accessed by the audio thread
+  std::array<Voice, data::NUM_SOUND_IDS> mVoices;
+  std::array<std::int32_t, MIX_BLOCK_SIZE> mAccumulator;
+  std::array<data::Sample, MIX_BLOCK_SIZE> mMusicBuffer;
+};
+
+}
@@ -16,6 +16,7 @@
 
 #include "entity_activation_system.hpp"
 
+#include "base/tracing.hpp"
 #include "data/game_traits.hpp"
 #include "engine/base_components.hpp"
 #include "engine/entity_tools.hpp"
@@ -75,6 +76,8 @@ void markActiveEntities(
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize
 ) {
+  RIGEL_TRACE_SCOPE("markActiveEntities");
+
   const BoundingBox activeRegionBox{cameraPosition, viewPortSize};
 
   es.each<WorldPosition, BoundingBox>([&activeRegionBox](
@@ -0,0 +1,59 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "entity_allocation_counter.hpp"
+
+#include <algorithm>
+
+
+namespace rigel::engine {
+
+EntityAllocationCounter::EntityAllocationCounter(
+  const entityx::EntityManager* pEntityManager,
+  entityx::EventManager& events
+)
+  : mpEntityManager(pEntityManager)
+  , mCapacityAtFrameStart(pEntityManager->capacity())
+{
+  events.subscribe<entityx::EntityCreatedEvent>(*this);
+  events.subscribe<entityx::EntityDestroyedEvent>(*this);
+}
+
+
+void EntityAllocationCounter::beginFrame() {
+  // Capacity can also shrink, when the entity manager is reset
+  const auto capacity = mpEntityManager->capacity();
+  mCurrentFrame.mSlotsAllocated =
+    capacity > mCapacityAtFrameStart ? capacity - mCapacityAtFrameStart : 0;
+  mCapacityAtFrameStart = capacity;
+
+  mPeakCreatedPerFrame =
+    std::max(mPeakCreatedPerFrame, mCurrentFrame.mCreated);
+  mLastFrame = mCurrentFrame;
+  mCurrentFrame = FrameStatistics{};
+}
+
+
+void EntityAllocationCounter::receive(const entityx::EntityCreatedEvent&) {
+  ++mCurrentFrame.mCreated;
+}
+
+
+void EntityAllocationCounter::receive(const entityx::EntityDestroyedEvent&) {
+  ++mCurrentFrame.mDestroyed;
+}
+
+}
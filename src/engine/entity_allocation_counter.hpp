@@ -0,0 +1,75 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstddef>
+
+
+namespace rigel::engine {
+
+/** Counts entity creations and destructions per frame
+ *
+ * Short-lived effect entities (explosions, smoke, debris etc.) are created
+ * and destroyed all the time. entityx recycles the storage of destroyed
+ * entities, so this normally doesn't cause any allocations. The counter makes
+ * this visible: In addition to the churn, it reports by how many slots the
+ * entity manager's storage had to grow during a frame.
+ */
+class EntityAllocationCounter
+  : public entityx::Receiver<EntityAllocationCounter> {
+public:
+  struct FrameStatistics {
+    int mCreated = 0;
+    int mDestroyed = 0;
+    std::size_t mSlotsAllocated = 0;
+  };
+
+  EntityAllocationCounter(
+    const entityx::EntityManager* pEntityManager,
+    entityx::EventManager& events);
+
+  /** Finish counting for the previous frame and start a new one */
+  void beginFrame();
+
+  /** Statistics for the last completed frame */
+  const FrameStatistics& lastFrame() const {
+    return mLastFrame;
+  }
+
+  /** Highest number of entities created in a single frame so far */
+  int peakCreatedPerFrame() const {
+    return mPeakCreatedPerFrame;
+  }
+
+  void receive(const entityx::EntityCreatedEvent& event);
+  void receive(const entityx::EntityDestroyedEvent& event);
+
+private:
+  const entityx::EntityManager* mpEntityManager;
+  FrameStatistics mCurrentFrame;
+  FrameStatistics mLastFrame;
+  std::size_t mCapacityAtFrameStart;
+  int mPeakCreatedPerFrame = 0;
+};
+
+}
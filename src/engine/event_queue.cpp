@@ -0,0 +1,108 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "event_queue.hpp"
+
+#include "base/defer.hpp"
+#include "base/tracing.hpp"
+
+#include <atomic>
+
+
+namespace rigel::engine {
+
+EventQueue::EventQueue(
+  entityx::EventManager* pEvents,
+  const DispatchMode mode
+)
+  : mpEvents(pEvents)
+  , mDispatchMode(mode)
+{
+}
+
+
+std::size_t EventQueue::nextChannelIndex() {
+  static std::atomic<std::size_t> sNextIndex{0};
+  return sNextIndex++;
+}
+
+
+void EventQueue::dispatch() {
+  RIGEL_TRACE_SCOPE("EventQueue::dispatch");
+
+  // A receiver posting a non-deferrable event would cause a nested dispatch.
+  // The outer loop takes care of all events, so there's nothing to do here.
+  if (mIsDispatching || !hasPendingEvents()) {
+    return;
+  }
+
+  mIsDispatching = true;
+  auto guard = base::defer([this]() { mIsDispatching = false; });
+
+  while (mNextToDispatch < mDispatchOrder.size()) {
+    auto& channel = *mChannels[mDispatchOrder[mNextToDispatch]];
+    ++mNextToDispatch;
+
+    if (!channel.dispatchNext(*mpEvents)) {
+      ++channel.mDroppedTotal;
+    }
+  }
+
+  mDispatchOrder.clear();
+  mNextToDispatch = 0;
+  for (auto& pChannel : mChannels) {
+    if (pChannel) {
+      pChannel->clear();
+    }
+  }
+}
+
+
+void EventQueue::beginFrame() {
+  for (auto& pChannel : mChannels) {
+    if (pChannel) {
+      pChannel->mPostedThisFrame = 0;
+    }
+  }
+}
+
+
+void EventQueue::setDispatchMode(const DispatchMode mode) {
+  mDispatchMode = mode;
+
+  if (mode == DispatchMode::Immediate) {
+    dispatch();
+  }
+}
+
+
+auto EventQueue::statistics() const -> std::vector<EventTypeStatistics> {
+  std::vector<EventTypeStatistics> result;
+
+  for (const auto& pChannel : mChannels) {
+    if (pChannel) {
+      result.push_back({
+        pChannel->mName,
+        pChannel->mPostedThisFrame,
+        pChannel->mPostedTotal,
+        pChannel->mDroppedTotal});
+    }
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,229 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cassert>
+#include <cstddef>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+
+namespace rigel::engine {
+
+namespace detail {
+
+template <typename T, typename = void>
+struct hasEntity : std::false_type {};
+
+template <typename T>
+struct hasEntity<T, std::void_t<decltype(std::declval<T>().mEntity)>> :
+  std::true_type {};
+
+}
+
+
+/** Frame-local buffer for game logic events
+ *
+ * Systems post events here instead of emitting them via entityx'
+ * EventManager directly. Receivers still subscribe to the EventManager as
+ * usual. In Immediate mode, post() forwards the event right away, which is
+ * the same as emitting it directly. In Deferred mode, events are appended to
+ * a per-type buffer, and forwarded in the order they were posted when
+ * dispatch() is called. This avoids running receivers in the middle of a
+ * system's update loop.
+ *
+ * Some events can't be deferred, e.g. because the posting system needs to
+ * see the receivers' reaction right away. These are registered as immediate
+ * only. Posting one of those first dispatches everything that's buffered, so
+ * that the overall order of events is always preserved. For the same reason,
+ * if a receiver posts such an event while buffered events are being
+ * dispatched, it's forwarded after the ones that are still waiting.
+ *
+ * If an event refers to an entity (via a member called mEntity) which has
+ * been destroyed by the time the event would be dispatched, the event is
+ * dropped.
+ *
+ * Event types must be registered before they can be posted.
+ */
+class EventQueue {
+public:
+  enum class DispatchMode {
+    Immediate,
+    Deferred
+  };
+
+  enum class Deferrable {
+    Yes,
+    No
+  };
+
+  struct EventTypeStatistics {
+    const char* mName;
+    std::size_t mPostedThisFrame;
+    std::size_t mPostedTotal;
+    std::size_t mDroppedTotal;
+  };
+
+  explicit EventQueue(
+    entityx::EventManager* pEvents,
+    DispatchMode mode = DispatchMode::Immediate);
+
+  template <typename Event>
+  void registerEventType(
+    const char* name,
+    const Deferrable deferrable = Deferrable::Yes
+  ) {
+    const auto index = channelIndex<Event>();
+    if (index >= mChannels.size()) {
+      mChannels.resize(index + 1);
+    }
+
+    mChannels[index] = std::make_unique<Channel<Event>>(name, deferrable);
+  }
+
+  template <typename Event>
+  void post(const Event& event) {
+    auto& channel = channelFor<Event>();
+    ++channel.mPostedThisFrame;
+    ++channel.mPostedTotal;
+
+    const auto forwardNow =
+      mDispatchMode == DispatchMode::Immediate ||
+      channel.mDeferrable == Deferrable::No;
+
+    // A receiver might post while we are dispatching. Forwarding right away
+    // would then overtake the events which are still waiting, so we queue up
+    // behind them instead. The ongoing dispatch() takes care of it.
+    if (forwardNow && !(mIsDispatching && hasPendingEvents())) {
+      dispatch();
+      mpEvents->emit(event);
+      return;
+    }
+
+    channel.mBuffered.push_back(event);
+    mDispatchOrder.push_back(channelIndex<Event>());
+  }
+
+  /** Forward all buffered events to the EventManager, in posting order
+   *
+   * Events posted by receivers during dispatch are dispatched as well.
+   */
+  void dispatch();
+
+  /** Reset per-frame counters. Buffered events are kept. */
+  void beginFrame();
+
+  /** Changing to Immediate mode dispatches any buffered events */
+  void setDispatchMode(DispatchMode mode);
+
+  DispatchMode dispatchMode() const {
+    return mDispatchMode;
+  }
+
+  bool hasPendingEvents() const {
+    return mNextToDispatch < mDispatchOrder.size();
+  }
+
+  std::vector<EventTypeStatistics> statistics() const;
+
+  /** For subscribing to events, and emitting ones which don't go through
+   * the queue
+   */
+  entityx::EventManager& eventManager() {
+    return *mpEvents;
+  }
+
+private:
+  struct ChannelBase {
+    ChannelBase(const char* name, const Deferrable deferrable)
+      : mName(name)
+      , mDeferrable(deferrable)
+    {
+    }
+
+    virtual ~ChannelBase() = default;
+
+    /** Emit the oldest buffered event. Returns false if it was dropped. */
+    virtual bool dispatchNext(entityx::EventManager& events) = 0;
+    virtual void clear() = 0;
+
+    const char* mName;
+    Deferrable mDeferrable;
+    std::size_t mPostedThisFrame = 0;
+    std::size_t mPostedTotal = 0;
+    std::size_t mDroppedTotal = 0;
+  };
+
+  template <typename Event>
+  struct Channel : ChannelBase {
+    using ChannelBase::ChannelBase;
+
+    bool dispatchNext(entityx::EventManager& events) override {
+      // Copy, since receivers might post more events, which could cause the
+      // buffer to reallocate
+      const auto event = mBuffered[mNextToDispatch++];
+
+      if constexpr (detail::hasEntity<Event>::value) {
+        if (!event.mEntity.valid()) {
+          return false;
+        }
+      }
+
+      events.emit(event);
+      return true;
+    }
+
+    void clear() override {
+      mBuffered.clear();
+      mNextToDispatch = 0;
+    }
+
+    std::vector<Event> mBuffered;
+    std::size_t mNextToDispatch = 0;
+  };
+
+  static std::size_t nextChannelIndex();
+
+  template <typename Event>
+  static std::size_t channelIndex() {
+    static const auto index = nextChannelIndex();
+    return index;
+  }
+
+  template <typename Event>
+  Channel<Event>& channelFor() {
+    const auto index = channelIndex<Event>();
+    assert(index < mChannels.size() && mChannels[index]);
+    return static_cast<Channel<Event>&>(*mChannels[index]);
+  }
+
+  entityx::EventManager* mpEvents;
+  std::vector<std::unique_ptr<ChannelBase>> mChannels;
+  std::vector<std::size_t> mDispatchOrder;
+  std::size_t mNextToDispatch = 0;
+  DispatchMode mDispatchMode;
+  bool mIsDispatching = false;
+};
+
+}
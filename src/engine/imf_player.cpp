@@ -19,81 +19,513 @@
 #include "base/math_tools.hpp"
 #include "data/game_traits.hpp"
 
+#include <algorithm>
+#include <numeric>
+#include <system_error>
+#include <utility>
+
 
 namespace rigel::engine {
 
 namespace {
 
+// While a volume ramp is in progress, volume is updated in steps of this many
+// samples
+constexpr auto VOLUME_RAMP_GRANULARITY = std::size_t{64};
+
+
+// Offline rendering checks for cancellation after each chunk of this many
+// samples
+constexpr auto PRERENDER_CHUNK_SIZE = std::size_t{8192};
+
+
 int imfDelayToSamples(const int delay, const int sampleRate) {
   const auto samplesPerImfTick =
     static_cast<double>(sampleRate) / data::GameTraits::musicPlaybackRate;
   return base::round(delay * samplesPerImfTick);
 }
 
+
+/** Advance playback of the given song by numSamples
+ *
+ * Executes IMF commands as needed, and invokes renderSamples(count) for each
+ * stretch of samples in between commands. This is shared by live playback and
+ * offline rendering, to guarantee that both produce identical output.
+ */
+template<typename RenderFunc>
+void advancePlayback(
+  const data::Song& song,
+  data::Song::const_iterator& iNextCommand,
+  std::size_t& samplesAvailable,
+  loader::AdlibEmulator& emulator,
+  const int sampleRate,
+  std::size_t numSamples,
+  RenderFunc renderSamples
+) {
+  while (numSamples > samplesAvailable) {
+    renderSamples(samplesAvailable);
+    numSamples -= samplesAvailable;
+
+    auto commandDelay = 0;
+    do {
+      const auto& command = *iNextCommand;
+      commandDelay = command.delay;
+      emulator.writeRegister(command.reg, command.value);
+      ++iNextCommand;
+      if (iNextCommand == song.end()) {
+        iNextCommand = song.begin();
+      }
+    } while (commandDelay == 0);
+
+    samplesAvailable = imfDelayToSamples(commandDelay, sampleRate);
+  }
+
+  renderSamples(numSamples);
+  samplesAvailable -= numSamples;
+}
+
+
+std::size_t songCacheKey(const data::Song& song) {
+  // FNV-1a
+  auto hash = std::size_t{14695981039346656037ull};
+  const auto addByte = [&hash](const std::uint8_t byte) {
+    hash = (hash ^ byte) * std::size_t{1099511628211ull};
+  };
+
+  for (const auto& command : song) {
+    addByte(command.reg);
+    addByte(command.value);
+    addByte(static_cast<std::uint8_t>(command.delay & 0xFF));
+    addByte(static_cast<std::uint8_t>(command.delay >> 8));
+  }
+
+  return hash ^ song.size();
+}
+
+
+std::size_t positionInRenderedSong(
+  const RenderedSong& song,
+  const std::size_t samplesPlayed
+) {
+  if (samplesPlayed < song.mSamples.size()) {
+    return samplesPlayed;
+  }
+
+  const auto loopLength = song.mSamples.size() - song.mLoopStart;
+  return song.mLoopStart + (samplesPlayed - song.mLoopStart) % loopLength;
+}
+
+}
+
+
+RenderedSong renderSong(
+  const data::Song& song,
+  const int sampleRate,
+  const std::atomic<bool>* pCancelled
+) {
+  const auto samplesPerPass = std::accumulate(
+    song.begin(),
+    song.end(),
+    std::size_t{0},
+    [sampleRate](const std::size_t sum, const data::ImfCommand& command) {
+      return sum + imfDelayToSamples(command.delay, sampleRate);
+    });
+
+  if (samplesPerPass == 0) {
+    return {};
+  }
+
+  loader::AdlibEmulator emulator(sampleRate);
+  auto iNextCommand = song.begin();
+  auto samplesAvailable = std::size_t{0};
+
+  RenderedSong result;
+  result.mSamples.resize(samplesPerPass * 2);
+  result.mLoopStart = samplesPerPass;
+
+  auto pOutput = result.mSamples.data();
+  auto samplesRemaining = result.mSamples.size();
+  while (samplesRemaining > 0) {
+    if (pCancelled && pCancelled->load(std::memory_order_relaxed)) {
+      return {};
+    }
+
+    const auto samplesForChunk =
+      std::min(samplesRemaining, PRERENDER_CHUNK_SIZE);
+    advancePlayback(
+      song,
+      iNextCommand,
+      samplesAvailable,
+      emulator,
+      sampleRate,
+      samplesForChunk,
+      [&](const std::size_t count) {
+        emulator.render(count, pOutput);
+        pOutput += count;
+      });
+
+    samplesRemaining -= samplesForChunk;
+  }
+
+  return result;
 }
 
 
 ImfPlayer::ImfPlayer(const int sampleRate)
   : mEmulator(sampleRate)
   , mSampleRate(sampleRate)
-  , mSongSwitchPending(false)
 {
-  mVolume.store(1.0f);
+}
+
+
+ImfPlayer::~ImfPlayer() {
+  cancelActivePrerendering();
 }
 
 
 void ImfPlayer::playSong(data::Song&& song) {
-  {
-    std::lock_guard<std::mutex> takeLock{mAudioLock};
-    mNextSongData = std::move(song);
+  Command command;
+  command.mType = Command::Type::PlaySong;
+  if (mPrerenderingEnabled && !song.empty()) {
+    command.mpPrerenderJob = prerenderJobFor(song);
   }
-  mSongSwitchPending = true;
+  command.mSong = std::move(song);
+  submitCommand(std::move(command));
 }
 
 
-void ImfPlayer::setVolume(const float volume) {
-  mVolume.store(std::clamp(volume, 0.0f, 1.0f));
+void ImfPlayer::stop() {
+  Command command;
+  command.mType = Command::Type::Stop;
+  submitCommand(std::move(command));
 }
 
 
-void ImfPlayer::render(std::int16_t* pBuffer, std::size_t samplesRequired) {
-  if (mSongSwitchPending && mAudioLock.try_lock()) {
-    mSongData = std::move(mNextSongData);
-    mSongSwitchPending = false;
-    mAudioLock.unlock();
+void ImfPlayer::setVolume(const float volume, const double rampTimeInSeconds) {
+  Command command;
+  command.mType = Command::Type::SetVolume;
+  command.mVolume = std::clamp(volume, 0.0f, 1.0f);
+  command.mRampSamples = base::round(rampTimeInSeconds * mSampleRate);
+  submitCommand(std::move(command));
+}
+
 
-    miNextCommand = mSongData.begin();
-    mSamplesAvailable = 0;
+void ImfPlayer::setPrerenderingEnabled(const bool enabled) {
+  if (enabled == mPrerenderingEnabled) {
+    return;
   }
 
-  if (mSongData.empty()) {
-    std::fill(pBuffer, pBuffer + samplesRequired, int16_t{0});
+  mPrerenderingEnabled = enabled;
+
+  if (!enabled) {
+    // A song that's currently being played from a pre-rendered buffer keeps
+    // playing that way, the audio thread holds on to it until the next song
+    // switch.
+    cancelActivePrerendering();
+    mRenderedSongCache.clear();
+  }
+}
+
+
+void ImfPlayer::waitForPrerendering() {
+  if (mActivePrerenderTask.valid()) {
+    mActivePrerenderTask.wait();
+  }
+}
+
+
+void ImfPlayer::update() {
+  releaseRetiredSongs();
+  flushDeferredCommands();
+}
+
+
+void ImfPlayer::submitCommand(Command&& command) {
+  releaseRetiredSongs();
+
+  // The audio thread drains the queue on each callback, so it can only be
+  // full if many commands are issued in very short succession, or if the
+  // audio thread isn't running (yet). We never wait for it: If there's no
+  // room, the command is kept back and delivered by a later update() or
+  // submitCommand() call. Previously deferred commands always go first, to
+  // keep the order intact.
+  if (flushDeferredCommands() && mCommands.tryPush(std::move(command))) {
     return;
   }
 
-  const auto volume = mVolume.load();
+  deferCommand(std::move(command));
+}
 
-  while (samplesRequired > mSamplesAvailable) {
-    mEmulator.render(mSamplesAvailable, pBuffer, volume);
-    pBuffer += mSamplesAvailable;
-    samplesRequired -= mSamplesAvailable;
 
-    auto commandDelay = 0;
-    do {
-      const auto& command = *miNextCommand;
-      commandDelay = command.delay;
-      mEmulator.writeRegister(command.reg, command.value);
-      ++miNextCommand;
-      if (miNextCommand == mSongData.end()) {
-        miNextCommand = mSongData.begin();
+void ImfPlayer::deferCommand(Command&& command) {
+  // Each kind of command fully replaces the effect of previous ones of the
+  // same kind, so only the most recent one needs to be kept.
+  if (command.mType == Command::Type::SetVolume) {
+    mDeferredVolumeCommand = std::move(command);
+  } else {
+    mDeferredSongCommand = std::move(command);
+  }
+}
+
+
+bool ImfPlayer::hasDeferredCommands() const {
+  return mDeferredSongCommand || mDeferredVolumeCommand;
+}
+
+
+bool ImfPlayer::flushDeferredCommands() {
+  const auto flush = [this](std::optional<Command>& command) {
+    if (command && mCommands.tryPush(std::move(*command))) {
+      command.reset();
+    }
+  };
+
+  flush(mDeferredSongCommand);
+  flush(mDeferredVolumeCommand);
+  return !hasDeferredCommands();
+}
+
+
+void ImfPlayer::releaseRetiredSongs() {
+  while (mRetiredCommands.front()) {
+    mRetiredCommands.pop();
+  }
+}
+
+
+auto ImfPlayer::prerenderJobFor(const data::Song& song)
+  -> std::shared_ptr<PrerenderJob>
+{
+  const auto key = songCacheKey(song);
+
+  const auto iCached = std::find_if(
+    mRenderedSongCache.begin(),
+    mRenderedSongCache.end(),
+    [key](const CachedSong& cached) { return cached.mKey == key; });
+  if (iCached != mRenderedSongCache.end()) {
+    // Move to front, so that the least recently used song is evicted first
+    std::rotate(mRenderedSongCache.begin(), iCached, std::next(iCached));
+    return mRenderedSongCache.front().mpJob;
+  }
+
+  // We only render one song at a time. If a previous song is still being
+  // rendered, it's not needed anymore.
+  cancelActivePrerendering();
+
+  auto pJob = std::make_shared<PrerenderJob>();
+
+  try {
+    mActivePrerenderTask = std::async(
+      std::launch::async,
+      [pJob, song, sampleRate = mSampleRate]() {
+        pJob->mResult = renderSong(song, sampleRate, &pJob->mCancelled);
+        if (!pJob->mResult.mSamples.empty()) {
+          pJob->mIsComplete.store(true, std::memory_order_release);
+        }
+      });
+  } catch (const std::system_error&) {
+    // Threads are not available on all platforms. Live playback works
+    // regardless, so we just do without pre-rendering in that case.
+    return nullptr;
+  }
+
+  mpActivePrerenderJob = pJob;
+  mRenderedSongCache.insert(mRenderedSongCache.begin(), CachedSong{key, pJob});
+  if (mRenderedSongCache.size() > MAX_CACHED_SONGS) {
+    mRenderedSongCache.pop_back();
+  }
+
+  return pJob;
+}
+
+
+void ImfPlayer::cancelActivePrerendering() {
+  if (!mpActivePrerenderJob) {
+    return;
+  }
+
+  if (!mpActivePrerenderJob->mIsComplete.load(std::memory_order_acquire)) {
+    mpActivePrerenderJob->mCancelled.store(true, std::memory_order_relaxed);
+
+    // An incomplete result is of no use, so it shouldn't stay in the cache
+    mRenderedSongCache.erase(
+      std::remove_if(
+        mRenderedSongCache.begin(),
+        mRenderedSongCache.end(),
+        [this](const CachedSong& cached) {
+          return cached.mpJob == mpActivePrerenderJob;
+        }),
+      mRenderedSongCache.end());
+  }
+
+  if (mActivePrerenderTask.valid()) {
+    mActivePrerenderTask.wait();
+  }
+
+  mpActivePrerenderJob.reset();
+}
+
+
+void ImfPlayer::processCommands() {
+  while (auto pCommand = mCommands.front()) {
+    const auto needsRetiring =
+      pCommand->mType == Command::Type::PlaySong ||
+      pCommand->mType == Command::Type::Stop;
+
+    // If the main thread hasn't released previously retired songs yet, we
+    // keep the command in the queue and try again during the next callback.
+    // This way, we never have to free memory on the audio thread.
+    if (needsRetiring && mRetiredCommands.full()) {
+      break;
+    }
+
+    switch (pCommand->mType) {
+      case Command::Type::PlaySong:
+      case Command::Type::Stop:
+        switchSong(*pCommand);
+        break;
+
+      case Command::Type::SetVolume:
+        mTargetVolume = pCommand->mVolume;
+        if (pCommand->mRampSamples > 0 && mTargetVolume != mVolume) {
+          mVolumeStepPerSample =
+            (mTargetVolume - mVolume) / pCommand->mRampSamples;
+        } else {
+          mVolume = mTargetVolume;
+          mVolumeStepPerSample = 0.0f;
+        }
+        break;
+
+      case Command::Type::None:
+        break;
+    }
+
+    mCommands.pop();
+  }
+}
+
+
+void ImfPlayer::switchSong(Command& command) {
+  using std::swap;
+
+  // The previous song ends up in the command, which is then handed back to
+  // the main thread for destruction.
+  swap(mSongData, command.mSong);
+  swap(mpPrerenderJob, command.mpPrerenderJob);
+  mRetiredCommands.tryPush(std::move(command));
+
+  miNextCommand = mSongData.begin();
+  mSamplesAvailable = 0;
+  mSamplesPlayed = 0;
+  mPrerenderedPosition = 0;
+  mIsUsingPrerenderedSong = false;
+}
+
+
+template<typename RenderFunc>
+void ImfPlayer::renderWithVolume(
+  std::int16_t* pBuffer,
+  std::size_t numSamples,
+  RenderFunc render
+) {
+  while (mVolume != mTargetVolume && numSamples > 0) {
+    const auto samplesForStep = std::min(numSamples, VOLUME_RAMP_GRANULARITY);
+    render(pBuffer, samplesForStep, mVolume);
+    pBuffer += samplesForStep;
+    numSamples -= samplesForStep;
+
+    const auto nextVolume = mVolume + mVolumeStepPerSample * samplesForStep;
+    const auto reachedTarget = mVolumeStepPerSample > 0.0f
+      ? nextVolume >= mTargetVolume
+      : nextVolume <= mTargetVolume;
+    mVolume = reachedTarget ? mTargetVolume : nextVolume;
+  }
+
+  render(pBuffer, numSamples, mVolume);
+}
+
+
+void ImfPlayer::renderLive(std::int16_t* pBuffer, const std::size_t numSamples) {
+  advancePlayback(
+    mSongData,
+    miNextCommand,
+    mSamplesAvailable,
+    mEmulator,
+    mSampleRate,
+    numSamples,
+    [&](const std::size_t count) {
+      renderWithVolume(pBuffer, count,
+        [this](std::int16_t* pDestination, std::size_t n, const float volume) {
+          mEmulator.render(n, pDestination, volume);
+        });
+      pBuffer += count;
+    });
+}
+
+
+void ImfPlayer::renderPrerendered(
+  std::int16_t* pBuffer,
+  const std::size_t numSamples
+) {
+  const auto& samples = mpPrerenderJob->mResult.mSamples;
+  const auto loopStart = mpPrerenderJob->mResult.mLoopStart;
+
+  renderWithVolume(pBuffer, numSamples,
+    [&](std::int16_t* pDestination, std::size_t count, const float volume) {
+      while (count > 0) {
+        const auto samplesToCopy =
+          std::min(count, samples.size() - mPrerenderedPosition);
+        const auto iStart = samples.begin() + mPrerenderedPosition;
+        pDestination = std::transform(
+          iStart,
+          iStart + samplesToCopy,
+          pDestination,
+          [volume](const std::int16_t sample) {
+            return static_cast<std::int16_t>(base::round(sample * volume));
+          });
+
+        count -= samplesToCopy;
+        mPrerenderedPosition += samplesToCopy;
+        if (mPrerenderedPosition == samples.size()) {
+          mPrerenderedPosition = loopStart;
+        }
       }
-    } while (commandDelay == 0);
+    });
+}
+
+
+void ImfPlayer::render(std::int16_t* pBuffer, std::size_t samplesRequired) {
+  processCommands();
+
+  if (mSongData.empty()) {
+    // No need to ramp if there is nothing to hear
+    mVolume = mTargetVolume;
+    std::fill(pBuffer, pBuffer + samplesRequired, int16_t{0});
+    return;
+  }
+
+  if (
+    !mIsUsingPrerenderedSong &&
+    mpPrerenderJob &&
+    mpPrerenderJob->mIsComplete.load(std::memory_order_acquire)
+  ) {
+    // Rendering has finished in the meantime. The pre-rendered song contains
+    // the same samples as live playback produces, so we can switch over at
+    // the current position without an audible seam. (Strictly speaking, live
+    // playback carries over emulator state from the previous song, but that
+    // is overwritten as soon as the new song has programmed all channels.)
+    mIsUsingPrerenderedSong = true;
+    mPrerenderedPosition =
+      positionInRenderedSong(mpPrerenderJob->mResult, mSamplesPlayed);
+  }
 
-    mSamplesAvailable = imfDelayToSamples(commandDelay, mSampleRate);
+  if (mIsUsingPrerenderedSong) {
+    renderPrerendered(pBuffer, samplesRequired);
+  } else {
+    renderLive(pBuffer, samplesRequired);
   }
 
-  mEmulator.render(samplesRequired, pBuffer, volume);
-  mSamplesAvailable -= samplesRequired;
+  mSamplesPlayed += samplesRequired;
 }
 
 
@@ -16,38 +16,176 @@
 
 #pragma once
 
+#include "base/spsc_queue.hpp"
 #include "data/song.hpp"
 #include "loader/adlib_emulator.hpp"
 
 #include <atomic>
-#include <mutex>
+#include <future>
+#include <memory>
+#include <optional>
+#include <vector>
 
 
 namespace rigel::engine {
 
+/** IMF song rendered to PCM ahead of time
+ *
+ * Contains two passes through the song. The first one is what's heard when
+ * the song starts. The second one starts with the emulator state left over
+ * from the first pass, which is what the song sounds like when it repeats
+ * during live playback. Looping therefore jumps back to the start of the
+ * second pass (mLoopStart) instead of to the very beginning.
+ */
+struct RenderedSong {
+  std::vector<std::int16_t> mSamples;
+  std::size_t mLoopStart = 0;
+};
+
+
+/** Render the given song to PCM
+ *
+ * Produces exactly the same samples as live playback via ImfPlayer at full
+ * volume, starting from a freshly initialized emulator. Returns an empty
+ * result if rendering was cancelled via pCancelled, or if the song has no
+ * duration.
+ */
+RenderedSong renderSong(
+  const data::Song& song,
+  int sampleRate,
+  const std::atomic<bool>* pCancelled = nullptr);
+
+
+/** Plays IMF music using an AdLib emulator
+ *
+ * render() is meant to be called from the audio thread, while all other
+ * functions are meant to be called from the main thread. Communication between
+ * the two happens via lock-free queues: render() never blocks or allocates,
+ * and memory owned by songs which are no longer needed is always released on
+ * the main thread. Neither side ever waits for the other, so update() needs
+ * to be called regularly on the main thread.
+ */
 class ImfPlayer {
 public:
   explicit ImfPlayer(int sampleRate);
   ImfPlayer(const ImfPlayer&) = delete;
   ImfPlayer& operator=(const ImfPlayer&) = delete;
+  ~ImfPlayer();
 
   void playSong(data::Song&& song);
-  void setVolume(const float volume);
+  void stop();
+
+  /** Change volume, with a linear ramp from the current volume
+   *
+   * The default ramp time is short enough to be perceived as an immediate
+   * change, but avoids audible clicks when changing volume during playback.
+   */
+  void setVolume(float volume, double rampTimeInSeconds = 0.02);
+
+  /** Enable or disable playback of pre-rendered songs
+   *
+   * When enabled, each song is rendered to PCM in the background when it's
+   * first played. Until rendering is finished, the song is played using the
+   * live emulator, and playback then switches over seamlessly. Rendered songs
+   * are kept in a small cache, so that playing them again doesn't require
+   * re-rendering. This trades memory for a substantial reduction in CPU load
+   * on the audio thread.
+   */
+  void setPrerenderingEnabled(bool enabled);
+
+  /** Block until the song that's currently being pre-rendered is finished
+   *
+   * Returns right away if nothing is being rendered. Playback switches over
+   * to the pre-rendered song during the next render() call.
+   */
+  void waitForPrerendering();
+
+  /** Main thread housekeeping, to be called once per frame
+   *
+   * Delivers commands to the audio thread which didn't fit into the command
+   * queue when they were issued, and releases memory of songs which the
+   * audio thread is done with.
+   */
+  void update();
 
   void render(std::int16_t* pBuffer, std::size_t samplesRequired);
 
 private:
-  loader::AdlibEmulator mEmulator;
-  std::mutex mAudioLock;
-  data::Song mNextSongData;
+  struct PrerenderJob {
+    RenderedSong mResult;
+    std::atomic<bool> mIsComplete{false};
+    std::atomic<bool> mCancelled{false};
+  };
+
+  struct CachedSong {
+    std::size_t mKey;
+    std::shared_ptr<PrerenderJob> mpJob;
+  };
+
+  struct Command {
+    enum class Type : std::uint8_t {
+      None,
+      PlaySong,
+      Stop,
+      SetVolume
+    };
+
+    Type mType = Type::None;
+    data::Song mSong;
+    std::shared_ptr<PrerenderJob> mpPrerenderJob;
+    float mVolume = 0.0f;
+    int mRampSamples = 0;
+  };
+
+  static constexpr auto COMMAND_QUEUE_CAPACITY = 32;
+
+  static constexpr auto MAX_CACHED_SONGS = 3;
 
+  void submitCommand(Command&& command);
+  void deferCommand(Command&& command);
+  bool hasDeferredCommands() const;
+  bool flushDeferredCommands();
+  void releaseRetiredSongs();
+  std::shared_ptr<PrerenderJob> prerenderJobFor(const data::Song& song);
+  void cancelActivePrerendering();
+
+  void processCommands();
+  void switchSong(Command& command);
+  void renderLive(std::int16_t* pBuffer, std::size_t numSamples);
+  void renderPrerendered(std::int16_t* pBuffer, std::size_t numSamples);
+
+  template<typename RenderFunc>
+  void renderWithVolume(
+    std::int16_t* pBuffer,
+    std::size_t numSamples,
+    RenderFunc render);
+
+  base::SpscQueue<Command, COMMAND_QUEUE_CAPACITY> mCommands;
+  base::SpscQueue<Command, COMMAND_QUEUE_CAPACITY> mRetiredCommands;
+
+  // Only accessed by the main thread
+  std::optional<Command> mDeferredSongCommand;
+  std::optional<Command> mDeferredVolumeCommand;
+  std::vector<CachedSong> mRenderedSongCache;
+  std::shared_ptr<PrerenderJob> mpActivePrerenderJob;
+  std::future<void> mActivePrerenderTask;
+  bool mPrerenderingEnabled = false;
+
+  // Only accessed by the audio thread
+  loader::AdlibEmulator mEmulator;
   data::Song mSongData;
   data::Song::const_iterator miNextCommand;
   std::size_t mSamplesAvailable = 0;
   int mSampleRate;
 
-  std::atomic<float> mVolume;
-  std::atomic<bool> mSongSwitchPending;
+  std::shared_ptr<PrerenderJob> mpPrerenderJob;
+  std::size_t mSamplesPlayed = 0;
+  std::size_t mPrerenderedPosition = 0;
+  bool mIsUsingPrerenderedSong = false;
+
+  float mVolume = 1.0f;
+  float mTargetVolume = 1.0f;
+  float mVolumeStepPerSample = 0.0f;
 };
 
 }
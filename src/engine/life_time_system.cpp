@@ -16,6 +16,7 @@
 
 #include "life_time_system.hpp"
 
+#include "base/tracing.hpp"
 #include "engine/physical_components.hpp"
 
 
@@ -26,6 +27,8 @@ void LifeTimeSystem::update(
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize
 ) {
+  RIGEL_TRACE_SCOPE("LifeTimeSystem::update");
+
   namespace c = components;
   using Condition = components::AutoDestroy::Condition;
 
@@ -130,6 +130,12 @@ void MapRenderer::switchBackdrops() {
 }
 
 
+void MapRenderer::synchronizeTo(const MapRenderer& other) {
+  mBackdropAutoScrollOffset = other.mBackdropAutoScrollOffset;
+  mElapsedFrames = other.mElapsedFrames;
+}
+
+
 void MapRenderer::renderBackground(
   const base::Vector& sectionStart,
   const base::Extents& sectionSize
@@ -177,28 +183,20 @@ void MapRenderer::renderMapTiles(
   const base::Extents& sectionSize,
   const DrawMode drawMode
 ) const {
-  for (int layer=0; layer<2; ++layer) {
-    for (int y=0; y<sectionSize.height; ++y) {
-      for (int x=0; x<sectionSize.width; ++x) {
-        const auto col = x + sectionStart.x;
-        const auto row = y + sectionStart.y;
-        if (col >= mpMap->width() || row >= mpMap->height()) {
-          continue;
-        }
-
-        const auto tileIndex = mpMap->tileAt(layer, col, row);
-        const auto isForeground =
-          mpMap->attributeDict().attributes(tileIndex).isForeGround();
-        const auto shouldRenderForeground = drawMode == DrawMode::Foreground;
-
-        if (isForeground != shouldRenderForeground) {
-          continue;
-        }
-
+  const auto& attributeDict = mpMap->attributeDict();
+  const auto shouldRenderForeground = drawMode == DrawMode::Foreground;
+
+  forEachTileInSection(
+    *mpMap,
+    sectionStart,
+    sectionSize,
+    [&](const data::map::TileIndex tileIndex, const int x, const int y) {
+      const auto isForeground =
+        attributeDict.attributes(tileIndex).isForeGround();
+      if (isForeground == shouldRenderForeground) {
         renderTile(tileIndex, x, y);
       }
-    }
-  }
+    });
 }
 
 
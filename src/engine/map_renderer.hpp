@@ -26,12 +26,49 @@
 
 namespace rigel::engine {
 
+/** Invokes callback(tileIndex, x, y) for each tile in the given section
+ *
+ * Visits both layers, but only tiles within the map's bounds. The x and y
+ * coordinates are relative to sectionStart.
+ */
+template <typename Callback>
+void forEachTileInSection(
+  const data::map::Map& map,
+  const base::Vector& sectionStart,
+  const base::Extents& sectionSize,
+  Callback&& callback
+) {
+  const auto visibleSection = map.clipToMap({sectionStart, sectionSize});
+  if (visibleSection.size.width <= 0 || visibleSection.size.height <= 0) {
+    return;
+  }
+
+  const auto firstCol = visibleSection.left();
+  const auto endCol = firstCol + visibleSection.size.width;
+  const auto firstRow = visibleSection.top();
+  const auto endRow = firstRow + visibleSection.size.height;
+
+  for (int layer=0; layer<2; ++layer) {
+    for (int row=firstRow; row<endRow; ++row) {
+      const auto tiles = map.tileRow(layer, row, firstCol, endCol);
+      const auto y = row - sectionStart.y;
+
+      auto x = firstCol - sectionStart.x;
+      for (const auto tileIndex : tiles) {
+        callback(tileIndex, x, y);
+        ++x;
+      }
+    }
+  }
+}
+
+
 class MapRenderer {
 public:
   struct MapRenderData {
-    data::Image mTileSetImage;
-    data::Image mBackdropImage;
-    std::optional<data::Image> mSecondaryBackdropImage;
+    data::IndexedImage mTileSetImage;
+    data::IndexedImage mBackdropImage;
+    std::optional<data::IndexedImage> mSecondaryBackdropImage;
     data::map::BackdropScrollMode mBackdropScrollMode;
   };
 
@@ -42,6 +79,12 @@ public:
 
   void switchBackdrops();
 
+  /** Copy animation and auto-scrolling state from another renderer
+   *
+   * Does not affect which backdrop is active, see switchBackdrops().
+   */
+  void synchronizeTo(const MapRenderer& other);
+
   void renderBackdrop(
     const base::Vector& cameraPosition,
     const base::Extents& viewPortSize) const;
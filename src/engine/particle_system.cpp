@@ -16,8 +16,10 @@
 
 #include "particle_system.hpp"
 
+#include "base/tracing.hpp"
 #include "data/unit_conversions.hpp"
 #include "engine/random_number_generator.hpp"
+#include "loader/file_utils.hpp"
 #include "renderer/renderer.hpp"
 
 #include <algorithm>
@@ -25,6 +27,7 @@
 #include <cassert>
 #include <functional>
 #include <memory>
+#include <stdexcept>
 
 
 namespace rigel::engine {
@@ -174,6 +177,62 @@ void ParticleSystem::synchronizeTo(const ParticleSystem& other) {
 }
 
 
+void ParticleSystem::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeU16(static_cast<std::uint16_t>(mParticleGroups.size()));
+
+  for (const auto& group : mParticleGroups) {
+    writer.writeS16(static_cast<std::int16_t>(group.mOrigin.x));
+    writer.writeS16(static_cast<std::int16_t>(group.mOrigin.y));
+    writer.writeU8(group.mColor.r);
+    writer.writeU8(group.mColor.g);
+    writer.writeU8(group.mColor.b);
+    writer.writeU8(group.mColor.a);
+    writer.writeU8(static_cast<std::uint8_t>(group.mFramesElapsed));
+
+    for (const auto& particle : *group.mpParticles) {
+      writer.writeS16(particle.mVelocityX);
+      writer.writeU8(static_cast<std::uint8_t>(particle.mInitialOffsetIndexY));
+    }
+  }
+}
+
+
+void ParticleSystem::readState(loader::LeStreamReader& reader) {
+  std::vector<ParticleGroup> groups;
+
+  const auto numGroups = reader.readU16();
+  for (auto i = 0; i < numGroups; ++i) {
+    const auto x = reader.readS16();
+    const auto y = reader.readS16();
+    const auto r = reader.readU8();
+    const auto g = reader.readU8();
+    const auto b = reader.readU8();
+    const auto a = reader.readU8();
+    const auto framesElapsed = reader.readU8();
+
+    if (framesElapsed >= PARTICLE_SYSTEM_LIFE_TIME) {
+      throw std::runtime_error("Invalid particle state");
+    }
+
+    auto pParticles = std::make_unique<ParticlesList>();
+    for (auto& particle : *pParticles) {
+      particle.mVelocityX = reader.readS16();
+      particle.mInitialOffsetIndexY = reader.readU8();
+
+      if (particle.mInitialOffsetIndexY > INITIAL_INDEX_LIMIT) {
+        throw std::runtime_error("Invalid particle state");
+      }
+    }
+
+    auto& group = groups.emplace_back(
+      base::Vector{x, y}, base::Color{r, g, b, a}, std::move(pParticles));
+    group.mFramesElapsed = framesElapsed;
+  }
+
+  mParticleGroups = std::move(groups);
+}
+
+
 void ParticleSystem::spawnParticles(
   const base::Vector& origin,
   const base::Color& color,
@@ -186,6 +245,8 @@ void ParticleSystem::spawnParticles(
 
 
 void ParticleSystem::update() {
+  RIGEL_TRACE_SCOPE("ParticleSystem::update");
+
   using namespace std;
 
   const auto it = remove_if(
@@ -21,6 +21,10 @@
 
 #include <vector>
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
 namespace rigel::renderer { class Renderer; }
 
 
@@ -40,6 +44,16 @@ public:
 
   void synchronizeTo(const ParticleSystem& other);
 
+  /** Write the state of all particle groups, used for quick saves */
+  void writeState(loader::LeStreamWriter& writer) const;
+
+  /** Replace all particle groups with state written by writeState()
+   *
+   * Throws std::runtime_error if the data is invalid. In that case, the
+   * current particle groups are left untouched.
+   */
+  void readState(loader::LeStreamReader& reader);
+
   void spawnParticles(
     const base::Vector& origin,
     const base::Color& color,
@@ -16,10 +16,14 @@
 
 #include "physics_system.hpp"
 
+#include "base/tracing.hpp"
 #include "engine/collision_checker.hpp"
 #include "engine/entity_tools.hpp"
+#include "engine/event_queue.hpp"
 #include "engine/movement.hpp"
 
+#include <algorithm>
+
 namespace ex = entityx;
 
 
@@ -78,14 +82,18 @@ BoundingBox toWorldSpace(
 PhysicsSystem::PhysicsSystem(
   const engine::CollisionChecker* pCollisionChecker,
   const data::map::Map* pMap,
-  entityx::EventManager* pEvents
+  EventQueue* pEventQueue
 )
   : mpCollisionChecker(pCollisionChecker)
   , mpMap(pMap)
-  , mpEvents(pEvents)
+  , mpEventQueue(pEventQueue)
 {
-  mpEvents->subscribe<ex::ComponentAddedEvent<MovingBody>>(*this);
-  mpEvents->subscribe<ex::ComponentRemovedEvent<MovingBody>>(*this);
+  auto& eventManager = mpEventQueue->eventManager();
+  eventManager.subscribe<ex::ComponentAddedEvent<MovingBody>>(*this);
+  eventManager.subscribe<ex::ComponentRemovedEvent<MovingBody>>(*this);
+
+  mpEventQueue->registerEventType<events::CollidedWithWorld>(
+    "CollidedWithWorld");
 }
 
 
@@ -104,30 +112,44 @@ void PhysicsSystem::update(ex::EntityManager& es) {
 
 
 void PhysicsSystem::updatePhase1(ex::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("PhysicsSystem::updatePhase1");
+
   update(es);
   mShouldCollectForPhase2 = true;
 }
 
 
 void PhysicsSystem::updatePhase2(ex::EntityManager& es) {
-  for (auto entity : mPhysicsObjectsForPhase2) {
-    assert(entity.has_component<MovingBody>());
-    const auto hasRequiredComponents =
-      entity.has_component<WorldPosition>() &&
-      entity.has_component<BoundingBox>() &&
-      entity.has_component<components::Active>();
-
-    if (hasRequiredComponents) {
-      applyPhysics(
-        entity,
-        *entity.component<MovingBody>(),
-        *entity.component<WorldPosition>(),
-        *entity.component<BoundingBox>());
+  RIGEL_TRACE_SCOPE("PhysicsSystem::updatePhase2");
+
+  // Not using a range-based for loop, since applyPhysics() might cause
+  // further entities to be added
+  for (std::size_t i = 0; i < mPhase2Entries.size(); ++i) {
+    auto entry = mPhase2Entries[i];
+    if (!entry.mEntity) {
+      continue;
+    }
+
+    assert(entry.mBody);
+    auto position = entry.mEntity.component<WorldPosition>();
+    auto bbox = entry.mEntity.component<BoundingBox>();
+
+    if (
+      position && bbox && entry.mEntity.has_component<components::Active>()
+    ) {
+      applyPhysics(entry.mEntity, *entry.mBody, *position, *bbox);
     }
   }
 
-  mPhysicsObjectsForPhase2.clear();
+  mPhase2Entries.clear();
   mShouldCollectForPhase2 = false;
+
+  ++mPhase2Generation;
+  if (mPhase2Generation == 0) {
+    // Wrapped around, stale slots could now appear valid again
+    std::fill(mPhase2Slots.begin(), mPhase2Slots.end(), Phase2Slot{});
+    mPhase2Generation = 1;
+  }
 }
 
 
@@ -183,7 +205,7 @@ void PhysicsSystem::applyPhysics(
     const auto top = targetPosition.y != position.y && movementY < 0;
     const auto bottom = targetPosition.y != position.y && movementY > 0;
 
-    mpEvents->emit(events::CollidedWithWorld{
+    mpEventQueue->post(events::CollidedWithWorld{
       entity, left, right, top, bottom});
   }
 
@@ -201,29 +223,41 @@ void PhysicsSystem::receive(
     return;
   }
 
-  mPhysicsObjectsForPhase2.push_back(event.entity);
+  auto entity = event.entity;
+  const auto entityIndex = entity.id().index();
+  if (entityIndex >= mPhase2Slots.size()) {
+    mPhase2Slots.resize(entityIndex + 1);
+  }
+
+  mPhase2Slots[entityIndex] = Phase2Slot{
+    mPhase2Generation, static_cast<std::uint32_t>(mPhase2Entries.size())};
+  mPhase2Entries.push_back(Phase2Entry{entity, event.component});
 }
 
 
 void PhysicsSystem::receive(
   const entityx::ComponentRemovedEvent<components::MovingBody>& event
 ) {
-  using namespace std;
-
   if (!mShouldCollectForPhase2) {
     return;
   }
 
-  const auto it = find_if(
-    begin(mPhysicsObjectsForPhase2),
-    end(mPhysicsObjectsForPhase2),
-    [&event](const auto& entity) {
-      return entity == event.entity;
-    });
+  const auto entityIndex = event.entity.id().index();
+  if (entityIndex >= mPhase2Slots.size()) {
+    return;
+  }
 
-  if (it != end(mPhysicsObjectsForPhase2)) {
-    mPhysicsObjectsForPhase2.erase(it);
+  auto& slot = mPhase2Slots[entityIndex];
+  if (slot.mGeneration != mPhase2Generation) {
+    return;
+  }
+
+  auto& entry = mPhase2Entries[slot.mEntryIndex];
+  if (entry.mEntity == event.entity) {
+    entry = Phase2Entry{};
   }
+
+  slot = Phase2Slot{};
 }
 
 
@@ -27,6 +27,7 @@ RIGEL_RESTORE_WARNINGS
 
 #include <cstdint>
 #include <tuple>
+#include <vector>
 
 
 namespace rigel::data::map { class Map; }
@@ -35,6 +36,7 @@ namespace rigel::data::map { class Map; }
 namespace rigel::engine {
 
 class CollisionChecker;
+class EventQueue;
 
 /** Implements game physics/world interaction
  *
@@ -44,7 +46,8 @@ class CollisionChecker;
  * entities will also fall down until they hit solid ground.
  *
  * Entities that collided with the world on the last update() will be tagged
- * with the CollidedWithWorld component.
+ * with the CollidedWithWorld component. In addition, a CollidedWithWorld
+ * event is posted to the event queue.
  *
  * The collision detection is very simple and relies on knowing each entity's
  * previous position. Therefore, entities which are to collide against the
@@ -60,7 +63,7 @@ public:
   PhysicsSystem(
     const engine::CollisionChecker* pCollisionChecker,
     const data::map::Map* pMap,
-    entityx::EventManager* pEvents);
+    EventQueue* pEventQueue);
 
   /** Process currently existing entities
    *
@@ -100,11 +103,33 @@ private:
     const components::BoundingBox& bbox,
     float currentVelocity);
 
+  /** Entities collected for phase 2, in the order they were added
+   *
+   * Entries whose MovingBody is removed before phase 2 are invalidated in
+   * place, which keeps removal O(1) while preserving processing order.
+   */
+  struct Phase2Entry {
+    entityx::Entity mEntity;
+    entityx::ComponentHandle<components::MovingBody> mBody;
+  };
+
+  /** Maps entity indices to positions in mPhase2Entries
+   *
+   * A slot is only valid if its generation matches mPhase2Generation, so the
+   * slot array doesn't need to be cleared between frames.
+   */
+  struct Phase2Slot {
+    std::uint32_t mGeneration = 0;
+    std::uint32_t mEntryIndex = 0;
+  };
+
 private:
-  std::vector<entityx::Entity> mPhysicsObjectsForPhase2;
+  std::vector<Phase2Entry> mPhase2Entries;
+  std::vector<Phase2Slot> mPhase2Slots;
+  std::uint32_t mPhase2Generation = 1;
   const CollisionChecker* mpCollisionChecker;
   const data::map::Map* mpMap;
-  entityx::EventManager* mpEvents;
+  EventQueue* mpEventQueue;
   bool mShouldCollectForPhase2 = false;
 };
 
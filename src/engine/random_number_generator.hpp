@@ -29,6 +29,15 @@ class RandomNumberGenerator {
 public:
   int gen();
 
+  /** Current position in the random number table */
+  std::size_t nextNumberIndex() const {
+    return mNextNumberIndex;
+  }
+
+  void setNextNumberIndex(const std::size_t index) {
+    mNextNumberIndex = index % RANDOM_NUMBER_TABLE.size();
+  }
+
 private:
   std::size_t mNextNumberIndex = 0;
 };
@@ -16,35 +16,27 @@
 
 #include "sound_system.hpp"
 
+#include "base/clock.hpp"
 #include "base/math_tools.hpp"
+#include "base/tracing.hpp"
+#include "base/warnings.hpp"
 #include "data/game_options.hpp"
+#include "engine/audio_mixer.hpp"
 #include "engine/imf_player.hpp"
 #include "loader/resource_loader.hpp"
 #include "sdl_utils/error.hpp"
 
+RIGEL_DISABLE_WARNINGS
+#include <SDL_audio.h>
+RIGEL_RESTORE_WARNINGS
+
 #include <speex/speex_resampler.h>
 
-#include <cassert>
-#include <cstring>
-#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <thread>
 #include <utility>
-
-
-namespace rigel::sdl_mixer {
-
-namespace {
-
-void check(int result) {
-  using namespace std::string_literals;
-
-  if (result != 0) {
-    throw std::runtime_error{"SDL_mixer error: "s + Mix_GetError()};
-  }
-}
-
-}
-
-}
+#include <vector>
 
 
 namespace rigel::engine {
@@ -103,9 +95,9 @@ void appendRampToZero(data::AudioBuffer& buffer, const int sampleRate) {
 }
 
 
-// Prepares the given audio buffer to be loaded into a Mix_Chunk. This includes
-// resampling to the given sample rate and making sure the buffer ends in a
-// zero value to avoid clicks/pops.
+// Prepares the given audio buffer for playback via the AudioMixer. This
+// includes resampling to the given sample rate and making sure the buffer ends
+// in a zero value to avoid clicks/pops.
 data::AudioBuffer prepareBuffer(
   const data::AudioBuffer& original,
   const int sampleRate
@@ -121,196 +113,180 @@ data::AudioBuffer prepareBuffer(
 }
 
 
-// Converts the given audio buffer into the given audio format and returns it
-// as a raw buffer
-RawBuffer convertBuffer(
-  const data::AudioBuffer& buffer,
-  const std::uint16_t audioFormat
-) {
-  SDL_AudioCVT conversionSpecs;
-  SDL_BuildAudioCVT(
-    &conversionSpecs,
-    AUDIO_S16LSB, 1, buffer.mSampleRate,
-    audioFormat, 1, buffer.mSampleRate);
-
-  const auto sizeInBytes = buffer.mSamples.size() * sizeof(std::int16_t);
-  auto converted = RawBuffer(sizeInBytes * conversionSpecs.len_mult);
-  std::memcpy(converted.data(), buffer.mSamples.data(), sizeInBytes);
-
-  conversionSpecs.len = static_cast<int>(sizeInBytes);
-  conversionSpecs.buf = converted.data();
-  SDL_ConvertAudio(&conversionSpecs);
-
-  return converted;
-}
-
-
 auto idToIndex(const data::SoundId id) {
   return static_cast<int>(id);
 }
 
+}
 
-void simpleMusicCallback(
-  void* pUserData,
-  Uint8* pOutBuffer,
-  const int bytesRequired
-) {
-  auto pPlayer = static_cast<ImfPlayer*>(pUserData);
-  auto pDestination = reinterpret_cast<std::int16_t*>(pOutBuffer);
-  const auto samplesRequired = bytesRequired / sizeof(std::int16_t);
 
-  pPlayer->render(pDestination, samplesRequired);
-}
+class SoundSystem::Output {
+public:
+  virtual ~Output() = default;
 
+  virtual int sampleRate() const = 0;
 
-// Turns the given audio buffer into a raw buffer without any conversion
-RawBuffer asRawBuffer(const data::AudioBuffer& buffer) {
-  const auto sizeInBytes = buffer.mSamples.size() * sizeof(data::Sample);
-  auto rawBuffer = RawBuffer(sizeInBytes);
-  std::memcpy(rawBuffer.data(), buffer.mSamples.data(), sizeInBytes);
-  return rawBuffer;
-}
+  /** Start requesting audio from the given mixer
+   *
+   * The mixer must stay alive until the output is destroyed.
+   */
+  virtual void start(AudioMixer* pMixer) = 0;
+};
 
-}
 
+class SoundSystem::DeviceOutput : public SoundSystem::Output {
+public:
+  DeviceOutput() {
+    SDL_AudioSpec desiredSpec{};
+    desiredSpec.freq = DESIRED_SAMPLE_RATE;
+    desiredSpec.format = AUDIO_S16SYS;
+    desiredSpec.channels = 1; // mono
+    desiredSpec.samples = BUFFER_SIZE;
+    desiredSpec.callback = audioCallback;
+    desiredSpec.userdata = this;
+
+    // We only allow the sample rate to differ from what we asked for. For any
+    // other differences, SDL converts our output to what the device needs.
+    SDL_AudioSpec actualSpec{};
+    mDevice = SDL_OpenAudioDevice(
+      nullptr,
+      0,
+      &desiredSpec,
+      &actualSpec,
+      SDL_AUDIO_ALLOW_FREQUENCY_CHANGE);
+    if (mDevice == 0) {
+      throw sdl_utils::Error{};
+    }
+
+    mSampleRate = actualSpec.freq;
+  }
+
+  ~DeviceOutput() override {
+    // Waits for a currently running callback to finish
+    SDL_CloseAudioDevice(mDevice);
+  }
 
-struct SoundSystem::MusicConversionWrapper {
-  MusicConversionWrapper(
-    ImfPlayer* pPlayer,
-    const std::uint16_t audioFormat,
-    const int sampleRate)
-    : mpPlayer(pPlayer)
-    , mBytesPerSample(SDL_AUDIO_BITSIZE(audioFormat) / 8)
-  {
-    SDL_BuildAudioCVT(
-      &mConversionSpecs,
-      AUDIO_S16LSB, 1, sampleRate,
-      audioFormat, 1, sampleRate);
-
-    const auto bufferSize =
-      BUFFER_SIZE * mBytesPerSample * mConversionSpecs.len_mult;
-    mpBuffer = std::unique_ptr<std::uint8_t[]>{new std::uint8_t[bufferSize]};
-    mConversionSpecs.buf = mpBuffer.get();
+  int sampleRate() const override {
+    return mSampleRate;
   }
 
-  void render(Uint8* pOutBuffer, int bytesRequired) {
-    auto pBuffer = mpBuffer.get();
-    const auto samplesToRender = bytesRequired / mBytesPerSample;
-    mpPlayer->render(reinterpret_cast<std::int16_t*>(pBuffer), samplesToRender);
+  void start(AudioMixer* pMixer) override {
+    // The device is initially paused, so the callback can't be running yet
+    mpMixer = pMixer;
+    SDL_PauseAudioDevice(mDevice, 0);
+  }
 
-    mConversionSpecs.len = bytesRequired;
-    SDL_ConvertAudio(&mConversionSpecs);
-    std::memcpy(pOutBuffer, pBuffer, mConversionSpecs.len_cvt);
+private:
+  static void audioCallback(
+    void* pUserData,
+    Uint8* pOutBuffer,
+    const int bytesRequired
+  ) {
+    auto pSelf = static_cast<DeviceOutput*>(pUserData);
+    pSelf->mpMixer->mix(
+      reinterpret_cast<data::Sample*>(pOutBuffer),
+      static_cast<std::size_t>(bytesRequired) / sizeof(data::Sample));
   }
 
-  SDL_AudioCVT mConversionSpecs;
-  std::unique_ptr<std::uint8_t[]> mpBuffer;
-  ImfPlayer* mpPlayer;
-  int mBytesPerSample;
+  SDL_AudioDeviceID mDevice = 0;
+  AudioMixer* mpMixer = nullptr;
+  int mSampleRate = 0;
 };
 
 
+class SoundSystem::NullOutput : public SoundSystem::Output {
+public:
+  ~NullOutput() override {
+    mStopRequested = true;
+    if (mThread.joinable()) {
+      mThread.join();
+    }
+  }
 
-SoundSystem::LoadedSound::LoadedSound(const data::AudioBuffer& buffer)
-  : LoadedSound(asRawBuffer(buffer))
-{
-}
+  int sampleRate() const override {
+    return DESIRED_SAMPLE_RATE;
+  }
 
+  void start(AudioMixer* pMixer) override {
+    mThread = std::thread{[this, pMixer]() { run(pMixer); }};
+  }
 
-SoundSystem::LoadedSound::LoadedSound(RawBuffer buffer)
-  : mData(std::move(buffer))
-  , mpMixChunk(sdl_utils::Ptr<Mix_Chunk>{
-      Mix_QuickLoad_RAW(mData.data(), static_cast<Uint32>(mData.size()))})
-{
-}
+private:
+  void run(AudioMixer* pMixer) {
+    // Request one buffer's worth of audio at a time, at the same pace as a
+    // real audio device would.
+    const auto bufferDuration =
+      std::chrono::duration_cast<base::Clock::duration>(
+        std::chrono::duration<double>{
+          static_cast<double>(BUFFER_SIZE) / DESIRED_SAMPLE_RATE});
 
+    std::vector<data::Sample> buffer(BUFFER_SIZE);
+    auto nextBufferTime = base::Clock::now();
 
-SoundSystem::SoundSystem(const loader::ResourceLoader& resources)
-{
-  sdl_mixer::check(Mix_OpenAudio(
-    DESIRED_SAMPLE_RATE,
-    AUDIO_S16LSB,
-    1, // mono
-    BUFFER_SIZE));
+    while (!mStopRequested) {
+      pMixer->mix(buffer.data(), buffer.size());
 
-  int sampleRate = 0;
-  std::uint16_t audioFormat = 0;
-  {
-    int numChannels;
-    Mix_QuerySpec(&sampleRate, &audioFormat, &numChannels);
+      nextBufferTime += bufferDuration;
+      std::this_thread::sleep_until(nextBufferTime);
+    }
   }
 
-  mpMusicPlayer = std::make_unique<ImfPlayer>(sampleRate);
+  std::thread mThread;
+  std::atomic<bool> mStopRequested{false};
+};
+
+
+SoundSystem::SoundSystem(
+  const loader::ResourceLoader& resources,
+  const AudioOutput output
+) {
+  RIGEL_TRACE_SCOPE("SoundSystem::SoundSystem");
 
-  // Our music is in a format which SDL_mixer does not understand (IMF format
-  // aka raw AdLib commands). Therefore, we cannot use any of the high-level
-  // music playback functionality offered by the library. Instead, we register
-  // our own callback handler and then use an AdLib emulator to generate audio
-  // from the music data (ImfPlayer class).
-  //
-  // Once we add the ability to override the original music with custom high
-  // fidelity music files in modern formats, this will have to be extended to
-  // alternate between IMF playback and playing back other formats.
-  //
-  // The ImfPlayer class only knows how to produce audio data in 16-bit integer
-  // format (AUDIO_S16LSB). If the audio device uses that same audio format, we
-  // can directly write the player's output into the output buffer (using
-  // simpleMusicCallback). But if the audio device uses a different format, we
-  // have to convert from the player's format into the device format. That's
-  // handled by the MusicConversionWrapper class.
-  if (audioFormat == AUDIO_S16LSB) {
-    Mix_HookMusic(simpleMusicCallback, mpMusicPlayer.get());
+  if (output == AudioOutput::Device) {
+    mpOutput = std::make_unique<DeviceOutput>();
   } else {
-    mpMusicConversionWrapper = std::make_unique<MusicConversionWrapper>(
-      mpMusicPlayer.get(), audioFormat, sampleRate);
-    Mix_HookMusic(
-      [](void* pUserData, Uint8* pOutBuffer, int bytesRequired) {
-        auto pWrapper = static_cast<MusicConversionWrapper*>(pUserData);
-        pWrapper->render(pOutBuffer, bytesRequired);
-      },
-      mpMusicConversionWrapper.get());
+    mpOutput = std::make_unique<NullOutput>();
   }
 
+  const auto sampleRate = mpOutput->sampleRate();
+
+  // Our music is in a format which isn't supported by any common audio
+  // library (IMF format aka raw AdLib commands). We use an AdLib emulator to
+  // generate audio from the music data (ImfPlayer class), which then becomes
+  // one of the inputs of our mixer.
+  mpMusicPlayer = std::make_unique<ImfPlayer>(sampleRate);
+
   // For sound playback, we want to be able to play as many sound effects in
   // parallel as possible. In the original game, the number of available sound
   // effects is hardcoded into the executable, with sounds being identified by
   // a numerical index (sound ID). This allows us to implement a very simple
-  // scheme: We allocate as many mixer channels as there are sound effects. We
-  // then create one playable audio buffer (aka Mix_Chunk) for each sound
-  // effect, and use its sound ID to determine which mixer channel it should be
-  // played on. This way, all possible sound effects can play simultaneously,
-  // but when the same sound effect is triggered multiple times in a row, it
-  // results in the sound being cut off and played again from the beginning as
-  // in the original game.
-  //
-  // Similarly to the music, the resource loader can only produce audio samples
-  // in AUDIO_S16LSB format. Consequently, we also need to convert if the audio
-  // device is using a different format, but we can directly load our data into
-  // Mix_Chunks if the format matches.
-  Mix_AllocateChannels(data::NUM_SOUND_IDS);
-
+  // scheme: The mixer has one voice for each sound ID. This way, all possible
+  // sound effects can play simultaneously, but when the same sound effect is
+  // triggered multiple times in a row, it results in the sound being cut off
+  // and played again from the beginning as in the original game.
+  AudioMixer::SoundData sounds;
+  auto totalSampleBytes = std::size_t{0};
   data::forEachSoundId([&](const auto id) {
-    auto buffer = prepareBuffer(resources.loadSound(id), sampleRate);
-
-    mSounds[idToIndex(id)] = audioFormat == AUDIO_S16LSB
-      ? LoadedSound{std::move(buffer)}
-      : LoadedSound{convertBuffer(buffer, audioFormat)};
+    auto& samples = sounds[idToIndex(id)];
+    samples = prepareBuffer(resources.loadSound(id), sampleRate).mSamples;
+    totalSampleBytes += samples.size() * sizeof(data::Sample);
   });
+  mSampleMemory.setSize(totalSampleBytes);
+
+  mpMixer = std::make_unique<AudioMixer>(
+    std::move(sounds), mpMusicPlayer.get(), sampleRate);
 
   setMusicVolume(data::MUSIC_VOLUME_DEFAULT);
   setSoundVolume(data::SOUND_VOLUME_DEFAULT);
+
+  mpOutput->start(mpMixer.get());
 }
 
 
 SoundSystem::~SoundSystem() {
-  Mix_HookMusic(nullptr, nullptr);
-
-  // We have to destroy all the MixChunks before we can call Mix_Quit().
-  for (auto& sound : mSounds) {
-    sound.mpMixChunk.reset(nullptr);
-  }
-
-  Mix_Quit();
+  // The output must be stopped first, since it's still calling into the mixer
+  // and music player.
+  mpOutput.reset();
 }
 
 
@@ -320,19 +296,17 @@ void SoundSystem::playSong(data::Song&& song) {
 
 
 void SoundSystem::stopMusic() const {
-  mpMusicPlayer->playSong({});
+  mpMusicPlayer->stop();
 }
 
 
 void SoundSystem::playSound(const data::SoundId id) const {
-  const auto index = idToIndex(id);
-  Mix_PlayChannel(index, mSounds[index].mpMixChunk.get(), 0);
+  mpMixer->playSound(id);
 }
 
 
 void SoundSystem::stopSound(const data::SoundId id) const {
-  const auto index = idToIndex(id);
-  Mix_HaltChannel(index);
+  mpMixer->stopSound(id);
 }
 
 
@@ -341,15 +315,23 @@ void SoundSystem::setMusicVolume(const float volume) {
 }
 
 
+void SoundSystem::setMusicPrerenderingEnabled(const bool enabled) {
+  mpMusicPlayer->setPrerenderingEnabled(enabled);
+}
+
+
 void SoundSystem::setSoundVolume(const float volume) {
-  const auto sdlVolume = static_cast<int>(
-    std::clamp(volume, 0.0f, 1.0f) * MIX_MAX_VOLUME);
+  mpMixer->setSoundVolume(volume);
+}
 
-  for (auto& sound : mSounds) {
-    if (sound.mpMixChunk) {
-      Mix_VolumeChunk(sound.mpMixChunk.get(), sdlVolume);
-    }
-  }
+
+void SoundSystem::update() {
+  mpMusicPlayer->update();
+}
+
+
+float SoundSystem::audioCpuLoad() const {
+  return mpMixer->cpuLoad();
 }
 
 }
@@ -16,12 +16,11 @@
 
 #pragma once
 
+#include "base/memory_tracking.hpp"
 #include "data/audio_buffer.hpp"
 #include "data/song.hpp"
 #include "data/sound_ids.hpp"
-#include "sdl_utils/ptr.hpp"
 
-#include <array>
 #include <memory>
 
 
@@ -30,10 +29,22 @@ namespace rigel::loader { class ResourceLoader; }
 
 namespace rigel::engine {
 
+class AudioMixer;
 class ImfPlayer;
 
 
-using RawBuffer = std::vector<std::uint8_t>;
+/** Where the mixed audio stream goes */
+enum class AudioOutput {
+  /** Regular audio device */
+  Device,
+
+  /** Mix audio at real-time pace on a background thread, but discard it.
+   *
+   * For headless runs, and for measuring the cost of audio processing on
+   * machines without a sound card.
+   */
+  Null
+};
 
 
 /** Provides sound and music playback functionality
@@ -42,10 +53,15 @@ using RawBuffer = std::vector<std::uint8_t>;
  * an audio device and loads all sound effects from the game's data files. From
  * that point on, sound effects and music playback can be triggered at any time
  * using the class' interface. Sound and music volume can also be adjusted.
+ *
+ * Mixing of sound effects and music is done by our own AudioMixer, running
+ * in the audio device's callback.
  */
 class SoundSystem {
 public:
-  explicit SoundSystem(const loader::ResourceLoader& resources);
+  explicit SoundSystem(
+    const loader::ResourceLoader& resources,
+    AudioOutput output = AudioOutput::Device);
   ~SoundSystem();
 
   /** Start playing given music data
@@ -74,21 +90,30 @@ public:
   void setMusicVolume(float volume);
   void setSoundVolume(float volume);
 
-private:
-  struct MusicConversionWrapper;
+  /** Play music from pre-rendered PCM data instead of emulating live
+   *
+   * See ImfPlayer::setPrerenderingEnabled()
+   */
+  void setMusicPrerenderingEnabled(bool enabled);
+
+  /** Main thread housekeeping, to be called once per frame
+   *
+   * See ImfPlayer::update()
+   */
+  void update();
 
-  struct LoadedSound {
-    LoadedSound() = default;
-    explicit LoadedSound(const data::AudioBuffer& buffer);
-    explicit LoadedSound(RawBuffer buffer);
+  /** Fraction of real time spent mixing audio, see AudioMixer::cpuLoad() */
+  float audioCpuLoad() const;
 
-    RawBuffer mData;
-    sdl_utils::Ptr<Mix_Chunk> mpMixChunk;
-  };
+private:
+  class Output;
+  class DeviceOutput;
+  class NullOutput;
 
-  std::array<LoadedSound, data::NUM_SOUND_IDS> mSounds;
+  std::unique_ptr<Output> mpOutput;
   std::unique_ptr<ImfPlayer> mpMusicPlayer;
-  std::unique_ptr<MusicConversionWrapper> mpMusicConversionWrapper;
+  std::unique_ptr<AudioMixer> mpMixer;
+  base::TrackedMemory mSampleMemory{base::MemoryTag::AudioSamples};
 };
 
 }
@@ -17,6 +17,7 @@
 #include "sprite_factory.hpp"
 
 #include "base/container_utils.hpp"
+#include "base/tracing.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/actor_image_package.hpp"
 
@@ -789,6 +790,8 @@ auto SpriteFactory::construct(
   renderer::Renderer* pRenderer,
   const loader::ActorImagePackage* pSpritePackage
 ) -> CtorArgs {
+  RIGEL_TRACE_SCOPE("SpriteFactory::construct");
+
   std::unordered_map<data::ActorID, SpriteData> spriteDataMap;
 
   std::vector<data::Image> spriteImages;
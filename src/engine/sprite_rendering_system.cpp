@@ -16,6 +16,7 @@
 
 #include "sprite_rendering_system.hpp"
 
+#include "base/tracing.hpp"
 #include "data/unit_conversions.hpp"
 #include "engine/sprite_tools.hpp"
 #include "engine/visual_components.hpp"
@@ -23,6 +24,8 @@
 #include "renderer/upscaling_utils.hpp"
 
 #include <algorithm>
+#include <cmath>
+#include <cstdlib>
 #include <functional>
 
 
@@ -40,6 +43,18 @@ using components::WorldPosition;
 
 namespace {
 
+// Sprites which move more than this (in tiles) within a single update are not
+// interpolated. This avoids sprites visibly sliding across the screen when
+// they are teleported or respawned.
+constexpr auto MAX_INTERPOLATION_DISTANCE = 4;
+
+// When interpolating, sprites are drawn up to one update's worth of movement
+// away from their current position, and the camera might also be drawn in
+// between two positions. We therefore keep sprites which are slightly outside
+// of the visible area. Without motion smoothing, this isn't necessary.
+constexpr auto CULLING_MARGIN = MAX_INTERPOLATION_DISTANCE;
+
+
 void advanceAnimation(Sprite& sprite, AnimationLoop& animated) {
   const auto numFrames = static_cast<int>(sprite.mpDrawData->mFrames.size());
   const auto endFrame = animated.mEndFrame ? *animated.mEndFrame : numFrames-1;
@@ -60,10 +75,41 @@ void advanceAnimation(Sprite& sprite, AnimationLoop& animated) {
 }
 
 
+base::Vector determineMotion(
+  const ex::Entity entity,
+  const WorldPosition& position,
+  std::vector<TrackedSpritePosition>& previousPositions
+) {
+  const auto index = entity.id().index();
+  if (index >= previousPositions.size()) {
+    previousPositions.resize(index + 1);
+  }
+
+  auto& previous = previousPositions[index];
+  const auto motion = previous.mId == entity.id()
+    ? position - previous.mPosition
+    : base::Vector{};
+
+  previous.mId = entity.id();
+  previous.mPosition = position;
+
+  if (
+    std::abs(motion.x) > MAX_INTERPOLATION_DISTANCE ||
+    std::abs(motion.y) > MAX_INTERPOLATION_DISTANCE
+  ) {
+    return {};
+  }
+
+  return data::tileVectorToPixelVector(motion);
+}
+
+
 void collectVisibleSprites(
   ex::EntityManager& es,
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize,
+  const bool motionSmoothingOn,
+  std::vector<TrackedSpritePosition>& previousPositions,
   std::vector<SortableDrawSpec>& output
 ) {
   using components::BoundingBox;
@@ -71,11 +117,15 @@ void collectVisibleSprites(
   using components::ExtendedFrameList;
   using components::OverrideDrawOrder;
 
-  const auto screenBox = BoundingBox{{}, viewPortSize};
+  const auto margin = motionSmoothingOn ? CULLING_MARGIN : 0;
+  const auto screenBox = BoundingBox{
+    {-margin, -margin},
+    {viewPortSize.width + 2 * margin, viewPortSize.height + 2 * margin}};
 
   auto submit = [&](
     const SpriteFrame& frame,
     const base::Vector& position,
+    const base::Vector& motion,
     const bool flashingWhite,
     const bool translucent,
     const bool drawTopmost,
@@ -97,7 +147,7 @@ void collectVisibleSprites(
       data::tileVectorToPixelVector(topLeft),
       data::tileExtentsToPixelExtents(frame.mDimensions)};
     const auto drawSpec = SpriteDrawSpec{
-      destRect, frame.mImageId, flashingWhite, translucent};
+      destRect, frame.mImageId, flashingWhite, translucent, motion};
 
     output.push_back({drawSpec, drawOrder, drawTopmost});
   };
@@ -108,6 +158,11 @@ void collectVisibleSprites(
     const Sprite& sprite,
     const WorldPosition& position
   ) {
+    // Positions need to be tracked for hidden sprites as well, otherwise we
+    // would interpolate from an outdated position once they become visible
+    // again.
+    const auto motion = determineMotion(entity, position, previousPositions);
+
     if (!sprite.mShow) {
       return;
     }
@@ -131,6 +186,7 @@ void collectVisibleSprites(
       submit(
         sprite.mpDrawData->mFrames[frameIndex],
         screenPosition,
+        motion,
         sprite.mFlashingWhiteStates.test(slotIndex),
         sprite.mTranslucent,
         drawTopmost,
@@ -147,6 +203,7 @@ void collectVisibleSprites(
         submit(
           sprite.mpDrawData->mFrames[frameIndex],
           screenPosition + item.mOffset,
+          motion,
           false,
           sprite.mTranslucent,
           drawTopmost,
@@ -195,6 +252,8 @@ int virtualToRealFrame(
 
 
 void updateAnimatedSprites(ex::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("updateAnimatedSprites");
+
   es.each<Sprite, AnimationLoop>([](
     ex::Entity entity,
     Sprite& sprite,
@@ -259,19 +318,29 @@ SpriteRenderingSystem::SpriteRenderingSystem(
 void SpriteRenderingSystem::update(
   ex::EntityManager& es,
   const base::Extents& viewPortSize,
-  const base::Vector& cameraPosition
+  const base::Vector& cameraPosition,
+  const bool motionSmoothingOn
 ) {
+  RIGEL_TRACE_SCOPE("SpriteRenderingSystem::update");
+
   using std::back_inserter;
   using std::begin;
   using std::end;
 
   mSortBuffer.clear();
-  collectVisibleSprites(es, cameraPosition, viewPortSize, mSortBuffer);
+  collectVisibleSprites(
+    es,
+    cameraPosition,
+    viewPortSize,
+    motionSmoothingOn,
+    mPreviousPositions,
+    mSortBuffer);
   std::sort(begin(mSortBuffer), end(mSortBuffer));
 
-  mSprites.clear();
-  mSprites.reserve(mSortBuffer.size());
-  std::transform(begin(mSortBuffer), end(mSortBuffer), back_inserter(mSprites),
+  auto& sprites = mDrawList.mSprites;
+  sprites.clear();
+  sprites.reserve(mSortBuffer.size());
+  std::transform(begin(mSortBuffer), end(mSortBuffer), back_inserter(sprites),
     [](const SortableDrawSpec& sortableSpec) {
       return sortableSpec.mSpec;
     });
@@ -281,27 +350,52 @@ void SpriteRenderingSystem::update(
     end(mSortBuffer),
     std::mem_fn(&SortableDrawSpec::mDrawTopMost));
 
-  miForegroundSprites = std::next(
-    begin(mSprites),
+  mDrawList.mFirstForegroundSprite = static_cast<std::size_t>(
     std::distance(begin(mSortBuffer), iFirstTopMostSprite));
 }
 
 
-void SpriteRenderingSystem::renderRegularSprites() const {
-  for (auto it = mSprites.begin(); it != miForegroundSprites; ++it) {
-    renderSprite(*it);
+void SpriteRenderingSystem::forgetPreviousPositions() {
+  mPreviousPositions.clear();
+}
+
+
+void SpriteRenderingSystem::renderRegularSprites(
+  const SpriteDrawList& drawList,
+  const float interpolationFactor
+) const {
+  for (auto i = std::size_t{0}; i < drawList.mFirstForegroundSprite; ++i) {
+    renderSprite(drawList.mSprites[i], interpolationFactor);
   }
 }
 
 
-void SpriteRenderingSystem::renderForegroundSprites() const {
-  for (auto it = miForegroundSprites; it != mSprites.end(); ++it) {
-    renderSprite(*it);
+void SpriteRenderingSystem::renderForegroundSprites(
+  const SpriteDrawList& drawList,
+  const float interpolationFactor
+) const {
+  for (
+    auto i = drawList.mFirstForegroundSprite;
+    i < drawList.mSprites.size();
+    ++i
+  ) {
+    renderSprite(drawList.mSprites[i], interpolationFactor);
   }
 }
 
 
-void SpriteRenderingSystem::renderSprite(const SpriteDrawSpec& spec) const {
+void SpriteRenderingSystem::renderSprite(
+  const SpriteDrawSpec& originalSpec,
+  const float interpolationFactor
+) const {
+  auto spec = originalSpec;
+  if (interpolationFactor < 1.0f) {
+    const auto remainingMotion = 1.0f - interpolationFactor;
+    spec.mDestRect.topLeft -= base::Vector{
+      static_cast<int>(std::round(spec.mMotion.x * remainingMotion)),
+      static_cast<int>(std::round(spec.mMotion.y * remainingMotion))};
+  }
+
   // White flash takes priority over translucency
   if (spec.mIsFlashingWhite) {
     const auto saved = renderer::saveState(mpRenderer);
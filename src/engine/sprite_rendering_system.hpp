@@ -26,6 +26,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <utility>
 #include <vector>
 
@@ -49,6 +50,10 @@ struct SpriteDrawSpec {
   int mImageId;
   bool mIsFlashingWhite;
   bool mIsTranslucent;
+
+  // Distance in pixels which the sprite moved since the previous update. Used
+  // for interpolating between two logic updates when rendering.
+  base::Vector mMotion;
 };
 
 
@@ -68,22 +73,78 @@ struct SortableDrawSpec {
 };
 
 
+/** Sprites collected by SpriteRenderingSystem::update(), in draw order */
+struct SpriteDrawList {
+  std::vector<SpriteDrawSpec> mSprites;
+
+  // Sprites before this index are drawn behind the map's foreground layer,
+  // the remaining ones on top of it.
+  std::size_t mFirstForegroundSprite = 0;
+};
+
+
+struct TrackedSpritePosition {
+  entityx::Entity::Id mId;
+  base::Vector mPosition;
+};
+
+
 class SpriteRenderingSystem {
 public:
   SpriteRenderingSystem(
     renderer::Renderer* pRenderer,
     const renderer::TextureAtlas* pTextureAtlas);
 
+  /** Collect sprites which are visible from the given camera position
+   *
+   * Also determines how far each sprite moved since the previous update().
+   * With motion smoothing on, sprites slightly outside of the view port are
+   * kept as well, since they might be drawn inside of it when interpolating.
+   */
   void update(
     entityx::EntityManager& es,
     const base::Extents& viewPortSize,
-    const base::Vector& cameraPosition);
+    const base::Vector& cameraPosition,
+    bool motionSmoothingOn);
+
+  /** Discard positions remembered from the previous update()
+   *
+   * Should be called when the world state was replaced (e.g. by loading a
+   * quick save), so that sprites are not interpolated between unrelated
+   * positions.
+   */
+  void forgetPreviousPositions();
+
+  /** Sprites collected by the last update()
+   *
+   * A copy of the list can be drawn without access to the entities it was
+   * collected from.
+   */
+  const SpriteDrawList& drawList() const {
+    return mDrawList;
+  }
 
-  void renderRegularSprites() const;
-  void renderForegroundSprites() const;
+  /** Draw sprites from a list produced by update()
+   *
+   * The interpolation factor determines where sprites are drawn in between
+   * their position at the previous update() (0.0) and the most recent one
+   * (1.0). Sprites which moved too far in one update, e.g. due to being
+   * teleported, are always drawn at their most recent position.
+   *
+   * Only reads the given list, so this can run concurrently to update() when
+   * drawing a copy of the list.
+   */
+  void renderRegularSprites(
+    const SpriteDrawList& drawList,
+    float interpolationFactor = 1.0f) const;
+  void renderForegroundSprites(
+    const SpriteDrawList& drawList,
+    float interpolationFactor = 1.0f) const;
 
 private:
-  void renderSprite(const SpriteDrawSpec& spec) const;
+  void renderSprite(
+    const SpriteDrawSpec& spec,
+    float interpolationFactor) const;
 
   // Temporary storage used for sorting sprites by draw order during sprite
   // collection. Scope-wise, this is only needed during update(), but in order
@@ -93,8 +154,11 @@ private:
 
   // Data needed to draw sprites that are currently visible. This is updated
   // by each call to update().
-  std::vector<SpriteDrawSpec> mSprites;
-  std::vector<SpriteDrawSpec>::iterator miForegroundSprites;
+  SpriteDrawList mDrawList;
+
+  // World position of each sprite entity at the time of the previous
+  // update(), indexed by entity index.
+  std::vector<TrackedSpritePosition> mPreviousPositions;
 
   // Dependencies needed for drawing
   renderer::Renderer* mpRenderer;
@@ -0,0 +1,123 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "deferring_service_provider.hpp"
+
+#include "base/match.hpp"
+
+
+namespace rigel {
+
+DeferringServiceProvider::DeferringServiceProvider(
+  IGameServiceProvider* pProvider
+)
+  : mpProvider(pProvider)
+{
+}
+
+
+void DeferringServiceProvider::setDeferralEnabled(const bool enabled) {
+  mDeferralEnabled = enabled;
+}
+
+
+void DeferringServiceProvider::flush() {
+  for (const auto& call : mDeferredCalls) {
+    base::match(call,
+      [this](const PlaySound& play) { mpProvider->playSound(play.mId); },
+      [this](const StopSound& stop) { mpProvider->stopSound(stop.mId); },
+      [this](const PlayMusic& play) { mpProvider->playMusic(play.mName); },
+      [this](const StopMusic&) { mpProvider->stopMusic(); });
+  }
+
+  mDeferredCalls.clear();
+}
+
+
+void DeferringServiceProvider::fadeOutScreen() {
+  mpProvider->fadeOutScreen();
+}
+
+
+void DeferringServiceProvider::fadeInScreen() {
+  mpProvider->fadeInScreen();
+}
+
+
+void DeferringServiceProvider::playSound(const data::SoundId id) {
+  if (mDeferralEnabled) {
+    mDeferredCalls.push_back(PlaySound{id});
+  } else {
+    mpProvider->playSound(id);
+  }
+}
+
+
+void DeferringServiceProvider::stopSound(const data::SoundId id) {
+  if (mDeferralEnabled) {
+    mDeferredCalls.push_back(StopSound{id});
+  } else {
+    mpProvider->stopSound(id);
+  }
+}
+
+
+void DeferringServiceProvider::playMusic(const std::string& name) {
+  if (mDeferralEnabled) {
+    mDeferredCalls.push_back(PlayMusic{name});
+  } else {
+    mpProvider->playMusic(name);
+  }
+}
+
+
+void DeferringServiceProvider::stopMusic() {
+  if (mDeferralEnabled) {
+    mDeferredCalls.push_back(StopMusic{});
+  } else {
+    mpProvider->stopMusic();
+  }
+}
+
+
+void DeferringServiceProvider::scheduleGameQuit() {
+  mpProvider->scheduleGameQuit();
+}
+
+
+void DeferringServiceProvider::switchGamePath(
+  const std::filesystem::path& newGamePath
+) {
+  mpProvider->switchGamePath(newGamePath);
+}
+
+
+void DeferringServiceProvider::markCurrentFrameAsWidescreen() {
+  mpProvider->markCurrentFrameAsWidescreen();
+}
+
+
+bool DeferringServiceProvider::isSharewareVersion() const {
+  return mpProvider->isSharewareVersion();
+}
+
+
+const CommandLineOptions& DeferringServiceProvider::commandLineOptions() const
+{
+  return mpProvider->commandLineOptions();
+}
+
+}
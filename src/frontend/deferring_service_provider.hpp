@@ -0,0 +1,78 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/game_service_provider.hpp"
+#include "data/sound_ids.hpp"
+
+#include <string>
+#include <variant>
+#include <vector>
+
+
+namespace rigel {
+
+/** Forwards to another service provider, optionally deferring audio calls
+ *
+ * When the game logic runs on a separate thread (see SimulationThread), it
+ * must not call into the audio system directly. While deferral is enabled,
+ * sound and music requests are recorded instead, and later forwarded in the
+ * original order by calling flush() on the main thread. All other calls are
+ * forwarded immediately.
+ */
+class DeferringServiceProvider : public IGameServiceProvider {
+public:
+  explicit DeferringServiceProvider(IGameServiceProvider* pProvider);
+
+  void setDeferralEnabled(bool enabled);
+  void flush();
+
+  void fadeOutScreen() override;
+  void fadeInScreen() override;
+  void playSound(data::SoundId id) override;
+  void stopSound(data::SoundId id) override;
+  void playMusic(const std::string& name) override;
+  void stopMusic() override;
+  void scheduleGameQuit() override;
+  void switchGamePath(const std::filesystem::path& newGamePath) override;
+  void markCurrentFrameAsWidescreen() override;
+  bool isSharewareVersion() const override;
+  const CommandLineOptions& commandLineOptions() const override;
+
+private:
+  struct PlaySound {
+    data::SoundId mId;
+  };
+
+  struct StopSound {
+    data::SoundId mId;
+  };
+
+  struct PlayMusic {
+    std::string mName;
+  };
+
+  struct StopMusic {};
+
+  using DeferredCall = std::variant<PlaySound, StopSound, PlayMusic, StopMusic>;
+
+  IGameServiceProvider* mpProvider;
+  std::vector<DeferredCall> mDeferredCalls;
+  bool mDeferralEnabled = false;
+};
+
+}
@@ -18,6 +18,8 @@
 
 #include "base/defer.hpp"
 #include "base/math_tools.hpp"
+#include "base/memory_tracking.hpp"
+#include "base/tracing.hpp"
 #include "data/duke_script.hpp"
 #include "data/game_traits.hpp"
 #include "engine/timing.hpp"
@@ -25,6 +27,7 @@
 #include "loader/duke_script_loader.hpp"
 #include "renderer/upscaling_utils.hpp"
 #include "ui/imgui_integration.hpp"
+#include "ui/memory_usage_panel.hpp"
 
 #include "anti_piracy_screen_mode.hpp"
 #include "game_session_mode.hpp"
@@ -42,6 +45,11 @@ using namespace engine;
 
 namespace {
 
+// Enough for all temporary containers of a typical frame. The arena grows
+// automatically if this turns out to be insufficient.
+constexpr auto INITIAL_FRAME_ARENA_SIZE = std::size_t{64 * 1024};
+
+
 /** Returns game path to be used for loading resources
  *
  * A game path specified on the command line takes priority over the path
@@ -87,6 +95,8 @@ auto wrapWithInitialFadeIn(std::unique_ptr<GameMode> mode) {
 
 
 auto loadScripts(const loader::ResourceLoader& resources) {
+  RIGEL_TRACE_SCOPE("loadScripts");
+
   auto allScripts = resources.loadScriptBundle("TEXT.MNI");
   const auto optionsScripts = resources.loadScriptBundle("OPTIONS.MNI");
   const auto orderInfoScripts = resources.loadScriptBundle("ORDERTXT.MNI");
@@ -191,7 +201,11 @@ std::optional<renderer::FpsLimiter> createLimiter(
   const data::GameOptions& options
 ) {
   if (options.mEnableFpsLimit && !options.mEnableVsync) {
-    return renderer::FpsLimiter{options.mMaxFps};
+    return renderer::FpsLimiter{
+      options.mMaxFps,
+      options.mPreciseFpsLimit
+        ? renderer::FpsLimiter::Mode::Precise
+        : renderer::FpsLimiter::Mode::Sleep};
   } else {
     return std::nullopt;
   }
@@ -209,10 +223,14 @@ Game::Game(
   : mpWindow(pWindow)
   , mRenderer(pWindow)
   , mResources(effectiveGamePath(commandLineOptions, *pUserProfile))
-  , mpSoundSystem([this]() {
+  , mpSoundSystem([this, &commandLineOptions]() {
       std::unique_ptr<engine::SoundSystem> pResult;
       try {
-        pResult = std::make_unique<engine::SoundSystem>(mResources);
+        pResult = std::make_unique<engine::SoundSystem>(
+          mResources,
+          commandLineOptions.mNullAudioOutput
+            ? engine::AudioOutput::Null
+            : engine::AudioOutput::Device);
       } catch (const std::exception& ex) {
         std::cerr << "WARNING: Failed to initialize audio: " << ex.what() << '\n';
       }
@@ -245,6 +263,7 @@ Game::Game(
       &mRenderer)
   , mSpriteFactory(&mRenderer, &mResources.mActorImagePackage)
   , mTextRenderer(&mUiSpriteSheet, &mRenderer, mResources)
+  , mFrameArena(INITIAL_FRAME_ARENA_SIZE)
 {
   applyChangedOptions();
 
@@ -261,7 +280,10 @@ auto Game::runOneFrame() -> std::optional<StopReason> {
   using namespace std::chrono;
   using base::defer;
 
+  RIGEL_TRACE_SCOPE("Frame");
+
   const auto startOfFrame = base::Clock::now();
+  const auto heapAllocationsAtStartOfFrame = base::heapAllocationCount();
   const auto elapsed =
     duration<entityx::TimeDelta>(startOfFrame - mLastTime).count();
   mLastTime = startOfFrame;
@@ -283,8 +305,16 @@ auto Game::runOneFrame() -> std::optional<StopReason> {
 
   swapBuffers();
 
+  mFrameArena.reset();
+  mHeapAllocationsInLastFrame =
+    base::heapAllocationCount() - heapAllocationsAtStartOfFrame;
+
   applyChangedOptions();
 
+  if (mpSoundSystem) {
+    mpSoundSystem->update();
+  }
+
   if (!mGamePathToSwitchTo.empty()) {
     mpUserProfile->mGamePath = mGamePathToSwitchTo;
     mpUserProfile->saveToDisk();
@@ -312,6 +342,8 @@ void Game::pumpEvents() {
 
 
 void Game::updateAndRender(const entityx::TimeDelta elapsed) {
+  RIGEL_TRACE_SCOPE("Game::updateAndRender");
+
   mCurrentFrameIsWidescreen = false;
 
   {
@@ -346,9 +378,23 @@ void Game::updateAndRender(const entityx::TimeDelta elapsed) {
     }
 
     if (mpUserProfile->mOptions.mShowFpsCounter) {
-      mFpsDisplay.updateAndRender(elapsed);
+      mFpsDisplay.updateAndRender(
+        elapsed,
+        mpSoundSystem
+          ? std::optional<float>{mpSoundSystem->audioCpuLoad()}
+          : std::nullopt,
+        mFpsLimiter
+          ? std::optional{mFpsLimiter->statistics()}
+          : std::nullopt,
+        base::HEAP_ALLOCATION_TRACKING_ENABLED
+          ? std::optional{mHeapAllocationsInLastFrame}
+          : std::nullopt);
     }
   }
+
+  if (mShowMemoryUsage) {
+    ui::drawMemoryUsagePanel(&mShowMemoryUsage);
+  }
 }
 
 
@@ -362,7 +408,8 @@ GameMode::Context Game::makeModeContext() {
     &mTextRenderer,
     &mUiSpriteSheet,
     &mSpriteFactory,
-    mpUserProfile};
+    mpUserProfile,
+    &mFrameArena};
 }
 
 
@@ -377,6 +424,12 @@ bool Game::handleEvent(const SDL_Event& event) {
       if (event.key.keysym.sym == SDLK_F6) {
         options.mShowFpsCounter = !options.mShowFpsCounter;
       }
+      if (
+        event.key.keysym.sym == SDLK_F12 &&
+        mCommandLineOptions.mDebugModeEnabled
+      ) {
+        mShowMemoryUsage = !mShowMemoryUsage;
+      }
       return false;
 
     case SDL_QUIT:
@@ -472,6 +525,8 @@ void Game::performScreenFadeBlocking(const FadeType type) {
 
 
 void Game::swapBuffers() {
+  RIGEL_TRACE_SCOPE("Game::swapBuffers");
+
   mRenderer.swapBuffers();
 
   if (mFpsLimiter) {
@@ -506,7 +561,8 @@ void Game::applyChangedOptions() {
   if (
     currentOptions.mEnableVsync != mPreviousOptions.mEnableVsync ||
     currentOptions.mEnableFpsLimit != mPreviousOptions.mEnableFpsLimit ||
-    currentOptions.mMaxFps != mPreviousOptions.mMaxFps
+    currentOptions.mMaxFps != mPreviousOptions.mMaxFps ||
+    currentOptions.mPreciseFpsLimit != mPreviousOptions.mPreciseFpsLimit
   ) {
     mFpsLimiter = createLimiter(currentOptions);
   }
@@ -531,6 +587,11 @@ void Game::applyChangedOptions() {
         : 0.0f;
       mpSoundSystem->setSoundVolume(newVolume);
     }
+
+    if (currentOptions.mPrerenderMusic != mPreviousOptions.mPrerenderMusic) {
+      mpSoundSystem->setMusicPrerenderingEnabled(
+        currentOptions.mPrerenderMusic);
+    }
   }
 
   if (currentOptions.mWidescreenModeOn != mPreviousOptions.mWidescreenModeOn) {
@@ -17,6 +17,7 @@
 #pragma once
 
 #include "base/clock.hpp"
+#include "base/frame_arena.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "common/game_mode.hpp"
@@ -37,6 +38,7 @@
 
 #include <SDL_gamecontroller.h>
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <string>
@@ -127,6 +129,7 @@ private:
   renderer::RenderTargetTexture mRenderTarget;
   std::uint8_t mAlphaMod = 0;
   bool mCurrentFrameIsWidescreen = false;
+  bool mShowMemoryUsage = false;
 
   std::unique_ptr<GameMode> mpCurrentGameMode;
 
@@ -145,6 +148,8 @@ private:
   engine::SpriteFactory mSpriteFactory;
   ui::MenuElementRenderer mTextRenderer;
   ui::FpsDisplay mFpsDisplay;
+  base::FrameArena mFrameArena;
+  std::uint64_t mHeapAllocationsInLastFrame = 0;
   std::vector<SDL_Event> mEventQueue;
   std::vector<sdl_utils::Ptr<SDL_GameController>> mGameControllers;
 };
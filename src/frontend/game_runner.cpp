@@ -22,11 +22,29 @@
 #include "game_logic/world_state.hpp"
 #include "ui/utils.hpp"
 
+#include <algorithm>
+#include <iomanip>
 #include <sstream>
 
 
 namespace rigel {
 
+namespace {
+
+constexpr auto DEFAULT_FAST_FORWARD_MULTIPLIER = 4;
+
+
+GameMode::Context withServiceProvider(
+  GameMode::Context context,
+  IGameServiceProvider* pServiceProvider
+) {
+  context.mpServiceProvider = pServiceProvider;
+  return context;
+}
+
+}
+
+
 GameRunner::GameRunner(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId& sessionId,
@@ -35,15 +53,34 @@ GameRunner::GameRunner(
   const bool showWelcomeMessage
 )
   : mContext(context)
+  , mThrottlingServiceProvider(context.mpServiceProvider)
+  , mDeferringServiceProvider(&mThrottlingServiceProvider)
   , mWorld(
       pPlayerModel,
       sessionId,
-      context,
+      withServiceProvider(context, &mDeferringServiceProvider),
       playerPositionOverride,
       showWelcomeMessage)
   , mInputHandler(&context.mpUserProfile->mOptions)
   , mMenu(context, pPlayerModel, &mWorld, sessionId)
+  , mFastForwardMultiplier(
+      context.mpServiceProvider->commandLineOptions().mFastForwardMultiplier
+        .value_or(DEFAULT_FAST_FORWARD_MULTIPLIER))
+  , mFastForwardEnabled(
+      context.mpServiceProvider->commandLineOptions().mFastForwardMultiplier
+        .has_value())
 {
+  mThrottlingServiceProvider.setThrottlingEnabled(mFastForwardEnabled);
+
+  const auto& commandLineOptions =
+    context.mpServiceProvider->commandLineOptions();
+  if (commandLineOptions.mThreadedSimulation) {
+    mpSimulationThread = std::make_unique<SimulationThread>();
+  }
+
+  mWorld.setBehaviorUpdatesGroupedByType(
+    commandLineOptions.mGroupedBehaviorUpdates);
+  mWorld.setGameEventsDeferred(commandLineOptions.mDeferredGameEvents);
 }
 
 
@@ -95,38 +132,155 @@ void GameRunner::updateAndRender(engine::TimeDelta dt) {
     return;
   }
 
+  // With a simulation thread, the logic updates run concurrently to rendering
+  // the previous updates' results. Otherwise, they are already done once
+  // updateWorld() returns.
   updateWorld(dt);
-  mWorld.render();
+  mWorld.render(
+    mpSimulationThread ? mPresentedInterpolationFactor : interpolationFactor());
+  finishLogicSteps();
+
   renderDebugText();
   mWorld.processEndOfFrameActions();
 }
 
 
 void GameRunner::updateWorld(const engine::TimeDelta dt) {
-  auto update = [this]() {
-    mWorld.updateGameLogic(mInputHandler.fetchInput());
+  // Input is always fetched here on the main thread, even if the updates
+  // themselves run on the simulation thread.
+  auto update = [this](const bool prepareRendering) {
+    mPendingLogicSteps.push_back(
+      LogicStep{mInputHandler.fetchInput(), prepareRendering});
   };
 
+  mThrottlingServiceProvider.beginFrame();
 
   if (mSingleStepping) {
     if (mDoNextSingleStep) {
-      update();
+      update(true);
       mDoNextSingleStep = false;
     }
+
+    updateLogicRateMeasurement(dt, 0);
   } else {
-    mAccumulatedTime += dt;
+    const auto speed = mFastForwardEnabled ? mFastForwardMultiplier : 1;
+    mAccumulatedTime += dt * speed;
+
+    // If the machine can't keep up with the requested speed, run at most
+    // one displayed frame's worth of updates instead of falling further and
+    // further behind.
+    if (mFastForwardEnabled) {
+      mAccumulatedTime = std::min(
+        mAccumulatedTime, speed * game_logic::GAME_LOGIC_UPDATE_DELAY);
+    }
+
+    auto numSteps = 0;
     for (;
       mAccumulatedTime >= game_logic::GAME_LOGIC_UPDATE_DELAY;
       mAccumulatedTime -= game_logic::GAME_LOGIC_UPDATE_DELAY
     ) {
-      update();
+      ++numSteps;
     }
 
-    mWorld.mpState->mMapRenderer.updateBackdropAutoScrolling(dt);
+    // Only the last update's result will be presented, so there's no need to
+    // prepare rendering for the ones before. Motion smoothing needs sprite
+    // positions from the update right before the last one, though.
+    const auto smoothing = motionSmoothingActive();
+    for (auto i = 0; i < numSteps; ++i) {
+      update(i == numSteps - 1 || smoothing);
+    }
+
+    updateLogicRateMeasurement(dt, numSteps);
+
+    mWorld.updateBackdropAutoScrolling(dt * speed);
+  }
+
+  startLogicSteps();
+}
+
+
+void GameRunner::startLogicSteps() {
+  auto runSteps = [this]() {
+    for (const auto& step : mPendingLogicSteps) {
+      mWorld.updateGameLogic(step.mInput, step.mPrepareRendering);
+    }
+  };
+
+  if (mpSimulationThread) {
+    if (!mPendingLogicSteps.empty()) {
+      mDeferringServiceProvider.setDeferralEnabled(true);
+      mpSimulationThread->start(runSteps);
+    }
+  } else {
+    runSteps();
+    mPendingLogicSteps.clear();
   }
 }
 
 
+void GameRunner::finishLogicSteps() {
+  if (!mpSimulationThread) {
+    return;
+  }
+
+  if (!mPendingLogicSteps.empty()) {
+    mpSimulationThread->wait();
+    mPendingLogicSteps.clear();
+
+    mDeferringServiceProvider.setDeferralEnabled(false);
+    mDeferringServiceProvider.flush();
+
+    mWorld.publishRenderSnapshot();
+  }
+
+  // The snapshot is presented during the next frame, so the interpolation
+  // factor needs to match the time at which it was published.
+  mPresentedInterpolationFactor = interpolationFactor();
+}
+
+
+void GameRunner::updateLogicRateMeasurement(
+  const engine::TimeDelta dt,
+  const int stepsTaken
+) {
+  mLogicRateMeasurementTime += dt;
+  mLogicStepsInMeasurement += stepsTaken;
+
+  if (mLogicRateMeasurementTime >= 1.0) {
+    mLogicStepsPerSecond =
+      mLogicStepsInMeasurement / mLogicRateMeasurementTime;
+    mLogicRateMeasurementTime = 0.0;
+    mLogicStepsInMeasurement = 0;
+  }
+}
+
+
+void GameRunner::toggleFastForward() {
+  mFastForwardEnabled = !mFastForwardEnabled;
+  mThrottlingServiceProvider.setThrottlingEnabled(mFastForwardEnabled);
+}
+
+
+bool GameRunner::motionSmoothingActive() const {
+  // Interpolation only makes sense when logic updates happen at the regular
+  // rate, it would be distracting in fast-forward or single step mode.
+  return
+    mContext.mpUserProfile->mOptions.mMotionSmoothingOn &&
+    !mFastForwardEnabled &&
+    !mSingleStepping;
+}
+
+
+float GameRunner::interpolationFactor() const {
+  if (!motionSmoothingActive()) {
+    return 1.0f;
+  }
+
+  const auto factor = mAccumulatedTime / game_logic::GAME_LOGIC_UPDATE_DELAY;
+  return static_cast<float>(std::clamp(factor, 0.0, 1.0));
+}
+
+
 bool GameRunner::updateMenu(const engine::TimeDelta dt) {
   if (mMenu.isActive()) {
     mInputHandler.reset();
@@ -169,10 +323,18 @@ void GameRunner::handleDebugKeys(const SDL_Event& event) {
       mShowDebugText = !mShowDebugText;
       break;
 
+    case SDLK_f:
+      toggleFastForward();
+      break;
+
     case SDLK_g:
       debuggingSystem.toggleGridDisplay();
       break;
 
+    case SDLK_r:
+      mWorld.rewind();
+      break;
+
     case SDLK_s:
       mSingleStepping = !mSingleStepping;
       break;
@@ -204,6 +366,16 @@ void GameRunner::renderDebugText() {
     debugText << "GOD MODE on\n";
   }
 
+  if (mFastForwardEnabled) {
+    debugText << "FAST FORWARD x" << mFastForwardMultiplier << '\n';
+  }
+
+  if (mFastForwardEnabled || mShowDebugText) {
+    debugText
+      << "Logic steps/s: " << std::fixed << std::setprecision(1)
+      << mLogicStepsPerSecond << '\n';
+  }
+
   if (mShowDebugText) {
     mWorld.printDebugText(debugText);
   }
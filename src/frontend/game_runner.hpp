@@ -21,7 +21,10 @@
 #include "common/game_mode.hpp"
 #include "data/bonus.hpp"
 #include "data/saved_game.hpp"
+#include "frontend/deferring_service_provider.hpp"
 #include "frontend/input_handler.hpp"
+#include "frontend/simulation_thread.hpp"
+#include "frontend/sound_throttling_service_provider.hpp"
 #include "game_logic/game_world.hpp"
 #include "game_logic/input.hpp"
 #include "ui/ingame_menu.hpp"
@@ -30,6 +33,9 @@ RIGEL_DISABLE_WARNINGS
 #include <SDL.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <memory>
+#include <vector>
+
 
 namespace rigel {
 
@@ -52,21 +58,51 @@ public:
   std::set<data::Bonus> achievedBonuses() const;
 
 private:
+  struct LogicStep {
+    game_logic::PlayerInput mInput;
+    bool mPrepareRendering;
+  };
+
   void updateWorld(engine::TimeDelta dt);
+  void startLogicSteps();
+  void finishLogicSteps();
   bool updateMenu(engine::TimeDelta dt);
   void handleDebugKeys(const SDL_Event& event);
   void renderDebugText();
 
+  void toggleFastForward();
+  bool motionSmoothingActive() const;
+  float interpolationFactor() const;
+  void updateLogicRateMeasurement(engine::TimeDelta dt, int stepsTaken);
+
   GameMode::Context mContext;
+  SoundThrottlingServiceProvider mThrottlingServiceProvider;
+  DeferringServiceProvider mDeferringServiceProvider;
+
+  std::vector<LogicStep> mPendingLogicSteps;
+  float mPresentedInterpolationFactor = 1.0f;
 
   game_logic::GameWorld mWorld;
   InputHandler mInputHandler;
   engine::TimeDelta mAccumulatedTime = 0.0;
   ui::IngameMenu mMenu;
+
+  int mFastForwardMultiplier;
+  bool mFastForwardEnabled;
+
+  engine::TimeDelta mLogicRateMeasurementTime = 0.0;
+  int mLogicStepsInMeasurement = 0;
+  double mLogicStepsPerSecond = 0.0;
+
   bool mShowDebugText = false;
   bool mSingleStepping = false;
   bool mDoNextSingleStep = false;
   bool mLevelFinishedByDebugKey = false;
+
+  // Only present when running game logic on a separate thread, see
+  // CommandLineOptions::mThreadedSimulation. Declared last so that it's
+  // destroyed (and thus done with its current job) before anything it uses.
+  std::unique_ptr<SimulationThread> mpSimulationThread;
 };
 
 
@@ -45,6 +45,8 @@ GameSessionMode::GameSessionMode(
   , mDifficulty(sessionId.mDifficulty)
   , mContext(context)
 {
+  // A quick save from a previous game must not leak into a new one
+  context.mpUserProfile->deleteQuickSave();
 }
 
 
@@ -128,6 +130,9 @@ std::unique_ptr<GameMode> GameSessionMode::updateAndRender(
       }
 
       if (pIngameMode->levelFinished()) {
+        // Quick saves are only valid within a level
+        mContext.mpUserProfile->deleteQuickSave();
+
         const auto achievedBonuses = pIngameMode->achievedBonuses();
         const auto scoreWithoutBonuses = mPlayerModel.score();
 
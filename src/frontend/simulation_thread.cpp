@@ -0,0 +1,104 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "simulation_thread.hpp"
+
+#include "base/tracing.hpp"
+
+#include <cassert>
+#include <utility>
+
+
+namespace rigel {
+
+SimulationThread::SimulationThread()
+  : mThread([this]() { run(); })
+{
+}
+
+
+SimulationThread::~SimulationThread() {
+  {
+    // Let a job that's still in flight finish. Errors are ignored here,
+    // since we can't throw from a destructor.
+    std::unique_lock lock{mMutex};
+    mJobChanged.wait(lock, [this]() { return !mJobInFlight; });
+    mStopRequested = true;
+  }
+
+  mJobChanged.notify_all();
+  mThread.join();
+}
+
+
+void SimulationThread::start(std::function<void()> job) {
+  {
+    std::lock_guard lock{mMutex};
+    assert(!mJobInFlight);
+
+    mJob = std::move(job);
+    mJobInFlight = true;
+  }
+
+  mJobChanged.notify_all();
+}
+
+
+void SimulationThread::wait() {
+  RIGEL_TRACE_SCOPE("SimulationThread::wait");
+
+  std::unique_lock lock{mMutex};
+  mJobChanged.wait(lock, [this]() { return !mJobInFlight; });
+
+  if (mpError) {
+    std::rethrow_exception(std::exchange(mpError, nullptr));
+  }
+}
+
+
+void SimulationThread::run() {
+  if (base::tracing::isEnabled()) {
+    base::tracing::setCurrentThreadName("Simulation");
+  }
+
+  std::unique_lock lock{mMutex};
+
+  while (true) {
+    mJobChanged.wait(
+      lock, [this]() { return mJobInFlight || mStopRequested; });
+
+    if (mStopRequested) {
+      return;
+    }
+
+    auto job = std::move(mJob);
+    lock.unlock();
+
+    std::exception_ptr pError;
+    try {
+      job();
+    } catch (...) {
+      pError = std::current_exception();
+    }
+
+    lock.lock();
+    mpError = pError;
+    mJobInFlight = false;
+    mJobChanged.notify_all();
+  }
+}
+
+}
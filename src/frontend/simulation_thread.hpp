@@ -0,0 +1,68 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+
+namespace rigel {
+
+/** Dedicated thread for running game logic updates
+ *
+ * GameRunner hands a batch of logic updates to this thread at the start of a
+ * frame, renders the results of the previous batch in the meantime, and then
+ * waits for the batch to complete. Only one job can be in flight at a time.
+ */
+class SimulationThread {
+public:
+  SimulationThread();
+  ~SimulationThread();
+
+  SimulationThread(const SimulationThread&) = delete;
+  SimulationThread& operator=(const SimulationThread&) = delete;
+
+  /** Start running the given job on the simulation thread
+   *
+   * Must not be called while a previous job is still in flight, i.e. each
+   * call needs to be followed by a call to wait().
+   */
+  void start(std::function<void()> job);
+
+  /** Block until the current job has finished
+   *
+   * If the job threw an exception, it is rethrown here. Does nothing if
+   * there is no job in flight.
+   */
+  void wait();
+
+private:
+  void run();
+
+  std::mutex mMutex;
+  std::condition_variable mJobChanged;
+  std::function<void()> mJob;
+  std::exception_ptr mpError;
+  bool mJobInFlight = false;
+  bool mStopRequested = false;
+  std::thread mThread;
+};
+
+}
@@ -0,0 +1,104 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "sound_throttling_service_provider.hpp"
+
+
+namespace rigel {
+
+SoundThrottlingServiceProvider::SoundThrottlingServiceProvider(
+  IGameServiceProvider* pProvider
+)
+  : mpProvider(pProvider)
+{
+}
+
+
+void SoundThrottlingServiceProvider::setThrottlingEnabled(const bool enabled) {
+  mThrottlingEnabled = enabled;
+}
+
+
+void SoundThrottlingServiceProvider::beginFrame() {
+  mSoundsPlayedThisFrame.reset();
+}
+
+
+void SoundThrottlingServiceProvider::fadeOutScreen() {
+  mpProvider->fadeOutScreen();
+}
+
+
+void SoundThrottlingServiceProvider::fadeInScreen() {
+  mpProvider->fadeInScreen();
+}
+
+
+void SoundThrottlingServiceProvider::playSound(const data::SoundId id) {
+  const auto index = static_cast<std::size_t>(id);
+  if (mThrottlingEnabled && mSoundsPlayedThisFrame.test(index)) {
+    return;
+  }
+
+  mSoundsPlayedThisFrame.set(index);
+  mpProvider->playSound(id);
+}
+
+
+void SoundThrottlingServiceProvider::stopSound(const data::SoundId id) {
+  mpProvider->stopSound(id);
+}
+
+
+void SoundThrottlingServiceProvider::playMusic(const std::string& name) {
+  mpProvider->playMusic(name);
+}
+
+
+void SoundThrottlingServiceProvider::stopMusic() {
+  mpProvider->stopMusic();
+}
+
+
+void SoundThrottlingServiceProvider::scheduleGameQuit() {
+  mpProvider->scheduleGameQuit();
+}
+
+
+void SoundThrottlingServiceProvider::switchGamePath(
+  const std::filesystem::path& newGamePath
+) {
+  mpProvider->switchGamePath(newGamePath);
+}
+
+
+void SoundThrottlingServiceProvider::markCurrentFrameAsWidescreen() {
+  mpProvider->markCurrentFrameAsWidescreen();
+}
+
+
+bool SoundThrottlingServiceProvider::isSharewareVersion() const {
+  return mpProvider->isSharewareVersion();
+}
+
+
+const CommandLineOptions&
+  SoundThrottlingServiceProvider::commandLineOptions() const
+{
+  return mpProvider->commandLineOptions();
+}
+
+}
@@ -0,0 +1,59 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "common/game_service_provider.hpp"
+#include "data/sound_ids.hpp"
+
+#include <bitset>
+
+
+namespace rigel {
+
+/** Forwards to another service provider, optionally limiting sound playback
+ *
+ * When fast-forwarding, several logic updates run per displayed frame. Playing
+ * all sounds triggered by these updates would result in a lot of noise, so
+ * while throttling is enabled, each sound is played at most once between two
+ * calls to beginFrame().
+ */
+class SoundThrottlingServiceProvider : public IGameServiceProvider {
+public:
+  explicit SoundThrottlingServiceProvider(IGameServiceProvider* pProvider);
+
+  void setThrottlingEnabled(bool enabled);
+  void beginFrame();
+
+  void fadeOutScreen() override;
+  void fadeInScreen() override;
+  void playSound(data::SoundId id) override;
+  void stopSound(data::SoundId id) override;
+  void playMusic(const std::string& name) override;
+  void stopMusic() override;
+  void scheduleGameQuit() override;
+  void switchGamePath(const std::filesystem::path& newGamePath) override;
+  void markCurrentFrameAsWidescreen() override;
+  bool isSharewareVersion() const override;
+  const CommandLineOptions& commandLineOptions() const override;
+
+private:
+  IGameServiceProvider* mpProvider;
+  std::bitset<data::NUM_SOUND_IDS> mSoundsPlayedThisFrame;
+  bool mThrottlingEnabled = false;
+};
+
+}
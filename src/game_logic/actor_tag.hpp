@@ -22,6 +22,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <limits>
 
 
@@ -49,6 +50,9 @@ struct ActorTag {
     FireBomb,
   };
 
+  // Must be kept in sync with the last entry of Type
+  static constexpr auto NUM_TYPES = static_cast<std::size_t>(Type::FireBomb) + 1;
+
   explicit ActorTag(const Type type, const int spawnIndex = INVALID_SPAWN_INDEX)
     : mType(type)
     , mSpawnIndex(spawnIndex)
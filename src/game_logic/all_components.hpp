@@ -0,0 +1,80 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "engine/base_components.hpp"
+#include "engine/life_time_components.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/visual_components.hpp"
+#include "game_logic/actor_tag.hpp"
+#include "game_logic/behavior_controller.hpp"
+#include "game_logic/collectable_components.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/dynamic_geometry_components.hpp"
+#include "game_logic/effect_components.hpp"
+#include "game_logic/interactive/enemy_radar.hpp"
+#include "game_logic/interactive/item_container.hpp"
+#include "game_logic/player/components.hpp"
+#include "game_logic/spawn_origin.hpp"
+
+
+namespace rigel::game_logic {
+
+template <typename... Components>
+struct TypeList {};
+
+
+// All component types used by the game. Must be kept up to date when adding
+// new components - WorldState::synchronizeTo() asserts that nothing was
+// missed.
+using AllComponents = TypeList<
+  components::AppearsOnRadar,
+  engine::components::ActivationSettings,
+  engine::components::Active,
+  components::ActorTag,
+  engine::components::AnimationLoop,
+  engine::components::AnimationSequence,
+  engine::components::AutoDestroy,
+  components::BehaviorController,
+  engine::components::BoundingBox,
+  components::CollectableItem,
+  components::CollectableItemForCheat,
+  engine::components::CollidedWithWorld,
+  components::DamageInflicting,
+  components::DestructionEffects,
+  engine::components::DrawTopMost,
+  engine::components::ExtendedFrameList,
+  components::Interactable,
+  components::ItemBounceEffect,
+  components::ItemContainer,
+  components::MapGeometryLink,
+  engine::components::MovementSequence,
+  engine::components::MovingBody,
+  engine::components::Orientation,
+  engine::components::OverrideDrawOrder,
+  components::PlayerDamaging,
+  components::PlayerProjectile,
+  components::RadarDish,
+  components::Shootable,
+  engine::components::SolidBody,
+  components::SpawnOrigin,
+  engine::components::Sprite,
+  components::SpriteCascadeSpawner,
+  components::TileDebris,
+  engine::components::WorldPosition>;
+
+}
@@ -17,19 +17,29 @@
 #pragma once
 
 #include "base/warnings.hpp"
+#include "engine/base_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 
 RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
 #include <memory>
+#include <new>
 #include <type_traits>
+#include <typeinfo>
+#include <utility>
 
 namespace rigel::engine::events {
   struct CollidedWithWorld;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::components {
 
@@ -60,6 +70,16 @@ struct hasOnCollision : std::false_type {};
 template <typename T>
 struct hasOnCollision<T, void_t<decltype(&T::onCollision)>> :
   std::true_type {};
+
+
+template <typename T, typename = void>
+struct hasPersistentState : std::false_type {};
+
+template <typename T>
+struct hasPersistentState<T, void_t<
+  decltype(&T::writeState),
+  decltype(&T::readState)>> :
+  std::true_type {};
 }
 
 
@@ -146,27 +166,100 @@ behaviorControllerOnCollision(
 }
 
 
+template <typename T>
+std::enable_if_t<detail::hasPersistentState<T>::value>
+behaviorControllerWriteState(const T& self, loader::LeStreamWriter& writer) {
+  self.writeState(writer);
+}
+
+
+template <typename T>
+std::enable_if_t<!detail::hasPersistentState<T>::value>
+behaviorControllerWriteState(const T&, loader::LeStreamWriter&) {
+}
+
+
+template <typename T>
+std::enable_if_t<detail::hasPersistentState<T>::value>
+behaviorControllerReadState(T& self, loader::LeStreamReader& reader) {
+  self.readState(reader);
+}
+
+
+template <typename T>
+std::enable_if_t<!detail::hasPersistentState<T>::value>
+behaviorControllerReadState(T&, loader::LeStreamReader&) {
+}
+
+
+/** Entry in a list of behavior controllers to update as a batch
+ *
+ * See BehaviorController::batchUpdater()
+ */
+struct BehaviorControllerBatchEntry {
+  const void* mpTypeTag;
+
+  // Types are numbered in order of their first appearance
+  std::size_t mTypeIndex;
+  std::size_t mOrder;
+  entityx::Entity mEntity;
+};
+
+
+/** Type-erased wrapper for an entity's behavior
+ *
+ * Small controllers (which is almost all of them) are stored inline, so that
+ * they end up in entityx' contiguous component storage, and copying them
+ * doesn't require a heap allocation. Larger ones are stored on the heap.
+ */
 class BehaviorController {
 public:
+  using BatchUpdateFunc = void (*)(
+    const BehaviorControllerBatchEntry* pFirst,
+    const BehaviorControllerBatchEntry* pLast,
+    GlobalDependencies& dependencies,
+    GlobalState& state);
+
   template<typename T>
-  explicit BehaviorController(T controller)
-    : mpSelf(std::make_unique<Model<T>>(std::move(controller)))
-  {
+  explicit BehaviorController(T controller) {
+    if constexpr (fitsInline<T>()) {
+      mpSelf = new (&mStorage) Model<T>(std::move(controller));
+    } else {
+      mpSelf = new Model<T>(std::move(controller));
+    }
   }
 
   BehaviorController(const BehaviorController& other)
-    : mpSelf(other.mpSelf->clone())
+    : mpSelf(other.mpSelf ? other.mpSelf->copyInto(&mStorage) : nullptr)
+    , mHasBeenInvoked(other.mHasBeenInvoked)
   {
   }
 
   BehaviorController& operator=(const BehaviorController& other) {
-    auto copy = other;
-    std::swap(mpSelf, copy.mpSelf);
+    if (this != &other) {
+      auto copy = other;
+      *this = std::move(copy);
+    }
+
+    return *this;
+  }
+
+  BehaviorController(BehaviorController&& other) noexcept {
+    takeFrom(other);
+  }
+
+  BehaviorController& operator=(BehaviorController&& other) noexcept {
+    if (this != &other) {
+      destroy();
+      takeFrom(other);
+    }
+
     return *this;
   }
 
-  BehaviorController(BehaviorController&&) = default;
-  BehaviorController& operator=(BehaviorController&&) = default;
+  ~BehaviorController() {
+    destroy();
+  }
 
   void update(
     GlobalDependencies& dependencies,
@@ -174,6 +267,7 @@ public:
     const bool isOnScreen,
     entityx::Entity entity
   ) {
+    mHasBeenInvoked = true;
     mpSelf->update(dependencies, state, isOnScreen, entity);
   }
 
@@ -183,6 +277,7 @@ public:
     const base::Point<float>& inflictorVelocity,
     entityx::Entity entity
   ) {
+    mHasBeenInvoked = true;
     mpSelf->onHit(dependencies, state, inflictorVelocity, entity);
   }
 
@@ -192,6 +287,7 @@ public:
     const base::Point<float>& inflictorVelocity,
     entityx::Entity entity
   ) {
+    mHasBeenInvoked = true;
     mpSelf->onKilled(dependencies, state, inflictorVelocity, entity);
   }
 
@@ -201,20 +297,97 @@ public:
     const engine::events::CollidedWithWorld& event,
     entityx::Entity entity
   ) {
+    mHasBeenInvoked = true;
     mpSelf->onCollision(dependencies, state, event, entity);
   }
 
+  /** Check if the wrapped behavior can store and restore its state
+   *
+   * Behaviors opt into this by providing two member functions:
+   *
+   *   void writeState(loader::LeStreamWriter& writer) const;
+   *   void readState(loader::LeStreamReader& reader);
+   *
+   * readState() is applied to a freshly created instance of the behavior, so
+   * only state which changes during gameplay needs to be written, not
+   * configuration passed in on construction. readState() must throw if the
+   * data is invalid. See also game_logic::serializeQuickSave().
+   */
+  bool hasPersistentState() const {
+    return mpSelf->hasPersistentState();
+  }
+
+  void writeState(loader::LeStreamWriter& writer) const {
+    mpSelf->writeState(writer);
+  }
+
+  void readState(loader::LeStreamReader& reader) {
+    mpSelf->readState(reader);
+  }
+
+  /** Check if the wrapped behavior is guaranteed to be in its initial state
+   *
+   * That's the case if it doesn't have any state, or if none of its
+   * functions have been invoked yet. A behavior in its initial state can be
+   * re-created without knowing its state, even if it doesn't support
+   * writeState()/readState().
+   */
+  bool isInInitialState() const {
+    return !mHasBeenInvoked || mpSelf->isStateless();
+  }
+
   template<typename T>
   T& get() {
-    auto pSelf = mpSelf.get();
+    auto pSelf = mpSelf;
     return dynamic_cast<Model<T>*>(pSelf)->mData;
   }
 
+  /** Unique value for each type of wrapped controller */
+  const void* typeTag() const {
+    return mpSelf->mpTypeTag;
+  }
+
+  /** Implementation-defined name of the wrapped controller's type
+   *
+   * Unlike typeTag(), this is the same across runs of the same executable.
+   */
+  const char* typeName() const {
+    return mpSelf->typeName();
+  }
+
+  /** Function for updating a batch of controllers of the same type
+   *
+   * All entries passed to the function must have the same type tag as this
+   * controller. The function updates the controllers in the given order, with
+   * direct (inlinable) calls instead of one virtual call per entity. Entities
+   * which became invalid, lost their controller or aren't active anymore
+   * by the time they are reached are skipped, and controllers which have been
+   * replaced with one of a different type in the meantime are updated
+   * normally.
+   */
+  BatchUpdateFunc batchUpdater() const {
+    return mpSelf->batchUpdater();
+  }
+
 private:
+  static constexpr auto INLINE_STORAGE_SIZE = std::size_t{64};
+
   struct Concept {
+    explicit Concept(const void* pTypeTag)
+      : mpTypeTag(pTypeTag)
+    {
+    }
+
     virtual ~Concept() = default;
 
-    virtual std::unique_ptr<Concept> clone() const = 0;
+    virtual Concept* copyInto(void* pStorage) const = 0;
+    virtual Concept* moveInto(void* pStorage) = 0;
+    virtual BatchUpdateFunc batchUpdater() const = 0;
+    virtual const char* typeName() const = 0;
+    virtual bool hasPersistentState() const = 0;
+    virtual bool isStateless() const = 0;
+    virtual void writeState(loader::LeStreamWriter& writer) const = 0;
+    virtual void readState(loader::LeStreamReader& reader) = 0;
 
     virtual void update(
       GlobalDependencies& dependencies,
@@ -239,17 +412,91 @@ private:
       GlobalState& state,
       const engine::events::CollidedWithWorld& event,
       entityx::Entity entity) = 0;
+
+    const void* mpTypeTag;
   };
 
   template<typename T>
   struct Model : public Concept {
     explicit Model(T data_)
-      : mData(std::move(data_))
+      : Concept(&sTypeTag)
+      , mData(std::move(data_))
     {
     }
 
-    std::unique_ptr<Concept> clone() const override {
-      return std::make_unique<Model>(mData);
+    Concept* copyInto(void* pStorage) const override {
+      if constexpr (fitsInline<T>()) {
+        return new (pStorage) Model(mData);
+      } else {
+        return new Model(mData);
+      }
+    }
+
+    Concept* moveInto(void* pStorage) override {
+      if constexpr (fitsInline<T>()) {
+        return new (pStorage) Model(std::move(mData));
+      } else {
+        return nullptr;
+      }
+    }
+
+    BatchUpdateFunc batchUpdater() const override {
+      return &updateBatch;
+    }
+
+    const char* typeName() const override {
+      return typeid(T).name();
+    }
+
+    bool hasPersistentState() const override {
+      return detail::hasPersistentState<T>::value;
+    }
+
+    bool isStateless() const override {
+      return std::is_empty_v<T>;
+    }
+
+    void writeState(loader::LeStreamWriter& writer) const override {
+      behaviorControllerWriteState(mData, writer);
+    }
+
+    void readState(loader::LeStreamReader& reader) override {
+      behaviorControllerReadState(mData, reader);
+    }
+
+    static void updateBatch(
+      const BehaviorControllerBatchEntry* pFirst,
+      const BehaviorControllerBatchEntry* pLast,
+      GlobalDependencies& dependencies,
+      GlobalState& state
+    ) {
+      using engine::components::Active;
+
+      for (auto pEntry = pFirst; pEntry != pLast; ++pEntry) {
+        auto entity = pEntry->mEntity;
+        if (
+          !entity.valid() ||
+          !entity.has_component<BehaviorController>() ||
+          !entity.has_component<Active>()
+        ) {
+          continue;
+        }
+
+        auto& controller = *entity.component<BehaviorController>();
+        const auto isOnScreen = entity.component<Active>()->mIsOnScreen;
+
+        if (controller.mpSelf->mpTypeTag == &sTypeTag) {
+          controller.mHasBeenInvoked = true;
+          updateBehaviorController(
+            static_cast<Model*>(controller.mpSelf)->mData,
+            dependencies,
+            state,
+            isOnScreen,
+            entity);
+        } else {
+          controller.update(dependencies, state, isOnScreen, entity);
+        }
+      }
     }
 
     void update(
@@ -303,10 +550,49 @@ private:
       behaviorControllerOnCollision(mData, dependencies, state, event, entity);
     }
 
+    // Only the address matters, it serves as the type tag
+    inline static char sTypeTag = 0;
+
     T mData;
   };
 
-  std::unique_ptr<Concept> mpSelf;
+  template<typename T>
+  static constexpr bool fitsInline() {
+    return
+      sizeof(Model<T>) <= INLINE_STORAGE_SIZE &&
+      alignof(Model<T>) <= alignof(std::max_align_t) &&
+      std::is_nothrow_move_constructible_v<T>;
+  }
+
+  bool isInline() const {
+    return static_cast<const void*>(mpSelf) ==
+      static_cast<const void*>(&mStorage);
+  }
+
+  void takeFrom(BehaviorController& other) {
+    mHasBeenInvoked = other.mHasBeenInvoked;
+
+    if (other.mpSelf && other.isInline()) {
+      mpSelf = other.mpSelf->moveInto(&mStorage);
+      other.destroy();
+    } else {
+      mpSelf = std::exchange(other.mpSelf, nullptr);
+    }
+  }
+
+  void destroy() {
+    if (isInline()) {
+      mpSelf->~Concept();
+    } else {
+      delete mpSelf;
+    }
+
+    mpSelf = nullptr;
+  }
+
+  Concept* mpSelf = nullptr;
+  bool mHasBeenInvoked = false;
+  alignas(std::max_align_t) std::byte mStorage[INLINE_STORAGE_SIZE];
 };
 
 }
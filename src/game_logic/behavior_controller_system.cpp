@@ -16,11 +16,16 @@
 
 #include "behavior_controller_system.hpp"
 
+#include "base/tracing.hpp"
 #include "common/global.hpp"
 #include "engine/base_components.hpp"
 #include "engine/physical_components.hpp"
 #include "game_logic/behavior_controller.hpp"
 
+#include <algorithm>
+#include <iterator>
+#include <tuple>
+
 
 namespace rigel::game_logic {
 
@@ -47,11 +52,18 @@ void BehaviorControllerSystem::update(
   entityx::EntityManager& es,
   const PerFrameState& s
 ) {
+  RIGEL_TRACE_SCOPE("BehaviorControllerSystem::update");
+
   using engine::components::Active;
   using game_logic::components::BehaviorController;
 
   mPerFrameState = s;
 
+  if (mUpdateMode == UpdateMode::GroupedByType) {
+    updateGroupedByType(es);
+    return;
+  }
+
   es.each<BehaviorController, Active>([this](
     entityx::Entity entity,
     BehaviorController& controller,
@@ -66,6 +78,79 @@ void BehaviorControllerSystem::update(
 }
 
 
+void BehaviorControllerSystem::updateGroupedByType(
+  entityx::EntityManager& es
+) {
+  using engine::components::Active;
+  using game_logic::components::BehaviorController;
+
+  mBatchEntries.clear();
+  mBatchTypes.clear();
+  es.each<BehaviorController, Active>([this](
+    entityx::Entity entity,
+    const BehaviorController& controller,
+    const Active&
+  ) {
+    // Numbering types by first appearance instead of ordering them by type
+    // tag makes the order independent of where the tags happen to be
+    // located in memory.
+    const auto pTypeTag = controller.typeTag();
+    const auto iType =
+      std::find(mBatchTypes.begin(), mBatchTypes.end(), pTypeTag);
+    const auto typeIndex =
+      static_cast<std::size_t>(std::distance(mBatchTypes.begin(), iType));
+    if (iType == mBatchTypes.end()) {
+      mBatchTypes.push_back(pTypeTag);
+    }
+
+    mBatchEntries.push_back(
+      {pTypeTag, typeIndex, mBatchEntries.size(), entity});
+  });
+
+  // The original position serves as tie-breaker, so that entity order is
+  // preserved within each type without needing a (potentially allocating)
+  // stable sort.
+  std::sort(
+    mBatchEntries.begin(),
+    mBatchEntries.end(),
+    [](const auto& lhs, const auto& rhs) {
+      return std::tie(lhs.mTypeIndex, lhs.mOrder) <
+        std::tie(rhs.mTypeIndex, rhs.mOrder);
+    });
+
+  const auto pEnd = mBatchEntries.data() + mBatchEntries.size();
+  for (auto pBatchStart = mBatchEntries.data(); pBatchStart != pEnd;) {
+    const auto pBatchEnd = std::find_if(
+      pBatchStart, pEnd, [pBatchStart](const auto& entry) {
+        return entry.mpTypeTag != pBatchStart->mpTypeTag;
+      });
+
+    // The first entity of a batch might have been destroyed by an earlier
+    // batch, so we can't always use it to look up the batch update function.
+    // But the type tag uniquely identifies the controller type, so any entity
+    // in the batch which still has a controller of that type will do. If
+    // there is none, all entities in the batch were either destroyed or have
+    // been given a different behavior during this frame, and are skipped.
+    const auto iLiveEntry = std::find_if(
+      pBatchStart, pBatchEnd, [](const auto& entry) {
+        auto entity = entry.mEntity;
+        return entity.valid() &&
+          entity.template has_component<BehaviorController>() &&
+          entity.template component<BehaviorController>()->typeTag() ==
+            entry.mpTypeTag;
+      });
+
+    if (iLiveEntry != pBatchEnd) {
+      const auto updateBatch = iLiveEntry->mEntity
+        .component<BehaviorController>()->batchUpdater();
+      updateBatch(pBatchStart, pBatchEnd, mDependencies, mGlobalState);
+    }
+
+    pBatchStart = pBatchEnd;
+  }
+}
+
+
 void BehaviorControllerSystem::receive(const events::ShootableDamaged& event) {
   using engine::components::Active;
   using game_logic::components::BehaviorController;
@@ -16,10 +16,13 @@
 
 #pragma once
 
+#include "game_logic/behavior_controller.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/input.hpp"
 
+#include <vector>
+
 namespace rigel::engine::events {
   struct CollidedWithWorld;
 }
@@ -30,6 +33,25 @@ namespace rigel::game_logic {
 class BehaviorControllerSystem :
   public entityx::Receiver<BehaviorControllerSystem> {
 public:
+  enum class UpdateMode {
+    /** Update each controller in entity order, like the original game */
+    InEntityOrder,
+
+    /** Update all controllers of the same type in one batch
+     *
+     * Avoids one virtual call per entity and keeps the code of each behavior
+     * type hot while updating it. Within a type, entity order is preserved.
+     * Types are updated in order of their first active entity, so the
+     * result only depends on the world state and is reproducible. It still
+     * differs from InEntityOrder, and controllers assigned during the update
+     * are not updated until the next frame. This can change gameplay in
+     * subtle ways when behaviors of different types interact within a frame,
+     * so it's not suitable for demo playback or anything else that requires
+     * exact reproduction of the original game's behavior.
+     */
+    GroupedByType
+  };
+
   BehaviorControllerSystem(
     GlobalDependencies dependencies,
     Player* pPlayer,
@@ -38,14 +60,23 @@ public:
 
   void update(entityx::EntityManager& es, const PerFrameState& s);
 
+  void setUpdateMode(const UpdateMode mode) {
+    mUpdateMode = mode;
+  }
+
   void receive(const events::ShootableDamaged& event);
   void receive(const events::ShootableKilled& event);
   void receive(const engine::events::CollidedWithWorld& event);
 
 private:
+  void updateGroupedByType(entityx::EntityManager& es);
+
+  std::vector<components::BehaviorControllerBatchEntry> mBatchEntries;
+  std::vector<const void*> mBatchTypes;
   GlobalDependencies mDependencies;
   PerFrameState mPerFrameState;
   GlobalState mGlobalState;
+  UpdateMode mUpdateMode = UpdateMode::InEntityOrder;
 };
 
 }
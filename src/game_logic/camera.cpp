@@ -19,10 +19,12 @@
 #include "common/global.hpp"
 #include "data/game_traits.hpp"
 #include "data/map.hpp"
+#include "data/unit_conversions.hpp"
 #include "engine/physical_components.hpp"
 #include "game_logic/player.hpp"
 
 #include <algorithm>
+#include <cmath>
 
 namespace ex = entityx;
 
@@ -147,6 +149,31 @@ base::Vector offsetToDeadZone(
 }
 
 
+InterpolatedCamera interpolateCamera(
+  const base::Vector& previousPosition,
+  const base::Vector& position,
+  const float interpolationFactor
+) {
+  const auto currentPx = data::tileVectorToPixelVector(position);
+  const auto previousPx = data::tileVectorToPixelVector(previousPosition);
+  const auto motionPx = currentPx - previousPx;
+
+  const auto positionPx = previousPx + base::Vector{
+    static_cast<int>(std::round(motionPx.x * interpolationFactor)),
+    static_cast<int>(std::round(motionPx.y * interpolationFactor))};
+
+  // The camera position is never negative, so integer division is fine here
+  const auto tilePosition = base::Vector{
+    data::pixelsToTiles(positionPx.x), data::pixelsToTiles(positionPx.y)};
+  const auto tilePositionPx = data::tileVectorToPixelVector(tilePosition);
+
+  return {
+    tilePosition,
+    tilePositionPx - positionPx,
+    currentPx - tilePositionPx};
+}
+
+
 Camera::Camera(
   const Player* pPlayer,
   const data::map::Map& map,
@@ -161,12 +188,24 @@ Camera::Camera(
 
 
 void Camera::synchronizeTo(const Camera& other) {
-  mPosition = other.mPosition;
-  mManualScrollCooldown = other.mManualScrollCooldown;
+  restoreSnapshot(other.snapshot());
+}
+
+
+Camera::Snapshot Camera::snapshot() const {
+  return Snapshot{mPosition, mManualScrollCooldown};
+}
+
+
+void Camera::restoreSnapshot(const Snapshot& snapshot) {
+  mPosition = snapshot.mPosition;
+  mPreviousPosition = snapshot.mPosition;
+  mManualScrollCooldown = snapshot.mManualScrollCooldown;
 }
 
 
 void Camera::update(const PlayerInput& input, const base::Extents& viewPortSize) {
+  mPreviousPosition = mPosition;
   mViewPortSize = viewPortSize;
   updateManualScrolling(input);
 
@@ -234,6 +273,7 @@ void Camera::centerViewOnPlayer() {
   }
 
   setPosition(playerPos - INITIAL_CAMERA_OFFSET);
+  mPreviousPosition = mPosition;
 }
 
 
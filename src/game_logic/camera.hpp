@@ -35,6 +35,38 @@ namespace rigel::game_logic {
 
 class Player;
 
+
+/** Camera position to draw the world at, see interpolateCamera()
+ *
+ * The camera moves in steps of whole tiles, but when interpolating, it can
+ * end up in between two tiles. In that case, we draw one additional row
+ * and column of map tiles and shift everything by a pixel offset.
+ */
+struct InterpolatedCamera {
+  // Top-left tile of the visible map section
+  base::Vector mTilePosition;
+
+  // Offset in pixels to apply when drawing the map
+  base::Vector mPixelOffset;
+
+  // Offset in pixels to apply when drawing sprites, in addition to
+  // mPixelOffset. Sprites are positioned relative to the most recent camera
+  // position instead of mTilePosition.
+  base::Vector mSpriteOffset;
+};
+
+
+/** Camera position for rendering in between two logic updates
+ *
+ * An interpolation factor of 0.0 gives the previous position, 1.0 the
+ * current one. Camera positions must not be negative.
+ */
+InterpolatedCamera interpolateCamera(
+  const base::Vector& previousPosition,
+  const base::Vector& position,
+  float interpolationFactor);
+
+
 class Camera : public entityx::Receiver<Camera> {
 public:
   Camera(
@@ -42,13 +74,29 @@ public:
     const data::map::Map& map,
     entityx::EventManager& eventManager);
 
+  struct Snapshot {
+    base::Vector mPosition;
+    int mManualScrollCooldown;
+  };
+
   void synchronizeTo(const Camera& other);
 
+  Snapshot snapshot() const;
+  void restoreSnapshot(const Snapshot& snapshot);
+
   void update(const PlayerInput& input, const base::Extents& viewPortSize);
   void centerViewOnPlayer();
 
   const base::Vector& position() const;
 
+  /** Position before the most recent update()
+   *
+   * Used for interpolating the camera position when rendering in between two
+   * logic updates. Equal to position() after the camera has been moved
+   * abruptly, e.g. by centerViewOnPlayer().
+   */
+  const base::Vector& previousPosition() const;
+
   void receive(const rigel::events::PlayerFiredShot& event);
 
 private:
@@ -59,6 +107,7 @@ private:
   const Player* mpPlayer;
   const data::map::Map* mpMap;
   base::Vector mPosition;
+  base::Vector mPreviousPosition;
   base::Extents mViewPortSize;
   int mManualScrollCooldown = 0;
 };
@@ -68,4 +117,9 @@ inline const base::Vector& Camera::position() const {
   return mPosition;
 }
 
+
+inline const base::Vector& Camera::previousPosition() const {
+  return mPreviousPosition;
+}
+
 }
@@ -16,9 +16,11 @@
 
 #include "damage_infliction_system.hpp"
 
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "data/player_model.hpp"
 #include "engine/base_components.hpp"
+#include "engine/event_queue.hpp"
 #include "engine/physical_components.hpp"
 #include "engine/visual_components.hpp"
 
@@ -51,16 +53,26 @@ auto extractVelocity(entityx::Entity entity) {
 DamageInflictionSystem::DamageInflictionSystem(
   data::PlayerModel* pPlayerModel,
   IGameServiceProvider* pServiceProvider,
-  entityx::EventManager* pEvents
+  engine::EventQueue* pEventQueue
 )
   : mpPlayerModel(pPlayerModel)
   , mpServiceProvider(pServiceProvider)
-  , mpEvents(pEvents)
+  , mpEventQueue(pEventQueue)
 {
+  mpEventQueue->registerEventType<events::ShootableDamaged>("ShootableDamaged");
+
+  // Receivers of this event can decide whether the shootable should be
+  // destroyed (see ItemContainerSystem), and we need to know that right
+  // away. It's also important that the entity still exists when receivers
+  // are invoked.
+  mpEventQueue->registerEventType<events::ShootableKilled>(
+    "ShootableKilled", engine::EventQueue::Deferrable::No);
 }
 
 
 void DamageInflictionSystem::update(ex::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("DamageInflictionSystem::update");
+
   es.each<DamageInflicting, WorldPosition, BoundingBox>(
     [this, &es](
       ex::Entity inflictorEntity,
@@ -115,7 +127,7 @@ void DamageInflictionSystem::inflictDamage(
 
   shootable.mHealth -= damage.mAmount;
   if (shootable.mHealth <= 0) {
-    mpEvents->emit(
+    mpEventQueue->post(
       events::ShootableKilled{shootableEntity, inflictorVelocity});
     // Event listeners mustn't remove the shootable component
     assert(shootableEntity.has_component<Shootable>());
@@ -128,7 +140,7 @@ void DamageInflictionSystem::inflictDamage(
       shootableEntity.remove<Shootable>();
     }
   } else {
-    mpEvents->emit(
+    mpEventQueue->post(
       events::ShootableDamaged{shootableEntity, inflictorVelocity});
 
     if (shootable.mEnableHitFeedback) {
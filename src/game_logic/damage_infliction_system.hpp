@@ -27,6 +27,7 @@ RIGEL_RESTORE_WARNINGS
 namespace rigel { struct IGameServiceProvider; }
 
 namespace rigel::data { class PlayerModel; }
+namespace rigel::engine { class EventQueue; }
 
 
 namespace rigel::game_logic {
@@ -36,7 +37,7 @@ public:
   DamageInflictionSystem(
     data::PlayerModel* pPlayerModel,
     IGameServiceProvider* pServiceProvider,
-    entityx::EventManager* pEvents);
+    engine::EventQueue* pEventQueue);
 
   void update(entityx::EntityManager& es);
 
@@ -49,7 +50,7 @@ private:
 
   data::PlayerModel* mpPlayerModel;
   IGameServiceProvider* mpServiceProvider;
-  entityx::EventManager* mpEvents;
+  engine::EventQueue* mpEventQueue;
 };
 
 }
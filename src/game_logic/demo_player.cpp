@@ -56,12 +56,18 @@ PlayerInput parseInput(
 }
 
 
-std::vector<DemoInput> loadDemo(const loader::ResourceLoader& resources) {
+data::GameSessionId demoSessionId(const std::size_t levelIndex) {
+  return {DEMO_EPISODE, DEMO_LEVELS[levelIndex], DEMO_DIFFICULTY};
+}
+
+}
+
+
+std::vector<DemoInput> parseDemoInput(const loader::ByteBuffer& data) {
   PlayerInput previousInput;
   std::vector<DemoInput> result;
 
-  const auto demoData = resources.file("NUKEM2.MNI");
-  for (const auto byte : demoData) {
+  for (const auto byte : data) {
     if (byte == END_OF_DEMO_MARKER) {
       break;
     }
@@ -77,16 +83,9 @@ std::vector<DemoInput> loadDemo(const loader::ResourceLoader& resources) {
 }
 
 
-data::GameSessionId demoSessionId(const std::size_t levelIndex) {
-  return {DEMO_EPISODE, DEMO_LEVELS[levelIndex], DEMO_DIFFICULTY};
-}
-
-}
-
-
 DemoPlayer::DemoPlayer(GameMode::Context context)
   : mContext(context)
-  , mFrames(loadDemo(*context.mpResources))
+  , mFrames(parseDemoInput(context.mpResources->file("NUKEM2.MNI")))
   , mpWorld(std::make_unique<GameWorld>(
       &mPlayerModel,
       demoSessionId(0),
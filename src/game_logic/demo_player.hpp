@@ -20,6 +20,7 @@
 #include "data/player_model.hpp"
 #include "engine/timing.hpp"
 #include "game_logic/input.hpp"
+#include "loader/byte_buffer.hpp"
 
 #include <memory>
 #include <vector>
@@ -36,6 +37,14 @@ struct DemoInput {
 };
 
 
+/** Parse recorded input in the format used by the original game's demo
+ *
+ * Each byte encodes the input for one frame. Parsing stops at the end of
+ * the data or at the end-of-demo marker.
+ */
+std::vector<DemoInput> parseDemoInput(const loader::ByteBuffer& data);
+
+
 class DemoPlayer {
 public:
   explicit DemoPlayer(GameMode::Context context);
@@ -69,6 +69,9 @@ struct DynamicGeometryController {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mFramesElapsed = 0;
   Type mType;
   State mState = State::Waiting;
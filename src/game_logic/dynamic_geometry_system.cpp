@@ -30,6 +30,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/dynamic_geometry_components.hpp"
 #include "game_logic/ientity_factory.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic {
@@ -513,4 +514,20 @@ void behaviors::DynamicGeometryController::update(
   }
 }
 
+
+void behaviors::DynamicGeometryController::writeState(
+  loader::LeStreamWriter& writer
+) const {
+  writer.writeS32(mFramesElapsed);
+  writeEnum(writer, mState);
+}
+
+
+void behaviors::DynamicGeometryController::readState(
+  loader::LeStreamReader& reader
+) {
+  mFramesElapsed = reader.readS32();
+  mState = readEnum(reader, State::Sinking);
+}
+
 }
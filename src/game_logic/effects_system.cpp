@@ -17,6 +17,7 @@
 #include "effects_system.hpp"
 
 #include "base/match.hpp"
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "engine/base_components.hpp"
 #include "engine/life_time_components.hpp"
@@ -97,6 +98,8 @@ EffectsSystem::EffectsSystem(
 
 
 void EffectsSystem::update(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("EffectsSystem::update");
+
   using namespace engine::components;
 
   es.each<DestructionEffects, WorldPosition>(
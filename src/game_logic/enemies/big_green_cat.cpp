@@ -21,6 +21,7 @@
 #include "engine/movement.hpp"
 #include "engine/visual_components.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -73,4 +74,16 @@ void BigGreenCat::update(
   }
 }
 
+
+void BigGreenCat::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mWaitFramesRemaining);
+  writer.writeS32(mAnimationStep);
+}
+
+
+void BigGreenCat::readState(loader::LeStreamReader& reader) {
+  mWaitFramesRemaining = reader.readS32();
+  mAnimationStep = readIntInRange(reader, 0, 3);
+}
+
 }
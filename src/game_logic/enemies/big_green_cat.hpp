@@ -28,6 +28,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -40,6 +45,9 @@ struct BigGreenCat {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mWaitFramesRemaining = FRAMES_TO_WAIT;
   int mAnimationStep = 0;
 };
@@ -28,6 +28,7 @@
 #include "game_logic/effect_components.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 #include "loader/palette.hpp"
 
 
@@ -197,4 +198,14 @@ void BigBomb::onCollision(
   entity.destroy();
 }
 
+
+void BigBomb::writeState(loader::LeStreamWriter& writer) const {
+  writeBool(writer, mStartedFalling);
+}
+
+
+void BigBomb::readState(loader::LeStreamReader& reader) {
+  mStartedFalling = readBool(reader);
+}
+
 }
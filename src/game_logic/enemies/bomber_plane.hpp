@@ -69,6 +69,9 @@ struct BigBomb {
     const engine::events::CollidedWithWorld& event,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   bool mStartedFalling = false;
 };
 
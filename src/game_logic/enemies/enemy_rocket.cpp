@@ -22,6 +22,7 @@
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace ec = rigel::engine::components;
@@ -78,4 +79,14 @@ void EnemyRocket::update(
   }
 }
 
+
+void EnemyRocket::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mFramesElapsed);
+}
+
+
+void EnemyRocket::readState(loader::LeStreamReader& reader) {
+  mFramesElapsed = reader.readS32();
+}
+
 }
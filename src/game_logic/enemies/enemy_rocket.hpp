@@ -29,6 +29,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -44,6 +49,9 @@ struct EnemyRocket {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   base::Vector mDirection;
   int mFramesElapsed = 0;
 };
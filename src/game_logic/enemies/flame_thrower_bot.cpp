@@ -21,6 +21,7 @@
 #include "engine/random_number_generator.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -73,4 +74,16 @@ void FlameThrowerBot::update(
   }
 }
 
+
+void FlameThrowerBot::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mFramesRemainingForFiring);
+  writeEnum(writer, mMovementDirection);
+}
+
+
+void FlameThrowerBot::readState(loader::LeStreamReader& reader) {
+  mFramesRemainingForFiring = reader.readS32();
+  mMovementDirection = readEnum(reader, MovementDirection::Down);
+}
+
 }
@@ -28,6 +28,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -43,6 +48,9 @@ struct FlameThrowerBot {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mFramesRemainingForFiring = 0;
   MovementDirection mMovementDirection = MovementDirection::Down;
 };
@@ -26,6 +26,7 @@
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -65,6 +66,18 @@ void HoverBotSpawnMachine::update(
 }
 
 
+void HoverBotSpawnMachine::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mSpawnsRemaining);
+  writer.writeS32(mNextSpawnCountdown);
+}
+
+
+void HoverBotSpawnMachine::readState(loader::LeStreamReader& reader) {
+  mSpawnsRemaining = reader.readS32();
+  mNextSpawnCountdown = reader.readS32();
+}
+
+
 void HoverBot::update(
   GlobalDependencies& d,
   GlobalState& s,
@@ -31,6 +31,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -41,6 +46,9 @@ struct HoverBotSpawnMachine {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mSpawnsRemaining = 30;
   int mNextSpawnCountdown = 0;
 };
@@ -26,6 +26,7 @@
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -186,4 +187,18 @@ void LaserTurret::onKilled(
     position);
 }
 
+
+void LaserTurret::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mAngle);
+  writer.writeS32(mSpinningTurnsLeft);
+  writer.writeS32(mNextShotCountdown);
+}
+
+
+void LaserTurret::readState(loader::LeStreamReader& reader) {
+  mAngle = readIntInRange(reader, 0, 7);
+  mSpinningTurnsLeft = reader.readS32();
+  mNextShotCountdown = reader.readS32();
+}
+
 }
@@ -27,6 +27,7 @@
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 #include "loader/palette.hpp"
 
 
@@ -137,6 +138,18 @@ void AggressivePrisoner::onKilled(
 }
 
 
+void AggressivePrisoner::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mGrabStep);
+  writeBool(writer, mIsGrabbing);
+}
+
+
+void AggressivePrisoner::readState(loader::LeStreamReader& reader) {
+  mGrabStep = reader.readS32();
+  mIsGrabbing = readBool(reader);
+}
+
+
 void PassivePrisoner::update(
   GlobalDependencies& d,
   GlobalState& s,
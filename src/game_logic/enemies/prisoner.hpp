@@ -29,6 +29,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -45,6 +50,9 @@ struct AggressivePrisoner {
     const base::Point<float>& inflictorVelocity,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mGrabStep = 0;
   bool mIsGrabbing = false;
 };
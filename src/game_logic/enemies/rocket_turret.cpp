@@ -24,6 +24,7 @@
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -97,4 +98,18 @@ void RocketTurret::update(
   engine::synchronizeBoundingBoxToSprite(entity);
 }
 
+
+void RocketTurret::writeState(loader::LeStreamWriter& writer) const {
+  writeEnum(writer, mOrientation);
+  writeBool(writer, mNeedsReorientation);
+  writer.writeS32(mNextShotCountdown);
+}
+
+
+void RocketTurret::readState(loader::LeStreamReader& reader) {
+  mOrientation = readEnum(reader, Orientation::Right);
+  mNeedsReorientation = readBool(reader);
+  mNextShotCountdown = reader.readS32();
+}
+
 }
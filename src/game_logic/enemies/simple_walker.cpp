@@ -74,4 +74,13 @@ void SimpleWalker::update(
   }
 }
 
+
+// The configuration is provided on creation, there's no other state.
+void SimpleWalker::writeState(loader::LeStreamWriter&) const {
+}
+
+
+void SimpleWalker::readState(loader::LeStreamReader&) {
+}
+
 }
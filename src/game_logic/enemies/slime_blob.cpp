@@ -28,6 +28,7 @@
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -101,6 +102,16 @@ void SlimeContainer::onKilled(
 }
 
 
+void SlimeContainer::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mBreakAnimationStep);
+}
+
+
+void SlimeContainer::readState(loader::LeStreamReader& reader) {
+  mBreakAnimationStep = reader.readS32();
+}
+
+
 void SlimeBlob::update(
   GlobalDependencies& d,
   GlobalState& s,
@@ -22,6 +22,7 @@
 #include "game_logic/effect_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -91,4 +92,14 @@ void SmallFlyingShip::update(
   }
 }
 
+
+void SmallFlyingShip::writeState(loader::LeStreamWriter& writer) const {
+  writeOptionalInt(writer, mInitialHeight);
+}
+
+
+void SmallFlyingShip::readState(loader::LeStreamReader& reader) {
+  mInitialHeight = readOptionalInt(reader);
+}
+
 }
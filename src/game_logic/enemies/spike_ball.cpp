@@ -24,6 +24,7 @@
 #include "engine/physical_components.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -114,4 +115,16 @@ void SpikeBall::onCollision(
   }
 }
 
+
+void SpikeBall::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mJumpBackCooldown);
+  writeBool(writer, mInitialized);
+}
+
+
+void SpikeBall::readState(loader::LeStreamReader& reader) {
+  mJumpBackCooldown = reader.readS32();
+  mInitialized = readBool(reader);
+}
+
 }
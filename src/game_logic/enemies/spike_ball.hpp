@@ -29,6 +29,11 @@ namespace rigel::game_logic {
   struct GlobalState;
 }
 
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
 
 namespace rigel::game_logic::behaviors {
 
@@ -51,6 +56,9 @@ struct SpikeBall {
     const engine::events::CollidedWithWorld& event,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mJumpBackCooldown = 0;
   bool mInitialized = false;
 };
@@ -20,6 +20,7 @@
 #include "engine/random_number_generator.hpp"
 #include "engine/visual_components.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -105,4 +106,20 @@ void WallWalker::update(
   }
 }
 
+
+void WallWalker::writeState(loader::LeStreamWriter& writer) const {
+  writeEnum(writer, mDirection);
+  writer.writeS32(mFramesUntilDirectionSwitch);
+  writer.writeS32(mMovementToggle);
+  writeBool(writer, mShouldSkipThisFrame);
+}
+
+
+void WallWalker::readState(loader::LeStreamReader& reader) {
+  mDirection = readEnum(reader, Direction::Right);
+  mFramesUntilDirectionSwitch = reader.readS32();
+  mMovementToggle = reader.readS32();
+  mShouldSkipThisFrame = readBool(reader);
+}
+
 }
@@ -29,6 +29,7 @@
 #include "game_logic/effect_components.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -298,6 +299,18 @@ void WatchBotCarrier::update(
 }
 
 
+void WatchBotCarrier::writeState(loader::LeStreamWriter& writer) const {
+  writeEnum(writer, mState);
+  writer.writeS32(mFramesElapsed);
+}
+
+
+void WatchBotCarrier::readState(loader::LeStreamReader& reader) {
+  mState = readEnum(reader, State::ReleasingPayload);
+  mFramesElapsed = reader.readS32();
+}
+
+
 void WatchBotContainer::update(
   GlobalDependencies& d,
   GlobalState& s,
@@ -337,4 +350,14 @@ void WatchBotContainer::update(
   }
 }
 
+
+void WatchBotContainer::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mFramesElapsed);
+}
+
+
+void WatchBotContainer::readState(loader::LeStreamReader& reader) {
+  mFramesElapsed = reader.readS32();
+}
+
 }
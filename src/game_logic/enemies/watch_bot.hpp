@@ -97,6 +97,9 @@ struct WatchBotCarrier {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   State mState = State::ApproachingPlayer;
   int mFramesElapsed = 0;
 };
@@ -109,6 +112,9 @@ struct WatchBotContainer {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mFramesElapsed = 0;
 };
 
@@ -389,6 +389,26 @@ void addItemBoxDestroyEffect(ex::Entity entity) {
   entity.assign<ItemContainer>(std::move(container));
 }
 
+/** True for actors whose configuration can't be shared via a prototype
+ *
+ * This is the case if configureEntity() does something depending on the
+ * individual instance, like looking at the actor's position, using the spawn
+ * index, or spawning additional entities. Use of random numbers and changes
+ * to the position are detected automatically, but anything else must be
+ * listed here.
+ */
+bool hasInstanceSpecificConfiguration(const ActorID id) {
+  switch (id) {
+    case ActorID::Force_field:
+    case ActorID::Ugly_green_bird:
+    case ActorID::Dynamic_geometry_3:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
 } // namespace
 
 
@@ -17,16 +17,19 @@
 #include "entity_factory.hpp"
 
 #include "base/container_utils.hpp"
+#include "base/defer.hpp"
 #include "common/game_service_provider.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
+#include "engine/entity_tools.hpp"
 #include "engine/life_time_components.hpp"
 #include "engine/physics_system.hpp"
 #include "engine/random_number_generator.hpp"
 #include "engine/sprite_factory.hpp"
 #include "engine/sprite_tools.hpp"
 #include "game_logic/actor_tag.hpp"
+#include "game_logic/all_components.hpp"
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/collectable_components.hpp"
 #include "game_logic/damage_components.hpp"
@@ -81,8 +84,12 @@
 #include "game_logic/interactive/tile_burner.hpp"
 #include "game_logic/player/level_exit_trigger.hpp"
 #include "game_logic/player/ship.hpp"
+#include "game_logic/spawn_origin.hpp"
 
+#include <algorithm>
+#include <cassert>
 #include <tuple>
+#include <type_traits>
 #include <utility>
 
 
@@ -119,6 +126,42 @@ void addDefaultMovingBody(
 }
 
 
+void setSpawnOrigin(entityx::Entity entity, const SpawnOrigin& origin) {
+  if (entity.has_component<SpawnOrigin>()) {
+    *entity.component<SpawnOrigin>() = origin;
+  } else {
+    entity.assign<SpawnOrigin>(origin);
+  }
+}
+
+
+template <typename T>
+void applyPrototypeComponent(entityx::Entity prototype, entityx::Entity entity) {
+  if constexpr (!std::is_same_v<T, WorldPosition>) {
+    if (prototype.has_component<T>()) {
+      const auto& value = *prototype.component<const T>();
+      if (entity.has_component<T>()) {
+        *entity.component<T>() = value;
+      } else {
+        entity.assign<T>(value);
+      }
+    } else {
+      engine::removeSafely<T>(entity);
+    }
+  }
+}
+
+
+template <typename... Components>
+void applyPrototype(
+  entityx::Entity prototype,
+  entityx::Entity entity,
+  TypeList<Components...>
+) {
+  (applyPrototypeComponent<Components>(prototype, entity), ...);
+}
+
+
 base::Vector adjustedPosition(
   const ProjectileType type,
   WorldPosition position,
@@ -303,12 +346,32 @@ EntityFactory::EntityFactory(
   , mpRandomGenerator(pRandomGenerator)
   , mpOptions(pOptions)
   , mDifficulty(difficulty)
+  , mPrototypeEntities(mPrototypeEvents)
 {
 }
 
 
 Sprite EntityFactory::createSpriteForId(const ActorID actorID) {
-  return mpSpriteFactory->createSprite(actorID);
+  return spritePrototype(actorID).mSprite;
+}
+
+
+const EntityFactory::SpritePrototype& EntityFactory::spritePrototype(
+  const ActorID actorID
+) {
+  const auto index = static_cast<size_t>(actorID);
+  if (index >= mSpritePrototypes.size()) {
+    mSpritePrototypes.resize(index + 1);
+  }
+
+  auto& prototype = mSpritePrototypes[index];
+  if (!prototype) {
+    prototype = SpritePrototype{
+      mpSpriteFactory->createSprite(actorID),
+      mpSpriteFactory->actorFrameRect(actorID, 0)};
+  }
+
+  return *prototype;
 }
 
 
@@ -316,12 +379,15 @@ entityx::Entity EntityFactory::spawnSprite(
   const data::ActorID actorID,
   const bool assignBoundingBox
 ) {
+  const auto& prototype = spritePrototype(actorID);
+
   auto entity = mpEntityManager->create();
-  auto sprite = createSpriteForId(actorID);
-  entity.assign<Sprite>(sprite);
+  entity.assign<Sprite>(prototype.mSprite);
+  entity.assign<SpawnOrigin>(
+    SpawnOrigin::sprite(actorID, assignBoundingBox));
 
   if (assignBoundingBox) {
-    entity.assign<BoundingBox>(mpSpriteFactory->actorFrameRect(actorID, 0));
+    entity.assign<BoundingBox>(prototype.mBoundingBox);
   }
 
   if (actorID == data::ActorID::Explosion_FX_1) {
@@ -356,6 +422,7 @@ entityx::Entity EntityFactory::spawnProjectile(
   using namespace game_logic::components::parameter_aliases;
 
   auto entity = spawnSprite(actorIdForProjectile(type, direction), true);
+  setSpawnOrigin(entity, SpawnOrigin::projectile(type, direction));
 
   const auto& boundingBox = *entity.component<BoundingBox>();
   const auto damageAmount = damageForProjectileType(type);
@@ -390,10 +457,7 @@ entityx::Entity EntityFactory::spawnActor(
   const base::Vector& position
 ) {
   auto entity = spawnSprite(id, position);
-  const auto boundingBox = mpSpriteFactory->actorFrameRect(id, 0);
-
-  configureEntity(entity, id, boundingBox);
-
+  configureActor(entity, id);
   return entity;
 }
 
@@ -420,20 +484,139 @@ void EntityFactory::createEntitiesForLevel(
     }
     entity.assign<WorldPosition>(position);
 
-    BoundingBox boundingBox;
     if (actor.mAssignedArea) {
       const auto mapSectionRect = *actor.mAssignedArea;
       entity.assign<MapGeometryLink>(mapSectionRect);
 
-      boundingBox = mapSectionRect;
+      auto boundingBox = BoundingBox{mapSectionRect};
       boundingBox.topLeft = {0, 0};
-    } else if (engine::hasAssociatedSprite(actor.mID)) {
-      const auto sprite = createSpriteForId(actor.mID);
-      boundingBox = mpSpriteFactory->actorFrameRect(actor.mID, 0);
-      entity.assign<Sprite>(sprite);
+      configureEntity(entity, actor.mID, boundingBox);
+    } else {
+      if (engine::hasAssociatedSprite(actor.mID)) {
+        entity.assign<Sprite>(createSpriteForId(actor.mID));
+      }
+
+      configureActor(entity, actor.mID);
+    }
+  }
+}
+
+
+void EntityFactory::configureActor(
+  entityx::Entity entity,
+  const data::ActorID actorID
+) {
+  if (const auto prototype = actorPrototype(actorID)) {
+    applyPrototype(prototype, entity, AllComponents{});
+
+    // Keep spawn indices the same as when running configureEntity()
+    ++mSpawnIndex;
+  } else {
+    configureEntity(entity, actorID, standardBoundingBox(actorID));
+  }
+
+  setSpawnOrigin(entity, SpawnOrigin::actor(actorID));
+}
+
+
+BoundingBox EntityFactory::standardBoundingBox(const data::ActorID actorID) {
+  return engine::hasAssociatedSprite(actorID)
+    ? spritePrototype(actorID).mBoundingBox
+    : BoundingBox{};
+}
+
+
+entityx::Entity EntityFactory::actorPrototype(const data::ActorID actorID) {
+  if (!mActorPrototypesEnabled) {
+    return {};
+  }
+
+  const auto index = static_cast<size_t>(actorID);
+  if (index >= mActorPrototypes.size()) {
+    mActorPrototypes.resize(index + 1);
+  }
+
+  // Creating the prototype can recursively create other prototypes, so we
+  // can't hold on to a reference into mActorPrototypes here.
+  if (!mActorPrototypes[index].mCreated) {
+    const auto prototype = createActorPrototype(actorID);
+    mActorPrototypes[index] = PrototypeSlot{prototype, true};
+  }
+
+  return mActorPrototypes[index].mEntity;
+}
+
+
+entityx::Entity EntityFactory::createActorPrototype(
+  const data::ActorID actorID
+) {
+  if (hasInstanceSpecificConfiguration(actorID)) {
+    return {};
+  }
+
+  auto prototype = mPrototypeEntities.create();
+  prototype.assign<WorldPosition>(0, 0);
+  if (engine::hasAssociatedSprite(actorID)) {
+    prototype.assign<Sprite>(createSpriteForId(actorID));
+  }
+
+  const auto spawnIndex = mSpawnIndex;
+  const auto randomNumberIndex = mpRandomGenerator->nextNumberIndex();
+  const auto numPrototypeEntities = mPrototypeEntities.size();
+
+  // Anything spawned during configuration ends up in the prototype entity
+  // manager, so that prototype creation never affects the game world.
+  {
+    auto pGameEntities = std::exchange(mpEntityManager, &mPrototypeEntities);
+    auto guard = base::defer([&]() { mpEntityManager = pGameEntities; });
+
+    configureEntity(prototype, actorID, standardBoundingBox(actorID));
+  }
+
+  mSpawnIndex = spawnIndex;
+
+  // Actors using random numbers during configuration (e.g. to pick a
+  // random initial direction) must be configured individually. The same
+  // goes for actors which adjust their position, or spawn additional
+  // entities. These should be listed in hasInstanceSpecificConfiguration(),
+  // but if one is missing, we still fall back to configureEntity() here.
+  const auto usedRandomNumbers =
+    mpRandomGenerator->nextNumberIndex() != randomNumberIndex;
+  const auto changedPosition =
+    *prototype.component<WorldPosition>() != WorldPosition{0, 0};
+  const auto spawnedEntities =
+    mPrototypeEntities.size() != numPrototypeEntities;
+  if (usedRandomNumbers || changedPosition || spawnedEntities) {
+    mpRandomGenerator->setNextNumberIndex(randomNumberIndex);
+    prototype.destroy();
+
+    if (spawnedEntities) {
+      destroyNonPrototypeEntities();
     }
 
-    configureEntity(entity, actor.mID, boundingBox);
+    return {};
+  }
+
+  return prototype;
+}
+
+
+void EntityFactory::destroyNonPrototypeEntities() {
+  std::vector<entityx::Entity> toDestroy;
+
+  for (auto entity : mPrototypeEntities.entities_for_debugging()) {
+    const auto isPrototype = std::any_of(
+      mActorPrototypes.begin(),
+      mActorPrototypes.end(),
+      [&](const PrototypeSlot& slot) { return slot.mEntity == entity; });
+
+    if (!isPrototype) {
+      toDestroy.push_back(entity);
+    }
+  }
+
+  for (auto entity : toDestroy) {
+    entity.destroy();
   }
 }
 
@@ -99,12 +99,34 @@ public:
     return *mpEntityManager;
   }
 
+  /** Enable or disable configuring actors by copying prototypes
+   *
+   * Enabled by default. When disabled, each actor is configured from
+   * scratch. The resulting entities are the same either way, this is meant
+   * for verifying exactly that, and for benchmarking.
+   */
+  void setActorPrototypesEnabled(const bool enabled) {
+    mActorPrototypesEnabled = enabled;
+  }
+
 private:
+  /** Configure an actor that uses its sprite's standard bounding box
+   *
+   * Uses the actor's prototype if possible, otherwise falls back to
+   * configureEntity().
+   */
+  void configureActor(entityx::Entity entity, data::ActorID actorID);
+
   void configureEntity(
     entityx::Entity entity,
     const data::ActorID actorID,
     const engine::components::BoundingBox& boundingBox);
 
+  engine::components::BoundingBox standardBoundingBox(data::ActorID actorID);
+  entityx::Entity actorPrototype(data::ActorID actorID);
+  entityx::Entity createActorPrototype(data::ActorID actorID);
+  void destroyNonPrototypeEntities();
+
   template<typename... Args>
   void configureItemBox(
     entityx::Entity entity,
@@ -114,6 +136,13 @@ private:
 
   engine::components::Sprite createSpriteComponent(data::ActorID mainId);
 
+  struct SpritePrototype {
+    engine::components::Sprite mSprite;
+    engine::components::BoundingBox mBoundingBox;
+  };
+
+  const SpritePrototype& spritePrototype(data::ActorID actorID);
+
   engine::ISpriteFactory* mpSpriteFactory;
   entityx::EntityManager* mpEntityManager;
   IGameServiceProvider* mpServiceProvider;
@@ -121,6 +150,25 @@ private:
   const data::GameOptions* mpOptions;
   int mSpawnIndex = 0;
   data::Difficulty mDifficulty;
+
+  // Effects like explosions and smoke are spawned many times per frame in
+  // busy scenes. Instead of looking up and configuring the sprite from
+  // scratch each time, a ready-made copy is kept per actor ID.
+  std::vector<std::optional<SpritePrototype>> mSpritePrototypes;
+
+  // Prototypes are created by running configureEntity() once per actor ID on
+  // an entity in a separate entity manager. Spawning an actor then only
+  // needs to copy the resulting components. Actors whose configuration
+  // depends on the individual instance have no prototype (invalid entity).
+  struct PrototypeSlot {
+    entityx::Entity mEntity;
+    bool mCreated = false;
+  };
+
+  entityx::EventManager mPrototypeEvents;
+  entityx::EntityManager mPrototypeEntities;
+  std::vector<PrototypeSlot> mActorPrototypes;
+  bool mActorPrototypesEnabled = true;
 };
 
 }
@@ -0,0 +1,108 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "entity_tag_index.hpp"
+
+#include <algorithm>
+
+
+namespace ex = entityx;
+
+namespace rigel::game_logic {
+
+using components::ActorTag;
+using components::AppearsOnRadar;
+using components::TileDebris;
+
+
+namespace {
+
+bool hasLowerIndex(const ex::Entity& lhs, const ex::Entity& rhs) {
+  return lhs.id().index() < rhs.id().index();
+}
+
+
+void insertSorted(EntityTagIndex::EntityList& list, ex::Entity entity) {
+  const auto iPos =
+    std::lower_bound(list.begin(), list.end(), entity, hasLowerIndex);
+  list.insert(iPos, entity);
+}
+
+
+void removeSorted(EntityTagIndex::EntityList& list, ex::Entity entity) {
+  const auto iPos =
+    std::lower_bound(list.begin(), list.end(), entity, hasLowerIndex);
+  if (iPos != list.end() && *iPos == entity) {
+    list.erase(iPos);
+  }
+}
+
+}
+
+
+EntityTagIndex::EntityTagIndex(ex::EventManager& events) {
+  events.subscribe<ex::ComponentAddedEvent<ActorTag>>(*this);
+  events.subscribe<ex::ComponentRemovedEvent<ActorTag>>(*this);
+  events.subscribe<ex::ComponentAddedEvent<AppearsOnRadar>>(*this);
+  events.subscribe<ex::ComponentRemovedEvent<AppearsOnRadar>>(*this);
+  events.subscribe<ex::ComponentAddedEvent<TileDebris>>(*this);
+  events.subscribe<ex::ComponentRemovedEvent<TileDebris>>(*this);
+}
+
+
+void EntityTagIndex::receive(const ex::ComponentAddedEvent<ActorTag>& event) {
+  const auto type = static_cast<std::size_t>(event.component->mType);
+  insertSorted(mEntitiesByActorTag[type], event.entity);
+}
+
+
+void EntityTagIndex::receive(
+  const ex::ComponentRemovedEvent<ActorTag>& event
+) {
+  const auto type = static_cast<std::size_t>(event.component->mType);
+  removeSorted(mEntitiesByActorTag[type], event.entity);
+}
+
+
+void EntityTagIndex::receive(
+  const ex::ComponentAddedEvent<AppearsOnRadar>& event
+) {
+  insertSorted(mEntitiesOnRadar, event.entity);
+}
+
+
+void EntityTagIndex::receive(
+  const ex::ComponentRemovedEvent<AppearsOnRadar>& event
+) {
+  removeSorted(mEntitiesOnRadar, event.entity);
+}
+
+
+void EntityTagIndex::receive(
+  const ex::ComponentAddedEvent<TileDebris>& event
+) {
+  insertSorted(mTileDebris, event.entity);
+}
+
+
+void EntityTagIndex::receive(
+  const ex::ComponentRemovedEvent<TileDebris>& event
+) {
+  removeSorted(mTileDebris, event.entity);
+}
+
+}
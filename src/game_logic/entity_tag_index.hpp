@@ -0,0 +1,82 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "base/warnings.hpp"
+#include "game_logic/actor_tag.hpp"
+#include "game_logic/dynamic_geometry_components.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <array>
+#include <vector>
+
+
+namespace rigel::game_logic {
+
+/** Keeps track of entities with certain marker components
+ *
+ * Some parts of the game need to look at all entities of a certain kind every
+ * frame, e.g. the radar needs all entities that appear on it, and rendering
+ * needs all water areas and tile debris pieces. Instead of scanning all
+ * entities each time, this class maintains lists of matching entities which
+ * are updated whenever the relevant components are added or removed.
+ *
+ * Lists are kept sorted by entity index, so iterating over them visits
+ * entities in the same order as entityx' each() would.
+ */
+class EntityTagIndex : public entityx::Receiver<EntityTagIndex> {
+public:
+  using EntityList = std::vector<entityx::Entity>;
+
+  explicit EntityTagIndex(entityx::EventManager& events);
+
+  const EntityList& entitiesWithTag(components::ActorTag::Type type) const {
+    return mEntitiesByActorTag[static_cast<std::size_t>(type)];
+  }
+
+  const EntityList& entitiesOnRadar() const {
+    return mEntitiesOnRadar;
+  }
+
+  const EntityList& tileDebris() const {
+    return mTileDebris;
+  }
+
+  void receive(
+    const entityx::ComponentAddedEvent<components::ActorTag>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::ActorTag>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::AppearsOnRadar>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::AppearsOnRadar>& event);
+  void receive(
+    const entityx::ComponentAddedEvent<components::TileDebris>& event);
+  void receive(
+    const entityx::ComponentRemovedEvent<components::TileDebris>& event);
+
+private:
+  std::array<EntityList, components::ActorTag::NUM_TYPES> mEntitiesByActorTag;
+  EntityList mEntitiesOnRadar;
+  EntityList mTileDebris;
+};
+
+}
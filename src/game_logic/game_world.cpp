@@ -17,6 +17,7 @@
 #include "game_world.hpp"
 
 #include "base/match.hpp"
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "common/user_profile.hpp"
 #include "data/game_options.hpp"
@@ -32,7 +33,10 @@
 #include "game_logic/collectable_components.hpp"
 #include "game_logic/dynamic_geometry_components.hpp"
 #include "game_logic/enemies/dying_boss.hpp"
+#include "game_logic/quick_save.hpp"
+#include "game_logic/rewind_buffer.hpp"
 #include "game_logic/world_state.hpp"
+#include "loader/file_utils.hpp"
 #include "loader/resource_loader.hpp"
 #include "renderer/upscaling_utils.hpp"
 #include "ui/menu_element_renderer.hpp"
@@ -40,9 +44,9 @@
 
 #include <cassert>
 #include <chrono>
+#include <cmath>
 #include <iomanip>
 #include <iostream>
-#include <sstream>
 
 
 
@@ -59,6 +63,9 @@ namespace {
 
 constexpr auto BOSS_LEVEL_INTRO_MUSIC = "CALM.IMF";
 
+// One snapshot per second of game time
+constexpr auto REWIND_SNAPSHOT_INTERVAL = 15;
+
 constexpr auto HEALTH_BAR_LABEL_START_X = 0;
 constexpr auto HEALTH_BAR_LABEL_START_Y = 0;
 constexpr auto HEALTH_BAR_TILE_INDEX = 4*40 + 1;
@@ -90,6 +97,16 @@ auto localToGlobalTranslation(
 }
 
 
+[[nodiscard]] auto offsetTranslation(
+  renderer::Renderer* pRenderer,
+  const base::Vector& offset
+) {
+  auto saved = renderer::saveState(pRenderer);
+  pRenderer->setGlobalTranslation(localToGlobalTranslation(pRenderer, offset));
+  return saved;
+}
+
+
 [[nodiscard]] auto setupIngameViewport(
   renderer::Renderer* pRenderer,
   const int screenShakeOffsetX
@@ -167,95 +184,218 @@ void setupWidescreenHudOffset(
 }
 
 
-std::vector<base::Vector> collectRadarDots(
-  entityx::EntityManager& entities,
-  const base::Vector& playerPosition
+base::ArenaVector<base::Vector> collectRadarDots(
+  const EntityTagIndex& index,
+  const base::Vector& playerPosition,
+  base::FrameArena* pArena
 ) {
   using engine::components::Active;
   using engine::components::WorldPosition;
-  using game_logic::components::AppearsOnRadar;
-
-  std::vector<base::Vector> radarDots;
-
-  entities.each<WorldPosition, AppearsOnRadar, Active>(
-    [&](
-      entityx::Entity,
-      const WorldPosition& position,
-      const AppearsOnRadar&,
-      const Active&
-    ) {
-      const auto positionRelativeToPlayer = position - playerPosition;
-      if (ui::isVisibleOnRadar(positionRelativeToPlayer)) {
-        radarDots.push_back(positionRelativeToPlayer);
-      }
-    });
+
+  auto radarDots = base::makeArenaVector<base::Vector>(pArena);
+
+  for (auto entity : index.entitiesOnRadar()) {
+    const auto position = entity.component<const WorldPosition>();
+    if (!position || !entity.has_component<Active>()) {
+      continue;
+    }
+
+    const auto positionRelativeToPlayer = *position - playerPosition;
+    if (ui::isVisibleOnRadar(positionRelativeToPlayer)) {
+      radarDots.push_back(positionRelativeToPlayer);
+    }
+  }
 
   return radarDots;
 }
 
 
-template<typename ValueT>
-std::string vec2String(const base::Point<ValueT>& vec, const int width) {
-  std::stringstream stream;
-  stream
-    << std::setw(width) << std::fixed << std::setprecision(2) << vec.x << ", "
-    << std::setw(width) << std::fixed << std::setprecision(2) << vec.y;
-  return stream.str();
+/** Prints a vector with padding, without creating a temporary string */
+struct PaddedVector {
+  base::Vector mVector;
+  int mWidth;
+};
+
+
+std::ostream& operator<<(std::ostream& stream, const PaddedVector& padded) {
+  return stream
+    << std::setw(padded.mWidth) << padded.mVector.x << ", "
+    << std::setw(padded.mWidth) << padded.mVector.y;
 }
 
 
-struct WaterEffectArea {
-  base::Rect<int> mArea;
-  bool mIsAnimated;
-};
+/** Invokes func(worldSpaceArea, isAnimated) for each water area */
+template <typename Func>
+void forEachWaterArea(const EntityTagIndex& index, Func&& func) {
+  using engine::components::BoundingBox;
+  using T = game_logic::components::ActorTag::Type;
+
+  // The original each() loop visited both kinds of water areas in entity
+  // order, so we merge the two (sorted) lists to preserve that.
+  const auto& animatedAreas = index.entitiesWithTag(T::AnimatedWaterArea);
+  const auto& regularAreas = index.entitiesWithTag(T::WaterArea);
+
+  auto iAnimated = animatedAreas.begin();
+  auto iRegular = regularAreas.begin();
+
+  while (iAnimated != animatedAreas.end() || iRegular != regularAreas.end()) {
+    const auto takeAnimated = iRegular == regularAreas.end() ||
+      (iAnimated != animatedAreas.end() &&
+       iAnimated->id().index() < iRegular->id().index());
+    auto entity = takeAnimated ? *iAnimated++ : *iRegular++;
+
+    const auto position = entity.component<const WorldPosition>();
+    const auto bbox = entity.component<const BoundingBox>();
+    if (!position || !bbox) {
+      continue;
+    }
+
+    func(engine::toWorldSpace(*bbox, *position), takeAnimated);
+  }
+}
 
 
-std::vector<WaterEffectArea> collectWaterEffectAreas(
-  entityx::EntityManager& es,
+void addWaterEffectAreaIfVisible(
+  base::ArenaVector<WaterEffectArea>& result,
+  const base::Rect<int>& worldSpaceArea,
+  const bool isAnimated,
   const base::Vector& cameraPosition,
   const base::Extents& viewPortSize
 ) {
-  using engine::components::BoundingBox;
-  using game_logic::components::ActorTag;
+  const auto screenBox = base::Rect<int>{cameraPosition, viewPortSize};
 
-  std::vector<WaterEffectArea> result;
-
-  const auto screenBox = BoundingBox{cameraPosition, viewPortSize};
-
-  es.each<ActorTag, WorldPosition, BoundingBox>(
-    [&](
-      entityx::Entity,
-      const ActorTag& tag,
-      const WorldPosition& position,
-      const BoundingBox& bbox
-    ) {
-      using T = ActorTag::Type;
-
-      const auto isWaterArea =
-        tag.mType == T::AnimatedWaterArea || tag.mType == T::WaterArea;
-      if (isWaterArea) {
-        const auto worldSpaceBbox = engine::toWorldSpace(bbox, position);
-
-        if (screenBox.intersects(worldSpaceBbox)) {
-          const auto topLeftPx =
-            data::tileVectorToPixelVector(
-              worldSpaceBbox.topLeft - cameraPosition);
-          const auto sizePx =
-            data::tileExtentsToPixelExtents(worldSpaceBbox.size);
-          const auto hasAnimatedSurface = tag.mType == T::AnimatedWaterArea;
-
-          result.push_back(
-            WaterEffectArea{{topLeftPx, sizePx}, hasAnimatedSurface});
-        }
-      }
-    });
+  if (screenBox.intersects(worldSpaceArea)) {
+    const auto topLeftPx =
+      data::tileVectorToPixelVector(worldSpaceArea.topLeft - cameraPosition);
+    const auto sizePx = data::tileExtentsToPixelExtents(worldSpaceArea.size);
+
+    result.push_back(WaterEffectArea{{topLeftPx, sizePx}, isAnimated});
+  }
+}
+
+
+base::ArenaVector<WaterEffectArea> collectWaterEffectAreas(
+  const EntityTagIndex& index,
+  const base::Vector& cameraPosition,
+  const base::Extents& viewPortSize,
+  base::FrameArena* pArena
+) {
+  auto result = base::makeArenaVector<WaterEffectArea>(pArena);
+
+  forEachWaterArea(index, [&](const auto& area, const bool isAnimated) {
+    addWaterEffectAreaIfVisible(
+      result, area, isAnimated, cameraPosition, viewPortSize);
+  });
 
   return result;
 }
 
+
+std::optional<int> bossHealth(const WorldState& state) {
+  using game_logic::components::Shootable;
+
+  if (!state.mActiveBossEntity) {
+    return std::nullopt;
+  }
+
+  return state.mActiveBossEntity.has_component<Shootable>()
+    ? state.mActiveBossEntity.component<const Shootable>()->mHealth : 0;
+}
+
+
+/** Make target's tiles equal to source's, both maps must have the same size */
+void applyTileChanges(const data::map::Map& source, data::map::Map& target) {
+  for (auto layer = 0; layer < 2; ++layer) {
+    for (auto y = 0; y < source.height(); ++y) {
+      const auto sourceRow = source.tileRow(layer, y);
+      const auto targetRow = target.tileRow(layer, y);
+      if (std::equal(sourceRow.begin(), sourceRow.end(), targetRow.begin())) {
+        continue;
+      }
+
+      for (auto x = 0; x < source.width(); ++x) {
+        if (sourceRow[x] != targetRow[x]) {
+          target.setTileAt(layer, x, y, sourceRow[x]);
+        }
+      }
+    }
+  }
+}
+
 }
 
 
+/** Everything render() needs to draw a frame, without access to the world
+ *
+ * Anything that depends on entities is collected in publishRenderSnapshot(),
+ * so that updating the snapshot only copies what's visible on screen and the
+ * map tiles that changed since the previous publish. The snapshot owns a map
+ * renderer for its own copy of the map. Debug overlays are not shown when
+ * drawing a snapshot, since they need access to entities.
+ */
+struct GameWorld::RenderSnapshot {
+  struct TileDebris {
+    data::map::TileIndex mTileIndex;
+    base::Vector mPosition;
+  };
+
+  RenderSnapshot(
+    renderer::Renderer* pRenderer,
+    data::map::LevelData&& level,
+    const data::PlayerModel& playerModel,
+    const ui::IngameMessageDisplay& messageDisplay
+  )
+    : mMap(std::move(level.mMap))
+    , mMapRenderer(
+        pRenderer,
+        &mMap,
+        engine::MapRenderer::MapRenderData{
+          std::move(level.mTileSetImage),
+          std::move(level.mBackdropImage),
+          std::move(level.mSecondaryBackdropImage),
+          level.mBackdropScrollMode})
+    , mParticles(nullptr, pRenderer)
+    , mPlayerModel(playerModel)
+    , mMessageDisplay(messageDisplay)
+  {
+  }
+
+  std::size_t memoryUsage() const {
+    const auto mapSize = static_cast<std::size_t>(mMap.width() * mMap.height());
+    return sizeof(RenderSnapshot) +
+      2 * mapSize * sizeof(data::map::TileIndex) +
+      mSprites.mSprites.capacity() * sizeof(engine::SpriteDrawSpec) +
+      mTileDebris.capacity() * sizeof(TileDebris) +
+      mWaterAreas.capacity() * sizeof(WaterEffectArea) +
+      mRadarDots.capacity() * sizeof(base::Vector);
+  }
+
+  data::map::Map mMap;
+  engine::MapRenderer mMapRenderer;
+
+  // Only drawn, never spawns particles, so it has no random number generator
+  engine::ParticleSystem mParticles;
+  engine::SpriteDrawList mSprites;
+  std::vector<TileDebris> mTileDebris;
+
+  // In world space, since visibility depends on the interpolated camera
+  std::vector<WaterEffectArea> mWaterAreas;
+  std::vector<base::Vector> mRadarDots;
+
+  base::Vector mCameraPosition;
+  base::Vector mPreviousCameraPosition;
+  std::optional<base::Color> mScreenFlashColor;
+  std::optional<base::Color> mBackdropFlashColor;
+  std::optional<int> mBossHealth;
+  int mScreenShakeOffsetX = 0;
+  int mWaterAnimStep = 0;
+  bool mBackdropSwitched = false;
+
+  data::PlayerModel mPlayerModel;
+  ui::IngameMessageDisplay mMessageDisplay;
+};
+
+
 GameWorld::GameWorld(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId& sessionId,
@@ -272,6 +412,7 @@ GameWorld::GameWorld(
   , mpOptions(&context.mpUserProfile->mOptions)
   , mpResources(context.mpResources)
   , mpSpriteFactory(context.mpSpriteFactory)
+  , mpFrameArena(context.mpFrameArena)
   , mSessionId(sessionId)
   , mPlayerModelAtLevelStart(*mpPlayerModel)
   , mHudRenderer(
@@ -290,7 +431,31 @@ GameWorld::GameWorld(
   , mWidescreenModeWasOn(
       mpOptions->mWidescreenModeOn &&
       renderer::canUseWidescreenMode(mpRenderer))
+  , mQuickSaveFilePath(context.mpUserProfile->quickSaveFilePath())
 {
+  if (mQuickSaveFilePath) {
+    std::error_code ec;
+    if (std::filesystem::exists(*mQuickSaveFilePath, ec)) {
+      try {
+        mHasPersistentQuickSave = isQuickSaveForSession(
+          loader::loadFile(*mQuickSaveFilePath),
+          mSessionId,
+          mPlayerModelAtLevelStart);
+      } catch (const std::exception&) {
+      }
+    }
+  }
+
+  const auto& commandLineOptions = mpServiceProvider->commandLineOptions();
+  if (
+    commandLineOptions.mDebugModeEnabled &&
+    commandLineOptions.mRewindHistorySeconds > 0
+  ) {
+    mpRewindBuffer = std::make_unique<RewindBuffer>(
+      static_cast<std::size_t>(commandLineOptions.mRewindHistorySeconds),
+      REWIND_SNAPSHOT_INTERVAL);
+  }
+
   using namespace std::chrono;
   auto before = high_resolution_clock::now();
 
@@ -314,6 +479,8 @@ GameWorld::GameWorld(
     mMessageDisplay.setMessage(data::Messages::FindAllRadars);
   }
 
+  publishRenderSnapshot();
+
   auto after = high_resolution_clock::now();
   std::cout << "Level load time: " <<
     duration<double>(after - before).count() * 1000.0 << " ms\n";
@@ -328,6 +495,11 @@ bool GameWorld::levelFinished() const {
 }
 
 
+bool GameWorld::playerDied() const {
+  return mpState->mPlayerDied;
+}
+
+
 std::set<data::Bonus> GameWorld::achievedBonuses() const {
   std::set<data::Bonus> bonuses;
 
@@ -335,9 +507,7 @@ std::set<data::Bonus> GameWorld::achievedBonuses() const {
     bonuses.insert(data::Bonus::NoDamageTaken);
   }
 
-  const auto counts =
-    countBonusRelatedItems(
-      const_cast<entityx::EntityManager&>(mpState->mEntities));
+  const auto counts = countBonusRelatedItems(mpState->mEntityTagIndex);
 
   if (mpState->mBonusInfo.mInitialCameraCount > 0 && counts.mCameraCount == 0) {
     bonuses.insert(data::Bonus::DestroyedAllCameras);
@@ -374,6 +544,23 @@ std::set<data::Bonus> GameWorld::achievedBonuses() const {
 }
 
 
+StateHash GameWorld::stateHash() const {
+  return computeStateHash(*mpState, *mpPlayerModel);
+}
+
+
+void GameWorld::setBehaviorUpdatesGroupedByType(const bool grouped) {
+  mBehaviorUpdatesGroupedByType = grouped;
+  applySimulationModes(*mpState);
+}
+
+
+void GameWorld::setGameEventsDeferred(const bool deferred) {
+  mGameEventsDeferred = deferred;
+  applySimulationModes(*mpState);
+}
+
+
 void GameWorld::receive(const rigel::events::CheckPointActivated& event) {
   mpState->mActivatedCheckpoint = CheckpointData{
     mpPlayerModel->makeCheckpoint(), event.mPosition};
@@ -476,6 +663,8 @@ void GameWorld::receive(const rigel::events::CloakExpired&) {
 
 
 void GameWorld::loadLevel(const PlayerInput& initialInput) {
+  RIGEL_TRACE_SCOPE("GameWorld::loadLevel");
+
   createNewState();
 
   mpState->mCamera.centerViewOnPlayer();
@@ -494,7 +683,27 @@ void GameWorld::createNewState() {
     unsubscribe(mpState->mEventManager);
   }
 
-  mpState = std::make_unique<WorldState>(
+  mpState = createStateForLevel();
+  mLevelStartMap = mpState->mMap;
+
+  if (mpServiceProvider->commandLineOptions().mThreadedSimulation) {
+    mpRenderSnapshot = std::make_unique<RenderSnapshot>(
+      mpRenderer,
+      loadLevelForSession(mSessionId, *mpResources),
+      *mpPlayerModel,
+      mMessageDisplay);
+  }
+
+  if (mpRewindBuffer) {
+    mpRewindBuffer->clear();
+  }
+
+  subscribe(mpState->mEventManager);
+}
+
+
+std::unique_ptr<WorldState> GameWorld::createStateForLevel() {
+  auto pState = std::make_unique<WorldState>(
     mpServiceProvider,
     mpRenderer,
     mpResources,
@@ -502,8 +711,21 @@ void GameWorld::createNewState() {
     mpOptions,
     mpSpriteFactory,
     mSessionId);
+  applySimulationModes(*pState);
+  return pState;
+}
 
-  subscribe(mpState->mEventManager);
+
+void GameWorld::applySimulationModes(WorldState& state) const {
+  using UpdateMode = BehaviorControllerSystem::UpdateMode;
+  using DispatchMode = engine::EventQueue::DispatchMode;
+
+  state.mBehaviorControllerSystem.setUpdateMode(
+    mBehaviorUpdatesGroupedByType
+      ? UpdateMode::GroupedByType
+      : UpdateMode::InEntityOrder);
+  state.mEventQueue.setDispatchMode(
+    mGameEventsDeferred ? DispatchMode::Deferred : DispatchMode::Immediate);
 }
 
 
@@ -543,7 +765,16 @@ void GameWorld::unsubscribe(entityx::EventManager& eventManager) {
 }
 
 
-void GameWorld::updateGameLogic(const PlayerInput& input) {
+void GameWorld::updateGameLogic(
+  const PlayerInput& input,
+  const bool prepareRendering
+) {
+  RIGEL_TRACE_SCOPE("GameWorld::updateGameLogic");
+
+  auto& eventQueue = mpState->mEventQueue;
+  eventQueue.beginFrame();
+  mpState->mEntityAllocationCounter.beginFrame();
+
   mpState->mBackdropFlashColor = std::nullopt;
   mpState->mScreenFlashColor = std::nullopt;
 
@@ -555,7 +786,12 @@ void GameWorld::updateGameLogic(const PlayerInput& input) {
     mpState->mEarthQuakeEffect->update();
   }
 
-  mHudRenderer.updateAnimation();
+  if (mpRenderSnapshot) {
+    ++mPendingHudAnimationSteps;
+  } else {
+    mHudRenderer.updateAnimation();
+  }
+
   mMessageDisplay.update();
 
   if (mpState->mActiveBossEntity && mpState->mBossDeathAnimationStartPending) {
@@ -595,6 +831,7 @@ void GameWorld::updateGameLogic(const PlayerInput& input) {
       mpState->mEarthQuakeEffect && mpState->mEarthQuakeEffect->isQuaking()});
 
   mpState->mPhysicsSystem.updatePhase1(mpState->mEntities);
+  eventQueue.dispatch();
 
   // Collect items after physics, so that any collectible
   // items are in their final positions for this frame.
@@ -602,6 +839,7 @@ void GameWorld::updateGameLogic(const PlayerInput& input) {
   mpState->mPlayerInteractionSystem.updateItemCollection(mpState->mEntities);
   mpState->mPlayerDamageSystem.update(mpState->mEntities);
   mpState->mDamageInflictionSystem.update(mpState->mEntities);
+  eventQueue.dispatch();
   mpState->mItemContainerSystem.update(mpState->mEntities);
   mpState->mPlayerProjectileSystem.update(mpState->mEntities);
 
@@ -611,17 +849,120 @@ void GameWorld::updateGameLogic(const PlayerInput& input) {
 
   // Now process any MovingBody objects that have been spawned after phase 1
   mpState->mPhysicsSystem.updatePhase2(mpState->mEntities);
+  eventQueue.dispatch();
 
   mpState->mParticles.update();
 
-  mpState->mSpriteRenderingSystem.update(
-    mpState->mEntities, viewPortSize, mpState->mCamera.position());
+  if (prepareRendering) {
+    mpState->mSpriteRenderingSystem.update(
+      mpState->mEntities,
+      viewPortSize,
+      mpState->mCamera.position(),
+      mpOptions->mMotionSmoothingOn);
+  }
 
   mpState->mIsOddFrame = !mpState->mIsOddFrame;
+
+  if (mpRewindBuffer) {
+    mpRewindBuffer->update(*mpState, mLevelStartMap, *mpPlayerModel);
+  }
 }
 
 
-void GameWorld::render() {
+void GameWorld::publishRenderSnapshot() {
+  if (!mpRenderSnapshot) {
+    return;
+  }
+
+  RIGEL_TRACE_SCOPE("GameWorld::publishRenderSnapshot");
+
+  using game_logic::components::TileDebris;
+
+  for (; mPendingHudAnimationSteps > 0; --mPendingHudAnimationSteps) {
+    mHudRenderer.updateAnimation();
+  }
+
+  auto& snapshot = *mpRenderSnapshot;
+  const auto& state = *mpState;
+
+  // Backdrop textures can't be copied, so we switch them in the same way as
+  // the original.
+  if (snapshot.mBackdropSwitched != state.mBackdropSwitched) {
+    snapshot.mMapRenderer.switchBackdrops();
+    snapshot.mBackdropSwitched = state.mBackdropSwitched;
+  }
+
+  applyTileChanges(state.mMap, snapshot.mMap);
+  snapshot.mMapRenderer.synchronizeTo(state.mMapRenderer);
+  snapshot.mParticles.synchronizeTo(state.mParticles);
+  snapshot.mSprites = state.mSpriteRenderingSystem.drawList();
+
+  snapshot.mTileDebris.clear();
+  for (auto entity : state.mEntityTagIndex.tileDebris()) {
+    const auto position = entity.component<const WorldPosition>();
+    if (position) {
+      snapshot.mTileDebris.push_back(
+        {entity.component<const TileDebris>()->mTileIndex, *position});
+    }
+  }
+
+  snapshot.mWaterAreas.clear();
+  forEachWaterArea(
+    state.mEntityTagIndex,
+    [&](const base::Rect<int>& area, const bool isAnimated) {
+      snapshot.mWaterAreas.push_back(WaterEffectArea{area, isAnimated});
+    });
+
+  const auto radarDots = collectRadarDots(
+    state.mEntityTagIndex, state.mPlayer.orientedPosition(), mpFrameArena);
+  snapshot.mRadarDots.assign(radarDots.begin(), radarDots.end());
+
+  snapshot.mCameraPosition = state.mCamera.position();
+  snapshot.mPreviousCameraPosition = state.mCamera.previousPosition();
+  snapshot.mScreenFlashColor = state.mScreenFlashColor;
+  snapshot.mBackdropFlashColor = state.mBackdropFlashColor;
+  snapshot.mBossHealth = bossHealth(state);
+  snapshot.mScreenShakeOffsetX = state.mScreenShakeOffsetX;
+  snapshot.mWaterAnimStep = state.mWaterAnimStep;
+
+  snapshot.mPlayerModel = *mpPlayerModel;
+  snapshot.mMessageDisplay = mMessageDisplay;
+}
+
+
+void GameWorld::updateBackdropAutoScrolling(const engine::TimeDelta dt) {
+  mpState->mMapRenderer.updateBackdropAutoScrolling(dt);
+
+  // Scrolling is purely visual and happens at render rate, so we apply it to
+  // the render snapshot as well instead of waiting for the next publish.
+  if (mpRenderSnapshot) {
+    mpRenderSnapshot->mMapRenderer.updateBackdropAutoScrolling(dt);
+  }
+}
+
+
+ui::IngameMessageDisplay& GameWorld::presentedMessageDisplay() {
+  return mpRenderSnapshot ? mpRenderSnapshot->mMessageDisplay : mMessageDisplay;
+}
+
+
+InterpolatedCamera GameWorld::interpolatedCamera(
+  const float interpolationFactor
+) const {
+  const auto [current, previous] = mpRenderSnapshot
+    ? std::pair{
+        mpRenderSnapshot->mCameraPosition,
+        mpRenderSnapshot->mPreviousCameraPosition}
+    : std::pair{
+        mpState->mCamera.position(), mpState->mCamera.previousPosition()};
+
+  return interpolateCamera(previous, current, interpolationFactor);
+}
+
+
+void GameWorld::render(const float interpolationFactor) {
+  RIGEL_TRACE_SCOPE("GameWorld::render");
+
   const auto widescreenModeOn =
     mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer);
 
@@ -630,7 +971,17 @@ void GameWorld::render() {
       mpRenderer, *mpOptions);
   }
 
-  auto drawWorld = [this](const base::Extents& viewPortSize) {
+  auto& state = *mpState;
+  const auto pSnapshot = mpRenderSnapshot.get();
+  const auto camera = interpolatedCamera(interpolationFactor);
+
+  const auto& screenFlashColor = pSnapshot
+    ? pSnapshot->mScreenFlashColor : state.mScreenFlashColor;
+  const auto screenShakeOffsetX = pSnapshot
+    ? pSnapshot->mScreenShakeOffsetX : state.mScreenShakeOffsetX;
+  auto& particles = pSnapshot ? pSnapshot->mParticles : state.mParticles;
+
+  auto drawWorld = [&, this](const base::Extents& viewPortSize) {
     const auto clipRectGuard = renderer::saveState(mpRenderer);
     mpRenderer->setClipRect(base::Rect<int>{
       mpRenderer->globalTranslation(),
@@ -638,47 +989,64 @@ void GameWorld::render() {
         data::tileExtentsToPixelExtents(viewPortSize),
         mpRenderer->globalScale())});
 
-    if (mpState->mScreenFlashColor) {
-      mpRenderer->clear(*mpState->mScreenFlashColor);
+    if (screenFlashColor) {
+      mpRenderer->clear(*screenFlashColor);
       return;
     }
 
+    const auto offsetGuard = offsetTranslation(mpRenderer, camera.mPixelOffset);
+
+    auto drawDebugInfo = [&]() {
+      // Debug overlays need the entities, which the render snapshot
+      // doesn't have.
+      if (pSnapshot) {
+        return;
+      }
+
+      // The debugging system draws relative to the most recent camera
+      // position, same as sprites.
+      const auto saved = offsetTranslation(mpRenderer, camera.mSpriteOffset);
+      state.mDebuggingSystem.update(state.mEntities, viewPortSize);
+    };
+
     if (mpOptions->mPerElementUpscalingEnabled) {
-      drawMapAndSprites(viewPortSize);
+      drawMapAndSprites(viewPortSize, camera, interpolationFactor);
 
       {
         const auto saved = mLowResLayer.bindAndReset();
 
         mpRenderer->clear({0, 0, 0, 0});
-        mpState->mParticles.render(mpState->mCamera.position());
-        mpState->mDebuggingSystem.update(mpState->mEntities, viewPortSize);
+        particles.render(camera.mTilePosition);
+        drawDebugInfo();
       }
 
       mLowResLayer.render(0, 0);
     } else {
-      drawMapAndSprites(viewPortSize);
-      mpState->mParticles.render(mpState->mCamera.position());
-      mpState->mDebuggingSystem.update(mpState->mEntities, viewPortSize);
+      drawMapAndSprites(viewPortSize, camera, interpolationFactor);
+      particles.render(camera.mTilePosition);
+      drawDebugInfo();
     }
   };
 
   auto drawTopRow = [&, this]() {
-    if (mpState->mActiveBossEntity) {
-      using game_logic::components::Shootable;
-
-      const auto health = mpState->mActiveBossEntity.has_component<Shootable>()
-        ? mpState->mActiveBossEntity.component<Shootable>()->mHealth : 0;
-
-      drawBossHealthBar(health, *mpTextRenderer, *mpUiSpriteSheet);
+    const auto health = pSnapshot ? pSnapshot->mBossHealth : bossHealth(state);
+    if (health) {
+      drawBossHealthBar(*health, *mpTextRenderer, *mpUiSpriteSheet);
     } else {
-      mMessageDisplay.render();
+      presentedMessageDisplay().render();
     }
   };
 
   auto drawHud = [&, this]() {
-    const auto radarDots =
-      collectRadarDots(mpState->mEntities, mpState->mPlayer.orientedPosition());
-    mHudRenderer.render(*mpPlayerModel, radarDots);
+    if (pSnapshot) {
+      mHudRenderer.render(pSnapshot->mPlayerModel, pSnapshot->mRadarDots);
+    } else {
+      const auto radarDots = collectRadarDots(
+        state.mEntityTagIndex,
+        state.mPlayer.orientedPosition(),
+        mpFrameArena);
+      mHudRenderer.render(*mpPlayerModel, radarDots);
+    }
   };
 
 
@@ -689,15 +1057,20 @@ void GameWorld::render() {
     const auto viewPortSize = base::Extents{
       info.mWidthTiles, data::GameTraits::viewPortHeightTiles - 1};
 
-    if (!mWidescreenModeWasOn) {
-      mpState->mSpriteRenderingSystem.update(
-        mpState->mEntities, viewPortSize, mpState->mCamera.position());
+    // With a render snapshot, the next published update will already use
+    // the widescreen viewport size.
+    if (!mWidescreenModeWasOn && !pSnapshot) {
+      state.mSpriteRenderingSystem.update(
+        state.mEntities,
+        viewPortSize,
+        state.mCamera.position(),
+        mpOptions->mMotionSmoothingOn);
     }
 
     if (mpOptions->mPerElementUpscalingEnabled) {
       {
         const auto saved = setupIngameViewportWidescreen(
-          mpRenderer, info, mpState->mScreenShakeOffsetX);
+          mpRenderer, info, screenShakeOffsetX);
 
         drawWorld(viewPortSize);
 
@@ -714,7 +1087,7 @@ void GameWorld::render() {
       drawTopRow();
 
       mpRenderer->setGlobalTranslation(base::Vector{
-        mpState->mScreenShakeOffsetX, data::GameTraits::inGameViewPortOffset.y});
+        screenShakeOffsetX, data::GameTraits::inGameViewPortOffset.y});
       drawWorld(viewPortSize);
 
       setupWidescreenHudOffset(mpRenderer, info.mWidthTiles);
@@ -722,8 +1095,7 @@ void GameWorld::render() {
     }
   } else {
     {
-      const auto saved = setupIngameViewport(
-        mpRenderer, mpState->mScreenShakeOffsetX);
+      const auto saved = setupIngameViewport(mpRenderer, screenShakeOffsetX);
 
       drawWorld(data::GameTraits::mapViewPortSize);
       drawHud();
@@ -732,8 +1104,7 @@ void GameWorld::render() {
     auto saved = renderer::saveState(mpRenderer);
     mpRenderer->setGlobalTranslation(localToGlobalTranslation(
       mpRenderer,
-      {mpState->mScreenShakeOffsetX + data::GameTraits::inGameViewPortOffset.x,
-      0}));
+      {screenShakeOffsetX + data::GameTraits::inGameViewPortOffset.x, 0}));
     drawTopRow();
   }
 
@@ -741,28 +1112,69 @@ void GameWorld::render() {
 }
 
 
-void GameWorld::drawMapAndSprites(const base::Extents& viewPortSize) {
+void GameWorld::drawMapAndSprites(
+  const base::Extents& visibleViewPortSize,
+  const InterpolatedCamera& camera,
+  const float interpolationFactor
+) {
   using game_logic::components::TileDebris;
 
-  auto& state = *mpState;
-  const auto& cameraPosition = mpState->mCamera.position();
+  const auto& state = *mpState;
+  const auto pSnapshot = mpRenderSnapshot.get();
+  const auto& cameraPosition = camera.mTilePosition;
+
+  const auto& mapRenderer =
+    pSnapshot ? pSnapshot->mMapRenderer : state.mMapRenderer;
+  const auto& backdropFlashColor = pSnapshot
+    ? pSnapshot->mBackdropFlashColor : state.mBackdropFlashColor;
+  const auto waterAnimStep =
+    pSnapshot ? pSnapshot->mWaterAnimStep : state.mWaterAnimStep;
+
+  // Only the draw list is taken from the snapshot, drawing it just needs the
+  // sprite rendering system's renderer and texture atlas.
+  const auto& spriteRenderer = state.mSpriteRenderingSystem;
+  const auto& sprites =
+    pSnapshot ? pSnapshot->mSprites : spriteRenderer.drawList();
+
+  // When the camera is in between two tiles, an additional row and column
+  // of the map becomes partially visible.
+  const auto viewPortSize = camera.mPixelOffset == base::Vector{}
+    ? visibleViewPortSize
+    : visibleViewPortSize + base::Extents{1, 1};
 
   auto renderBackgroundLayers = [&]() {
-    if (state.mBackdropFlashColor) {
+    if (backdropFlashColor) {
       mpRenderer->drawFilledRectangle(
         {{}, data::tileExtentsToPixelExtents(viewPortSize)},
-        *state.mBackdropFlashColor);
+        *backdropFlashColor);
     } else {
-      state.mMapRenderer.renderBackdrop(cameraPosition, viewPortSize);
+      mapRenderer.renderBackdrop(cameraPosition, viewPortSize);
     }
 
-    state.mMapRenderer.renderBackground(cameraPosition, viewPortSize);
-    state.mSpriteRenderingSystem.renderRegularSprites();
+    mapRenderer.renderBackground(cameraPosition, viewPortSize);
+
+    const auto saved = offsetTranslation(mpRenderer, camera.mSpriteOffset);
+    spriteRenderer.renderRegularSprites(sprites, interpolationFactor);
   };
 
 
-  const auto waterEffectAreas = collectWaterEffectAreas(
-    state.mEntities, cameraPosition, viewPortSize);
+  const auto waterEffectAreas = [&]() {
+    if (!pSnapshot) {
+      return collectWaterEffectAreas(
+        state.mEntityTagIndex,
+        cameraPosition,
+        viewPortSize,
+        mpFrameArena);
+    }
+
+    auto result = base::makeArenaVector<WaterEffectArea>(mpFrameArena);
+    for (const auto& area : pSnapshot->mWaterAreas) {
+      addWaterEffectAreaIfVisible(
+        result, area.mArea, area.mIsAnimated, cameraPosition, viewPortSize);
+    }
+    return result;
+  }();
+
   if (waterEffectAreas.empty()) {
     renderBackgroundLayers();
   } else {
@@ -782,20 +1194,34 @@ void GameWorld::drawMapAndSprites(const base::Extents& viewPortSize) {
       mpRenderer->drawWaterEffect(
         area.mArea,
         mWaterEffectBuffer.data(),
-        area.mIsAnimated
-          ? std::optional<int>(state.mWaterAnimStep) : std::nullopt);
+        area.mIsAnimated ? std::optional<int>(waterAnimStep) : std::nullopt);
     }
   }
 
-  state.mMapRenderer.renderForeground(cameraPosition, viewPortSize);
-  state.mSpriteRenderingSystem.renderForegroundSprites();
+  mapRenderer.renderForeground(cameraPosition, viewPortSize);
+
+  {
+    const auto saved = offsetTranslation(mpRenderer, camera.mSpriteOffset);
+    spriteRenderer.renderForegroundSprites(sprites, interpolationFactor);
+  }
 
   // tile debris
-  state.mEntities.each<TileDebris, WorldPosition>(
-    [&](entityx::Entity, const TileDebris& debris, const WorldPosition& pos) {
-      state.mMapRenderer.renderSingleTile(
-        debris.mTileIndex, pos, cameraPosition);
-    });
+  if (pSnapshot) {
+    for (const auto& debris : pSnapshot->mTileDebris) {
+      mapRenderer.renderSingleTile(
+        debris.mTileIndex, debris.mPosition, cameraPosition);
+    }
+  } else {
+    for (auto entity : state.mEntityTagIndex.tileDebris()) {
+      const auto position = entity.component<const WorldPosition>();
+      if (position) {
+        mapRenderer.renderSingleTile(
+          entity.component<const TileDebris>()->mTileIndex,
+          *position,
+          cameraPosition);
+      }
+    }
+  }
 }
 
 
@@ -805,6 +1231,10 @@ void GameWorld::processEndOfFrameActions() {
   handleTeleporter();
 
   mpState->mScreenShakeOffsetX = 0;
+
+  mWorldStateMemory.setSize(
+    mpState->memoryUsage() +
+    (mpRenderSnapshot ? mpRenderSnapshot->memoryUsage() : 0));
 }
 
 
@@ -871,22 +1301,20 @@ void GameWorld::quickSave() {
     return;
   }
 
-  auto pStateCopy = std::make_unique<WorldState>(
-    mpServiceProvider,
-    mpRenderer,
-    mpResources,
-    mpPlayerModel,
-    mpOptions,
-    mpSpriteFactory,
-    mSessionId);
+  auto pStateCopy = createStateForLevel();
   pStateCopy->synchronizeTo(
     *mpState,
     mpServiceProvider,
     mpPlayerModel,
     mSessionId);
 
-  mpQuickSave = std::make_unique<QuickSaveData>(
-    QuickSaveData{*mpPlayerModel, std::move(pStateCopy)});
+  const auto stateSize = pStateCopy->memoryUsage();
+  mpQuickSave = std::make_unique<QuickSaveData>(QuickSaveData{
+    *mpPlayerModel,
+    std::move(pStateCopy),
+    base::TrackedMemory{base::MemoryTag::SavedWorldState, stateSize}});
+
+  writePersistentQuickSave();
 
   mMessageDisplay.setMessage("Quick saved.");
 }
@@ -897,25 +1325,115 @@ void GameWorld::quickLoad() {
     return;
   }
 
-  *mpPlayerModel = mpQuickSave->mPlayerModel;
-  mpState->synchronizeTo(
-    *mpQuickSave->mpState,
-    mpServiceProvider,
-    mpPlayerModel,
-    mSessionId);
+  // The in-memory quick save is exact, so it's preferred. The persistent one
+  // is only used when there's nothing in memory, e.g. after restarting the
+  // game.
+  if (mpQuickSave) {
+    *mpPlayerModel = mpQuickSave->mPlayerModel;
+    mpState->synchronizeTo(
+      *mpQuickSave->mpState,
+      mpServiceProvider,
+      mpPlayerModel,
+      mSessionId);
+  } else if (!restorePersistentQuickSave()) {
+    mMessageDisplay.setMessage("Quick save could not be restored.");
+    return;
+  }
+
   mMessageDisplay.setMessage("Quick save restored.");
+  mpState->mSpriteRenderingSystem.forgetPreviousPositions();
 
   const auto& viewPortSize =
     mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer)
       ? viewPortSizeWideScreen(mpRenderer)
       : data::GameTraits::mapViewPortSize;
   mpState->mSpriteRenderingSystem.update(
-    mpState->mEntities, viewPortSize, mpState->mCamera.position());
+    mpState->mEntities,
+    viewPortSize,
+    mpState->mCamera.position(),
+    mpOptions->mMotionSmoothingOn);
+  publishRenderSnapshot();
 }
 
 
 bool GameWorld::canQuickLoad() const {
-  return mpOptions->mQuickSavingEnabled && mpQuickSave;
+  return
+    mpOptions->mQuickSavingEnabled && (mpQuickSave || mHasPersistentQuickSave);
+}
+
+
+void GameWorld::rewind() {
+  if (!mpRewindBuffer || !mpRewindBuffer->canRewind()) {
+    return;
+  }
+
+  mpRewindBuffer->rewind(
+    *mpState, mLevelStartMap, mpServiceProvider, mpPlayerModel, mSessionId);
+  mpState->mSpriteRenderingSystem.forgetPreviousPositions();
+
+  const auto& viewPortSize =
+    mpOptions->mWidescreenModeOn && renderer::canUseWidescreenMode(mpRenderer)
+      ? viewPortSizeWideScreen(mpRenderer)
+      : data::GameTraits::mapViewPortSize;
+  mpState->mSpriteRenderingSystem.update(
+    mpState->mEntities,
+    viewPortSize,
+    mpState->mCamera.position(),
+    mpOptions->mMotionSmoothingOn);
+  publishRenderSnapshot();
+}
+
+
+void GameWorld::writePersistentQuickSave() {
+  if (!mQuickSaveFilePath) {
+    return;
+  }
+
+  try {
+    const auto data = serializeQuickSave(
+      *mpState,
+      mLevelStartMap,
+      QuickSavePlayerModels{*mpPlayerModel, mPlayerModelAtLevelStart},
+      mSessionId);
+    loader::saveToFileAtomically(data, *mQuickSaveFilePath);
+    mHasPersistentQuickSave = true;
+  } catch (const std::exception& ex) {
+    std::cerr << "WARNING: Failed to store quick save, keeping it in memory "
+      << "only: " << ex.what() << '\n';
+
+    // A previously stored quick save is outdated now, so it must not be
+    // picked up after restarting the game.
+    std::error_code ec;
+    std::filesystem::remove(*mQuickSaveFilePath, ec);
+    mHasPersistentQuickSave = false;
+  }
+}
+
+
+bool GameWorld::restorePersistentQuickSave() {
+  try {
+    const auto data = loader::loadFile(*mQuickSaveFilePath);
+
+    // Restore into a separate state first, so that the current one stays
+    // untouched in case the quick save turns out to be invalid.
+    auto pNewState = createStateForLevel();
+    auto playerModel = restoreQuickSave(
+      data, *pNewState, mSessionId, mPlayerModelAtLevelStart);
+
+    unsubscribe(mpState->mEventManager);
+    mpState = std::move(pNewState);
+    subscribe(mpState->mEventManager);
+
+    *mpPlayerModel = std::move(playerModel);
+
+    if (mpRewindBuffer) {
+      mpRewindBuffer->clear();
+    }
+    return true;
+  } catch (const std::exception& ex) {
+    std::cerr << "WARNING: Failed to restore quick save: " << ex.what() << '\n';
+    return false;
+  }
 }
 
 
@@ -982,6 +1500,7 @@ void GameWorld::restartLevel() {
     mMessageDisplay.setMessage(data::Messages::FindAllRadars);
   }
 
+  publishRenderSnapshot();
   render();
 
   mpServiceProvider->fadeInScreen();
@@ -1004,6 +1523,7 @@ void GameWorld::restartFromCheckpoint() {
 
   mpState->mCamera.centerViewOnPlayer();
   updateGameLogic({});
+  publishRenderSnapshot();
   render();
 
   mpServiceProvider->fadeInScreen();
@@ -1030,6 +1550,7 @@ void GameWorld::handleTeleporter() {
 
   mpState->mCamera.centerViewOnPlayer();
   updateGameLogic({});
+  publishRenderSnapshot();
   mpServiceProvider->fadeInScreen();
 }
 
@@ -1044,9 +1565,42 @@ void GameWorld::showTutorialMessage(const data::TutorialMessageId id) {
 
 void GameWorld::printDebugText(std::ostream& stream) const {
   stream
-    << "Scroll: " << vec2String(mpState->mCamera.position(), 4) << '\n'
-    << "Player: " << vec2String(mpState->mPlayer.position(), 4) << '\n'
+    << "Scroll: " << PaddedVector{mpState->mCamera.position(), 4} << '\n'
+    << "Player: " << PaddedVector{mpState->mPlayer.position(), 4} << '\n'
     << "Entities: " << mpState->mEntities.size() << '\n';
+
+  const auto& allocations = mpState->mEntityAllocationCounter;
+  stream
+    << "Spawned: " << allocations.lastFrame().mCreated
+    << " (peak " << allocations.peakCreatedPerFrame()
+    << "), destroyed: " << allocations.lastFrame().mDestroyed
+    << ", new slots: " << allocations.lastFrame().mSlotsAllocated << '\n';
+
+  for (const auto& stats : mpState->mEventQueue.statistics()) {
+    stream
+      << stats.mName << ": " << stats.mPostedThisFrame
+      << " (total " << stats.mPostedTotal
+      << ", dropped " << stats.mDroppedTotal << ")\n";
+  }
+
+  if (mpRewindBuffer) {
+    const auto seconds =
+      mpRewindBuffer->historyLengthInFrames() * GAME_LOGIC_UPDATE_DELAY;
+    const auto kiloBytes = mpRewindBuffer->memoryUsage() / 1024.0;
+
+    stream
+      << "Rewind: " << mpRewindBuffer->size() << " snapshots, "
+      << std::fixed << std::setprecision(1) << seconds << " s, "
+      << kiloBytes << " KB";
+    if (seconds > 0.0) {
+      stream << " (" << kiloBytes / seconds << " KB/s)";
+    }
+    if (const auto duration = mpRewindBuffer->lastRestoreDuration()) {
+      stream
+        << ", restore " << std::setprecision(2) << *duration * 1000.0 << " ms";
+    }
+    stream << '\n';
+  }
 }
 
 }
@@ -17,17 +17,22 @@
 #pragma once
 
 #include "base/color.hpp"
+#include "base/frame_arena.hpp"
+#include "base/memory_tracking.hpp"
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "common/game_mode.hpp"
 #include "common/global.hpp"
 #include "data/bonus.hpp"
 #include "data/game_session_data.hpp"
+#include "data/map.hpp"
 #include "data/player_model.hpp"
 #include "data/tutorial_messages.hpp"
 #include "engine/sprite_factory.hpp"
+#include "engine/timing.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/input.hpp"
+#include "game_logic/state_hash.hpp"
 #include "ui/hud_renderer.hpp"
 #include "ui/ingame_message_display.hpp"
 
@@ -35,6 +40,7 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <filesystem>
 #include <iosfwd>
 #include <optional>
 #include <vector>
@@ -57,8 +63,16 @@ namespace rigel::game_logic {
 constexpr auto GAME_LOGIC_UPDATE_DELAY = 1.0/15.0;
 
 
+class RewindBuffer;
+struct InterpolatedCamera;
 struct WorldState;
 
+
+struct WaterEffectArea {
+  base::Rect<int> mArea;
+  bool mIsAnimated;
+};
+
 class GameWorld : public entityx::Receiver<GameWorld> {
 public:
   GameWorld(
@@ -71,8 +85,34 @@ public:
   ~GameWorld(); // NOLINT
 
   bool levelFinished() const;
+
+  /** True if the player died during the last call to updateGameLogic()
+   *
+   * Reset by processEndOfFrameActions(), which respawns the player.
+   */
+  bool playerDied() const;
   std::set<data::Bonus> achievedBonuses() const;
 
+  /** Fingerprint of the current game state, see StateHash */
+  StateHash stateHash() const;
+
+  /** Use BehaviorControllerSystem::UpdateMode::GroupedByType
+   *
+   * Off by default. Changes gameplay subtly, so this must not be used for
+   * playing back demos.
+   */
+  void setBehaviorUpdatesGroupedByType(bool grouped);
+
+  /** Use engine::EventQueue::DispatchMode::Deferred for game logic events
+   *
+   * Physics and damage events are then forwarded to receivers at fixed
+   * points in updateGameLogic(), instead of in the middle of the posting
+   * system's update. Off by default, since this changes the order in which
+   * things happen compared to the original game. Must not be used for
+   * playing back demos.
+   */
+  void setGameEventsDeferred(bool deferred);
+
   void receive(const rigel::events::CheckPointActivated& event);
   void receive(const rigel::events::ExitReached& event);
   void receive(const rigel::events::PlayerDied& event);
@@ -88,10 +128,39 @@ public:
   void receive(const rigel::events::CloakPickedUp& event);
   void receive(const rigel::events::CloakExpired& event);
 
-  void updateGameLogic(const PlayerInput& input);
-  void render();
+  /** Advance the game by one logic frame
+   *
+   * If the result of the update won't be presented (e.g. because multiple
+   * updates are run before the next render() call), prepareRendering can be
+   * set to false to skip collecting sprites for rendering.
+   */
+  void updateGameLogic(const PlayerInput& input, bool prepareRendering = true);
+
+  /** Draw the current state of the world
+   *
+   * With an interpolation factor below 1.0, sprites and the camera are drawn
+   * in between their positions after the previous and the most recent call
+   * to updateGameLogic(). This allows for smoother motion when rendering at
+   * a higher frame rate than the game logic runs at. A factor of 0.0
+   * corresponds to the previous update.
+   */
+  void render(float interpolationFactor = 1.0f);
   void processEndOfFrameActions();
 
+  /** Make the results of the most recent updates visible to render()
+   *
+   * Only needed when running with a simulation thread (see
+   * CommandLineOptions::mThreadedSimulation). render() then draws a
+   * snapshot of the visible parts of the world, so that it can run
+   * concurrently to updateGameLogic(). This function brings the snapshot up
+   * to date. It must not be called while an update is in progress. Does
+   * nothing in single-threaded mode.
+   */
+  void publishRenderSnapshot();
+
+  /** Advance backdrop auto-scrolling, should be called once per frame */
+  void updateBackdropAutoScrolling(engine::TimeDelta dt);
+
   void activateFullHealthCheat();
   void activateGiveItemsCheat();
 
@@ -99,11 +168,16 @@ public:
   void quickLoad();
   bool canQuickLoad() const;
 
+  /** Go back in time, see RewindBuffer. Only available in debug mode */
+  void rewind();
+
   friend class rigel::GameRunner;
 
 private:
   void loadLevel(const PlayerInput& initialInput);
   void createNewState();
+  std::unique_ptr<WorldState> createStateForLevel();
+  void applySimulationModes(WorldState& state) const;
   void subscribe(entityx::EventManager& eventManager);
   void unsubscribe(entityx::EventManager& eventManager);
 
@@ -118,14 +192,27 @@ private:
   void updateTemporaryItemExpiration();
   void showTutorialMessage(const data::TutorialMessageId id);
 
+  void writePersistentQuickSave();
+  bool restorePersistentQuickSave();
+
   void printDebugText(std::ostream& stream) const;
 
 private:
-  void drawMapAndSprites(const base::Extents& viewPortSize);
+  /** Copy of everything render() needs, see publishRenderSnapshot() */
+  struct RenderSnapshot;
+
+  ui::IngameMessageDisplay& presentedMessageDisplay();
+
+  InterpolatedCamera interpolatedCamera(float interpolationFactor) const;
+  void drawMapAndSprites(
+    const base::Extents& viewPortSize,
+    const InterpolatedCamera& camera,
+    float interpolationFactor);
 
   struct QuickSaveData {
     data::PlayerModel mPlayerModel;
     std::unique_ptr<WorldState> mpState;
+    base::TrackedMemory mMemoryTracking;
   };
 
   renderer::Renderer* mpRenderer;
@@ -136,6 +223,7 @@ private:
   const data::GameOptions* mpOptions;
   const loader::ResourceLoader* mpResources;
   engine::SpriteFactory* mpSpriteFactory;
+  base::FrameArena* mpFrameArena;
   data::GameSessionId mSessionId;
 
   data::PlayerModel mPlayerModelAtLevelStart;
@@ -144,9 +232,29 @@ private:
   renderer::RenderTargetTexture mWaterEffectBuffer;
   renderer::RenderTargetTexture mLowResLayer;
   bool mWidescreenModeWasOn;
+  bool mBehaviorUpdatesGroupedByType = false;
+  bool mGameEventsDeferred = false;
 
   std::unique_ptr<WorldState> mpState;
   std::unique_ptr<QuickSaveData> mpQuickSave;
+
+  // Covers mpState and the render snapshot, updated once per frame in
+  // processEndOfFrameActions()
+  base::TrackedMemory mWorldStateMemory{base::MemoryTag::WorldState};
+
+  // Only used when running with a simulation thread. Updates must not touch
+  // the HUD renderer in that case, as it's used for rendering the snapshot
+  // concurrently. HUD animation steps are applied when publishing instead.
+  std::unique_ptr<RenderSnapshot> mpRenderSnapshot;
+  int mPendingHudAnimationSteps = 0;
+
+  // Persistent quick saves are stored as differences to the level's
+  // initial map, see quick_save.hpp
+  data::map::Map mLevelStartMap;
+  std::optional<std::filesystem::path> mQuickSaveFilePath;
+  bool mHasPersistentQuickSave = false;
+
+  std::unique_ptr<RewindBuffer> mpRewindBuffer;
 };
 
 }
@@ -43,6 +43,11 @@ namespace rigel {
     struct IEntityFactory;
     class Player;
   }
+
+  namespace loader {
+    class LeStreamReader;
+    class LeStreamWriter;
+  }
 }
 
 
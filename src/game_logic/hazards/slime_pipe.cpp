@@ -25,6 +25,7 @@
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/damage_components.hpp"
 #include "game_logic/ientity_factory.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -84,6 +85,16 @@ void SlimePipe::update(
 }
 
 
+void SlimePipe::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mGameFramesSinceLastDrop);
+}
+
+
+void SlimePipe::readState(loader::LeStreamReader& reader) {
+  mGameFramesSinceLastDrop = reader.readS32();
+}
+
+
 void SlimeDrop::onCollision(
   GlobalDependencies& dependencies,
   GlobalState& state,
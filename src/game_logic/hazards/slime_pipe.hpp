@@ -33,6 +33,9 @@ struct SlimePipe {
     GlobalState& state,
     bool isOnScreen,
     entityx::Entity entity);
+
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
 };
 
 
@@ -19,6 +19,7 @@
 #include "common/game_service_provider.hpp"
 #include "engine/visual_components.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -110,4 +111,18 @@ void BlowingFan::update(
   }
 }
 
+
+void BlowingFan::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mStep);
+  writeEnum(writer, mState);
+  writeBool(writer, mIsPushingPlayer);
+}
+
+
+void BlowingFan::readState(loader::LeStreamReader& reader) {
+  mStep = readIntInRange(reader, 0, 60);
+  mState = readEnum(reader, State::SlowingDown);
+  mIsPushingPlayer = readBool(reader);
+}
+
 }
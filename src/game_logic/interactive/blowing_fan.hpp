@@ -35,6 +35,9 @@ struct BlowingFan {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mStep = 0;
   State mState = State::SpeedingUp;
   bool mIsPushingPlayer = false;
@@ -18,6 +18,7 @@
 
 #include "engine/visual_components.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 #include <array>
 
@@ -126,4 +127,18 @@ void behaviors::RadarComputer::update(
   }
 }
 
+
+void behaviors::RadarComputer::writeState(
+  loader::LeStreamWriter& writer
+) const {
+  writer.writeS32(mAnimationStep);
+}
+
+
+void behaviors::RadarComputer::readState(
+  loader::LeStreamReader& reader
+) {
+  mAnimationStep = readIntInRange(reader, 0, NUM_ANIMATION_STEPS - 1);
+}
+
 }
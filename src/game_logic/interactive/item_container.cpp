@@ -16,6 +16,7 @@
 
 #include "item_container.hpp"
 
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "data/sound_ids.hpp"
 #include "engine/base_components.hpp"
@@ -28,6 +29,7 @@
 #include "game_logic/effect_components.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/spawn_origin.hpp"
 
 
 namespace rigel::game_logic {
@@ -41,6 +43,7 @@ using engine::components::Sprite;
 using engine::components::WorldPosition;
 using game_logic::components::ItemBounceEffect;
 using game_logic::components::ItemContainer;
+using game_logic::components::SpawnOrigin;
 
 constexpr int ITEM_BOUNCE_SEQUENCE[] = {-3, -2, -1, 0, 1, 2, 3, -1, 1};
 
@@ -60,6 +63,8 @@ ItemContainerSystem::ItemContainerSystem(
 
 
 void ItemContainerSystem::update(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("ItemContainerSystem::update");
+
   using RS = ItemContainer::ReleaseStyle;
 
   auto releaseItem = [this](
@@ -72,6 +77,20 @@ void ItemContainerSystem::update(entityx::EntityManager& es) {
     }
 
     contents.assign<WorldPosition>(*entity.component<WorldPosition>());
+
+    // Record where the contents came from, so that they can be re-created
+    // when restoring a quick save
+    if (entity.has_component<SpawnOrigin>()) {
+      const auto& origin = *entity.component<SpawnOrigin>();
+      if (origin.mType == SpawnOrigin::Type::Actor) {
+        contents.assign<SpawnOrigin>(
+          SpawnOrigin::containerContents(origin.mActorId, 1));
+      } else if (origin.mType == SpawnOrigin::Type::ContainerContents) {
+        contents.assign<SpawnOrigin>(SpawnOrigin::containerContents(
+          origin.mActorId, origin.mContainerDepth + 1));
+      }
+    }
+
     return contents;
   };
 
@@ -128,6 +147,8 @@ void ItemContainerSystem::update(entityx::EntityManager& es) {
 
 
 void ItemContainerSystem::updateItemBounce(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("ItemContainerSystem::updateItemBounce");
+
   es.each<WorldPosition, BoundingBox, MovingBody, ItemBounceEffect>(
     [this](
       entityx::Entity entity,
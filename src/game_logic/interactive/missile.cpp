@@ -28,6 +28,7 @@
 #include "game_logic/effect_components.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/global_dependencies.hpp"
+#include "game_logic/quick_save_tools.hpp"
 #include "loader/palette.hpp"
 
 
@@ -148,6 +149,18 @@ void Missile::onKilled(
 }
 
 
+void Missile::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mFramesElapsed);
+  writeBool(writer, mIsActive);
+}
+
+
+void Missile::readState(loader::LeStreamReader& reader) {
+  mFramesElapsed = reader.readS32();
+  mIsActive = readBool(reader);
+}
+
+
 void BrokenMissile::update(
   GlobalDependencies& d,
   GlobalState& state,
@@ -207,4 +220,16 @@ void BrokenMissile::onKilled(
   }
 }
 
+
+void BrokenMissile::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mFramesElapsed);
+  writeBool(writer, mIsActive);
+}
+
+
+void BrokenMissile::readState(loader::LeStreamReader& reader) {
+  mFramesElapsed = reader.readS32();
+  mIsActive = readBool(reader);
+}
+
 }
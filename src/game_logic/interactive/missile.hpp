@@ -26,6 +26,7 @@ RIGEL_RESTORE_WARNINGS
 
 namespace rigel::game_logic { struct GlobalDependencies; }
 namespace rigel::game_logic { struct GlobalState; }
+namespace rigel::loader { class LeStreamReader; class LeStreamWriter; }
 
 namespace rigel::game_logic::behaviors {
 
@@ -42,6 +43,9 @@ struct Missile {
     const base::Point<float>& inflictorVelocity,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mFramesElapsed = 0;
   bool mIsActive = false;
 };
@@ -60,6 +64,9 @@ struct BrokenMissile {
     const base::Point<float>& inflictorVelocity,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   int mFramesElapsed = 0;
   bool mIsActive = false;
 };
@@ -24,6 +24,7 @@
 #include "engine/visual_components.hpp"
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::interaction {
@@ -109,4 +110,16 @@ void RespawnCheckpoint::update(
   }
 }
 
+
+void RespawnCheckpoint::writeState(loader::LeStreamWriter& writer) const {
+  writeBool(writer, mInitialized);
+  writeOptionalInt(writer, mActivationCountdown);
+}
+
+
+void RespawnCheckpoint::readState(loader::LeStreamReader& reader) {
+  mInitialized = readBool(reader);
+  mActivationCountdown = readOptionalInt(reader);
+}
+
 }
@@ -30,6 +30,9 @@ struct RespawnCheckpoint {
     bool isOnScreen,
     entityx::Entity entity);
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   bool mInitialized = false;
   std::optional<int> mActivationCountdown;
 };
@@ -25,6 +25,7 @@
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 #include <algorithm>
 
@@ -237,4 +238,18 @@ void VerticalSlidingDoor::update(
   }
 }
 
+
+void VerticalSlidingDoor::writeState(loader::LeStreamWriter& writer) const {
+  writeEnum(writer, mState);
+  writeBool(writer, mPlayerWasInRange);
+  writer.writeS32(mSlideStep);
+}
+
+
+void VerticalSlidingDoor::readState(loader::LeStreamReader& reader) {
+  mState = readEnum(reader, State::Closing);
+  mPlayerWasInRange = readBool(reader);
+  mSlideStep = readIntInRange(reader, 0, 7);
+}
+
 }
@@ -28,6 +28,7 @@
 #include "game_logic/damage_components.hpp"
 #include "game_logic/ientity_factory.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 #include "loader/palette.hpp"
 
 
@@ -149,4 +150,16 @@ void SuperForceField::startFizzle() {
   }
 }
 
+
+void SuperForceField::writeState(loader::LeStreamWriter& writer) const {
+  writeOptionalInt(writer, mFizzleFramesElapsed);
+  writeOptionalInt(writer, mDestructionFramesElapsed);
+}
+
+
+void SuperForceField::readState(loader::LeStreamReader& reader) {
+  mFizzleFramesElapsed = readOptionalInt(reader);
+  mDestructionFramesElapsed = readOptionalInt(reader);
+}
+
 }
@@ -38,6 +38,9 @@ struct SuperForceField {
 
   void startFizzle();
 
+  void writeState(loader::LeStreamWriter& writer) const;
+  void readState(loader::LeStreamReader& reader);
+
   std::optional<int> mFizzleFramesElapsed;
   std::optional<int> mDestructionFramesElapsed;
 };
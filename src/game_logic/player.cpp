@@ -18,6 +18,7 @@
 
 #include "base/match.hpp"
 #include "base/math_tools.hpp"
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "common/global.hpp"
 #include "data/game_options.hpp"
@@ -334,29 +335,61 @@ void Player::synchronizeTo(
   const Player& other,
   entityx::EntityManager& es
 ) {
-  using game_logic::components::ActorTag;
-
-  mGodModeOn = other.mGodModeOn;
-  mState = other.mState;
-  mHitBox = other.mHitBox;
-  mStance = other.mStance;
-  mVisualState = other.mVisualState;
-  mMercyFramesPerHit = other.mMercyFramesPerHit;
-  mMercyFramesRemaining = other.mMercyFramesRemaining;
-  mFramesElapsedHavingRapidFire = other.mFramesElapsedHavingRapidFire;
-  mFramesElapsedHavingCloak = other.mFramesElapsedHavingCloak;
-  mAttachedSpiders = other.mAttachedSpiders;
-  mRapidFiredLastFrame = other.mRapidFiredLastFrame;
-  mIsOddFrame = other.mIsOddFrame;
-  mRecoilAnimationActive = other.mRecoilAnimationActive;
-  mIsRidingElevator = other.mIsRidingElevator;
-  mJumpRequested = other.mJumpRequested;
+  restoreSnapshot(other.snapshot(), es);
 
   *mEntity.component<c::Sprite>() = *other.mEntity.component<const c::Sprite>();
   *mEntity.component<c::BoundingBox>() =
     *other.mEntity.component<const c::BoundingBox>();
+}
+
+
+Player::Snapshot Player::snapshot() const {
+  return Snapshot{
+    mState,
+    mHitBox,
+    mStance,
+    mVisualState,
+    mMercyFramesPerHit,
+    mMercyFramesRemaining,
+    mFramesElapsedHavingRapidFire,
+    mFramesElapsedHavingCloak,
+    mAttachedSpiders,
+    mGodModeOn,
+    mRapidFiredLastFrame,
+    mFiredLastFrame,
+    mIsOddFrame,
+    mRecoilAnimationActive,
+    mIsRidingElevator,
+    mJumpRequested,
+    static_cast<bool>(mAttachedElevator)};
+}
 
-  if (other.mAttachedElevator) {
+
+void Player::restoreSnapshot(
+  const Snapshot& snapshot,
+  entityx::EntityManager& es
+) {
+  using game_logic::components::ActorTag;
+
+  mGodModeOn = snapshot.mGodModeOn;
+  mState = snapshot.mState;
+  mHitBox = snapshot.mHitBox;
+  mStance = snapshot.mStance;
+  mVisualState = snapshot.mVisualState;
+  mMercyFramesPerHit = snapshot.mMercyFramesPerHit;
+  mMercyFramesRemaining = snapshot.mMercyFramesRemaining;
+  mFramesElapsedHavingRapidFire = snapshot.mFramesElapsedHavingRapidFire;
+  mFramesElapsedHavingCloak = snapshot.mFramesElapsedHavingCloak;
+  mAttachedSpiders = snapshot.mAttachedSpiders;
+  mRapidFiredLastFrame = snapshot.mRapidFiredLastFrame;
+  mFiredLastFrame = snapshot.mFiredLastFrame;
+  mIsOddFrame = snapshot.mIsOddFrame;
+  mRecoilAnimationActive = snapshot.mRecoilAnimationActive;
+  mIsRidingElevator = snapshot.mIsRidingElevator;
+  mJumpRequested = snapshot.mJumpRequested;
+
+  mAttachedElevator = {};
+  if (snapshot.mIsAttachedToElevator) {
     entityx::ComponentHandle<ActorTag> tag;
     for (auto entity : es.entities_with_components(tag)) {
       if (tag->mType == ActorTag::Type::ActiveElevator) {
@@ -509,6 +542,8 @@ void Player::endBeingPushedByFan() {
 
 
 void Player::update(const PlayerInput& unfilteredInput) {
+  RIGEL_TRACE_SCOPE("Player::update");
+
   using namespace engine;
 
   updateTemporaryItemExpiration();
@@ -216,8 +216,42 @@ public:
   Player& operator=(const Player&) = delete;
   Player& operator=(Player&&) = default;
 
+  /** All of the player's mutable state
+   *
+   * Doesn't include the player entity's components, those need to be
+   * captured separately.
+   */
+  struct Snapshot {
+    PlayerState mState;
+    engine::components::BoundingBox mHitBox;
+    WeaponStance mStance;
+    VisualState mVisualState;
+    int mMercyFramesPerHit;
+    int mMercyFramesRemaining;
+    int mFramesElapsedHavingRapidFire;
+    int mFramesElapsedHavingCloak;
+    std::bitset<3> mAttachedSpiders;
+    bool mGodModeOn;
+    bool mRapidFiredLastFrame;
+    bool mFiredLastFrame;
+    bool mIsOddFrame;
+    bool mRecoilAnimationActive;
+    bool mIsRidingElevator;
+    bool mJumpRequested;
+    bool mIsAttachedToElevator;
+  };
+
   void synchronizeTo(const Player& other, entityx::EntityManager& es);
 
+  Snapshot snapshot() const;
+
+  /** Restore state previously captured via snapshot()
+   *
+   * The entity manager is used to find the elevator the player is attached
+   * to, if any.
+   */
+  void restoreSnapshot(const Snapshot& snapshot, entityx::EntityManager& es);
+
   void update(const PlayerInput& inputs);
 
   void takeDamage(int amount);
@@ -16,6 +16,7 @@
 
 #include "damage_system.hpp"
 
+#include "base/tracing.hpp"
 #include "common/global.hpp"
 #include "data/player_model.hpp"
 #include "engine/base_components.hpp"
@@ -40,6 +41,8 @@ DamageSystem::DamageSystem(Player* pPlayer)
 
 
 void DamageSystem::update(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("player::DamageSystem::update");
+
   if (mpPlayer->isDead()) {
     return;
   }
@@ -16,6 +16,7 @@
 
 #include "interaction_system.hpp"
 
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "common/global.hpp"
 #include "data/strings.hpp"
@@ -214,6 +215,8 @@ void PlayerInteractionSystem::updatePlayerInteraction(
   const PlayerInput& input,
   entityx::EntityManager& es
 ) {
+  RIGEL_TRACE_SCOPE("PlayerInteractionSystem::updatePlayerInteraction");
+
   if (mpPlayer->isDead()) {
     return;
   }
@@ -234,6 +237,8 @@ void PlayerInteractionSystem::updatePlayerInteraction(
 
 
 void PlayerInteractionSystem::updateItemCollection(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("PlayerInteractionSystem::updateItemCollection");
+
   if (mpPlayer->isDead()) {
     return;
   }
@@ -16,6 +16,7 @@
 
 #include "projectile_system.hpp"
 
+#include "base/tracing.hpp"
 #include "common/game_service_provider.hpp"
 #include "data/map.hpp"
 #include "engine/collision_checker.hpp"
@@ -137,6 +138,8 @@ ProjectileSystem::ProjectileSystem(
 
 
 void ProjectileSystem::update(entityx::EntityManager& es) {
+  RIGEL_TRACE_SCOPE("player::ProjectileSystem::update");
+
   using namespace engine::components;
   using namespace game_logic::components;
 
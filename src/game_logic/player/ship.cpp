@@ -24,6 +24,7 @@
 #include "engine/physical_components.hpp"
 #include "game_logic/global_dependencies.hpp"
 #include "game_logic/player.hpp"
+#include "game_logic/quick_save_tools.hpp"
 
 
 namespace rigel::game_logic::behaviors {
@@ -71,4 +72,14 @@ void PlayerShip::update(
   }
 }
 
+
+void PlayerShip::writeState(loader::LeStreamWriter& writer) const {
+  writer.writeS32(mPickUpCoolDownFrames);
+}
+
+
+void PlayerShip::readState(loader::LeStreamReader& reader) {
+  mPickUpCoolDownFrames = reader.readS32();
+}
+
 }
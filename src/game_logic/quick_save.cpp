@@ -0,0 +1,1379 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "quick_save.hpp"
+
+#include "data/map.hpp"
+#include "data/saved_game.hpp"
+#include "data/tutorial_messages.hpp"
+#include "engine/base_components.hpp"
+#include "engine/entity_tools.hpp"
+#include "engine/life_time_components.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/sprite_factory.hpp"
+#include "engine/visual_components.hpp"
+#include "game_logic/actor_tag.hpp"
+#include "game_logic/all_components.hpp"
+#include "game_logic/behavior_controller.hpp"
+#include "game_logic/collectable_components.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/dynamic_geometry_components.hpp"
+#include "game_logic/effect_components.hpp"
+#include "game_logic/interactive/enemy_radar.hpp"
+#include "game_logic/interactive/item_container.hpp"
+#include "game_logic/player/components.hpp"
+#include "game_logic/quick_save_tools.hpp"
+#include "game_logic/spawn_origin.hpp"
+#include "game_logic/world_state.hpp"
+#include "loader/file_utils.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace rigel::game_logic {
+
+using namespace engine::components;
+using namespace game_logic::components;
+
+using loader::LeStreamReader;
+using loader::LeStreamWriter;
+
+
+namespace {
+
+constexpr auto MAGIC_NUMBER = std::uint32_t{0x53514752}; // "RGQS"
+
+// Must be incremented whenever the format changes in any way, including
+// changes to the component lists below.
+constexpr auto FORMAT_VERSION = std::uint16_t{3};
+
+constexpr auto ENTITY_ALIVE_BIT = std::uint32_t{1};
+
+
+template <typename T>
+struct Tag {
+  using type = T;
+};
+
+
+/** Components which are fully stored, and (re-)assigned on restore */
+using ValueComponents = TypeList<
+  WorldPosition,
+  BoundingBox,
+  Orientation,
+  ActivationSettings,
+  MovingBody,
+  Shootable,
+  DamageInflicting,
+  PlayerDamaging,
+  MapGeometryLink,
+  ActorTag,
+  AutoDestroy,
+  AnimationLoop,
+  ItemBounceEffect>;
+
+/** Components containing references to static data
+ *
+ * Only their mutable state is stored, and restored onto the component
+ * created when loading the level. If the freshly loaded entity doesn't have
+ * the component, the stored state is ignored.
+ */
+using StatefulComponents = TypeList<Sprite, ItemContainer, BehaviorController>;
+
+/** Components without any persisted state
+ *
+ * Only their presence is stored. If a component was removed before saving,
+ * it's also removed on restore, otherwise, the component as created when
+ * loading the level is kept.
+ */
+using PresenceOnlyComponents = TypeList<
+  AppearsOnRadar,
+  AnimationSequence,
+  CollectableItem,
+  DestructionEffects,
+  DrawTopMost,
+  ExtendedFrameList,
+  Interactable,
+  MovementSequence,
+  OverrideDrawOrder,
+  RadarDish,
+  SolidBody,
+  SpriteCascadeSpawner>;
+
+
+std::uint8_t packFlags(std::initializer_list<bool> flags) {
+  auto result = std::uint8_t{0};
+  auto bit = 0;
+  for (const auto flag : flags) {
+    if (flag) {
+      result |= static_cast<std::uint8_t>(1 << bit);
+    }
+    ++bit;
+  }
+
+  return result;
+}
+
+
+bool flagAt(const std::uint8_t flags, const int bit) {
+  return (flags & (1 << bit)) != 0;
+}
+
+
+void writeFloat(LeStreamWriter& writer, const float value) {
+  static_assert(sizeof(float) == sizeof(std::uint32_t));
+
+  std::uint32_t bits;
+  std::memcpy(&bits, &value, sizeof(bits));
+  writer.writeU32(bits);
+}
+
+
+float readFloat(LeStreamReader& reader) {
+  const auto bits = reader.readU32();
+
+  float value;
+  std::memcpy(&value, &bits, sizeof(value));
+  return value;
+}
+
+
+void write(LeStreamWriter& writer, const base::Vector& vector) {
+  writer.writeS16(static_cast<std::int16_t>(vector.x));
+  writer.writeS16(static_cast<std::int16_t>(vector.y));
+}
+
+
+base::Vector read(LeStreamReader& reader, Tag<base::Vector>) {
+  const auto x = reader.readS16();
+  const auto y = reader.readS16();
+  return {x, y};
+}
+
+
+void write(LeStreamWriter& writer, const base::Rect<int>& rect) {
+  write(writer, rect.topLeft);
+  writer.writeS16(static_cast<std::int16_t>(rect.size.width));
+  writer.writeS16(static_cast<std::int16_t>(rect.size.height));
+}
+
+
+base::Rect<int> read(LeStreamReader& reader, Tag<base::Rect<int>>) {
+  const auto topLeft = read(reader, Tag<base::Vector>{});
+  const auto width = reader.readS16();
+  const auto height = reader.readS16();
+  return {topLeft, {width, height}};
+}
+
+
+void write(LeStreamWriter& writer, const Orientation orientation) {
+  writeEnum(writer, orientation);
+}
+
+
+Orientation read(LeStreamReader& reader, Tag<Orientation>) {
+  return readEnum(reader, Orientation::Right);
+}
+
+
+void write(LeStreamWriter& writer, const ActivationSettings& settings) {
+  writeEnum(writer, settings.mPolicy);
+  writer.writeU8(packFlags({settings.mHasBeenActivated}));
+}
+
+
+ActivationSettings read(LeStreamReader& reader, Tag<ActivationSettings>) {
+  using Policy = ActivationSettings::Policy;
+
+  ActivationSettings settings{readEnum(reader, Policy::WhenOnScreen)};
+  settings.mHasBeenActivated = flagAt(reader.readU8(), 0);
+  return settings;
+}
+
+
+void write(LeStreamWriter& writer, const MovingBody& body) {
+  writeFloat(writer, body.mVelocity.x);
+  writeFloat(writer, body.mVelocity.y);
+  writer.writeU8(packFlags({
+    body.mGravityAffected, body.mIgnoreCollisions, body.mIsActive}));
+}
+
+
+MovingBody read(LeStreamReader& reader, Tag<MovingBody>) {
+  const auto velocityX = readFloat(reader);
+  const auto velocityY = readFloat(reader);
+  const auto flags = reader.readU8();
+
+  MovingBody body{
+    base::Point<float>{velocityX, velocityY},
+    flagAt(flags, 0),
+    flagAt(flags, 1)};
+  body.mIsActive = flagAt(flags, 2);
+  return body;
+}
+
+
+void write(LeStreamWriter& writer, const Shootable& shootable) {
+  writer.writeS16(static_cast<std::int16_t>(shootable.mHealth));
+  writer.writeS32(shootable.mGivenScore);
+  writer.writeU8(packFlags({
+    shootable.mInvincible,
+    shootable.mEnableHitFeedback,
+    shootable.mDestroyWhenKilled,
+    shootable.mAlwaysConsumeInflictor,
+    shootable.mCanBeHitWhenOffscreen}));
+}
+
+
+Shootable read(LeStreamReader& reader, Tag<Shootable>) {
+  const auto health = reader.readS16();
+  const auto givenScore = reader.readS32();
+  const auto flags = reader.readU8();
+
+  Shootable shootable{health, givenScore};
+  shootable.mInvincible = flagAt(flags, 0);
+  shootable.mEnableHitFeedback = flagAt(flags, 1);
+  shootable.mDestroyWhenKilled = flagAt(flags, 2);
+  shootable.mAlwaysConsumeInflictor = flagAt(flags, 3);
+  shootable.mCanBeHitWhenOffscreen = flagAt(flags, 4);
+  return shootable;
+}
+
+
+void write(LeStreamWriter& writer, const DamageInflicting& damage) {
+  writer.writeS16(static_cast<std::int16_t>(damage.mAmount));
+  writer.writeU8(
+    packFlags({damage.mDestroyOnContact, damage.mHasCausedDamage}));
+}
+
+
+DamageInflicting read(LeStreamReader& reader, Tag<DamageInflicting>) {
+  const auto amount = reader.readS16();
+  const auto flags = reader.readU8();
+
+  DamageInflicting damage{amount, flagAt(flags, 0)};
+  damage.mHasCausedDamage = flagAt(flags, 1);
+  return damage;
+}
+
+
+void write(LeStreamWriter& writer, const PlayerDamaging& damage) {
+  writer.writeS16(static_cast<std::int16_t>(damage.mAmount));
+  writer.writeU8(packFlags({damage.mIsFatal, damage.mDestroyOnContact}));
+}
+
+
+PlayerDamaging read(LeStreamReader& reader, Tag<PlayerDamaging>) {
+  const auto amount = reader.readS16();
+  const auto flags = reader.readU8();
+  return PlayerDamaging{amount, flagAt(flags, 0), flagAt(flags, 1)};
+}
+
+
+void write(LeStreamWriter& writer, const MapGeometryLink& link) {
+  write(writer, link.mLinkedGeometrySection);
+}
+
+
+MapGeometryLink read(LeStreamReader& reader, Tag<MapGeometryLink>) {
+  return MapGeometryLink{read(reader, Tag<base::Rect<int>>{})};
+}
+
+
+void write(LeStreamWriter& writer, const ActorTag& tag) {
+  writeEnum(writer, tag.mType);
+  writer.writeS32(tag.mSpawnIndex);
+}
+
+
+ActorTag read(LeStreamReader& reader, Tag<ActorTag>) {
+  const auto type = readEnum(reader, ActorTag::Type::FireBomb);
+  const auto spawnIndex = reader.readS32();
+  return ActorTag{type, spawnIndex};
+}
+
+
+void write(LeStreamWriter& writer, const AutoDestroy& autoDestroy) {
+  writer.writeU8(static_cast<std::uint8_t>(autoDestroy.mConditionFlags));
+  writer.writeS32(autoDestroy.mFramesToLive);
+}
+
+
+AutoDestroy read(LeStreamReader& reader, Tag<AutoDestroy>) {
+  const auto conditionFlags = reader.readU8();
+  const auto framesToLive = reader.readS32();
+
+  auto autoDestroy = AutoDestroy::afterTimeout(framesToLive);
+  autoDestroy.mConditionFlags = conditionFlags;
+  return autoDestroy;
+}
+
+
+void write(LeStreamWriter& writer, const AnimationLoop& loop) {
+  writer.writeS16(static_cast<std::int16_t>(loop.mDelayInFrames));
+  writer.writeS16(static_cast<std::int16_t>(loop.mFramesElapsed));
+  writer.writeS16(static_cast<std::int16_t>(loop.mStartFrame));
+  writeOptionalInt(writer, loop.mEndFrame);
+  writer.writeU8(static_cast<std::uint8_t>(loop.mRenderSlot));
+}
+
+
+AnimationLoop read(LeStreamReader& reader, Tag<AnimationLoop>) {
+  AnimationLoop loop;
+  loop.mDelayInFrames = reader.readS16();
+  loop.mFramesElapsed = reader.readS16();
+  loop.mStartFrame = reader.readS16();
+  loop.mEndFrame = readOptionalInt(reader);
+  loop.mRenderSlot = reader.readU8();
+
+  if (loop.mRenderSlot >= engine::NUM_RENDER_SLOTS) {
+    throw std::runtime_error("Invalid animation in quick save");
+  }
+
+  return loop;
+}
+
+
+void write(LeStreamWriter& writer, const ItemBounceEffect& effect) {
+  writer.writeS16(static_cast<std::int16_t>(effect.mFramesElapsed));
+  writeFloat(writer, effect.mFallVelocity);
+}
+
+
+ItemBounceEffect read(LeStreamReader& reader, Tag<ItemBounceEffect>) {
+  const auto framesElapsed = reader.readS16();
+
+  ItemBounceEffect effect{readFloat(reader)};
+  effect.mFramesElapsed = framesElapsed;
+  return effect;
+}
+
+
+/** Check that a sprite frame can be drawn, see engine::virtualToRealFrame() */
+bool isValidFrame(
+  const int frame,
+  const engine::SpriteDrawData& drawData,
+  const std::optional<Orientation>& orientation
+) {
+  if (frame == engine::IGNORE_RENDER_SLOT) {
+    return true;
+  }
+
+  auto realFrame = frame;
+  if (
+    drawData.mOrientationOffset &&
+    orientation &&
+    *orientation == Orientation::Right
+  ) {
+    realFrame += *drawData.mOrientationOffset;
+  }
+
+  if (realFrame < 0) {
+    return false;
+  }
+
+  if (!drawData.mVirtualToRealFrameMap.empty()) {
+    const auto mapSize =
+      static_cast<int>(drawData.mVirtualToRealFrameMap.size());
+    if (realFrame >= mapSize) {
+      return false;
+    }
+
+    realFrame = drawData.mVirtualToRealFrameMap[realFrame];
+  }
+
+  return
+    realFrame >= 0 && realFrame < static_cast<int>(drawData.mFrames.size());
+}
+
+
+void write(LeStreamWriter& writer, const Sprite& sprite) {
+  static_assert(engine::NUM_RENDER_SLOTS <= 8);
+
+  for (const auto& slot : sprite.mFramesToRender) {
+    writer.writeS8(slot.mFrame);
+  }
+
+  writer.writeU8(static_cast<std::uint8_t>(
+    sprite.mFlashingWhiteStates.to_ulong()));
+  writer.writeU8(packFlags({sprite.mTranslucent, sprite.mShow}));
+}
+
+
+void readInto(
+  LeStreamReader& reader,
+  Sprite& sprite,
+  const entityx::Entity owner
+) {
+  const auto orientation = owner && owner.has_component<Orientation>()
+    ? std::make_optional(*owner.component<const Orientation>())
+    : std::nullopt;
+
+  for (auto& slot : sprite.mFramesToRender) {
+    slot.mFrame = reader.readS8();
+
+    if (
+      sprite.mpDrawData &&
+      !isValidFrame(slot.mFrame, *sprite.mpDrawData, orientation)
+    ) {
+      throw std::runtime_error("Invalid sprite frame in quick save");
+    }
+  }
+
+  sprite.mFlashingWhiteStates = reader.readU8();
+
+  const auto flags = reader.readU8();
+  sprite.mTranslucent = flagAt(flags, 0);
+  sprite.mShow = flagAt(flags, 1);
+}
+
+
+void write(LeStreamWriter& writer, const ItemContainer& container) {
+  writer.writeS8(container.mFramesElapsed);
+  writer.writeU8(packFlags({container.mHasBeenShot}));
+}
+
+
+void readInto(
+  LeStreamReader& reader,
+  ItemContainer& container,
+  entityx::Entity
+) {
+  container.mFramesElapsed = reader.readS8();
+  container.mHasBeenShot = flagAt(reader.readU8(), 0);
+}
+
+
+/** Identifies the type of a behavior within a quick save
+ *
+ * Based on the type's name, so it's stable across builds made with the same
+ * compiler. Quick saves are not portable across compilers as a consequence.
+ */
+std::uint32_t behaviorTypeHash(const BehaviorController& controller) {
+  // FNV-1a
+  auto hash = std::uint32_t{0x811C9DC5};
+  for (auto pChar = controller.typeName(); *pChar; ++pChar) {
+    hash ^= static_cast<std::uint8_t>(*pChar);
+    hash *= 0x01000193;
+  }
+
+  return hash;
+}
+
+
+void write(LeStreamWriter& writer, const BehaviorController& controller) {
+  // A behavior which has already run, but can't store its state, would
+  // start over after restoring, while everything else around it is
+  // restored. This can lead to contradictions, e.g. a boss restarting its
+  // attack sequence while keeping its reduced health, so we refuse to store
+  // it.
+  if (!controller.hasPersistentState() && !controller.isInInitialState()) {
+    throw std::runtime_error(
+      std::string{"Can't store state of behavior "} + controller.typeName());
+  }
+
+  writer.writeU32(behaviorTypeHash(controller));
+  writer.writeU8(packFlags({controller.hasPersistentState()}));
+
+  if (controller.hasPersistentState()) {
+    LeStreamWriter stateWriter;
+    controller.writeState(stateWriter);
+
+    const auto& state = stateWriter.data();
+    if (state.size() > UINT16_MAX) {
+      throw std::runtime_error("Behavior state too large for quick save");
+    }
+
+    writer.writeU16(static_cast<std::uint16_t>(state.size()));
+    for (const auto byte : state) {
+      writer.writeU8(byte);
+    }
+  }
+}
+
+
+/** Read a block of behavior state, see write(const BehaviorController&) */
+LeStreamReader readBehaviorState(LeStreamReader& reader) {
+  const auto size = reader.readU16();
+  const auto iStart = reader.currentIter();
+  reader.skipBytes(size);
+  return LeStreamReader{iStart, reader.currentIter()};
+}
+
+
+void readInto(
+  LeStreamReader& reader,
+  BehaviorController& controller,
+  entityx::Entity
+) {
+  // The controller must be of the same type as when saving. This is not the
+  // case if a controller was replaced during gameplay, e.g. a boss which
+  // started its death sequence.
+  const auto typeHash = reader.readU32();
+  const auto hasState = flagAt(reader.readU8(), 0);
+  if (
+    typeHash != behaviorTypeHash(controller) ||
+    hasState != controller.hasPersistentState()
+  ) {
+    throw std::runtime_error("Behavior in quick save doesn't match level");
+  }
+
+  if (hasState) {
+    auto stateReader = readBehaviorState(reader);
+    controller.readState(stateReader);
+
+    if (stateReader.hasData()) {
+      throw std::runtime_error("Invalid behavior state in quick save");
+    }
+  }
+}
+
+
+template <typename T>
+void skipStoredState(LeStreamReader& reader, Tag<T>) {
+  T discarded;
+  readInto(reader, discarded, entityx::Entity{});
+}
+
+
+void skipStoredState(LeStreamReader& reader, Tag<BehaviorController>) {
+  reader.readU32();
+  if (flagAt(reader.readU8(), 0)) {
+    readBehaviorState(reader);
+  }
+}
+
+
+template <typename T>
+void restoreComponent(entityx::Entity entity, const T& value) {
+  // Assigning in place avoids emitting component added/removed events,
+  // which would make systems like physics treat the entity as newly spawned.
+  if (entity.has_component<T>()) {
+    *entity.component<T>() = value;
+  } else {
+    entity.assign<T>(value);
+  }
+}
+
+
+void restoreComponent(entityx::Entity entity, const ActorTag& tag) {
+  // The entity tag index is maintained via component events, so changing
+  // a tag needs to go through remove/assign.
+  const auto existingTag = entity.component<ActorTag>();
+  if (
+    !existingTag ||
+    existingTag->mType != tag.mType ||
+    existingTag->mSpawnIndex != tag.mSpawnIndex
+  ) {
+    engine::reassign<ActorTag>(entity, tag);
+  }
+}
+
+
+template <typename... Components>
+void collectPresentComponents(
+  entityx::Entity entity,
+  std::uint32_t& mask,
+  int& bit,
+  TypeList<Components...>
+) {
+  auto check = [&](const bool isPresent) {
+    if (isPresent) {
+      mask |= 1u << bit;
+    }
+    ++bit;
+  };
+
+  (check(entity.has_component<Components>()), ...);
+}
+
+
+template <typename... Components>
+void writeComponents(
+  LeStreamWriter& writer,
+  entityx::Entity entity,
+  TypeList<Components...>
+) {
+  auto writeIfPresent = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+
+    if (entity.has_component<T>()) {
+      write(writer, *entity.component<const T>());
+    }
+  };
+
+  (writeIfPresent(Tag<Components>{}), ...);
+}
+
+
+template <typename... Components>
+void restoreValueComponents(
+  LeStreamReader& reader,
+  entityx::Entity entity,
+  const std::uint32_t mask,
+  int& bit,
+  TypeList<Components...>
+) {
+  auto restore = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+
+    if (mask & (1u << bit)) {
+      restoreComponent(entity, read(reader, tag));
+    } else {
+      engine::removeSafely<T>(entity);
+    }
+    ++bit;
+  };
+
+  (restore(Tag<Components>{}), ...);
+}
+
+
+template <typename... Components>
+void restoreStatefulComponents(
+  LeStreamReader& reader,
+  entityx::Entity entity,
+  const std::uint32_t mask,
+  int& bit,
+  TypeList<Components...>
+) {
+  auto restore = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+
+    if (mask & (1u << bit)) {
+      if (entity.has_component<T>()) {
+        readInto(reader, *entity.component<T>(), entity);
+      } else {
+        skipStoredState(reader, tag);
+      }
+    } else {
+      engine::removeSafely<T>(entity);
+    }
+    ++bit;
+  };
+
+  (restore(Tag<Components>{}), ...);
+}
+
+
+template <typename... Components>
+void restorePresenceOnlyComponents(
+  entityx::Entity entity,
+  const std::uint32_t mask,
+  int& bit,
+  TypeList<Components...>
+) {
+  auto restore = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+
+    if (!(mask & (1u << bit))) {
+      engine::removeSafely<T>(entity);
+    }
+    ++bit;
+  };
+
+  (restore(Tag<Components>{}), ...);
+}
+
+
+void writeEntity(LeStreamWriter& writer, entityx::Entity entity) {
+  auto mask = ENTITY_ALIVE_BIT;
+  auto bit = 1;
+  collectPresentComponents(entity, mask, bit, ValueComponents{});
+  collectPresentComponents(entity, mask, bit, StatefulComponents{});
+  collectPresentComponents(entity, mask, bit, PresenceOnlyComponents{});
+  static_assert(sizeof(mask) * 8 >= 29, "Too many component types for mask");
+
+  writer.writeU32(mask);
+  writeComponents(writer, entity, ValueComponents{});
+  writeComponents(writer, entity, StatefulComponents{});
+}
+
+
+void restoreEntity(
+  LeStreamReader& reader,
+  entityx::Entity entity,
+  const std::uint32_t mask
+) {
+  auto bit = 1;
+  restoreValueComponents(reader, entity, mask, bit, ValueComponents{});
+  restoreStatefulComponents(reader, entity, mask, bit, StatefulComponents{});
+  restorePresenceOnlyComponents(entity, mask, bit, PresenceOnlyComponents{});
+}
+
+
+template <typename... Components>
+constexpr int numTypes(TypeList<Components...>) {
+  return sizeof...(Components);
+}
+
+
+template <typename T, typename... Components>
+constexpr int indexOf(TypeList<Components...>) {
+  constexpr bool matches[] = {std::is_same_v<T, Components>...};
+  for (auto i = 0; i < numTypes(TypeList<Components...>{}); ++i) {
+    if (matches[i]) {
+      return i;
+    }
+  }
+
+  return -1;
+}
+
+
+template <typename... Components>
+bool lacksAnyComponent(
+  entityx::Entity entity,
+  const std::uint32_t mask,
+  int& bit,
+  TypeList<Components...>
+) {
+  auto lacksComponent = false;
+  auto check = [&](auto tag) {
+    using T = typename decltype(tag)::type;
+
+    if ((mask & (1u << bit)) && !entity.has_component<T>()) {
+      lacksComponent = true;
+    }
+    ++bit;
+  };
+
+  (check(Tag<Components>{}), ...);
+  return lacksComponent;
+}
+
+
+/** Check if an entity has all components which were present when saving
+ *
+ * Only value components can be added on restore, all others must have been
+ * created along with the entity.
+ */
+bool hasAllStoredComponents(entityx::Entity entity, const std::uint32_t mask) {
+  auto bit = 1 + numTypes(ValueComponents{});
+  return
+    !lacksAnyComponent(entity, mask, bit, StatefulComponents{}) &&
+    !lacksAnyComponent(entity, mask, bit, PresenceOnlyComponents{});
+}
+
+
+/** Check if an entity had a behavior controller which it now lacks
+ *
+ * This happens for level entities which were given a behavior during
+ * gameplay, e.g. a door opened with the blue key. The behavior can't be
+ * re-created in that case.
+ */
+bool lacksStoredBehavior(entityx::Entity entity, const std::uint32_t mask) {
+  constexpr auto bit = 1 + numTypes(ValueComponents{}) +
+    indexOf<BehaviorController>(StatefulComponents{});
+  return (mask & (1u << bit)) && !entity.has_component<BehaviorController>();
+}
+
+
+void write(LeStreamWriter& writer, const SpawnOrigin& origin) {
+  writeEnum(writer, origin.mType);
+  writer.writeU16(static_cast<std::uint16_t>(origin.mActorId));
+  writeEnum(writer, origin.mProjectileType);
+  writeEnum(writer, origin.mProjectileDirection);
+  writer.writeU8(static_cast<std::uint8_t>(origin.mContainerDepth));
+}
+
+
+SpawnOrigin read(LeStreamReader& reader, Tag<SpawnOrigin>) {
+  constexpr auto LAST_ACTOR_ID = data::ActorID::Rigelatin_soldier_projectile;
+
+  SpawnOrigin origin;
+  origin.mType = readEnum(reader, SpawnOrigin::Type::ContainerContents);
+
+  const auto actorId = reader.readU16();
+  if (actorId > static_cast<std::uint16_t>(LAST_ACTOR_ID)) {
+    throw std::runtime_error("Invalid actor ID in quick save");
+  }
+  origin.mActorId = static_cast<data::ActorID>(actorId);
+
+  origin.mProjectileType = readEnum(reader, ProjectileType::ReactorDebris);
+  origin.mProjectileDirection = readEnum(reader, ProjectileDirection::Down);
+  origin.mContainerDepth = reader.readU8();
+  return origin;
+}
+
+
+entityx::Entity recreateContainerContents(
+  IEntityFactory& factory,
+  const SpawnOrigin& origin
+) {
+  constexpr auto MAX_CONTAINER_DEPTH = 8;
+
+  if (
+    origin.mContainerDepth < 1 ||
+    origin.mContainerDepth > MAX_CONTAINER_DEPTH
+  ) {
+    return {};
+  }
+
+  // Replay releasing the contents, starting from a freshly configured
+  // container. This gives us the same components as the item container
+  // system would have created.
+  auto source = factory.spawnActor(origin.mActorId, {});
+  for (auto depth = 0; depth < origin.mContainerDepth; ++depth) {
+    if (!source.has_component<ItemContainer>()) {
+      source.destroy();
+      return {};
+    }
+
+    auto contents = factory.entityManager().create();
+    const auto& container = *source.component<const ItemContainer>();
+    for (const auto& component : container.mContainedComponents) {
+      component.assignToEntity(contents);
+    }
+
+    source.destroy();
+    source = contents;
+  }
+
+  source.assign<SpawnOrigin>(origin);
+  return source;
+}
+
+
+/** Re-create an entity which was spawned during gameplay
+ *
+ * Returns an invalid entity if that's not possible.
+ */
+entityx::Entity recreateEntity(
+  IEntityFactory& factory,
+  const SpawnOrigin& origin
+) {
+  using Type = SpawnOrigin::Type;
+
+  if (
+    origin.mType != Type::Projectile &&
+    !engine::hasAssociatedSprite(origin.mActorId)
+  ) {
+    return {};
+  }
+
+  switch (origin.mType) {
+    case Type::Sprite:
+      return factory.spawnSprite(origin.mActorId, false);
+
+    case Type::SpriteWithBoundingBox:
+      return factory.spawnSprite(origin.mActorId, true);
+
+    case Type::Actor:
+      return factory.spawnActor(origin.mActorId, {});
+
+    case Type::Projectile:
+      return factory.spawnProjectile(
+        origin.mProjectileType, WorldPosition{}, origin.mProjectileDirection);
+
+    case Type::ContainerContents:
+      return recreateContainerContents(factory, origin);
+  }
+
+  return {};
+}
+
+
+void writePlayerModel(LeStreamWriter& writer, const data::PlayerModel& model) {
+  writeEnum(writer, model.weapon());
+  writer.writeU8(static_cast<std::uint8_t>(model.ammo()));
+  writer.writeU8(static_cast<std::uint8_t>(model.health()));
+  writer.writeS32(model.score());
+
+  writer.writeU8(static_cast<std::uint8_t>(model.inventory().size()));
+  for (const auto item : model.inventory()) {
+    writeEnum(writer, item);
+  }
+
+  writer.writeU8(static_cast<std::uint8_t>(model.collectedLetters().size()));
+  for (const auto letter : model.collectedLetters()) {
+    writeEnum(writer, letter);
+  }
+
+  auto shownMessages = std::uint8_t{0};
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i) {
+    const auto id = static_cast<data::TutorialMessageId>(i);
+    if (model.tutorialMessages().hasBeenShown(id)) {
+      shownMessages |= static_cast<std::uint8_t>(1 << (i % 8));
+    }
+
+    if (i % 8 == 7 || i == data::NUM_TUTORIAL_MESSAGES - 1) {
+      writer.writeU8(shownMessages);
+      shownMessages = 0;
+    }
+  }
+}
+
+
+data::PlayerModel readPlayerModel(LeStreamReader& reader) {
+  data::SavedGame save;
+  save.mWeapon = readEnum(reader, data::WeaponType::FlameThrower);
+  save.mAmmo = reader.readU8();
+  const auto health = reader.readU8();
+  save.mScore = reader.readS32();
+
+  std::vector<data::InventoryItemType> inventory(reader.readU8());
+  for (auto& item : inventory) {
+    item = readEnum(reader, data::InventoryItemType::CloakingDevice);
+  }
+
+  std::vector<data::CollectableLetterType> letters(reader.readU8());
+  for (auto& letter : letters) {
+    letter = readEnum(reader, data::CollectableLetterType::M);
+  }
+
+  auto shownMessages = std::uint8_t{0};
+  for (auto i = 0; i < data::NUM_TUTORIAL_MESSAGES; ++i) {
+    if (i % 8 == 0) {
+      shownMessages = reader.readU8();
+    }
+
+    if (flagAt(shownMessages, i % 8)) {
+      save.mTutorialMessagesAlreadySeen.markAsShown(
+        static_cast<data::TutorialMessageId>(i));
+    }
+  }
+
+  if (
+    save.mAmmo > data::MAX_AMMO_FLAME_THROWER ||
+    health > data::MAX_HEALTH ||
+    save.mScore < 0 ||
+    save.mScore > data::MAX_SCORE
+  ) {
+    throw std::runtime_error("Invalid player data in quick save");
+  }
+
+  data::PlayerModel model{save};
+  model.takeDamage(data::MAX_HEALTH - health);
+
+  for (const auto item : inventory) {
+    model.giveItem(item);
+  }
+
+  for (const auto letter : letters) {
+    model.addLetter(letter);
+  }
+
+  return model;
+}
+
+
+void writeMapDeltas(
+  LeStreamWriter& writer,
+  const data::map::Map& map,
+  const data::map::Map& initialMap
+) {
+  struct TileChange {
+    int mLayer;
+    int mX;
+    int mY;
+    data::map::TileIndex mTile;
+  };
+
+  std::vector<TileChange> changes;
+
+  for (int layer = 0; layer < 2; ++layer) {
+    for (int y = 0; y < map.height(); ++y) {
+      for (int x = 0; x < map.width(); ++x) {
+        const auto tile = map.tileAt(layer, x, y);
+        if (tile != initialMap.tileAt(layer, x, y)) {
+          changes.push_back({layer, x, y, tile});
+        }
+      }
+    }
+  }
+
+  writer.writeU16(static_cast<std::uint16_t>(map.width()));
+  writer.writeU16(static_cast<std::uint16_t>(map.height()));
+  writer.writeU32(static_cast<std::uint32_t>(changes.size()));
+
+  for (const auto& change : changes) {
+    writer.writeU8(static_cast<std::uint8_t>(change.mLayer));
+    writer.writeU16(static_cast<std::uint16_t>(change.mX));
+    writer.writeU16(static_cast<std::uint16_t>(change.mY));
+    writer.writeU16(static_cast<std::uint16_t>(change.mTile));
+  }
+}
+
+
+void restoreMapDeltas(LeStreamReader& reader, data::map::Map& map) {
+  const auto width = reader.readU16();
+  const auto height = reader.readU16();
+  if (width != map.width() || height != map.height()) {
+    throw std::runtime_error("Quick save doesn't match level");
+  }
+
+  const auto numChanges = reader.readU32();
+  for (auto i = 0u; i < numChanges; ++i) {
+    const auto layer = reader.readU8();
+    const auto x = reader.readU16();
+    const auto y = reader.readU16();
+    const auto tile = reader.readU16();
+
+    if (layer >= 2 || x >= width || y >= height) {
+      throw std::runtime_error("Invalid tile position in quick save");
+    }
+
+    map.setTileAt(layer, x, y, tile);
+  }
+}
+
+
+void writeHeader(
+  LeStreamWriter& writer,
+  const data::GameSessionId& sessionId
+) {
+  writer.writeU32(MAGIC_NUMBER);
+  writer.writeU16(FORMAT_VERSION);
+  writer.writeU8(static_cast<std::uint8_t>(sessionId.mEpisode));
+  writer.writeU8(static_cast<std::uint8_t>(sessionId.mLevel));
+  writeEnum(writer, sessionId.mDifficulty);
+}
+
+
+void readHeader(LeStreamReader& reader, const data::GameSessionId& sessionId) {
+  if (reader.readU32() != MAGIC_NUMBER) {
+    throw std::runtime_error("Not a quick save file");
+  }
+
+  if (reader.readU16() != FORMAT_VERSION) {
+    throw std::runtime_error("Unsupported quick save version");
+  }
+
+  const auto episode = reader.readU8();
+  const auto level = reader.readU8();
+  const auto difficulty = readEnum(reader, data::Difficulty::Hard);
+  if (
+    episode != sessionId.mEpisode ||
+    level != sessionId.mLevel ||
+    difficulty != sessionId.mDifficulty
+  ) {
+    throw std::runtime_error("Quick save was made for a different level");
+  }
+}
+
+
+/** Read the player model at the start of the level and compare to expected
+ *
+ * A mismatch means that the quick save stems from a different playthrough
+ * of the same level.
+ */
+void verifyPlayerModelAtLevelStart(
+  LeStreamReader& reader,
+  const data::PlayerModel& expected
+) {
+  LeStreamWriter expectedWriter;
+  writePlayerModel(expectedWriter, expected);
+  const auto& expectedData = expectedWriter.data();
+
+  const auto iStart = reader.currentIter();
+  readPlayerModel(reader);
+
+  if (!std::equal(
+    iStart,
+    reader.currentIter(),
+    expectedData.begin(),
+    expectedData.end())
+  ) {
+    throw std::runtime_error("Quick save belongs to a different game");
+  }
+}
+
+}
+
+
+void writeQuickSaveEntities(
+  loader::LeStreamWriter& writer,
+  entityx::EntityManager& entities,
+  const std::vector<entityx::Entity>& levelEntities,
+  const entityx::Entity player
+) {
+  writer.writeU32(static_cast<std::uint32_t>(levelEntities.size()));
+  for (const auto& entity : levelEntities) {
+    if (!entity) {
+      writer.writeU32(0);
+    } else if (entity == player) {
+      // The player's state is handled separately
+      writer.writeU32(ENTITY_ALIVE_BIT);
+    } else {
+      writeEntity(writer, entity);
+    }
+  }
+
+  std::vector<bool> isLevelEntity(entities.capacity());
+  for (const auto& entity : levelEntities) {
+    if (entity) {
+      isLevelEntity[entity.id().index()] = true;
+    }
+  }
+
+  // Entities without a spawn origin can't be re-created. These are helper
+  // entities owned by behavior controllers, which create them again after
+  // restoring, and short-lived effects like tile debris.
+  std::vector<entityx::Entity> spawnedEntities;
+  for (const auto entity : entities.entities_for_debugging()) {
+    if (
+      entity != player &&
+      !isLevelEntity[entity.id().index()] &&
+      entity.has_component<SpawnOrigin>()
+    ) {
+      spawnedEntities.push_back(entity);
+    }
+  }
+
+  writer.writeU32(static_cast<std::uint32_t>(spawnedEntities.size()));
+  for (const auto& entity : spawnedEntities) {
+    write(writer, *entity.component<const SpawnOrigin>());
+    writeEntity(writer, entity);
+  }
+}
+
+
+void restoreQuickSaveEntities(
+  loader::LeStreamReader& reader,
+  IEntityFactory& factory,
+  const std::vector<entityx::Entity>& levelEntities,
+  const entityx::Entity player
+) {
+  const auto numLevelEntities = reader.readU32();
+  if (numLevelEntities != levelEntities.size()) {
+    throw std::runtime_error("Quick save doesn't match level");
+  }
+
+  for (auto entity : levelEntities) {
+    const auto mask = reader.readU32();
+
+    if (entity == player) {
+      continue;
+    }
+
+    if (!(mask & ENTITY_ALIVE_BIT)) {
+      entity.destroy();
+      continue;
+    }
+
+    if (lacksStoredBehavior(entity, mask)) {
+      throw std::runtime_error("Behavior in quick save doesn't match level");
+    }
+
+    restoreEntity(reader, entity, mask);
+  }
+
+  auto& entities = factory.entityManager();
+
+  std::vector<entityx::Entity> spawnedEntities;
+  const auto numSpawnedEntities = reader.readU32();
+  for (auto i = 0u; i < numSpawnedEntities; ++i) {
+    const auto origin = read(reader, Tag<SpawnOrigin>{});
+    const auto mask = reader.readU32();
+    if (!(mask & ENTITY_ALIVE_BIT)) {
+      throw std::runtime_error("Invalid entity in quick save");
+    }
+
+    auto entity = recreateEntity(factory, origin);
+    if (!entity) {
+      // The data still needs to be consumed
+      auto discarded = entities.create();
+      restoreEntity(reader, discarded, mask);
+      discarded.destroy();
+      continue;
+    }
+
+    restoreEntity(reader, entity, mask);
+
+    if (hasAllStoredComponents(entity, mask)) {
+      spawnedEntities.push_back(entity);
+    } else {
+      entity.destroy();
+    }
+  }
+
+  // Re-creating entities can have the side effect of spawning additional
+  // ones, e.g. for actors which create helper entities while being
+  // configured. These are either part of the quick save already, or will be
+  // created again by their owner. Either way, they need to go.
+  std::vector<bool> isKnownEntity(entities.capacity());
+  auto markAsKnown = [&](const entityx::Entity& entity) {
+    if (entity) {
+      isKnownEntity[entity.id().index()] = true;
+    }
+  };
+
+  markAsKnown(player);
+  for (const auto& entity : levelEntities) {
+    markAsKnown(entity);
+  }
+  for (const auto& entity : spawnedEntities) {
+    markAsKnown(entity);
+  }
+
+  std::vector<entityx::Entity> sideEffectEntities;
+  for (const auto entity : entities.entities_for_debugging()) {
+    if (!isKnownEntity[entity.id().index()]) {
+      sideEffectEntities.push_back(entity);
+    }
+  }
+
+  for (auto entity : sideEffectEntities) {
+    entity.destroy();
+  }
+}
+
+
+loader::ByteBuffer serializeQuickSave(
+  const WorldState& state,
+  const data::map::Map& initialMap,
+  const QuickSavePlayerModels& playerModels,
+  const data::GameSessionId& sessionId
+) {
+  LeStreamWriter writer;
+
+  writeHeader(writer, sessionId);
+
+  writePlayerModel(writer, playerModels.mCurrent);
+  writePlayerModel(writer, playerModels.mAtLevelStart);
+
+  write(writer, state.mPlayer.position());
+  write(writer, state.mPlayer.orientation());
+
+  writer.writeU16(static_cast<std::uint16_t>(
+    state.mRandomGenerator.nextNumberIndex()));
+  writer.writeS16(static_cast<std::int16_t>(
+    state.mBonusInfo.mNumShotBonusGlobes));
+  writer.writeU8(packFlags({
+    state.mBonusInfo.mPlayerTookDamage,
+    state.mBackdropSwitched,
+    state.mIsOddFrame,
+    state.mActivatedCheckpoint.has_value()}));
+
+  if (const auto& checkpoint = state.mActivatedCheckpoint) {
+    writeEnum(writer, checkpoint->mState.mWeapon);
+    writer.writeU8(static_cast<std::uint8_t>(checkpoint->mState.mAmmo));
+    writer.writeU8(static_cast<std::uint8_t>(checkpoint->mState.mHealth));
+    write(writer, checkpoint->mPosition);
+  }
+
+  writeOptionalInt(writer, state.mReactorDestructionFramesElapsed);
+
+  writeMapDeltas(writer, state.mMap, initialMap);
+
+  writeQuickSaveEntities(
+    writer,
+    const_cast<entityx::EntityManager&>(state.mEntities),
+    state.mLevelEntities,
+    state.mPlayer.entity());
+
+  const auto camera = state.mCamera.snapshot();
+  write(writer, camera.mPosition);
+  writer.writeS16(static_cast<std::int16_t>(camera.mManualScrollCooldown));
+
+  state.mParticles.writeState(writer);
+
+  return writer.takeData();
+}
+
+
+bool isQuickSaveForSession(
+  const loader::ByteBuffer& data,
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModelAtLevelStart
+) {
+  try {
+    LeStreamReader reader(data);
+    readHeader(reader, sessionId);
+    readPlayerModel(reader);
+    verifyPlayerModelAtLevelStart(reader, playerModelAtLevelStart);
+    return true;
+  } catch (const std::exception&) {
+    return false;
+  }
+}
+
+
+data::PlayerModel restoreQuickSave(
+  const loader::ByteBuffer& data,
+  WorldState& state,
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModelAtLevelStart
+) {
+  LeStreamReader reader(data);
+
+  readHeader(reader, sessionId);
+
+  auto playerModel = readPlayerModel(reader);
+  verifyPlayerModelAtLevelStart(reader, playerModelAtLevelStart);
+
+  const auto playerPosition = read(reader, Tag<base::Vector>{});
+  const auto playerOrientation = read(reader, Tag<Orientation>{});
+
+  // Re-creating entities can consume random numbers, so the random number
+  // generator's state is restored at the very end
+  const auto nextRandomNumberIndex = reader.readU16();
+  state.mBonusInfo.mNumShotBonusGlobes = reader.readS16();
+
+  const auto flags = reader.readU8();
+  state.mBonusInfo.mPlayerTookDamage = flagAt(flags, 0);
+  state.mIsOddFrame = flagAt(flags, 2);
+
+  if (flagAt(flags, 1)) {
+    state.mMapRenderer.switchBackdrops();
+    state.mBackdropSwitched = true;
+  }
+
+  if (flagAt(flags, 3)) {
+    CheckpointData checkpoint;
+    checkpoint.mState.mWeapon =
+      readEnum(reader, data::WeaponType::FlameThrower);
+    checkpoint.mState.mAmmo = reader.readU8();
+    checkpoint.mState.mHealth = reader.readU8();
+    checkpoint.mPosition = read(reader, Tag<base::Vector>{});
+    state.mActivatedCheckpoint = checkpoint;
+  }
+
+  state.mReactorDestructionFramesElapsed = readOptionalInt(reader);
+
+  restoreMapDeltas(reader, state.mMap);
+
+  restoreQuickSaveEntities(
+    reader,
+    state.mEntityFactory,
+    state.mLevelEntities,
+    state.mPlayer.entity());
+
+  Camera::Snapshot camera;
+  camera.mPosition = read(reader, Tag<base::Vector>{});
+  camera.mManualScrollCooldown = reader.readS16();
+
+  state.mParticles.readState(reader);
+
+  state.mPlayer.reSpawnAt(playerPosition);
+  auto playerEntity = state.mPlayer.entity();
+  *playerEntity.component<Orientation>() = playerOrientation;
+  state.mCamera.restoreSnapshot(camera);
+
+  state.mRandomGenerator.setNextNumberIndex(nextRandomNumberIndex);
+
+  return playerModel;
+}
+
+}
@@ -0,0 +1,140 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+#include "data/game_session_data.hpp"
+#include "data/player_model.hpp"
+#include "loader/byte_buffer.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+namespace rigel::data::map { class Map; }
+namespace rigel::loader {
+  class LeStreamReader;
+  class LeStreamWriter;
+}
+
+
+namespace rigel::game_logic {
+
+struct IEntityFactory;
+struct WorldState;
+
+
+struct QuickSavePlayerModels {
+  data::PlayerModel mCurrent;
+  data::PlayerModel mAtLevelStart;
+};
+
+
+/** Serialize a world's state into a compact, versioned binary format
+ *
+ * Instead of storing the complete state, only the differences to a freshly
+ * loaded copy of the same level are stored: Map tiles which differ from the
+ * level's initial map, and the state of all entities which were spawned when
+ * loading the level (see WorldState::mLevelEntities). Entities spawned during
+ * gameplay are stored along with their components::SpawnOrigin, which allows
+ * re-creating them when restoring. In addition, the player model, the
+ * player's position, the camera, particles, and global state like the random
+ * number generator's position and the activated checkpoint are stored.
+ *
+ * Behavior controllers store their internal state if their behavior provides
+ * writeState() and readState() (see
+ * components::BehaviorController::hasPersistentState()). Behaviors without
+ * these can only be stored as long as they haven't run yet, otherwise they
+ * would start over after restoring while the world around them doesn't.
+ * Serializing throws an exception in that case. This currently applies to
+ * behaviors with variant-based state machines (e.g. the snake or the
+ * Rigelatin soldier), the bosses, and behaviors holding on to other entities.
+ * Behaviors are identified by their type name, so quick saves can't be
+ * shared between builds made with different compilers.
+ *
+ * Some transient state is not persisted. This includes entities without a
+ * spawn origin (helper entities owned by behavior controllers, which are
+ * re-created by their owner, and short-lived effects like tile debris). The
+ * player is restored at the saved position in the same way as when
+ * respawning at a checkpoint.
+ */
+loader::ByteBuffer serializeQuickSave(
+  const WorldState& state,
+  const data::map::Map& initialMap,
+  const QuickSavePlayerModels& playerModels,
+  const data::GameSessionId& sessionId);
+
+
+/** Check if data produced by serializeQuickSave() can be restored
+ *
+ * A quick save belongs to a game session if it was made for the same level,
+ * and the level was started with the same player model. Otherwise, it stems
+ * from a different playthrough and must not be used.
+ */
+bool isQuickSaveForSession(
+  const loader::ByteBuffer& data,
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModelAtLevelStart);
+
+
+/** Apply data produced by serializeQuickSave() to a world state
+ *
+ * The given state must have been freshly created for the level specified by
+ * sessionId, without running any updates yet. Returns the player model stored
+ * in the quick save. Throws an exception if the data is invalid, was created
+ * by an incompatible version, or doesn't belong to the given game session
+ * (see isQuickSaveForSession()). It also throws if a level entity's behavior
+ * doesn't match the stored one, which happens when a behavior was replaced
+ * or added during gameplay (e.g. a boss starting its death sequence).
+ */
+data::PlayerModel restoreQuickSave(
+  const loader::ByteBuffer& data,
+  WorldState& state,
+  const data::GameSessionId& sessionId,
+  const data::PlayerModel& playerModelAtLevelStart);
+
+
+/** Store the state of all entities except the player
+ *
+ * Part of serializeQuickSave(), exposed separately for testing. Entities in
+ * levelEntities are identified by their position in the list, all other
+ * entities are stored if they have a components::SpawnOrigin.
+ */
+void writeQuickSaveEntities(
+  loader::LeStreamWriter& writer,
+  entityx::EntityManager& entities,
+  const std::vector<entityx::Entity>& levelEntities,
+  entityx::Entity player);
+
+
+/** Counterpart to writeQuickSaveEntities()
+ *
+ * Part of restoreQuickSave(), exposed separately for testing. Level entities
+ * are updated in place, or destroyed if they were gone when saving. All other
+ * entities are re-created using the given factory. levelEntities must
+ * correspond to the ones used when saving.
+ */
+void restoreQuickSaveEntities(
+  loader::LeStreamReader& reader,
+  IEntityFactory& factory,
+  const std::vector<entityx::Entity>& levelEntities,
+  entityx::Entity player);
+
+}
@@ -0,0 +1,99 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "loader/file_utils.hpp"
+
+#include <cstdint>
+#include <optional>
+#include <stdexcept>
+
+
+namespace rigel::game_logic {
+
+// Helpers for reading and writing quick save data. Used by the quick save
+// itself, and by behavior controllers which store their state in quick saves
+// (see components::BehaviorController::hasPersistentState()). The read
+// functions throw if the data is invalid.
+
+
+template <typename T>
+void writeEnum(loader::LeStreamWriter& writer, const T value) {
+  writer.writeU8(static_cast<std::uint8_t>(value));
+}
+
+
+template <typename T>
+T readEnum(loader::LeStreamReader& reader, const T lastValidValue) {
+  const auto value = reader.readU8();
+  if (value > static_cast<std::uint8_t>(lastValidValue)) {
+    throw std::runtime_error("Invalid enum value in quick save");
+  }
+
+  return static_cast<T>(value);
+}
+
+
+inline void writeBool(loader::LeStreamWriter& writer, const bool value) {
+  writer.writeU8(value ? 1 : 0);
+}
+
+
+inline bool readBool(loader::LeStreamReader& reader) {
+  return reader.readU8() != 0;
+}
+
+
+/** Read an int, throwing if it's outside of [min, max]
+ *
+ * Meant for values which are used as array indices.
+ */
+inline int readIntInRange(
+  loader::LeStreamReader& reader,
+  const int min,
+  const int max
+) {
+  const auto value = reader.readS32();
+  if (value < min || value > max) {
+    throw std::runtime_error("Invalid value in quick save");
+  }
+
+  return value;
+}
+
+
+inline void writeOptionalInt(
+  loader::LeStreamWriter& writer,
+  const std::optional<int>& value
+) {
+  writer.writeU8(value ? 1 : 0);
+  if (value) {
+    writer.writeS32(*value);
+  }
+}
+
+
+inline std::optional<int> readOptionalInt(loader::LeStreamReader& reader) {
+  if (reader.readU8() != 0) {
+    return reader.readS32();
+  }
+
+  return std::nullopt;
+}
+
+}
@@ -0,0 +1,148 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "rewind_buffer.hpp"
+
+#include "base/tracing.hpp"
+
+#include <cassert>
+#include <chrono>
+#include <utility>
+
+
+namespace rigel::game_logic {
+
+RewindBuffer::RewindBuffer(
+  const std::size_t maxSnapshots,
+  const int framesPerSnapshot
+)
+  : mMaxSnapshots(maxSnapshots)
+  , mFramesPerSnapshot(framesPerSnapshot)
+  // Capture a snapshot right away on the first update
+  , mFramesSinceLastSnapshot(framesPerSnapshot)
+{
+  assert(maxSnapshots > 0);
+  assert(framesPerSnapshot > 0);
+  mSnapshots.reserve(maxSnapshots);
+}
+
+
+void RewindBuffer::update(
+  const WorldState& state,
+  const data::map::Map& levelStartMap,
+  const data::PlayerModel& playerModel
+) {
+  RIGEL_TRACE_SCOPE("RewindBuffer::update");
+
+  if (mFramesSinceLastSnapshot < mFramesPerSnapshot) {
+    ++mFramesSinceLastSnapshot;
+  }
+
+  // Like quick saving, we don't allow rewinding into a state where the player
+  // is dead
+  if (
+    mFramesSinceLastSnapshot < mFramesPerSnapshot ||
+    state.mPlayer.isDead()
+  ) {
+    return;
+  }
+
+  auto snapshot = state.createSnapshot(levelStartMap, playerModel);
+  if (mNextIndex < mSnapshots.size()) {
+    mSnapshots[mNextIndex] = std::move(snapshot);
+  } else {
+    mSnapshots.push_back(std::move(snapshot));
+  }
+
+  mNextIndex = (mNextIndex + 1) % mMaxSnapshots;
+  if (mSize < mMaxSnapshots) {
+    ++mSize;
+  }
+
+  mFramesSinceLastSnapshot = 0;
+  mMemoryTracking.setSize(memoryUsage());
+}
+
+
+bool RewindBuffer::canRewind() const {
+  return mSize > 0;
+}
+
+
+void RewindBuffer::rewind(
+  WorldState& state,
+  const data::map::Map& levelStartMap,
+  IGameServiceProvider* pServiceProvider,
+  data::PlayerModel* pPlayerModel,
+  const data::GameSessionId sessionId
+) {
+  if (!canRewind()) {
+    return;
+  }
+
+  if (mFramesSinceLastSnapshot < mFramesPerSnapshot / 2 && mSize > 1) {
+    mNextIndex = indexOfNewest();
+    --mSize;
+  }
+
+  using namespace std::chrono;
+  const auto before = high_resolution_clock::now();
+
+  state.restoreSnapshot(
+    mSnapshots[indexOfNewest()],
+    levelStartMap,
+    pServiceProvider,
+    pPlayerModel,
+    sessionId);
+
+  const auto after = high_resolution_clock::now();
+  mLastRestoreDuration = duration<double>(after - before).count();
+
+  mFramesSinceLastSnapshot = 0;
+}
+
+
+void RewindBuffer::clear() {
+  mSnapshots.clear();
+  mNextIndex = 0;
+  mSize = 0;
+  mFramesSinceLastSnapshot = mFramesPerSnapshot;
+  mMemoryTracking.setSize(0);
+}
+
+
+int RewindBuffer::historyLengthInFrames() const {
+  return static_cast<int>(mSize) * mFramesPerSnapshot;
+}
+
+
+std::size_t RewindBuffer::memoryUsage() const {
+  // Slots which have been given up by rewinding still hold on to their
+  // memory until they are overwritten, so they are included here.
+  auto total = std::size_t{0};
+  for (const auto& snapshot : mSnapshots) {
+    total += snapshot.memoryUsage();
+  }
+
+  return total;
+}
+
+
+std::size_t RewindBuffer::indexOfNewest() const {
+  return (mNextIndex + mMaxSnapshots - 1) % mMaxSnapshots;
+}
+
+}
@@ -0,0 +1,92 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/memory_tracking.hpp"
+#include "game_logic/world_state.hpp"
+
+#include <cstddef>
+#include <optional>
+#include <vector>
+
+
+namespace rigel { struct IGameServiceProvider; }
+
+
+namespace rigel::game_logic {
+
+/** Fixed-size history of world snapshots for rewinding gameplay
+ *
+ * A snapshot is captured every framesPerSnapshot logic frames. Once the buffer
+ * is full, the oldest snapshot is overwritten, so memory use is bounded by
+ * maxSnapshots times the size of a single snapshot (see
+ * WorldState::createSnapshot() for what a snapshot contains).
+ *
+ * Rewinding always returns to one of the captured snapshots. Re-simulating the
+ * frames in between would require recording input and would replay sound
+ * effects, so it's not done.
+ */
+class RewindBuffer {
+public:
+  RewindBuffer(std::size_t maxSnapshots, int framesPerSnapshot);
+
+  /** Must be called once after each logic update */
+  void update(
+    const WorldState& state,
+    const data::map::Map& levelStartMap,
+    const data::PlayerModel& playerModel);
+
+  bool canRewind() const;
+
+  /** Go back to the most recent snapshot
+   *
+   * If that snapshot was captured less than half a snapshot interval ago, it
+   * is discarded and the one before is used instead, so that rewinding
+   * repeatedly keeps going further back in time.
+   */
+  void rewind(
+    WorldState& state,
+    const data::map::Map& levelStartMap,
+    IGameServiceProvider* pServiceProvider,
+    data::PlayerModel* pPlayerModel,
+    data::GameSessionId sessionId);
+
+  void clear();
+
+  std::size_t size() const { return mSize; }
+  int historyLengthInFrames() const;
+  std::size_t memoryUsage() const;
+
+  /** Time taken by the last call to rewind() in seconds, if any */
+  std::optional<double> lastRestoreDuration() const {
+    return mLastRestoreDuration;
+  }
+
+private:
+  std::size_t indexOfNewest() const;
+
+  std::vector<WorldStateSnapshot> mSnapshots;
+  std::size_t mMaxSnapshots;
+  std::size_t mNextIndex = 0;
+  std::size_t mSize = 0;
+  int mFramesPerSnapshot;
+  int mFramesSinceLastSnapshot;
+  std::optional<double> mLastRestoreDuration;
+  base::TrackedMemory mMemoryTracking{base::MemoryTag::SavedWorldState};
+};
+
+}
@@ -0,0 +1,95 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#pragma once
+
+#include "data/actor_ids.hpp"
+#include "game_logic/ientity_factory.hpp"
+
+#include <cstdint>
+
+
+namespace rigel::game_logic::components {
+
+/** Describes how an entity was created
+ *
+ * Assigned by the entity factory and the item container system. Persistent
+ * quick saves use this to re-create entities which were spawned during
+ * gameplay, see quick_save.hpp.
+ */
+struct SpawnOrigin {
+  enum class Type : std::uint8_t {
+    /** IEntityFactory::spawnSprite() */
+    Sprite,
+
+    /** IEntityFactory::spawnSprite() with assignBoundingBox == true */
+    SpriteWithBoundingBox,
+
+    /** IEntityFactory::spawnActor(), or created when loading the level */
+    Actor,
+
+    /** IEntityFactory::spawnProjectile() */
+    Projectile,
+
+    /** Released from an item container
+     *
+     * mActorId is the actor which was initially configured as container,
+     * mContainerDepth tells how often contents had to be released to arrive
+     * at this entity (containers can contain other containers).
+     */
+    ContainerContents
+  };
+
+  static SpawnOrigin sprite(
+    const data::ActorID actorId,
+    const bool withBoundingBox
+  ) {
+    return SpawnOrigin{
+      withBoundingBox ? Type::SpriteWithBoundingBox : Type::Sprite, actorId};
+  }
+
+  static SpawnOrigin actor(const data::ActorID actorId) {
+    return SpawnOrigin{Type::Actor, actorId};
+  }
+
+  static SpawnOrigin projectile(
+    const ProjectileType type,
+    const ProjectileDirection direction
+  ) {
+    auto origin = SpawnOrigin{Type::Projectile};
+    origin.mProjectileType = type;
+    origin.mProjectileDirection = direction;
+    return origin;
+  }
+
+  static SpawnOrigin containerContents(
+    const data::ActorID actorId,
+    const int containerDepth
+  ) {
+    auto origin = SpawnOrigin{Type::ContainerContents, actorId};
+    origin.mContainerDepth = containerDepth;
+    return origin;
+  }
+
+  Type mType = Type::Actor;
+  data::ActorID mActorId = data::ActorID{};
+  ProjectileType mProjectileType = ProjectileType::Normal;
+  ProjectileDirection mProjectileDirection = ProjectileDirection::Left;
+  int mContainerDepth = 0;
+};
+
+}
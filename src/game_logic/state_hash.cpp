@@ -0,0 +1,285 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "state_hash.hpp"
+
+#include "data/player_model.hpp"
+#include "engine/base_components.hpp"
+#include "engine/physical_components.hpp"
+#include "engine/random_number_generator.hpp"
+#include "game_logic/damage_components.hpp"
+#include "game_logic/world_state.hpp"
+
+#include <array>
+#include <cstring>
+#include <iomanip>
+#include <istream>
+#include <ostream>
+#include <sstream>
+#include <stdexcept>
+
+
+namespace rigel::game_logic {
+
+namespace {
+
+using engine::components::MovingBody;
+using engine::components::WorldPosition;
+using game_logic::components::Shootable;
+
+
+struct ComponentInfo {
+  std::uint64_t StateHash::*mpMember;
+  const char* mName;
+};
+
+
+constexpr std::array<ComponentInfo, 6> COMPONENTS{{
+  {&StateHash::mPositions, "positions"},
+  {&StateHash::mVelocities, "velocities"},
+  {&StateHash::mHealth, "health"},
+  {&StateHash::mMapTiles, "mapTiles"},
+  {&StateHash::mPlayerModel, "playerModel"},
+  {&StateHash::mRandomNumberIndex, "randomNumberIndex"},
+}};
+
+
+/** 64-bit FNV-1a, fed with one integer at a time */
+class Hasher {
+public:
+  void add(const std::uint64_t value) {
+    for (auto i = 0; i < 8; ++i) {
+      mHash ^= (value >> (i * 8)) & 0xFF;
+      mHash *= FNV_PRIME;
+    }
+  }
+
+  void add(const int value) {
+    add(static_cast<std::uint64_t>(static_cast<std::int64_t>(value)));
+  }
+
+  void add(const float value) {
+    // Hashing the bit pattern instead of the value means that even tiny
+    // differences in floating point results are detected
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(std::uint64_t{bits});
+  }
+
+  std::uint64_t value() const {
+    return mHash;
+  }
+
+private:
+  static constexpr std::uint64_t FNV_OFFSET_BASIS = 0xCBF29CE484222325;
+  static constexpr std::uint64_t FNV_PRIME = 0x100000001B3;
+
+  std::uint64_t mHash = FNV_OFFSET_BASIS;
+};
+
+
+std::uint64_t hashMap(const data::map::Map& map) {
+  Hasher hasher;
+  hasher.add(map.width());
+  hasher.add(map.height());
+
+  for (auto layer = 0; layer < 2; ++layer) {
+    for (auto y = 0; y < map.height(); ++y) {
+      for (const auto tile : map.tileRow(layer, y)) {
+        hasher.add(static_cast<int>(tile));
+      }
+    }
+  }
+
+  return hasher.value();
+}
+
+
+std::uint64_t hashPlayerModel(const data::PlayerModel& model) {
+  Hasher hasher;
+  hasher.add(model.score());
+  hasher.add(model.health());
+  hasher.add(model.ammo());
+  hasher.add(static_cast<int>(model.weapon()));
+
+  hasher.add(static_cast<int>(model.inventory().size()));
+  for (const auto item : model.inventory()) {
+    hasher.add(static_cast<int>(item));
+  }
+
+  hasher.add(static_cast<int>(model.collectedLetters().size()));
+  for (const auto letter : model.collectedLetters()) {
+    hasher.add(static_cast<int>(letter));
+  }
+
+  return hasher.value();
+}
+
+}
+
+
+bool StateHash::operator==(const StateHash& other) const {
+  for (const auto& info : COMPONENTS) {
+    if (this->*info.mpMember != other.*info.mpMember) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+
+StateHash computeStateHash(
+  const WorldState& state,
+  const data::PlayerModel& playerModel
+) {
+  return computeStateHash(
+    const_cast<entityx::EntityManager&>(state.mEntities),
+    state.mMap,
+    state.mRandomGenerator,
+    playerModel);
+}
+
+
+StateHash computeStateHash(
+  entityx::EntityManager& entities,
+  const data::map::Map& map,
+  const engine::RandomNumberGenerator& randomGenerator,
+  const data::PlayerModel& playerModel
+) {
+  Hasher positions;
+  Hasher velocities;
+  Hasher health;
+
+  // Entity ids are not hashed, but iteration order follows the entity slots.
+  // So if the same set of entities ends up in different slots (e.g. because
+  // slots were reused in a different order), that still counts as a
+  // difference.
+  for (auto entity : entities.entities_for_debugging()) {
+    if (entity.has_component<WorldPosition>()) {
+      const auto& position = *entity.component<WorldPosition>();
+      positions.add(position.x);
+      positions.add(position.y);
+    }
+
+    if (entity.has_component<MovingBody>()) {
+      const auto& body = *entity.component<MovingBody>();
+      velocities.add(body.mVelocity.x);
+      velocities.add(body.mVelocity.y);
+    }
+
+    if (entity.has_component<Shootable>()) {
+      health.add(entity.component<Shootable>()->mHealth);
+    }
+  }
+
+  StateHash result;
+  result.mPositions = positions.value();
+  result.mVelocities = velocities.value();
+  result.mHealth = health.value();
+  result.mMapTiles = hashMap(map);
+  result.mPlayerModel = hashPlayerModel(playerModel);
+  result.mRandomNumberIndex = randomGenerator.nextNumberIndex();
+  return result;
+}
+
+
+std::vector<std::string> differingComponents(
+  const StateHash& a,
+  const StateHash& b
+) {
+  std::vector<std::string> result;
+
+  for (const auto& info : COMPONENTS) {
+    if (a.*info.mpMember != b.*info.mpMember) {
+      result.emplace_back(info.mName);
+    }
+  }
+
+  return result;
+}
+
+
+std::optional<StateHashMismatch> findFirstMismatch(
+  const std::vector<StateHash>& expected,
+  const std::vector<StateHash>& actual
+) {
+  const auto commonSize = std::min(expected.size(), actual.size());
+
+  for (std::size_t i = 0; i < commonSize; ++i) {
+    if (expected[i] != actual[i]) {
+      return StateHashMismatch{
+        static_cast<int>(i), differingComponents(expected[i], actual[i])};
+    }
+  }
+
+  if (expected.size() != actual.size()) {
+    return StateHashMismatch{static_cast<int>(commonSize), {"frameCount"}};
+  }
+
+  return std::nullopt;
+}
+
+
+void writeStateHashTrace(
+  std::ostream& stream,
+  const std::vector<StateHash>& trace
+) {
+  for (const auto& hash : trace) {
+    std::stringstream line;
+    line << std::hex << std::setfill('0');
+
+    for (const auto& info : COMPONENTS) {
+      if (&info != &COMPONENTS.front()) {
+        line << ' ';
+      }
+
+      line << std::setw(16) << hash.*info.mpMember;
+    }
+
+    stream << line.str() << '\n';
+  }
+}
+
+
+std::vector<StateHash> readStateHashTrace(std::istream& stream) {
+  std::vector<StateHash> result;
+
+  std::string line;
+  while (std::getline(stream, line)) {
+    if (line.empty()) {
+      continue;
+    }
+
+    std::istringstream lineStream(line);
+    lineStream >> std::hex;
+
+    StateHash hash;
+    for (const auto& info : COMPONENTS) {
+      if (!(lineStream >> hash.*info.mpMember)) {
+        throw std::invalid_argument(
+          "Malformed state hash trace in line " +
+          std::to_string(result.size() + 1));
+      }
+    }
+
+    result.push_back(hash);
+  }
+
+  return result;
+}
+
+}
@@ -0,0 +1,133 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <entityx/entityx.h>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <iosfwd>
+#include <optional>
+#include <string>
+#include <vector>
+
+
+namespace rigel::data { class PlayerModel; }
+namespace rigel::data::map { class Map; }
+namespace rigel::engine { class RandomNumberGenerator; }
+
+
+namespace rigel::game_logic {
+
+struct WorldState;
+
+
+/** Fingerprint of the game state after a logic update
+ *
+ * Each member covers one aspect of the state, so that a mismatch can be
+ * narrowed down to the part of the game logic which caused it. Only
+ * gameplay-relevant state is included, things like particles or the state of
+ * the HUD are not.
+ */
+struct StateHash {
+  /** Positions of all entities, in iteration order */
+  std::uint64_t mPositions = 0;
+
+  /** Velocities of all moving bodies */
+  std::uint64_t mVelocities = 0;
+
+  /** Health of all shootable entities */
+  std::uint64_t mHealth = 0;
+
+  /** Both layers of the map */
+  std::uint64_t mMapTiles = 0;
+
+  /** Score, health, weapon, ammo, inventory and collected letters */
+  std::uint64_t mPlayerModel = 0;
+
+  /** Position in the random number table, stored as is */
+  std::uint64_t mRandomNumberIndex = 0;
+
+  bool operator==(const StateHash& other) const;
+  bool operator!=(const StateHash& other) const {
+    return !(*this == other);
+  }
+};
+
+
+StateHash computeStateHash(
+  const WorldState& state,
+  const data::PlayerModel& playerModel);
+
+
+/** Compute a state hash from the individual parts of a world state
+ *
+ * The overload taking a WorldState forwards to this one. Exposed separately
+ * for testing, since creating a complete WorldState requires a renderer.
+ */
+StateHash computeStateHash(
+  entityx::EntityManager& entities,
+  const data::map::Map& map,
+  const engine::RandomNumberGenerator& randomGenerator,
+  const data::PlayerModel& playerModel);
+
+
+/** Names of the members of StateHash which differ between a and b */
+std::vector<std::string> differingComponents(
+  const StateHash& a,
+  const StateHash& b);
+
+
+/** First difference between two state hash traces, see findFirstMismatch() */
+struct StateHashMismatch {
+  int mFrame;
+
+  /** Names as returned by differingComponents(). If one of the traces ends
+   * before the other, this is "frameCount" instead.
+   */
+  std::vector<std::string> mComponents;
+};
+
+
+/** Compare a recorded trace to a golden one
+ *
+ * Returns std::nullopt if both traces are identical.
+ */
+std::optional<StateHashMismatch> findFirstMismatch(
+  const std::vector<StateHash>& expected,
+  const std::vector<StateHash>& actual);
+
+
+/** Write a trace as text, with one line per frame
+ *
+ * Each line holds the members of StateHash in declaration order, as
+ * hexadecimal numbers separated by spaces. This keeps traces easy to diff.
+ */
+void writeStateHashTrace(
+  std::ostream& stream,
+  const std::vector<StateHash>& trace);
+
+/** Parse a trace as written by writeStateHashTrace()
+ *
+ * Throws std::invalid_argument if the data is malformed.
+ */
+std::vector<StateHash> readStateHashTrace(std::istream& stream);
+
+}
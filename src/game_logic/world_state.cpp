@@ -23,6 +23,7 @@
 #include "engine/sprite_factory.hpp"
 #include "engine/visual_components.hpp"
 #include "game_logic/actor_tag.hpp"
+#include "game_logic/all_components.hpp"
 #include "game_logic/behavior_controller.hpp"
 #include "game_logic/collectable_components.hpp"
 #include "game_logic/damage_components.hpp"
@@ -32,11 +33,20 @@
 #include "loader/resource_loader.hpp"
 #include "renderer/renderer.hpp"
 
+#include <cstdint>
+#include <limits>
+#include <tuple>
+#include <utility>
+
 
 namespace rigel::game_logic {
 
 namespace {
 
+using namespace engine::components;
+using namespace game_logic::components;
+
+
 char EPISODE_PREFIXES[] = {'L', 'M', 'N', 'O'};
 
 
@@ -60,74 +70,233 @@ void copyComponentIfPresent(entityx::Entity from, entityx::Entity to) {
 }
 
 
-void copyAllComponents(entityx::Entity from, entityx::Entity to) {
-  using namespace engine::components;
-  using namespace game_logic::components;
-
-  copyComponentIfPresent<AppearsOnRadar>(from, to);
-  copyComponentIfPresent<ActivationSettings>(from, to);
-  copyComponentIfPresent<Active>(from, to);
-  copyComponentIfPresent<ActorTag>(from, to);
-  copyComponentIfPresent<AnimationLoop>(from, to);
-  copyComponentIfPresent<AnimationSequence>(from, to);
-  copyComponentIfPresent<AutoDestroy>(from, to);
-  copyComponentIfPresent<BehaviorController>(from, to);
-  copyComponentIfPresent<BoundingBox>(from, to);
-  copyComponentIfPresent<CollectableItem>(from, to);
-  copyComponentIfPresent<CollectableItemForCheat>(from, to);
-  copyComponentIfPresent<CollidedWithWorld>(from, to);
-  copyComponentIfPresent<DamageInflicting>(from, to);
-  copyComponentIfPresent<DestructionEffects>(from, to);
-  copyComponentIfPresent<DrawTopMost>(from, to);
-  copyComponentIfPresent<ExtendedFrameList>(from, to);
-  copyComponentIfPresent<Interactable>(from, to);
-  copyComponentIfPresent<ItemBounceEffect>(from, to);
-  copyComponentIfPresent<ItemContainer>(from, to);
-  copyComponentIfPresent<MapGeometryLink>(from, to);
-  copyComponentIfPresent<MovementSequence>(from, to);
-  copyComponentIfPresent<MovingBody>(from, to);
-  copyComponentIfPresent<Orientation>(from, to);
-  copyComponentIfPresent<OverrideDrawOrder>(from, to);
-  copyComponentIfPresent<PlayerDamaging>(from, to);
-  copyComponentIfPresent<PlayerProjectile>(from, to);
-  copyComponentIfPresent<RadarDish>(from, to);
-  copyComponentIfPresent<Shootable>(from, to);
-  copyComponentIfPresent<SolidBody>(from, to);
-  copyComponentIfPresent<Sprite>(from, to);
-  copyComponentIfPresent<SpriteCascadeSpawner>(from, to);
-  copyComponentIfPresent<TileDebris>(from, to);
-  copyComponentIfPresent<WorldPosition>(from, to);
+template <typename... Components>
+void copyAllComponents(
+  entityx::Entity from,
+  entityx::Entity to,
+  TypeList<Components...>
+) {
+  (copyComponentIfPresent<Components>(from, to), ...);
 
   assert(from.component_mask() == to.component_mask());
 }
 
+
+template <typename... Components>
+constexpr std::size_t combinedSize(TypeList<Components...>) {
+  return (sizeof(Components) + ...);
 }
 
 
-BonusRelatedItemCounts countBonusRelatedItems(entityx::EntityManager& es) {
-  using game_logic::components::ActorTag;
-  using AT = ActorTag::Type;
+template <typename... Components>
+void registerComponentTypes(
+  entityx::EntityManager& entities,
+  entityx::EventManager& events,
+  TypeList<Components...>
+) {
+  // Creating a view causes entityx to assign a family id to the type. The
+  // same goes for emitting an event.
+  (entities.entities_with_components<Components>(), ...);
+  (events.emit(entityx::ComponentAddedEvent<Components>{
+    entityx::Entity{}, entityx::ComponentHandle<Components>{}}), ...);
+  (events.emit(entityx::ComponentRemovedEvent<Components>{
+    entityx::Entity{}, entityx::ComponentHandle<Components>{}}), ...);
+}
 
-  BonusRelatedItemCounts counts;
 
-  es.each<ActorTag>([&counts](entityx::Entity, const ActorTag& tag) {
-      switch (tag.mType) {
-        case AT::ShootableCamera: ++counts.mCameraCount; break;
-        case AT::FireBomb: ++counts.mFireBombCount; break;
-        case AT::CollectableWeapon: ++counts.mWeaponCount; break;
-        case AT::Merchandise: ++counts.mMerchandiseCount; break;
-        case AT::ShootableBonusGlobe: ++counts.mBonusGlobeCount; break;
-        case AT::MountedLaserTurret: ++counts.mLaserTurretCount; break;
-
-        default:
-          break;
-      }
-    });
+template <typename T>
+using ComponentList = std::vector<std::pair<std::uint32_t, T>>;
+
+
+template <typename List>
+struct ComponentStorage;
+
+
+template <typename... Components>
+struct ComponentStorage<TypeList<Components...>> {
+  void capture(entityx::Entity entity, const std::uint32_t ordinal) {
+    (captureIfPresent<Components>(entity, ordinal), ...);
+  }
+
+  void restore(const std::vector<entityx::Entity>& entities) const {
+    (restoreAll<Components>(entities), ...);
+  }
+
+  std::size_t memoryUsage() const {
+    return (listMemoryUsage<Components>() + ...);
+  }
+
+private:
+  template <typename T>
+  void captureIfPresent(entityx::Entity entity, const std::uint32_t ordinal) {
+    if (entity.has_component<T>()) {
+      std::get<ComponentList<T>>(mLists).emplace_back(
+        ordinal, *entity.component<const T>());
+    }
+  }
+
+  template <typename T>
+  std::size_t listMemoryUsage() const {
+    const auto& list = std::get<ComponentList<T>>(mLists);
+    return list.capacity() * sizeof(typename ComponentList<T>::value_type);
+  }
+
+  template <typename T>
+  void restoreAll(const std::vector<entityx::Entity>& entities) const {
+    for (const auto& [ordinal, component] : std::get<ComponentList<T>>(mLists)) {
+      entityx::Entity entity = entities[ordinal];
+      entity.assign<T>(component);
+    }
+  }
+
+  std::tuple<ComponentList<Components>...> mLists;
+};
+
+
+struct TileChange {
+  std::uint16_t mX;
+  std::uint16_t mY;
+  std::uint8_t mLayer;
+  data::map::TileIndex mTile;
+};
+
 
+constexpr auto INVALID_ORDINAL = std::numeric_limits<std::uint32_t>::max();
+
+
+/** Copy plain global state between world states and snapshots
+ *
+ * Used by synchronizeTo(), createSnapshot() and restoreSnapshot(), so that
+ * none of them can miss a member. Whether the backdrop is switched is not
+ * included, since restoring it also requires updating the map renderer.
+ */
+template <typename Source, typename Target>
+void copyGlobalState(const Source& source, Target& target) {
+  target.mBonusInfo = source.mBonusInfo;
+  target.mLevelMusicFile = source.mLevelMusicFile;
+  target.mActivatedCheckpoint = source.mActivatedCheckpoint;
+  target.mScreenFlashColor = source.mScreenFlashColor;
+  target.mBackdropFlashColor = source.mBackdropFlashColor;
+  target.mTeleportTargetPosition = source.mTeleportTargetPosition;
+  target.mCloakPickupPosition = source.mCloakPickupPosition;
+  target.mReactorDestructionFramesElapsed =
+    source.mReactorDestructionFramesElapsed;
+  target.mScreenShakeOffsetX = source.mScreenShakeOffsetX;
+  target.mWaterAnimStep = source.mWaterAnimStep;
+  target.mBossDeathAnimationStartPending =
+    source.mBossDeathAnimationStartPending;
+  target.mLevelFinished = source.mLevelFinished;
+  target.mPlayerDied = source.mPlayerDied;
+  target.mIsOddFrame = source.mIsOddFrame;
+}
+
+}
+
+
+void registerAllComponentTypes() {
+  entityx::EventManager events;
+  entityx::EntityManager entities{events};
+  registerComponentTypes(entities, events, AllComponents{});
+}
+
+
+struct WorldStateSnapshot::Impl {
+  Impl(
+    engine::RandomNumberGenerator randomGenerator,
+    data::PlayerModel playerModel,
+    Player::Snapshot playerState,
+    Camera::Snapshot cameraState
+  )
+    : mRandomGenerator(randomGenerator)
+    , mPlayerModel(std::move(playerModel))
+    , mPlayerState(playerState)
+    , mCameraState(cameraState)
+    , mParticles(nullptr, nullptr)
+  {
+  }
+
+  std::vector<TileChange> mMapChanges;
+  ComponentStorage<AllComponents> mComponents;
+  std::vector<std::uint32_t> mLevelEntityOrdinals;
+  std::uint32_t mNumEntities = 0;
+  std::uint32_t mPlayerOrdinal = INVALID_ORDINAL;
+  std::uint32_t mActiveBossOrdinal = INVALID_ORDINAL;
+
+  engine::RandomNumberGenerator mRandomGenerator;
+  data::PlayerModel mPlayerModel;
+  Player::Snapshot mPlayerState;
+  Camera::Snapshot mCameraState;
+  engine::ParticleSystem mParticles;
+  std::optional<EarthQuakeEffect> mEarthQuakeEffect;
+
+  LevelBonusInfo mBonusInfo;
+  std::string mLevelMusicFile;
+  std::optional<CheckpointData> mActivatedCheckpoint;
+  std::optional<base::Color> mScreenFlashColor;
+  std::optional<base::Color> mBackdropFlashColor;
+  std::optional<base::Vector> mTeleportTargetPosition;
+  std::optional<base::Vector> mCloakPickupPosition;
+  std::optional<int> mReactorDestructionFramesElapsed;
+  int mScreenShakeOffsetX = 0;
+  int mWaterAnimStep = 0;
+  bool mBossDeathAnimationStartPending = false;
+  bool mBackdropSwitched = false;
+  bool mLevelFinished = false;
+  bool mPlayerDied = false;
+  bool mIsOddFrame = true;
+};
+
+
+WorldStateSnapshot::WorldStateSnapshot(std::unique_ptr<Impl> pImpl)
+  : mpImpl(std::move(pImpl))
+{
+}
+
+
+WorldStateSnapshot::WorldStateSnapshot(WorldStateSnapshot&&) noexcept =
+  default;
+WorldStateSnapshot& WorldStateSnapshot::operator=(
+  WorldStateSnapshot&&) noexcept = default;
+WorldStateSnapshot::~WorldStateSnapshot() = default;
+
+
+std::size_t WorldStateSnapshot::memoryUsage() const {
+  return sizeof(Impl) +
+    mpImpl->mMapChanges.capacity() * sizeof(TileChange) +
+    mpImpl->mComponents.memoryUsage() +
+    mpImpl->mLevelEntityOrdinals.capacity() * sizeof(std::uint32_t);
+}
+
+
+BonusRelatedItemCounts countBonusRelatedItems(const EntityTagIndex& index) {
+  using AT = game_logic::components::ActorTag::Type;
+
+  const auto count = [&](const AT type) {
+    return static_cast<int>(index.entitiesWithTag(type).size());
+  };
+
+  BonusRelatedItemCounts counts;
+  counts.mCameraCount = count(AT::ShootableCamera);
+  counts.mFireBombCount = count(AT::FireBomb);
+  counts.mWeaponCount = count(AT::CollectableWeapon);
+  counts.mMerchandiseCount = count(AT::Merchandise);
+  counts.mBonusGlobeCount = count(AT::ShootableBonusGlobe);
+  counts.mLaserTurretCount = count(AT::MountedLaserTurret);
   return counts;
 }
 
 
+data::map::LevelData loadLevelForSession(
+  const data::GameSessionId& sessionId,
+  const loader::ResourceLoader& resources
+) {
+  return loader::loadLevel(
+    levelFileName(sessionId.mEpisode, sessionId.mLevel),
+    resources,
+    sessionId.mDifficulty);
+}
+
+
 WorldState::WorldState(
   IGameServiceProvider* pServiceProvider,
   renderer::Renderer* pRenderer,
@@ -145,10 +314,7 @@ WorldState::WorldState(
       pOptions,
       pSpriteFactory,
       sessionId,
-      loader::loadLevel(
-        levelFileName(sessionId.mEpisode, sessionId.mLevel),
-        *pResources,
-        sessionId.mDifficulty))
+      loadLevelForSession(sessionId, *pResources))
 {
 }
 
@@ -164,6 +330,7 @@ WorldState::WorldState(
   data::map::LevelData&& loadedLevel
 )
   : mMap(std::move(loadedLevel.mMap))
+  , mEventQueue(&mEventManager)
   , mEntities(mEventManager)
   , mEntityFactory(
     pSpriteFactory,
@@ -173,6 +340,8 @@ WorldState::WorldState(
     pOptions,
     sessionId.mDifficulty)
   , mRadarDishCounter(mEntities, mEventManager)
+  , mEntityTagIndex(mEventManager)
+  , mEntityAllocationCounter(&mEntities, mEventManager)
   , mCollisionChecker(&mMap, mEntities, mEventManager)
   , mpOptions(pOptions)
   , mPlayer(
@@ -205,7 +374,7 @@ WorldState::WorldState(
         std::move(loadedLevel.mBackdropImage),
         std::move(loadedLevel.mSecondaryBackdropImage),
         loadedLevel.mBackdropScrollMode})
-  , mPhysicsSystem(&mCollisionChecker, &mMap, &mEventManager)
+  , mPhysicsSystem(&mCollisionChecker, &mMap, &mEventQueue)
   , mDebuggingSystem(pRenderer, &mCamera.position(), &mMap)
   , mPlayerInteractionSystem(
       sessionId,
@@ -221,7 +390,7 @@ WorldState::WorldState(
       pServiceProvider,
       &mCollisionChecker,
       &mMap)
-  , mDamageInflictionSystem(pPlayerModel, pServiceProvider, &mEventManager)
+  , mDamageInflictionSystem(pPlayerModel, pServiceProvider, &mEventQueue)
   , mDynamicGeometrySystem(
       pServiceProvider,
       &mEntities,
@@ -253,7 +422,12 @@ WorldState::WorldState(
 {
   mEntityFactory.createEntitiesForLevel(loadedLevel.mActors);
 
-  const auto counts = countBonusRelatedItems(mEntities);
+  mLevelEntities.reserve(mEntities.size());
+  for (const auto entity : mEntities.entities_for_debugging()) {
+    mLevelEntities.push_back(entity);
+  }
+
+  const auto counts = countBonusRelatedItems(mEntityTagIndex);
   mBonusInfo.mInitialCameraCount = counts.mCameraCount;
   mBonusInfo.mInitialMerchandiseCount = counts.mMerchandiseCount;
   mBonusInfo.mInitialWeaponCount = counts.mWeaponCount;
@@ -273,20 +447,8 @@ void WorldState::synchronizeTo(
   data::PlayerModel* pPlayerModel,
   const data::GameSessionId sessionId
 ) {
-  mBonusInfo = other.mBonusInfo;
-  mLevelMusicFile = other.mLevelMusicFile;
-  mActivatedCheckpoint = other.mActivatedCheckpoint;
-  mScreenFlashColor = other.mScreenFlashColor;
-  mBackdropFlashColor = other.mBackdropFlashColor;
-  mTeleportTargetPosition = other.mTeleportTargetPosition;
-  mCloakPickupPosition = other.mCloakPickupPosition;
-  mReactorDestructionFramesElapsed = other.mReactorDestructionFramesElapsed;
-  mScreenShakeOffsetX = other.mScreenShakeOffsetX;
-  mBossDeathAnimationStartPending = other.mBossDeathAnimationStartPending;
+  copyGlobalState(other, *this);
   mBackdropSwitched = other.mBackdropSwitched;
-  mLevelFinished = other.mLevelFinished;
-  mPlayerDied = other.mPlayerDied;
-  mIsOddFrame = other.mIsOddFrame;
 
   mMap = other.mMap;
   mRandomGenerator = other.mRandomGenerator;
@@ -303,6 +465,7 @@ void WorldState::synchronizeTo(
 
   mEntities.reset();
 
+  std::vector<entityx::Entity> clonesByIndex(other.mEntities.capacity());
   entityx::Entity playerEntity;
   for (
     const auto entity :
@@ -311,7 +474,8 @@ void WorldState::synchronizeTo(
   ) {
     auto clone = mEntities.create();
 
-    copyAllComponents(entity, clone);
+    copyAllComponents(entity, clone, AllComponents{});
+    clonesByIndex[entity.id().index()] = clone;
 
     if (entity == other.mPlayer.entity())
     {
@@ -324,6 +488,12 @@ void WorldState::synchronizeTo(
     }
   }
 
+  mLevelEntities.clear();
+  for (const auto& entity : other.mLevelEntities) {
+    mLevelEntities.push_back(
+      entity ? clonesByIndex[entity.id().index()] : entityx::Entity{});
+  }
+
   {
     mPlayer = Player{
       playerEntity,
@@ -340,4 +510,152 @@ void WorldState::synchronizeTo(
   }
 }
 
+
+
+WorldStateSnapshot WorldState::createSnapshot(
+  const data::map::Map& levelStartMap,
+  const data::PlayerModel& playerModel
+) const {
+  auto pImpl = std::make_unique<WorldStateSnapshot::Impl>(
+    mRandomGenerator, playerModel, mPlayer.snapshot(), mCamera.snapshot());
+
+  for (int layer = 0; layer < 2; ++layer) {
+    for (int y = 0; y < mMap.height(); ++y) {
+      const auto tiles = mMap.tileRow(layer, y);
+      const auto initialTiles =
+        levelStartMap.tileRow(layer, y, 0, mMap.width());
+
+      for (int x = 0; x < mMap.width(); ++x) {
+        const auto tile = tiles[x];
+        if (tile != initialTiles[x]) {
+          pImpl->mMapChanges.push_back(TileChange{
+            static_cast<std::uint16_t>(x),
+            static_cast<std::uint16_t>(y),
+            static_cast<std::uint8_t>(layer),
+            tile});
+        }
+      }
+    }
+  }
+
+  // Entities are identified by their position in iteration order
+  std::vector<std::uint32_t> ordinalsByIndex(
+    mEntities.capacity(), INVALID_ORDINAL);
+  std::uint32_t ordinal = 0;
+  for (
+    const auto entity :
+      const_cast<entityx::EntityManager&>(mEntities).entities_for_debugging()
+  ) {
+    pImpl->mComponents.capture(entity, ordinal);
+    ordinalsByIndex[entity.id().index()] = ordinal;
+
+    if (entity == mPlayer.entity()) {
+      pImpl->mPlayerOrdinal = ordinal;
+    }
+
+    if (entity == mActiveBossEntity) {
+      pImpl->mActiveBossOrdinal = ordinal;
+    }
+
+    ++ordinal;
+  }
+
+  pImpl->mNumEntities = ordinal;
+
+  pImpl->mLevelEntityOrdinals.reserve(mLevelEntities.size());
+  for (const auto& entity : mLevelEntities) {
+    pImpl->mLevelEntityOrdinals.push_back(
+      entity ? ordinalsByIndex[entity.id().index()] : INVALID_ORDINAL);
+  }
+
+  pImpl->mParticles.synchronizeTo(mParticles);
+  pImpl->mEarthQuakeEffect = mEarthQuakeEffect;
+
+  copyGlobalState(*this, *pImpl);
+  pImpl->mBackdropSwitched = mBackdropSwitched;
+
+  return WorldStateSnapshot{std::move(pImpl)};
+}
+
+
+void WorldState::restoreSnapshot(
+  const WorldStateSnapshot& snapshot,
+  const data::map::Map& levelStartMap,
+  IGameServiceProvider* pServiceProvider,
+  data::PlayerModel* pPlayerModel,
+  const data::GameSessionId sessionId
+) {
+  const auto& data = *snapshot.mpImpl;
+
+  copyGlobalState(data, *this);
+
+  if (mBackdropSwitched != data.mBackdropSwitched) {
+    mMapRenderer.switchBackdrops();
+    mBackdropSwitched = data.mBackdropSwitched;
+  }
+
+  mMap = levelStartMap;
+  for (const auto& change : data.mMapChanges) {
+    mMap.setTileAt(change.mLayer, change.mX, change.mY, change.mTile);
+  }
+
+  *pPlayerModel = data.mPlayerModel;
+  mRandomGenerator = data.mRandomGenerator;
+  mCamera.restoreSnapshot(data.mCameraState);
+  mParticles.synchronizeTo(data.mParticles);
+
+  if (data.mEarthQuakeEffect) {
+    mEarthQuakeEffect = EarthQuakeEffect{
+      pServiceProvider, &mRandomGenerator, &mEventManager};
+    mEarthQuakeEffect->synchronizeTo(*data.mEarthQuakeEffect);
+  } else {
+    mEarthQuakeEffect.reset();
+  }
+
+  mEntities.reset();
+
+  std::vector<entityx::Entity> entities;
+  entities.reserve(data.mNumEntities);
+  for (auto i = 0u; i < data.mNumEntities; ++i) {
+    entities.push_back(mEntities.create());
+  }
+
+  data.mComponents.restore(entities);
+
+  const auto entityAt = [&](const std::uint32_t ordinal) {
+    return ordinal != INVALID_ORDINAL ? entities[ordinal] : entityx::Entity{};
+  };
+
+  mActiveBossEntity = entityAt(data.mActiveBossOrdinal);
+
+  mLevelEntities.clear();
+  for (const auto ordinal : data.mLevelEntityOrdinals) {
+    mLevelEntities.push_back(entityAt(ordinal));
+  }
+
+  mPlayer = Player{
+    entityAt(data.mPlayerOrdinal),
+    sessionId.mDifficulty,
+    pPlayerModel,
+    pServiceProvider,
+    mpOptions,
+    &mCollisionChecker,
+    &mMap,
+    &mEntityFactory,
+    &mEventManager,
+    &mRandomGenerator};
+  mPlayer.restoreSnapshot(data.mPlayerState, mEntities);
+}
+
+
+std::size_t WorldState::memoryUsage() const {
+  // entityx keeps a pool per component type, sized according to the
+  // number of entity slots. Not all types are used by each level, so this
+  // overestimates a bit.
+  const auto mapSize = static_cast<std::size_t>(mMap.width() * mMap.height());
+  return sizeof(WorldState) +
+    2 * mapSize * sizeof(data::map::TileIndex) +
+    mEntities.capacity() * combinedSize(AllComponents{});
+}
+
 }
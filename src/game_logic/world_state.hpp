@@ -19,10 +19,13 @@
 #include "base/spatial_types.hpp"
 #include "base/warnings.hpp"
 #include "data/bonus.hpp"
+#include "data/game_session_data.hpp"
 #include "data/map.hpp"
 #include "data/player_model.hpp"
 #include "engine/collision_checker.hpp"
+#include "engine/entity_allocation_counter.hpp"
 #include "engine/entity_activation_system.hpp"
+#include "engine/event_queue.hpp"
 #include "engine/life_time_system.hpp"
 #include "engine/map_renderer.hpp"
 #include "engine/particle_system.hpp"
@@ -37,6 +40,7 @@
 #include "game_logic/earth_quake_effect.hpp"
 #include "game_logic/effects_system.hpp"
 #include "game_logic/entity_factory.hpp"
+#include "game_logic/entity_tag_index.hpp"
 #include "game_logic/interactive/enemy_radar.hpp"
 #include "game_logic/interactive/item_container.hpp"
 #include "game_logic/player.hpp"
@@ -49,7 +53,10 @@ RIGEL_DISABLE_WARNINGS
 #include <entityx/entityx.h>
 RIGEL_RESTORE_WARNINGS
 
+#include <cstddef>
+#include <memory>
 #include <string>
+#include <vector>
 
 
 namespace rigel { struct IGameServiceProvider; }
@@ -70,7 +77,23 @@ struct BonusRelatedItemCounts {
   int mLaserTurretCount = 0;
 };
 
-BonusRelatedItemCounts countBonusRelatedItems(entityx::EntityManager& es);
+BonusRelatedItemCounts countBonusRelatedItems(const EntityTagIndex& index);
+
+
+/** Load the level played in the given session, as used by WorldState */
+data::map::LevelData loadLevelForSession(
+  const data::GameSessionId& sessionId,
+  const loader::ResourceLoader& resources);
+
+
+/** Make entityx assign type ids to all component types
+ *
+ * entityx does this lazily when a component type (or the corresponding
+ * added/removed event) is first used, which is not thread-safe. When running
+ * multiple worlds on different threads, this must be called once before
+ * starting the threads.
+ */
+void registerAllComponentTypes();
 
 
 struct LevelBonusInfo {
@@ -89,6 +112,31 @@ struct CheckpointData {
   base::Vector mPosition;
 };
 
+/** Compact copy of a world state, see WorldState::createSnapshot()
+ *
+ * Map tiles are stored as differences to the level's initial map, and
+ * components are stored in densely packed per-type lists instead of a full
+ * entityx pool per type.
+ */
+class WorldStateSnapshot {
+public:
+  WorldStateSnapshot(WorldStateSnapshot&&) noexcept;
+  WorldStateSnapshot& operator=(WorldStateSnapshot&&) noexcept;
+  ~WorldStateSnapshot();
+
+  /** Approximate number of bytes occupied by the snapshot */
+  std::size_t memoryUsage() const;
+
+private:
+  friend struct WorldState;
+
+  struct Impl;
+  explicit WorldStateSnapshot(std::unique_ptr<Impl> pImpl);
+
+  std::unique_ptr<Impl> mpImpl;
+};
+
+
 struct WorldState {
   WorldState(
     IGameServiceProvider* pServiceProvider,
@@ -114,13 +162,46 @@ struct WorldState {
     data::PlayerModel* pPlayerModel,
     data::GameSessionId sessionId);
 
+  /** Capture the complete state in compact form
+   *
+   * levelStartMap must be the map as it was right after loading the level.
+   * The given player model is stored along with the world state.
+   */
+  WorldStateSnapshot createSnapshot(
+    const data::map::Map& levelStartMap,
+    const data::PlayerModel& playerModel) const;
+
+  /** Return to a state previously captured with createSnapshot()
+   *
+   * Has the same effect as synchronizeTo() with the state the snapshot was
+   * taken from. The player model stored in the snapshot is written to
+   * pPlayerModel. levelStartMap must be the same as when creating the
+   * snapshot.
+   */
+  void restoreSnapshot(
+    const WorldStateSnapshot& snapshot,
+    const data::map::Map& levelStartMap,
+    IGameServiceProvider* pServiceProvider,
+    data::PlayerModel* pPlayerModel,
+    data::GameSessionId sessionId);
+
+  /** Approximate number of bytes occupied by the world state
+   *
+   * Covers the map and the storage for entities and their components, which
+   * make up the bulk of it.
+   */
+  std::size_t memoryUsage() const;
+
   data::map::Map mMap;
 
   entityx::EventManager mEventManager;
+  engine::EventQueue mEventQueue;
   entityx::EntityManager mEntities;
   engine::RandomNumberGenerator mRandomGenerator;
   EntityFactory mEntityFactory;
   RadarDishCounter mRadarDishCounter;
+  EntityTagIndex mEntityTagIndex;
+  engine::EntityAllocationCounter mEntityAllocationCounter;
   engine::CollisionChecker mCollisionChecker;
   const data::GameOptions* mpOptions;
 
@@ -141,6 +222,14 @@ struct WorldState {
   game_logic::ItemContainerSystem mItemContainerSystem;
   game_logic::BehaviorControllerSystem mBehaviorControllerSystem;
 
+  /** All entities which existed right after loading the level
+   *
+   * In creation order, entries become invalid once the corresponding entity
+   * is destroyed. Persistent quick saves use this to identify entities, see
+   * quick_save.hpp.
+   */
+  std::vector<entityx::Entity> mLevelEntities;
+
   LevelBonusInfo mBonusInfo;
   std::string mLevelMusicFile;
   std::optional<CheckpointData> mActivatedCheckpoint;
@@ -17,6 +17,8 @@
 #include "game_main.hpp"
 
 #include "base/defer.hpp"
+#include "base/memory_tracking.hpp"
+#include "base/tracing.hpp"
 #include "frontend/game.hpp"
 #include "renderer/opengl.hpp"
 #include "sdl_utils/error.hpp"
@@ -36,6 +38,8 @@ RIGEL_RESTORE_WARNINGS
 #endif
 
 #include <filesystem>
+#include <iostream>
+#include <optional>
 
 
 namespace rigel {
@@ -146,7 +150,11 @@ void initAndRunGame(
 ) {
   auto run = [&](const CommandLineOptions& options, const bool isFirstLaunch) {
     showLoadingScreen(pWindow);
+
+    auto startupEvent =
+      std::make_optional<base::tracing::ScopedEvent>("Game startup");
     Game game(options, &userProfile, pWindow, isFirstLaunch);
+    startupEvent.reset();
 
     for (;;) {
       auto maybeStopReason = game.runOneFrame();
@@ -176,6 +184,14 @@ void initAndRunGame(
     optionsForRestartedGame.mSkipIntro = true;
     optionsForRestartedGame.mDebugModeEnabled =
       commandLineOptions.mDebugModeEnabled;
+    optionsForRestartedGame.mRewindHistorySeconds =
+      commandLineOptions.mRewindHistorySeconds;
+    optionsForRestartedGame.mThreadedSimulation =
+      commandLineOptions.mThreadedSimulation;
+    optionsForRestartedGame.mGroupedBehaviorUpdates =
+      commandLineOptions.mGroupedBehaviorUpdates;
+    optionsForRestartedGame.mDeferredGameEvents =
+      commandLineOptions.mDeferredGameEvents;
 
     while (result == Game::StopReason::RestartNeeded) {
       result = run(optionsForRestartedGame, false);
@@ -197,6 +213,11 @@ void gameMain(const CommandLineOptions& options) {
   SetProcessDPIAware();
 #endif
 
+  if (options.mTraceFile) {
+    base::tracing::enable();
+    base::tracing::setCurrentThreadName("Main");
+  }
+
   sdl_utils::check(SDL_Init(
     SDL_INIT_VIDEO | SDL_INIT_AUDIO | SDL_INIT_GAMECONTROLLER));
   auto sdlGuard = defer([]() { SDL_Quit(); });
@@ -229,6 +250,15 @@ void gameMain(const CommandLineOptions& options) {
   } catch (const std::exception& error) {
     ui::showErrorMessage(pWindow.get(), error.what());
   }
+
+  if (options.mTraceFile) {
+    base::tracing::writeTraceFile(
+      std::filesystem::u8path(*options.mTraceFile));
+  }
+
+  if (options.mMemoryReport) {
+    base::printMemoryReport(std::cout);
+  }
 }
 
 }
@@ -17,6 +17,7 @@
 #include "actor_image_package.hpp"
 
 #include "base/container_utils.hpp"
+#include "base/tracing.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/ega_image_decoder.hpp"
@@ -57,6 +58,8 @@ ActorImagePackage::ActorImagePackage(
   : mImageData(std::move(imageData))
   , mMaybeReplacementsPath(std::move(maybeImageReplacementsPath))
 {
+  RIGEL_TRACE_SCOPE("ActorImagePackage::ActorImagePackage");
+
   LeStreamReader actorInfoReader(actorInfoData);
   const auto numEntries = actorInfoReader.peekU16();
 
@@ -100,6 +103,8 @@ ActorData ActorImagePackage::loadActor(
   const ActorID id,
   const Palette16& palette
 ) const {
+  RIGEL_TRACE_SCOPE("ActorImagePackage::loadActor");
+
   // Font has to be loaded using loadFont()
   assert(id != data::ActorID::Menu_font_grayscale);
 
@@ -152,12 +157,14 @@ data::Image ActorImagePackage::loadImage(
   }
 
   const auto dataStart = mImageData.begin() + frameHeader.mFileOffset;
+  // Sprites are packed into a texture atlas together with replacement
+  // images, which are always RGBA, so the palette is applied right away.
   return loadTiledImage(
     dataStart,
     dataStart + dataSize,
     width,
     palette,
-    T::Masked);
+    T::Masked).toRgbaImage();
 }
 
 
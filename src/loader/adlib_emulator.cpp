@@ -0,0 +1,181 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "adlib_emulator.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || \
+  (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+  #define RIGEL_ADLIB_CONVERSION_SSE2
+  #include <emmintrin.h>
+#elif defined(__aarch64__) || defined(_M_ARM64)
+  #define RIGEL_ADLIB_CONVERSION_NEON
+  #include <arm_neon.h>
+#endif
+
+
+namespace rigel::loader {
+
+namespace {
+
+#if defined(RIGEL_ADLIB_CONVERSION_SSE2)
+
+constexpr auto SAMPLES_PER_ITERATION = std::size_t{8};
+
+
+__m128i clamp(const __m128i value, const __m128i min, const __m128i max) {
+  // SSE2 has no min/max for 32-bit integers
+  const auto tooLow = _mm_cmplt_epi32(value, min);
+  const auto lowClamped =
+    _mm_or_si128(_mm_and_si128(tooLow, min), _mm_andnot_si128(tooLow, value));
+  const auto tooHigh = _mm_cmpgt_epi32(lowClamped, max);
+  return _mm_or_si128(
+    _mm_and_si128(tooHigh, max), _mm_andnot_si128(tooHigh, lowClamped));
+}
+
+
+__m128i scaleAndRound(const std::int32_t* pSource, const __m128 volumeScale) {
+  const auto scaled = _mm_mul_ps(
+    _mm_cvtepi32_ps(
+      _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource))),
+    volumeScale);
+
+  // std::round rounds half away from zero, which SSE2 can't do directly.
+  // Instead, we truncate and then adjust the result by one in the direction
+  // of the sign if the fractional part was at least 0.5. The subtraction
+  // yielding the fractional part is always exact.
+  const auto truncated = _mm_cvttps_epi32(scaled);
+  const auto fraction = _mm_sub_ps(scaled, _mm_cvtepi32_ps(truncated));
+  const auto absFraction = _mm_andnot_ps(_mm_set1_ps(-0.0f), fraction);
+  const auto needsAdjustment =
+    _mm_castps_si128(_mm_cmpge_ps(absFraction, _mm_set1_ps(0.5f)));
+
+  // -1 for negative values, +1 otherwise
+  const auto direction = _mm_or_si128(
+    _mm_srai_epi32(_mm_castps_si128(scaled), 31),
+    _mm_set1_epi32(1));
+
+  return _mm_add_epi32(truncated, _mm_and_si128(needsAdjustment, direction));
+}
+
+
+std::size_t convertSamplesSimd(
+  const std::int32_t* pSource,
+  std::int16_t* pDestination,
+  const std::size_t numSamples,
+  const float volumeScale
+) {
+  const auto volume = _mm_set1_ps(volumeScale);
+  const auto min = _mm_set1_epi32(-16384);
+  const auto max = _mm_set1_epi32(16384);
+
+  auto samplesConverted = std::size_t{0};
+  for (
+    ;
+    samplesConverted + SAMPLES_PER_ITERATION <= numSamples;
+    samplesConverted += SAMPLES_PER_ITERATION
+  ) {
+    const auto pInput = pSource + samplesConverted;
+    const auto low = clamp(scaleAndRound(pInput, volume), min, max);
+    const auto high = clamp(scaleAndRound(pInput + 4, volume), min, max);
+
+    _mm_storeu_si128(
+      reinterpret_cast<__m128i*>(pDestination + samplesConverted),
+      _mm_packs_epi32(low, high));
+  }
+
+  return samplesConverted;
+}
+
+#elif defined(RIGEL_ADLIB_CONVERSION_NEON)
+
+constexpr auto SAMPLES_PER_ITERATION = std::size_t{8};
+
+
+int16x4_t convertFour(
+  const std::int32_t* pSource,
+  const float volumeScale,
+  const int32x4_t min,
+  const int32x4_t max
+) {
+  const auto scaled =
+    vmulq_n_f32(vcvtq_f32_s32(vld1q_s32(pSource)), volumeScale);
+
+  // Round to nearest with ties away from zero, same as std::round
+  const auto rounded = vcvtaq_s32_f32(scaled);
+  return vmovn_s32(vmaxq_s32(vminq_s32(rounded, max), min));
+}
+
+
+std::size_t convertSamplesSimd(
+  const std::int32_t* pSource,
+  std::int16_t* pDestination,
+  const std::size_t numSamples,
+  const float volumeScale
+) {
+  const auto min = vdupq_n_s32(-16384);
+  const auto max = vdupq_n_s32(16384);
+
+  auto samplesConverted = std::size_t{0};
+  for (
+    ;
+    samplesConverted + SAMPLES_PER_ITERATION <= numSamples;
+    samplesConverted += SAMPLES_PER_ITERATION
+  ) {
+    const auto pInput = pSource + samplesConverted;
+    vst1q_s16(
+      pDestination + samplesConverted,
+      vcombine_s16(
+        convertFour(pInput, volumeScale, min, max),
+        convertFour(pInput + 4, volumeScale, min, max)));
+  }
+
+  return samplesConverted;
+}
+
+#else
+
+std::size_t convertSamplesSimd(
+  const std::int32_t*,
+  std::int16_t*,
+  std::size_t,
+  float
+) {
+  return 0;
+}
+
+#endif
+
+}
+
+
+void convertSamples(
+  const std::int32_t* pSource,
+  std::int16_t* pDestination,
+  const std::size_t numSamples,
+  const float volumeScale
+) {
+  const auto samplesConverted =
+    convertSamplesSimd(pSource, pDestination, numSamples, volumeScale);
+
+  // Remainder which doesn't fill a whole SIMD iteration
+  convertSamplesScalar(
+    pSource + samplesConverted,
+    pDestination + samplesConverted,
+    numSamples - samplesConverted,
+    volumeScale);
+}
+
+}
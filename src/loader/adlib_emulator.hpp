@@ -22,11 +22,44 @@
 
 #include <algorithm>
 #include <array>
+#include <cstddef>
 #include <cstdint>
+#include <type_traits>
 
 
 namespace rigel::loader {
 
+/** Convert 32-bit emulator output to 16-bit samples, applying volume
+ *
+ * Each sample is multiplied by volumeScale, rounded (half away from zero) and
+ * clamped to [-16384, 16384]. Uses SIMD instructions where available, with
+ * results identical to convertSamplesScalar().
+ */
+void convertSamples(
+  const std::int32_t* pSource,
+  std::int16_t* pDestination,
+  std::size_t numSamples,
+  float volumeScale);
+
+
+/** Reference implementation of convertSamples() without SIMD */
+inline void convertSamplesScalar(
+  const std::int32_t* pSource,
+  std::int16_t* pDestination,
+  const std::size_t numSamples,
+  const float volumeScale
+) {
+  std::transform(
+    pSource,
+    pSource + numSamples,
+    pDestination,
+    [volumeScale](const std::int32_t sample32Bit) {
+      return static_cast<std::int16_t>(
+        std::clamp(base::round(sample32Bit * volumeScale), -16384, 16384));
+    });
+}
+
+
 class AdlibEmulator {
 public:
   explicit AdlibEmulator(int sampleRate)
@@ -57,22 +90,33 @@ public:
 
       mEmulator.GenerateBlock2(
         static_cast<DBOPL::Bitu>(samplesForIteration), mTempBuffer.data());
-      destination = std::transform(
-        mTempBuffer.begin(),
-        mTempBuffer.begin() + samplesForIteration,
-        destination,
-        [volumeScale](const auto sample32Bit) {
-          return static_cast<std::int16_t>(
-            std::clamp(base::round(sample32Bit * volumeScale), -16384, 16384));
-        });
+
+      if constexpr (std::is_same_v<OutputIt, std::int16_t*>) {
+        convertSamples(
+          mTempBuffer.data(), destination, samplesForIteration, volumeScale);
+        destination += samplesForIteration;
+      } else {
+        std::array<std::int16_t, TEMP_BUFFER_SIZE> converted;
+        convertSamples(
+          mTempBuffer.data(),
+          converted.data(),
+          samplesForIteration,
+          volumeScale);
+        destination = std::copy(
+          converted.begin(),
+          converted.begin() + samplesForIteration,
+          destination);
+      }
 
       numSamples -= samplesForIteration;
     }
   }
 
 private:
+  static constexpr auto TEMP_BUFFER_SIZE = std::size_t{1024};
+
   DBOPL::Chip mEmulator;
-  std::array<std::int32_t, 256> mTempBuffer;
+  std::array<std::int32_t, TEMP_BUFFER_SIZE> mTempBuffer;
 };
 
 }
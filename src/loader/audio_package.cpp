@@ -16,6 +16,7 @@
 
 #include "audio_package.hpp"
 
+#include "base/tracing.hpp"
 #include "loader/adlib_emulator.hpp"
 #include "loader/file_utils.hpp"
 
@@ -92,6 +93,8 @@ AudioPackage::AudioPackage(
   const ByteBuffer& audioDictData,
   const ByteBuffer& bundledAudioData
 ) {
+  RIGEL_TRACE_SCOPE("AudioPackage::AudioPackage");
+
   const auto audioDict = readAudioDict(audioDictData);
   if (audioDict.size() < 68u) {
     throw std::invalid_argument("Corrupt Duke Nukem II AUDIOT/AUDIOHED");
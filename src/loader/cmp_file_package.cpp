@@ -16,6 +16,7 @@
 
 #include "cmp_file_package.hpp"
 
+#include "base/tracing.hpp"
 #include "loader/file_utils.hpp"
 
 #include <algorithm>
@@ -48,7 +49,10 @@ std::string normalizedFileName(const std::string& fileName) {
 
 CMPFilePackage::CMPFilePackage(const string& filePath)
   : mFileData(loadFile(filePath))
+  , mMemoryTracking(base::MemoryTag::GameData, mFileData.size())
 {
+  RIGEL_TRACE_SCOPE("CMPFilePackage::CMPFilePackage");
+
   LeStreamReader dictReader(mFileData.begin(), mFileData.end());
 
   while (dictReader.hasData()) {
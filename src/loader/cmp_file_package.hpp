@@ -16,6 +16,7 @@
 
 #pragma once
 
+#include "base/memory_tracking.hpp"
 #include "loader/byte_buffer.hpp"
 
 #include <cstddef>
@@ -52,6 +53,7 @@ private:
 private:
   std::vector<std::uint8_t> mFileData;
   FileDict mFileDict;
+  base::TrackedMemory mMemoryTracking;
 };
 
 
@@ -16,7 +16,6 @@
 
 #include "ega_image_decoder.hpp"
 
-#include "base/container_utils.hpp"
 #include "base/math_tools.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/bitwise_iter.hpp"
@@ -31,13 +30,12 @@ namespace rigel::loader {
 
 using namespace std;
 using data::GameTraits;
+using data::IndexedPixelBuffer;
 using data::PixelBuffer;
 using data::tilesToPixels;
 
 namespace {
 
-using PalettizedPixelBuffer = std::vector<std::uint8_t>;
-
 
 size_t inferHeight(
   const ByteBufferCIter begin,
@@ -142,15 +140,34 @@ void applyEgaMask(
 }
 
 
-template<typename Callable>
-data::PixelBuffer decodeTiledEgaData(
+/** Apply mask to decoded palette indices
+ *
+ * Like applyEgaMask, but replaces masked pixels with MASKED_PIXEL_INDEX.
+ */
+template<typename MaskIter, typename IndexIter>
+void applyEgaMaskToIndices(
+  MaskIter maskValues,
+  IndexIter indices,
+  const size_t pixelCount
+) {
+  for (size_t i = 0; i < pixelCount; ++i, ++indices) {
+    const auto maskActive = *maskValues++;
+    if (maskActive) {
+      *indices = MASKED_PIXEL_INDEX;
+    }
+  }
+}
+
+
+template<typename Buffer, typename Callable>
+Buffer decodeTiledEgaData(
   const ByteBufferCIter dataIter,
   const std::size_t widthInTiles,
   const std::size_t heightInTiles,
   Callable decodeRow
 ) {
   const auto targetBufferStride = tilesToPixels(widthInTiles);
-  PixelBuffer pixels(
+  Buffer pixels(
     widthInTiles * heightInTiles * GameTraits::tileSizeSquared);
 
   BitWiseIterator<ByteBufferCIter> bitsIter(dataIter);
@@ -172,10 +189,22 @@ data::PixelBuffer decodeTiledEgaData(
 }
 
 
-data::PixelBuffer decodeSimplePlanarEgaBuffer(
+data::Palette makeImagePalette(
+  const Palette16& palette,
+  const data::TileImageType type
+) {
+  auto result = data::Palette(palette.begin(), palette.end());
+  if (type == data::TileImageType::Masked) {
+    result.push_back(data::Pixel{0, 0, 0, 0});
+  }
+
+  return result;
+}
+
+
+data::IndexedPixelBuffer decodeSimplePlanarEgaBuffer(
   const ByteBufferCIter begin,
-  const ByteBufferCIter end,
-  const Palette16& palette
+  const ByteBufferCIter end
 ) {
   const auto numBytes = distance(begin, end);
   assert(numBytes > 0);
@@ -184,17 +213,13 @@ data::PixelBuffer decodeSimplePlanarEgaBuffer(
     GameTraits::pixelsPerEgaByte;
 
   BitWiseIterator<ByteBufferCIter> bitsIter(begin);
-  PalettizedPixelBuffer indexedPixels(numPixels, 0);
+  IndexedPixelBuffer indexedPixels(numPixels, 0);
   readEgaColorData(bitsIter, indexedPixels.begin(), numPixels);
-
-  return utils::transformed(indexedPixels,
-    [&palette](const auto colorIndex) {
-      return palette[colorIndex];
-    });
+  return indexedPixels;
 }
 
 
-data::Image loadTiledImage(
+data::IndexedImage loadTiledImage(
   const ByteBufferCIter begin,
   const ByteBufferCIter end,
   std::size_t widthInTiles,
@@ -204,8 +229,11 @@ data::Image loadTiledImage(
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerTile(type));
 
-  auto pixels = decodeTiledEgaData(begin, widthInTiles, heightInTiles,
-    [&palette, type](auto sourceBitsIter, const auto targetPixelIter) {
+  auto pixels = decodeTiledEgaData<IndexedPixelBuffer>(
+    begin,
+    widthInTiles,
+    heightInTiles,
+    [type](auto sourceBitsIter, const auto targetPixelIter) {
       const auto isMasked = type == data::TileImageType::Masked;
       array<bool, GameTraits::tileSize> pixelMask;
       if (isMasked) {
@@ -213,26 +241,24 @@ data::Image loadTiledImage(
           sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
       }
 
-      array<uint8_t, GameTraits::tileSize> indexedPixels;
-      indexedPixels.fill(0);
+      // The target buffer is zero-initialized, as required by
+      // readEgaColorData()
       sourceBitsIter = readEgaColorData(
-        sourceBitsIter, indexedPixels.begin(), GameTraits::tileSize);
-
-      for (auto i=0; i<GameTraits::tileSize; ++i) {
-        *(targetPixelIter + i) = palette[indexedPixels[i]];
-      }
+        sourceBitsIter, targetPixelIter, GameTraits::tileSize);
 
       if (isMasked) {
-        applyEgaMask(pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
+        applyEgaMaskToIndices(
+          pixelMask.begin(), targetPixelIter, GameTraits::tileSize);
       }
 
       return sourceBitsIter;
     });
 
-  return data::Image(
+  return data::IndexedImage(
     std::move(pixels),
     tilesToPixels(widthInTiles),
-    tilesToPixels(heightInTiles));
+    tilesToPixels(heightInTiles),
+    makeImagePalette(palette, type));
 }
 
 
@@ -244,7 +270,10 @@ data::Image loadTiledFontBitmap(
   const auto heightInTiles =
     inferHeight(begin, end, widthInTiles, GameTraits::bytesPerFontTile());
 
-  auto pixels = decodeTiledEgaData(begin, widthInTiles, heightInTiles,
+  auto pixels = decodeTiledEgaData<PixelBuffer>(
+    begin,
+    widthInTiles,
+    heightInTiles,
     [](auto sourceBitsIter, const auto targetPixelIter) {
       array<bool, GameTraits::tileSize> pixelMask;
       sourceBitsIter = readEgaMaskPlane(sourceBitsIter, pixelMask.begin(), GameTraits::tileSize);
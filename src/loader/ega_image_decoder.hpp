@@ -21,16 +21,35 @@
 #include "data/game_traits.hpp"
 #include "data/image.hpp"
 
+#include <cstdint>
+
 
 namespace rigel::loader {
 
-data::PixelBuffer decodeSimplePlanarEgaBuffer(
+/** Palette index used for transparent pixels in masked images
+ *
+ * The palette of images produced by loadTiledImage() with
+ * TileImageType::Masked has an additional fully transparent entry at this
+ * index, following the 16 regular colors.
+ */
+constexpr auto MASKED_PIXEL_INDEX = std::uint8_t{16};
+
+
+/** Make a palette for an IndexedImage from a 16 color EGA palette
+ *
+ * For masked images, this includes the entry at MASKED_PIXEL_INDEX.
+ */
+data::Palette makeImagePalette(
+  const Palette16& palette,
+  data::TileImageType type = data::TileImageType::Unmasked);
+
+
+data::IndexedPixelBuffer decodeSimplePlanarEgaBuffer(
   ByteBufferCIter begin,
-  ByteBufferCIter end,
-  const Palette16& palette);
+  ByteBufferCIter end);
 
 
-data::Image loadTiledImage(
+data::IndexedImage loadTiledImage(
   ByteBufferCIter begin,
   ByteBufferCIter end,
   std::size_t widthInTiles,
@@ -38,7 +57,7 @@ data::Image loadTiledImage(
   data::TileImageType type);
 
 
-inline data::Image loadTiledImage(
+inline data::IndexedImage loadTiledImage(
   const ByteBuffer& data,
   std::size_t widthInTiles,
   const Palette16& palette,
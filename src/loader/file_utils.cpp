@@ -62,6 +62,24 @@ void saveToFile(
 }
 
 
+void saveToFileAtomically(
+  const loader::ByteBuffer& buffer,
+  const std::filesystem::path& filePath
+) {
+  auto tempFilePath = filePath;
+  tempFilePath += ".tmp";
+
+  try {
+    saveToFile(buffer, tempFilePath);
+    std::filesystem::rename(tempFilePath, filePath);
+  } catch (const std::exception&) {
+    std::error_code ec;
+    std::filesystem::remove(tempFilePath, ec);
+    throw;
+  }
+}
+
+
 std::string asText(const ByteBuffer& buffer) {
   const auto pBytesAsChars = reinterpret_cast<const char*>(buffer.data());
   return std::string(pBytesAsChars, pBytesAsChars + buffer.size());
@@ -219,4 +237,36 @@ string readFixedSizeString(LeStreamReader& reader, const size_t len) {
   return string(characters.data());
 }
 
+
+void LeStreamWriter::writeU8(const uint8_t value) {
+  mData.push_back(value);
+}
+
+
+void LeStreamWriter::writeU16(const uint16_t value) {
+  writeU8(static_cast<uint8_t>(value & 0xFF));
+  writeU8(static_cast<uint8_t>(value >> 8));
+}
+
+
+void LeStreamWriter::writeU32(const uint32_t value) {
+  writeU16(static_cast<uint16_t>(value & 0xFFFF));
+  writeU16(static_cast<uint16_t>(value >> 16));
+}
+
+
+void LeStreamWriter::writeS8(const int8_t value) {
+  writeU8(static_cast<uint8_t>(value));
+}
+
+
+void LeStreamWriter::writeS16(const int16_t value) {
+  writeU16(static_cast<uint16_t>(value));
+}
+
+
+void LeStreamWriter::writeS32(const int32_t value) {
+  writeU32(static_cast<uint32_t>(value));
+}
+
 }
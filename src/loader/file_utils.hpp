@@ -21,6 +21,7 @@
 #include <cstdint>
 #include <filesystem>
 #include <string>
+#include <utility>
 
 
 namespace rigel::loader {
@@ -39,6 +40,15 @@ void saveToFile(
   const loader::ByteBuffer& buffer,
   const std::filesystem::path& filePath);
 
+/** Like saveToFile(), but never leaves a partially written file behind
+ *
+ * The data is first written to a temporary file next to the target, which
+ * then replaces the target. If anything fails, the target is left untouched.
+ */
+void saveToFileAtomically(
+  const loader::ByteBuffer& buffer,
+  const std::filesystem::path& filePath);
+
 std::string asText(const ByteBuffer& buffer);
 
 
@@ -89,4 +99,28 @@ private:
 std::string readFixedSizeString(LeStreamReader& reader, std::size_t len);
 
 
+/** Counterpart to LeStreamReader, writes little-endian data into a buffer */
+class LeStreamWriter {
+public:
+  void writeU8(std::uint8_t value);
+  void writeU16(std::uint16_t value);
+  void writeU32(std::uint32_t value);
+
+  void writeS8(std::int8_t value);
+  void writeS16(std::int16_t value);
+  void writeS32(std::int32_t value);
+
+  const ByteBuffer& data() const {
+    return mData;
+  }
+
+  ByteBuffer takeData() {
+    return std::move(mData);
+  }
+
+private:
+  ByteBuffer mData;
+};
+
+
 }
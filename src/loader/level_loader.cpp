@@ -19,6 +19,7 @@
 #include "base/container_utils.hpp"
 #include "base/grid.hpp"
 #include "base/math_tools.hpp"
+#include "base/tracing.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/bitwise_iter.hpp"
@@ -500,6 +501,8 @@ LevelData loadLevel(
   const ResourceLoader& resources,
   const Difficulty chosenDifficulty
 ) {
+  RIGEL_TRACE_SCOPE("loadLevel");
+
   const auto levelData = resources.file(mapName);
   LeStreamReader levelReader(levelData);
 
@@ -585,7 +588,7 @@ LevelData loadLevel(
   }
 
   auto backdropImage = resources.loadTiledFullscreenImage(header.backdrop);
-  std::optional<data::Image> alternativeBackdropImage;
+  std::optional<data::IndexedImage> alternativeBackdropImage;
   if (header.flagBitSet(0x40) || header.flagBitSet(0x80)) {
     alternativeBackdropImage = resources.loadTiledFullscreenImage(
       backdropNameFromNumber(header.alternativeBackdropNumber));
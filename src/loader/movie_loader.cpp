@@ -20,7 +20,10 @@
 #include "loader/palette.hpp"
 #include "loader/rle_compression.hpp"
 
+#include <algorithm>
+#include <iterator>
 #include <stdexcept>
+#include <utility>
 
 
 /* Duke Nukem II Movie/Animation loader
@@ -110,42 +113,36 @@ Palette256 readPalette(LeStreamReader& reader) {
 }
 
 
-data::PixelBuffer readMainImagePixels(
+template<typename Callback>
+void decodeMainImage(
   LeStreamReader& reader,
-  const uint16_t width,
   const uint16_t height,
-  const Palette256& palette
+  Callback callback
 ) {
   SubChunkHeader mainImageSubChunkHeader(reader);
   if (mainImageSubChunkHeader.mType != SubChunkType::MainImage) {
     throw invalid_argument(INVALID_MOVIE_FILE);
   }
 
-  data::PixelBuffer mainImagePixels;
-  mainImagePixels.reserve(width * height);
-
   for (auto row=0u; row<height; ++row) {
     const auto numRLEFlagsInRow = reader.readU8();
-    decompressRle(reader, numRLEFlagsInRow,
-      [&mainImagePixels, &palette](const auto colorIndex) {
-        mainImagePixels.push_back(palette[colorIndex]);
-      });
+    decompressRle(reader, numRLEFlagsInRow, callback);
   }
-
-  return mainImagePixels;
 }
 
 
-data::PixelBuffer readAnimationFramePixels(
+/** Decode the rows of an animation frame
+ *
+ * Invokes the callback with (row, column, colorIndex) for each pixel that's
+ * replaced by the frame. Row numbers are relative to the frame's start row.
+ */
+template<typename Callback>
+void decodeAnimationFrameRows(
   LeStreamReader& reader,
-  const uint16_t width,
-  const uint16_t height,
-  const Palette256& palette
+  const uint16_t numRows,
+  Callback callback
 ) {
-  data::PixelBuffer framePixels(width * height, data::Pixel{});
-
-  for (auto row=0u; row<height; ++row) {
-    const auto startOffset = row * width;
+  for (auto row=0; row<numRows; ++row) {
     auto targetCol = 0;
 
     const auto numRleWords = reader.readU8();
@@ -157,18 +154,73 @@ data::PixelBuffer readAnimationFramePixels(
       // chunks...
       const auto invertedMarkerByte = reader.readS8();
       expandSingleRleWord(-invertedMarkerByte, reader,
-        [&framePixels, &palette, &targetCol, startOffset](
-          const auto colorIndex
-        ) {
-          framePixels[targetCol++ + startOffset] = palette[colorIndex];
+        [&callback, &targetCol, row](const auto colorIndex) {
+          callback(row, targetCol++, colorIndex);
         });
     }
   }
+}
+
+
+data::PixelBuffer readMainImagePixels(
+  LeStreamReader& reader,
+  const uint16_t width,
+  const uint16_t height,
+  const Palette256& palette
+) {
+  data::PixelBuffer mainImagePixels;
+  mainImagePixels.reserve(width * height);
+
+  decodeMainImage(reader, height,
+    [&mainImagePixels, &palette](const auto colorIndex) {
+      mainImagePixels.push_back(palette[colorIndex]);
+    });
+
+  return mainImagePixels;
+}
+
+
+data::PixelBuffer readAnimationFramePixels(
+  LeStreamReader& reader,
+  const uint16_t width,
+  const uint16_t height,
+  const Palette256& palette
+) {
+  data::PixelBuffer framePixels(width * height, data::Pixel{});
+
+  decodeAnimationFrameRows(reader, height,
+    [&framePixels, &palette, width](
+      const int row,
+      const int col,
+      const auto colorIndex
+    ) {
+      framePixels[col + row * width] = palette[colorIndex];
+    });
 
   return framePixels;
 }
 
 
+/** Reads the headers preceding an animation frame's pixel data
+ *
+ * Returns the frame's start row and number of rows.
+ */
+pair<uint16_t, uint16_t> readAnimationFrameHeader(LeStreamReader& reader) {
+  ChunkHeader frameChunkHeader(reader);
+  SubChunkHeader frameChunkSubHeader(reader);
+  if (
+    frameChunkHeader.mNumSubChunks != 1 ||
+    frameChunkSubHeader.mType != SubChunkType::AnimationFrame
+  ) {
+    throw invalid_argument(INVALID_MOVIE_FILE);
+  }
+
+  const auto yOffset = reader.readU16();
+  const auto numRows = reader.readU16();
+  return {yOffset, numRows};
+}
+
+
 vector<data::MovieFrame> readAnimationFrames(
   LeStreamReader& reader,
   const uint16_t width,
@@ -177,17 +229,7 @@ vector<data::MovieFrame> readAnimationFrames(
 ) {
   vector<data::MovieFrame> frames;
   for (auto frame=0u; frame<numAnimFrames; ++frame) {
-    ChunkHeader frameChunkHeader(reader);
-    SubChunkHeader frameChunkSubHeader(reader);
-    if (
-      frameChunkHeader.mNumSubChunks != 1 ||
-      frameChunkSubHeader.mType != SubChunkType::AnimationFrame
-    ) {
-      throw invalid_argument(INVALID_MOVIE_FILE);
-    }
-
-    const auto yOffset = reader.readU16();
-    const auto numRows = reader.readU16();
+    const auto [yOffset, numRows] = readAnimationFrameHeader(reader);
     frames.emplace_back(
       data::Image(
         readAnimationFramePixels(reader, width, numRows, palette),
@@ -199,27 +241,45 @@ vector<data::MovieFrame> readAnimationFrames(
   return frames;
 }
 
+
+struct FileHeader {
+  explicit FileHeader(LeStreamReader& reader, const ByteBuffer& file)
+    : mFileSize(reader.readU32())
+    , mType(reader.readU16())
+    , mNumAnimFrames(reader.readU16())
+    , mWidth(reader.readU16())
+    , mHeight(reader.readU16())
+  {
+    reader.skipBytes(4 + 4); // unknown1, unknown2
+    reader.skipBytes(108); // padding
+
+    if (mFileSize != file.size() || mType != 0xAF11) {
+      throw invalid_argument(INVALID_MOVIE_FILE);
+    }
+
+    ChunkHeader mainImageChunkHeader(reader);
+    if (mainImageChunkHeader.mNumSubChunks != 2) {
+      throw invalid_argument(INVALID_MOVIE_FILE);
+    }
+  }
+
+  uint32_t mFileSize = 0;
+  uint16_t mType = 0;
+  uint16_t mNumAnimFrames = 0;
+  uint16_t mWidth = 0;
+  uint16_t mHeight = 0;
+};
+
 }
 
 
 data::Movie loadMovie(const ByteBuffer& file) {
   LeStreamReader reader(file);
 
-  const auto fileSize = reader.readU32();
-  const auto type = reader.readU16();
-  const auto numAnimFrames = reader.readU16();
-  const auto width = reader.readU16();
-  const auto height = reader.readU16();
-  reader.skipBytes(4 + 4); // unknown1, unknown2
-  reader.skipBytes(108); // padding
-
-  if (fileSize != file.size() || type != 0xAF11) {
-    throw invalid_argument(INVALID_MOVIE_FILE);
-  }
-  ChunkHeader mainImageChunkHeader(reader);
-  if (mainImageChunkHeader.mNumSubChunks != 2) {
-    throw invalid_argument(INVALID_MOVIE_FILE);
-  }
+  const auto header = FileHeader{reader, file};
+  const auto numAnimFrames = header.mNumAnimFrames;
+  const auto width = header.mWidth;
+  const auto height = header.mHeight;
   const auto palette = readPalette(reader);
   auto mainImagePixels =
     readMainImagePixels(reader, width, height, palette);
@@ -233,4 +293,129 @@ data::Movie loadMovie(const ByteBuffer& file) {
 }
 
 
+MovieDecoder::MovieDecoder(ByteBuffer file)
+  : mFile(std::move(file))
+{
+  LeStreamReader reader(mFile);
+
+  const auto header = FileHeader{reader, mFile};
+  mNumFrames = header.mNumAnimFrames;
+  mWidth = header.mWidth;
+  mHeight = header.mHeight;
+
+  mPalette = readPalette(reader);
+  mBaseImageOffset = distance(mFile.cbegin(), reader.currentIter());
+
+  // We need to decode the base image once in order to know where the
+  // animation frames start
+  rewind();
+
+  mMemoryTracking.setSize(mFile.size() + mIndexedPixels.capacity());
+}
+
+
+data::Image MovieDecoder::decodeBaseImage() {
+  rewind();
+
+  data::PixelBuffer pixels;
+  convertRows(0, mHeight, pixels);
+  return data::Image(std::move(pixels), mWidth, mHeight);
+}
+
+
+data::MovieFrame MovieDecoder::decodeNextFrame() {
+  const auto [yOffset, numRows] = applyNextFrame();
+
+  data::PixelBuffer pixels;
+  convertRows(yOffset, numRows, pixels);
+  return data::MovieFrame{
+    data::Image(std::move(pixels), mWidth, numRows), yOffset};
+}
+
+
+void MovieDecoder::seekToFrame(const int frameIndex) {
+  if (frameIndex < 0 || frameIndex >= mNumFrames) {
+    throw invalid_argument("Movie frame index out of range");
+  }
+
+  rewind();
+
+  // Animation frames are deltas, so we have to replay all frames up to the
+  // target. Only the indexed state is updated, no conversion is needed.
+  while (mNextFrameIndex < frameIndex) {
+    applyNextFrame();
+  }
+}
+
+
+void MovieDecoder::restartAnimation() {
+  mNextFrameOffset = mFirstFrameOffset;
+  mNextFrameIndex = 0;
+}
+
+
+void MovieDecoder::rewind() {
+  LeStreamReader reader(mFile.cbegin() + mBaseImageOffset, mFile.cend());
+
+  mIndexedPixels.clear();
+  mIndexedPixels.reserve(mWidth * mHeight);
+  decodeMainImage(reader, static_cast<uint16_t>(mHeight),
+    [this](const auto colorIndex) {
+      mIndexedPixels.push_back(colorIndex);
+    });
+  mIndexedPixels.resize(mWidth * mHeight);
+
+  mFirstFrameOffset = distance(mFile.cbegin(), reader.currentIter());
+  mNextFrameOffset = mFirstFrameOffset;
+  mNextFrameIndex = 0;
+}
+
+
+pair<int, int> MovieDecoder::applyNextFrame() {
+  if (mNumFrames == 0) {
+    throw invalid_argument(INVALID_MOVIE_FILE);
+  }
+
+  if (mNextFrameIndex >= mNumFrames) {
+    restartAnimation();
+  }
+
+  LeStreamReader reader(mFile.cbegin() + mNextFrameOffset, mFile.cend());
+
+  const auto [yOffset, numRows] = readAnimationFrameHeader(reader);
+  if (yOffset + numRows > mHeight) {
+    throw invalid_argument(INVALID_MOVIE_FILE);
+  }
+
+  const auto startOffset = yOffset * mWidth;
+  decodeAnimationFrameRows(reader, numRows,
+    [this, startOffset](const int row, const int col, const auto colorIndex) {
+      if (col >= mWidth) {
+        throw invalid_argument(INVALID_MOVIE_FILE);
+      }
+
+      mIndexedPixels[startOffset + row * mWidth + col] = colorIndex;
+    });
+
+  mNextFrameOffset = distance(mFile.cbegin(), reader.currentIter());
+  ++mNextFrameIndex;
+
+  return {yOffset, numRows};
+}
+
+
+void MovieDecoder::convertRows(
+  const int firstRow,
+  const int numRows,
+  data::PixelBuffer& target
+) const {
+  const auto iFirst = mIndexedPixels.begin() + firstRow * mWidth;
+  const auto iLast = iFirst + numRows * mWidth;
+
+  target.resize(numRows * mWidth);
+  transform(iFirst, iLast, target.begin(),
+    [this](const uint8_t colorIndex) { return mPalette[colorIndex]; });
+}
+
+
 }
@@ -16,8 +16,15 @@
 
 #pragma once
 
+#include "base/memory_tracking.hpp"
 #include "data/movie.hpp"
 #include "loader/byte_buffer.hpp"
+#include "loader/palette.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
 
 
 namespace rigel::loader {
@@ -25,4 +32,85 @@ namespace rigel::loader {
 data::Movie loadMovie(const ByteBuffer& file);
 
 
+/** Incremental movie decoder
+ *
+ * As opposed to loadMovie(), which expands the entire movie into RGBA images
+ * up-front, this decodes one animation frame at a time. The current state of
+ * the movie is kept as palette indices, and only the rows which are replaced
+ * by a frame are converted to RGBA. This way, only a single frame's worth of
+ * RGBA data needs to exist at any time.
+ *
+ * Frames are decoded in order. After the last frame, decoding wraps around to
+ * the first frame again, applying it on top of the current state - this
+ * matches how the movie looks when played back in a loop.
+ */
+class MovieDecoder {
+public:
+  explicit MovieDecoder(ByteBuffer file);
+
+  /** Decode the full first image of the movie
+   *
+   * This also resets decoding so that the next call to decodeNextFrame()
+   * returns the first animation frame.
+   */
+  data::Image decodeBaseImage();
+
+  /** Decode the next animation frame
+   *
+   * The returned frame contains complete rows, i.e. pixels which are
+   * not changed by the frame are filled in from the current movie state.
+   */
+  data::MovieFrame decodeNextFrame();
+
+  /** Reset decoding state so that the next call to decodeNextFrame()
+   * returns the given frame
+   *
+   * Throws std::invalid_argument if the frame index is out of range.
+   */
+  void seekToFrame(int frameIndex);
+
+  /** Make the next call to decodeNextFrame() return the first animation
+   * frame, applied on top of the current movie state
+   *
+   * Unlike seekToFrame(0), this doesn't go back to the base image. This
+   * matches what happens when rendering frames from loadMovie() onto a
+   * canvas and jumping back to the first frame.
+   */
+  void restartAnimation();
+
+  int nextFrameIndex() const {
+    return mNextFrameIndex;
+  }
+
+  int numFrames() const {
+    return mNumFrames;
+  }
+
+  int width() const {
+    return mWidth;
+  }
+
+  int height() const {
+    return mHeight;
+  }
+
+private:
+  void rewind();
+  std::pair<int, int> applyNextFrame();
+  void convertRows(int firstRow, int numRows, data::PixelBuffer& target) const;
+
+  ByteBuffer mFile;
+  Palette256 mPalette;
+  std::vector<std::uint8_t> mIndexedPixels;
+  std::size_t mBaseImageOffset;
+  std::size_t mFirstFrameOffset = 0;
+  std::size_t mNextFrameOffset = 0;
+  int mNextFrameIndex = 0;
+  int mNumFrames;
+  int mWidth;
+  int mHeight;
+  base::TrackedMemory mMemoryTracking{base::MemoryTag::Movies};
+};
+
+
 }
@@ -17,6 +17,7 @@
 #include "resource_loader.hpp"
 
 #include "base/container_utils.hpp"
+#include "base/tracing.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
 #include "loader/ega_image_decoder.hpp"
@@ -81,17 +82,19 @@ ResourceLoader::ResourceLoader(const std::string& gamePath)
 }
 
 
-data::Image ResourceLoader::loadTiledFullscreenImage(
+data::IndexedImage ResourceLoader::loadTiledFullscreenImage(
   const std::string& name
 ) const {
   return loadTiledFullscreenImage(name, INGAME_PALETTE);
 }
 
 
-data::Image ResourceLoader::loadTiledFullscreenImage(
+data::IndexedImage ResourceLoader::loadTiledFullscreenImage(
   const std::string& name,
   const Palette16& overridePalette
 ) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadTiledFullscreenImage");
+
   return loadTiledImage(
     file(name),
     data::GameTraits::viewPortWidthTiles,
@@ -100,9 +103,11 @@ data::Image ResourceLoader::loadTiledFullscreenImage(
 }
 
 
-data::Image ResourceLoader::loadStandaloneFullscreenImage(
+data::IndexedImage ResourceLoader::loadStandaloneFullscreenImage(
   const std::string& name
 ) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadStandaloneFullscreenImage");
+
   const auto& data = file(name);
   const auto paletteStart = data.begin() + FULL_SCREEN_IMAGE_DATA_SIZE;
   const auto palette = load6bitPalette16(
@@ -111,16 +116,18 @@ data::Image ResourceLoader::loadStandaloneFullscreenImage(
 
   auto pixels = decodeSimplePlanarEgaBuffer(
     data.begin(),
-    data.begin() + FULL_SCREEN_IMAGE_DATA_SIZE,
-    palette);
-  return data::Image(
+    data.begin() + FULL_SCREEN_IMAGE_DATA_SIZE);
+  return data::IndexedImage(
     std::move(pixels),
     GameTraits::viewPortWidthPx,
-    GameTraits::viewPortHeightPx);
+    GameTraits::viewPortHeightPx,
+    makeImagePalette(palette));
 }
 
 
-data::Image ResourceLoader::loadAntiPiracyImage() const {
+data::IndexedImage ResourceLoader::loadAntiPiracyImage() const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadAntiPiracyImage");
+
   using namespace std;
 
   // For some reason, the anti-piracy screen is in a different format than all
@@ -132,14 +139,11 @@ data::Image ResourceLoader::loadAntiPiracyImage() const {
   const auto iImageStart = begin(data) + 256*3;
   const auto palette = load6bitPalette256(begin(data), iImageStart);
 
-  data::PixelBuffer pixels;
-  pixels.reserve(GameTraits::viewPortWidthPx * GameTraits::viewPortHeightPx);
-  transform(iImageStart, end(data), back_inserter(pixels),
-    [&palette](const auto indexedPixel) { return palette[indexedPixel]; });
-  return data::Image(
-    move(pixels),
+  return data::IndexedImage(
+    data::IndexedPixelBuffer(iImageStart, end(data)),
     GameTraits::viewPortWidthPx,
-    GameTraits::viewPortHeightPx);
+    GameTraits::viewPortHeightPx,
+    data::Palette(palette.begin(), palette.end()));
 }
 
 
@@ -153,6 +157,8 @@ loader::Palette16 ResourceLoader::loadPaletteFromFullScreenImage(
 
 
 TileSet ResourceLoader::loadCZone(const std::string& name) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadCZone");
+
   using namespace data;
   using namespace map;
   using T = data::TileImageType;
@@ -171,15 +177,18 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const {
     }
   }
 
-  Image fullImage(
+  IndexedImage fullImage(
     tilesToPixels(GameTraits::CZone::tileSetImageWidth),
-    tilesToPixels(GameTraits::CZone::tileSetImageHeight));
+    tilesToPixels(GameTraits::CZone::tileSetImageHeight),
+    makeImagePalette(INGAME_PALETTE, T::Masked));
 
   const auto tilesBegin =
     data.begin() + GameTraits::CZone::attributeBytesTotal;
   const auto maskedTilesBegin =
     tilesBegin + GameTraits::CZone::numSolidTiles*GameTraits::CZone::tileBytes;
 
+  // The solid tiles' palette lacks the transparent entry, but is otherwise
+  // identical, so they can be inserted into the combined image as well.
   const auto solidTilesImage = loadTiledImage(
     tilesBegin,
     maskedTilesBegin,
@@ -203,16 +212,27 @@ TileSet ResourceLoader::loadCZone(const std::string& name) const {
 
 
 data::Movie ResourceLoader::loadMovie(const std::string& name) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadMovie");
+
   return loader::loadMovie(loadFile(mGamePath / fs::u8path(name)));
 }
 
 
+MovieDecoder ResourceLoader::openMovie(const std::string& name) const {
+  return MovieDecoder(loadFile(mGamePath / fs::u8path(name)));
+}
+
+
 data::Song ResourceLoader::loadMusic(const std::string& name) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadMusic");
+
   return loader::loadSong(file(name));
 }
 
 
 data::AudioBuffer ResourceLoader::loadSound(const data::SoundId id) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadSound");
+
   static const std::map<data::SoundId, const char*> INTRO_SOUND_MAP{
     {data::SoundId::IntroGunShot, "INTRO3.MNI"},
     {data::SoundId::IntroGunShotLow, "INTRO4.MNI"},
@@ -247,11 +267,15 @@ data::AudioBuffer ResourceLoader::loadSound(const std::string& name) const {
 ScriptBundle ResourceLoader::loadScriptBundle(
   const std::string& fileName
 ) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::loadScriptBundle");
+
   return loader::loadScripts(fileAsText(fileName));
 }
 
 
 ByteBuffer ResourceLoader::file(const std::string& name) const {
+  RIGEL_TRACE_SCOPE("ResourceLoader::file");
+
   const auto unpackedFilePath = mGamePath / fs::u8path(name);
   if (fs::exists(unpackedFilePath)) {
     return loadFile(unpackedFilePath);
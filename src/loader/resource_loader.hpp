@@ -26,6 +26,7 @@
 #include "loader/audio_package.hpp"
 #include "loader/duke_script_loader.hpp"
 #include "loader/cmp_file_package.hpp"
+#include "loader/movie_loader.hpp"
 #include "loader/palette.hpp"
 
 #include <string>
@@ -35,7 +36,7 @@
 namespace rigel::loader {
 
 struct TileSet {
-  data::Image mTiles;
+  data::IndexedImage mTiles;
   data::map::TileAttributeDict mAttributes;
 };
 
@@ -44,19 +45,21 @@ class ResourceLoader {
 public:
   explicit ResourceLoader(const std::string& gamePath);
 
-  data::Image loadTiledFullscreenImage(const std::string& name) const;
-  data::Image loadTiledFullscreenImage(
+  data::IndexedImage loadTiledFullscreenImage(const std::string& name) const;
+  data::IndexedImage loadTiledFullscreenImage(
     const std::string& name,
     const Palette16& overridePalette) const;
 
-  data::Image loadStandaloneFullscreenImage(const std::string& name) const;
+  data::IndexedImage loadStandaloneFullscreenImage(
+    const std::string& name) const;
   loader::Palette16 loadPaletteFromFullScreenImage(
     const std::string& imageName) const;
 
-  data::Image loadAntiPiracyImage() const;
+  data::IndexedImage loadAntiPiracyImage() const;
 
   TileSet loadCZone(const std::string& name) const;
   data::Movie loadMovie(const std::string& name) const;
+  MovieDecoder openMovie(const std::string& name) const;
   data::Song loadMusic(const std::string& name) const;
 
   data::AudioBuffer loadSound(const std::string& name) const;
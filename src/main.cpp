@@ -137,9 +137,43 @@ int main(int argc, char** argv) {
     ("debug-mode,d",
      po::bool_switch(&config.mDebugModeEnabled),
      "Enable debugging features")
+    ("rewind-history",
+     po::value<int>(&config.mRewindHistorySeconds)->default_value(30),
+     "Seconds of gameplay to keep for rewinding (debug mode only, R key).\n"
+     "0 disables rewinding")
+    ("fast-forward",
+     po::value<int>(),
+     "Start with fast-forward enabled, running the game logic at the given\n"
+     "multiple of normal speed (2 or higher). Can be toggled with F in debug\n"
+     "mode")
+    ("threaded-simulation",
+     po::bool_switch(&config.mThreadedSimulation),
+     "Run game logic on a separate thread, in parallel to rendering the\n"
+     "previous update's results. Adds one frame of latency")
+    ("grouped-behavior-updates",
+     po::bool_switch(&config.mGroupedBehaviorUpdates),
+     "Update enemy and object behaviors grouped by type. Faster with many\n"
+     "active entities, but can change gameplay subtly compared to the\n"
+     "original game")
+    ("deferred-game-events",
+     po::bool_switch(&config.mDeferredGameEvents),
+     "Deliver collision and damage events at fixed points of each game logic\n"
+     "update instead of right away. Can change gameplay subtly compared to\n"
+     "the original game")
+    ("trace-file",
+     po::value<std::string>(),
+     "Record a timeline of startup and each frame, and write it to the given\n"
+     "file on exit. The file can be viewed in chrome://tracing or Perfetto")
+    ("memory-report",
+     po::bool_switch(&config.mMemoryReport),
+     "Print current and peak memory usage per category on exit")
     ("play-demo",
      po::bool_switch(&config.mPlayDemo),
      "Play pre-recorded demo")
+    ("null-audio",
+     po::bool_switch(&config.mNullAudioOutput),
+     "Mix audio as usual, but discard it instead of sending it to an audio\n"
+     "device")
     ("game-path",
      po::value<std::string>(&config.mGamePath)->default_value(""),
      "Path to original game's installation. Can also be given as positional "
@@ -192,6 +226,20 @@ int main(int argc, char** argv) {
         options["player-pos"].as<std::string>());
     }
 
+    if (options.count("fast-forward")) {
+      const auto multiplier = options["fast-forward"].as<int>();
+      if (multiplier < 2) {
+        throw std::invalid_argument(
+          "Fast-forward multiplier must be 2 or higher");
+      }
+
+      config.mFastForwardMultiplier = multiplier;
+    }
+
+    if (options.count("trace-file")) {
+      config.mTraceFile = options["trace-file"].as<std::string>();
+    }
+
     if (!config.mGamePath.empty() && config.mGamePath.back() != '/') {
       config.mGamePath += "/";
     }
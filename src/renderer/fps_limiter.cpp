@@ -18,20 +18,110 @@
 
 #include <SDL_timer.h>
 
+#include <algorithm>
+#include <thread>
+
 
 namespace rigel::renderer {
 
-FpsLimiter::FpsLimiter(const int targetFps)
-  : mLastTime(base::Clock::now())
+namespace {
+
+using namespace std::chrono;
+
+// How long before the deadline to stop sleeping and start spinning. Needs to
+// cover the typical oversleep of SDL_Delay.
+constexpr auto SPIN_THRESHOLD = base::Clock::duration{milliseconds{2}};
+
+constexpr auto NUM_FRAME_TIMES_FOR_STATISTICS = std::size_t{600};
+
+
+struct SystemFrameClock : IFrameClock {
+  base::Clock::time_point now() const override {
+    return base::Clock::now();
+  }
+
+  void sleepFor(const base::Clock::duration duration) override {
+    // We use SDL_Delay instead of std::this_thread::sleep_for, because the
+    // former is more accurate on some platforms.
+    const auto milliSeconds = duration_cast<milliseconds>(duration).count();
+    SDL_Delay(static_cast<Uint32>(milliSeconds));
+  }
+
+  void yield() override {
+    std::this_thread::yield();
+  }
+};
+
+
+IFrameClock* systemFrameClock() {
+  static SystemFrameClock clock;
+  return &clock;
+}
+
+
+double percentile(std::vector<double>& values, const double fraction) {
+  const auto index = std::min(
+    static_cast<std::size_t>(fraction * static_cast<double>(values.size())),
+    values.size() - 1);
+  std::nth_element(values.begin(), values.begin() + index, values.end());
+  return values[index];
+}
+
+}
+
+
+FpsLimiter::FpsLimiter(
+  const int targetFps,
+  const Mode mode,
+  IFrameClock* pClock
+)
+  : mpClock(pClock ? pClock : systemFrameClock())
+  , mMode(mode)
+  , mLastTime(mpClock->now())
+  , mNextDeadline(mLastTime)
+  , mLastFrameEndTime(mLastTime)
+  , mTargetFrameDuration(
+      duration_cast<base::Clock::duration>(duration<double>(1.0 / targetFps)))
   , mTargetFrameTime(1.0 / targetFps)
 {
+  mNextDeadline += mTargetFrameDuration;
+  mRecentFrameTimes.reserve(NUM_FRAME_TIMES_FOR_STATISTICS);
+  mFrameTimesScratch.reserve(NUM_FRAME_TIMES_FOR_STATISTICS);
 }
 
 
 void FpsLimiter::updateAndWait() {
-  using namespace std::chrono;
+  const auto now = mpClock->now();
+
+  if (mMode == Mode::Precise) {
+    waitPrecisely(now);
+  } else {
+    waitSleeping(now);
+  }
 
-  const auto now = base::Clock::now();
+  recordFrameTime(mpClock->now());
+}
+
+
+FrameTimeStatistics FpsLimiter::statistics() const {
+  FrameTimeStatistics result;
+  result.mMissedDeadlines = mMissedDeadlines;
+
+  if (mRecentFrameTimes.empty()) {
+    return result;
+  }
+
+  // Reuses the scratch buffer's capacity, so this doesn't allocate
+  auto& frameTimes = mFrameTimesScratch;
+  frameTimes.assign(mRecentFrameTimes.begin(), mRecentFrameTimes.end());
+  result.mMax = *std::max_element(frameTimes.begin(), frameTimes.end());
+  result.mMedian = percentile(frameTimes, 0.5);
+  result.mPercentile99 = percentile(frameTimes, 0.99);
+  return result;
+}
+
+
+void FpsLimiter::waitSleeping(const base::Clock::time_point now) {
   const auto delta = duration<double>(now - mLastTime).count();
   mLastTime = now;
 
@@ -39,10 +129,49 @@ void FpsLimiter::updateAndWait() {
 
   const auto timeToWaitFor = mTargetFrameTime + mError;
   if (timeToWaitFor > 0.0) {
-    // We use SDL_Delay instead of std::this_thread::sleep_for, because the
-    // former is more accurate on some platforms.
-    SDL_Delay(static_cast<Uint32>(timeToWaitFor * 1000.0));
+    mpClock->sleepFor(
+      duration_cast<base::Clock::duration>(duration<double>(timeToWaitFor)));
+  }
+}
+
+
+void FpsLimiter::waitPrecisely(const base::Clock::time_point now) {
+  if (now > mNextDeadline) {
+    ++mMissedDeadlines;
+
+    // If we're more than a frame behind, don't try to catch up - that would
+    // result in a burst of frames without any waiting.
+    if (now - mNextDeadline > mTargetFrameDuration) {
+      mNextDeadline = now;
+    }
+  } else {
+    const auto timeUntilDeadline = mNextDeadline - now;
+    if (timeUntilDeadline > SPIN_THRESHOLD) {
+      mpClock->sleepFor(timeUntilDeadline - SPIN_THRESHOLD);
+    }
+
+    while (mpClock->now() < mNextDeadline) {
+      mpClock->yield();
+    }
+  }
+
+  mNextDeadline += mTargetFrameDuration;
+}
+
+
+void FpsLimiter::recordFrameTime(const base::Clock::time_point frameEndTime) {
+  const auto frameTime =
+    duration<double>(frameEndTime - mLastFrameEndTime).count();
+  mLastFrameEndTime = frameEndTime;
+
+  if (mRecentFrameTimes.size() < NUM_FRAME_TIMES_FOR_STATISTICS) {
+    mRecentFrameTimes.push_back(frameTime);
+  } else {
+    mRecentFrameTimes[mNextFrameTimeIndex] = frameTime;
   }
+
+  mNextFrameTimeIndex =
+    (mNextFrameTimeIndex + 1) % NUM_FRAME_TIMES_FOR_STATISTICS;
 }
 
 }
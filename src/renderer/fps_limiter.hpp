@@ -18,19 +18,91 @@
 
 #include "base/clock.hpp"
 
+#include <cstddef>
+#include <vector>
+
 
 namespace rigel::renderer {
 
+/** Source of time and waiting used by FpsLimiter
+ *
+ * The default implementation uses base::Clock and SDL_Delay. Tests can
+ * provide their own implementation in order to simulate time.
+ */
+struct IFrameClock {
+  virtual ~IFrameClock() = default;
+
+  virtual base::Clock::time_point now() const = 0;
+
+  /** Sleep for roughly the given duration, with millisecond granularity
+   *
+   * Might sleep longer than requested, depending on the OS scheduler.
+   */
+  virtual void sleepFor(base::Clock::duration duration) = 0;
+
+  /** Give up the remainder of the current time slice */
+  virtual void yield() = 0;
+};
+
+
+/** Frame times measured by FpsLimiter, in seconds */
+struct FrameTimeStatistics {
+  double mMedian = 0.0;
+  double mPercentile99 = 0.0;
+  double mMax = 0.0;
+  int mMissedDeadlines = 0;
+};
+
+
 class FpsLimiter {
 public:
-  explicit FpsLimiter(int targetFps);
+  enum class Mode {
+    /** Sleep with millisecond granularity, carry over the error */
+    Sleep,
+
+    /** Sleep until shortly before the deadline, then spin until it's hit
+     *
+     * Trades a bit of CPU time for much more even frame pacing, which is
+     * especially noticeable at high refresh rates like 120 or 144 Hz.
+     */
+    Precise
+  };
+
+  explicit FpsLimiter(
+    int targetFps,
+    Mode mode = Mode::Sleep,
+    IFrameClock* pClock = nullptr);
 
   void updateAndWait();
 
+  /** Statistics for the most recent frames
+   *
+   * Frame times are measured between consecutive returns from
+   * updateAndWait(). Missed deadlines (frames which took longer than the
+   * target frame time, in precise mode) are counted since construction.
+   * Meant to be called once per frame while the statistics are shown, it
+   * doesn't allocate memory.
+   */
+  FrameTimeStatistics statistics() const;
+
 private:
+  void waitSleeping(base::Clock::time_point now);
+  void waitPrecisely(base::Clock::time_point now);
+  void recordFrameTime(base::Clock::time_point frameEndTime);
+
+  IFrameClock* mpClock;
+  Mode mMode;
   base::Clock::time_point mLastTime = {};
+  base::Clock::time_point mNextDeadline = {};
+  base::Clock::time_point mLastFrameEndTime = {};
+  base::Clock::duration mTargetFrameDuration;
   double mTargetFrameTime;
   double mError = 0.0;
+
+  std::vector<double> mRecentFrameTimes;
+  mutable std::vector<double> mFrameTimesScratch;
+  std::size_t mNextFrameTimeIndex = 0;
+  int mMissedDeadlines = 0;
 };
 
 }
@@ -16,6 +16,7 @@
 
 #include "renderer.hpp"
 
+#include "base/tracing.hpp"
 #include "data/game_options.hpp"
 #include "data/game_traits.hpp"
 #include "loader/palette.hpp"
@@ -49,6 +50,9 @@ constexpr auto WATER_MASK_HEIGHT = 8;
 constexpr auto WATER_NUM_MASKS = 5;
 constexpr auto WATER_MASK_INDEX_FILLED = 4;
 
+// 4:3, so that widescreen mode is never used when running headless
+constexpr auto HEADLESS_WINDOW_SIZE = base::Size<int>{640, 480};
+
 
 class DummyVao {
 #ifndef RIGEL_USE_GL_ES
@@ -508,6 +512,8 @@ struct Renderer::Impl {
       return;
     }
 
+    RIGEL_TRACE_SCOPE("Renderer::submitBatch");
+
     commitChangedState();
 
     switch (mRenderMode) {
@@ -1043,6 +1049,26 @@ struct Renderer::Impl {
 
 
   TextureId createTexture(const data::Image& image) {
+    const auto& pixels = image.pixelData();
+    return createTexture(image, [&](const std::size_t index) {
+      return pixels[index];
+    });
+  }
+
+
+  TextureId createTexture(const data::IndexedImage& image) {
+    // The palette is applied while converting into the upload buffer, there
+    // is no intermediate RGBA image
+    const auto& indices = image.pixelData();
+    const auto& palette = image.palette();
+    return createTexture(image, [&](const std::size_t index) {
+      return palette[indices[index]];
+    });
+  }
+
+
+  template <typename ImageT, typename PixelLookup>
+  TextureId createTexture(const ImageT& image, const PixelLookup& pixelAt) {
     submitBatch();
 
     // OpenGL wants pixel data in bottom-up format, so transform it accordingly
@@ -1054,7 +1080,7 @@ struct Renderer::Impl {
       const auto yOffset = y * image.width() * 4;
 
       for (std::size_t x = 0; x < image.width(); ++x) {
-        const auto& pixel = image.pixelData()[x + yOffsetSource];
+        const data::Pixel pixel = pixelAt(x + yOffsetSource);
         pixelData[x*4 +     yOffset] = pixel.r;
         pixelData[x*4 + 1 + yOffset] = pixel.g;
         pixelData[x*4 + 2 + yOffset] = pixel.b;
@@ -1090,7 +1116,7 @@ struct Renderer::Impl {
 
 
 Renderer::Renderer(SDL_Window* pWindow)
-  : mpImpl(std::make_unique<Impl>(pWindow))
+  : mpImpl(pWindow ? std::make_unique<Impl>(pWindow) : nullptr)
 {
 }
 
@@ -1099,17 +1125,23 @@ Renderer::~Renderer() = default;
 
 
 void Renderer::setOverlayColor(const base::Color& color) {
-  mpImpl->setOverlayColor(color);
+  if (mpImpl) {
+    mpImpl->setOverlayColor(color);
+  }
 }
 
 
 void Renderer::setColorModulation(const base::Color& colorModulation) {
-  mpImpl->setColorModulation(colorModulation);
+  if (mpImpl) {
+    mpImpl->setColorModulation(colorModulation);
+  }
 }
 
 
 void Renderer::setTextureRepeatEnabled(const bool enable) {
-  mpImpl->setTextureRepeatEnabled(enable);
+  if (mpImpl) {
+    mpImpl->setTextureRepeatEnabled(enable);
+  }
 }
 
 
@@ -1118,12 +1150,16 @@ void Renderer::drawTexture(
   const TexCoords& sourceRect,
   const base::Rect<int>& destRect
 ) {
-  mpImpl->drawTexture(texture, sourceRect, destRect);
+  if (mpImpl) {
+    mpImpl->drawTexture(texture, sourceRect, destRect);
+  }
 }
 
 
 void Renderer::submitBatch() {
-  mpImpl->submitBatch();
+  if (mpImpl) {
+    mpImpl->submitBatch();
+  }
 }
 
 
@@ -1131,7 +1167,9 @@ void Renderer::drawFilledRectangle(
   const base::Rect<int>& rect,
   const base::Color& color
 ) {
-  mpImpl->drawFilledRectangle(rect, color);
+  if (mpImpl) {
+    mpImpl->drawFilledRectangle(rect, color);
+  }
 }
 
 
@@ -1139,7 +1177,9 @@ void Renderer::drawRectangle(
   const base::Rect<int>& rect,
   const base::Color& color
 ) {
-  mpImpl->drawRectangle(rect, color);
+  if (mpImpl) {
+    mpImpl->drawRectangle(rect, color);
+  }
 }
 
 
@@ -1150,7 +1190,9 @@ void Renderer::drawLine(
   const int y2,
   const base::Color& color
 ) {
-  mpImpl->drawLine(x1, y1, x2, y2, color);
+  if (mpImpl) {
+    mpImpl->drawLine(x1, y1, x2, y2, color);
+  }
 }
 
 
@@ -1158,7 +1200,9 @@ void Renderer::drawPoint(
   const base::Vector& position,
   const base::Color& color
 ) {
-  mpImpl->drawPoint(position, color);
+  if (mpImpl) {
+    mpImpl->drawPoint(position, color);
+  }
 }
 
 
@@ -1167,31 +1211,45 @@ void Renderer::drawWaterEffect(
   const TextureId texture,
   std::optional<int> surfaceAnimationStep
 ) {
-  mpImpl->drawWaterEffect(area, texture, surfaceAnimationStep);
+  if (mpImpl) {
+    mpImpl->drawWaterEffect(area, texture, surfaceAnimationStep);
+  }
 }
 
 
 void Renderer::pushState() {
-  mpImpl->pushState();
+  if (mpImpl) {
+    mpImpl->pushState();
+  }
 }
 
 
 void Renderer::popState() {
-  mpImpl->popState();
+  if (mpImpl) {
+    mpImpl->popState();
+  }
 }
 
 
 void Renderer::resetState() {
-  mpImpl->resetState();
+  if (mpImpl) {
+    mpImpl->resetState();
+  }
 }
 
 
 void Renderer::setGlobalTranslation(const base::Vector& translation) {
-  mpImpl->setGlobalTranslation(translation);
+  if (mpImpl) {
+    mpImpl->setGlobalTranslation(translation);
+  }
 }
 
 
 base::Vector Renderer::globalTranslation() const {
+  if (!mpImpl) {
+    return {};
+  }
+
   return base::Vector{
     static_cast<int>(mpImpl->mStateStack.back().mGlobalTranslation.x),
     static_cast<int>(mpImpl->mStateStack.back().mGlobalTranslation.y)};
@@ -1199,47 +1257,73 @@ base::Vector Renderer::globalTranslation() const {
 
 
 void Renderer::setGlobalScale(const base::Point<float>& scale) {
-  mpImpl->setGlobalScale(scale);
+  if (mpImpl) {
+    mpImpl->setGlobalScale(scale);
+  }
 }
 
 
 base::Point<float> Renderer::globalScale() const {
+  if (!mpImpl) {
+    return {1.0f, 1.0f};
+  }
+
   return {mpImpl->mStateStack.back().mGlobalScale.x, mpImpl->mStateStack.back().mGlobalScale.y};
 }
 
 
 void Renderer::setClipRect(const std::optional<base::Rect<int>>& clipRect) {
-  mpImpl->setClipRect(clipRect);
+  if (mpImpl) {
+    mpImpl->setClipRect(clipRect);
+  }
 }
 
 
 std::optional<base::Rect<int>> Renderer::clipRect() const {
+  if (!mpImpl) {
+    return std::nullopt;
+  }
+
   return mpImpl->mStateStack.back().mClipRect;
 }
 
 
 base::Size<int> Renderer::windowSize() const {
+  if (!mpImpl) {
+    return HEADLESS_WINDOW_SIZE;
+  }
+
   return mpImpl->mWindowSize;
 }
 
 
 base::Size<int> Renderer::maxWindowSize() const {
+  if (!mpImpl) {
+    return HEADLESS_WINDOW_SIZE;
+  }
+
   return mpImpl->mMaxWindowSize;
 }
 
 
 void Renderer::setRenderTarget(const TextureId target) {
-  mpImpl->setRenderTarget(target);
+  if (mpImpl) {
+    mpImpl->setRenderTarget(target);
+  }
 }
 
 
 void Renderer::swapBuffers() {
-  mpImpl->swapBuffers();
+  if (mpImpl) {
+    mpImpl->swapBuffers();
+  }
 }
 
 
 void Renderer::clear(const base::Color& clearColor) {
-  mpImpl->clear(clearColor);
+  if (mpImpl) {
+    mpImpl->clear(clearColor);
+  }
 }
 
 
@@ -1247,17 +1331,36 @@ TextureId Renderer::createRenderTargetTexture(
   const int width,
   const int height
 ) {
+  if (!mpImpl) {
+    return 0;
+  }
+
   return mpImpl->createRenderTargetTexture(width, height);
 }
 
 
 TextureId Renderer::createTexture(const data::Image& image) {
+  if (!mpImpl) {
+    return 0;
+  }
+
+  return mpImpl->createTexture(image);
+}
+
+
+TextureId Renderer::createTexture(const data::IndexedImage& image) {
+  if (!mpImpl) {
+    return 0;
+  }
+
   return mpImpl->createTexture(image);
 }
 
 
 void Renderer::destroyTexture(TextureId texture) {
-  mpImpl->destroyTexture(texture);
+  if (mpImpl) {
+    mpImpl->destroyTexture(texture);
+  }
 }
 
 }
@@ -83,12 +83,22 @@ inline TexCoords toTexCoords(
   *
   * A valid OpenGL context must be created before instantiating this
   * class.
+  *
+  * When given a nullptr window, the renderer runs headless: No OpenGL calls
+  * are made, all drawing and state changes are ignored, and created textures
+  * are not backed by anything. This is meant for running the game logic
+  * without a window, e.g. for batch runs. A headless renderer reports a
+  * fixed 4:3 window size.
   */
 class Renderer {
 public:
   explicit Renderer(SDL_Window* pWindow);
   ~Renderer();
 
+  bool isHeadless() const {
+    return mpImpl == nullptr;
+  }
+
   // Drawing API
   ////////////////////////////////////////////////////////////////////////
 
@@ -243,6 +253,13 @@ public:
     */
   TextureId createTexture(const data::Image& image);
 
+  /** Create a texture from a palettized image
+    *
+    * Like createTexture() for regular images. The palette is applied while
+    * preparing the upload.
+    */
+  TextureId createTexture(const data::IndexedImage& image);
+
   /** Create a render target texture
     *
     * This is a low-level API. Using the renderer::RenderTarget class
@@ -22,6 +22,7 @@
 namespace rigel::renderer {
 
 using data::Image;
+using data::IndexedImage;
 
 
 void Texture::render(const int x, const int y) const {
@@ -72,6 +73,16 @@ Texture::Texture(renderer::Renderer* pRenderer, const Image& image)
 }
 
 
+Texture::Texture(renderer::Renderer* pRenderer, const IndexedImage& image)
+  : Texture(
+      pRenderer,
+      pRenderer->createTexture(image),
+      static_cast<int>(image.width()),
+      static_cast<int>(image.height()))
+{
+}
+
+
 Texture::~Texture() {
   if (mpRenderer) {
     mpRenderer->destroyTexture(mId);
@@ -34,6 +34,7 @@ class Texture {
 public:
   Texture() = default;
   Texture(Renderer* renderer, const data::Image& image);
+  Texture(Renderer* renderer, const data::IndexedImage& image);
   ~Texture();
 
   Texture(Texture&& other) noexcept
@@ -16,6 +16,7 @@
 
 #include "texture_atlas.hpp"
 
+#include "base/memory_tracking.hpp"
 #include "base/warnings.hpp"
 #include "renderer/renderer.hpp"
 
@@ -33,15 +34,20 @@ namespace {
 constexpr auto ATLAS_WIDTH = 2048;
 constexpr auto ATLAS_HEIGHT = 1024;
 
+
+std::size_t totalMemoryUsage(const std::vector<data::Image>& images) {
+  std::size_t result = 0;
+  for (const auto& image : images) {
+    result += image.memoryUsage();
+  }
+
+  return result;
 }
 
+}
 
-TextureAtlas::TextureAtlas(
-  Renderer* pRenderer,
-  const std::vector<data::Image>& images
-)
-  : mpRenderer(pRenderer)
-{
+
+PackedAtlas packIntoAtlas(const std::vector<data::Image>& images) {
   std::vector<stbrp_rect> rects;
   rects.reserve(images.size());
 
@@ -74,20 +80,42 @@ TextureAtlas::TextureAtlas(
     throw std::runtime_error("Failed to build texture atlas");
   }
 
-  data::Image atlas{static_cast<size_t>(ATLAS_WIDTH), static_cast<size_t>(ATLAS_HEIGHT)};
+  PackedAtlas packedAtlas{
+    data::Image{
+      static_cast<size_t>(ATLAS_WIDTH), static_cast<size_t>(ATLAS_HEIGHT)},
+    std::vector<base::Rect<int>>(images.size())};
 
   for (const auto& packedRect : rects) {
-    atlas.insertImage(packedRect.x, packedRect.y, images[packedRect.id]);
+    packedAtlas.mImage.insertImage(
+      packedRect.x, packedRect.y, images[packedRect.id]);
+    packedAtlas.mImageRects[packedRect.id] =
+      {{packedRect.x, packedRect.y}, {packedRect.w, packedRect.h}};
   }
 
-  mAtlasTexture = Texture{mpRenderer, std::move(atlas)};
+  return packedAtlas;
+}
+
+
+TextureAtlas::TextureAtlas(
+  Renderer* pRenderer,
+  const std::vector<data::Image>& images
+)
+  : mpRenderer(pRenderer)
+{
+  auto packedAtlas = packIntoAtlas(images);
+
+  // The source images and the packed atlas exist at the same time until the
+  // upload is done
+  const auto stagingMemory = base::TrackedMemory{
+    base::MemoryTag::TextureStaging,
+    totalMemoryUsage(images) + packedAtlas.mImage.memoryUsage()};
+
+  mAtlasTexture = Texture{mpRenderer, std::move(packedAtlas.mImage)};
 
   mCoordinatesMap.reserve(images.size());
-  for (const auto& packedRect : rects) {
+  for (const auto& rect : packedAtlas.mImageRects) {
     mCoordinatesMap.push_back(toTexCoords(
-      {{packedRect.x, packedRect.y}, {packedRect.w, packedRect.h}},
-      mAtlasTexture.width(),
-      mAtlasTexture.height()));
+      rect, mAtlasTexture.width(), mAtlasTexture.height()));
   }
 }
 
@@ -16,13 +16,34 @@
 
 #pragma once
 
+#include "base/spatial_types.hpp"
 #include "data/image.hpp"
 #include "renderer/renderer.hpp"
 #include "renderer/texture.hpp"
 
+#include <vector>
+
 
 namespace rigel::renderer {
 
+/** Images arranged into a single atlas image, see packIntoAtlas() */
+struct PackedAtlas {
+  data::Image mImage;
+
+  // Location of each input image inside mImage, in the same order as the
+  // list of images given to packIntoAtlas().
+  std::vector<base::Rect<int>> mImageRects;
+};
+
+
+/** Arrange images into a single image
+ *
+ * This is the part of building a TextureAtlas that doesn't involve the GPU.
+ * Throws an exception if not all images fit into the atlas size.
+ */
+PackedAtlas packIntoAtlas(const std::vector<data::Image>& images);
+
+
 /** Combines multiple images into a single texture
   *
   * For more efficient rendering, we want to minimize the number of
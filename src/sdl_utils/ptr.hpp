@@ -20,7 +20,6 @@
 
 RIGEL_DISABLE_WARNINGS
 #include <SDL.h>
-#include <SDL_mixer.h>
 RIGEL_RESTORE_WARNINGS
 
 #include <memory>
@@ -47,11 +46,6 @@ struct DeleterFor<SDL_GameController> {
   static auto deleter() { return &SDL_GameControllerClose; }
 };
 
-template<>
-struct DeleterFor<Mix_Chunk> {
-  static auto deleter() { return &Mix_FreeChunk; }
-};
-
 template<typename SDLType>
 auto deleterFor() {
   return DeleterFor<SDLType>::deleter();
@@ -18,6 +18,7 @@
 
 #include "common/game_mode.hpp"
 #include "engine/timing.hpp"
+#include "loader/movie_loader.hpp"
 #include "ui/movie_player.hpp"
 
 
@@ -36,7 +37,7 @@ public:
 private:
   ui::MoviePlayer mMoviePlayer;
   IGameServiceProvider* mpServiceProvider;
-  data::Movie mLogoMovie;
+  loader::MovieDecoder mLogoMovie;
 
   engine::TimeDelta mElapsedTime;
 };
@@ -20,9 +20,11 @@
 
 #include "utils.hpp"
 
-#include <iomanip>
-#include <string>
-#include <sstream>
+#include <algorithm>
+#include <array>
+#include <cstdarg>
+#include <cstdio>
+#include <string_view>
 
 
 namespace rigel::ui {
@@ -32,10 +34,49 @@ namespace {
 const auto PRE_FILTER_WEIGHT = 0.7f;
 const auto FILTER_WEIGHT = 0.9f;
 
+
+/** Fixed-size text buffer, to avoid allocating memory every frame */
+class StatsReport {
+public:
+#if defined(__GNUC__) || defined(__clang__)
+  __attribute__((format(printf, 2, 3)))
+#endif
+  void append(const char* format, ...) {
+    const auto capacity = static_cast<int>(mBuffer.size());
+
+    std::va_list args;
+    va_start(args, format);
+    const auto written = std::vsnprintf(
+      mBuffer.data() + mSize,
+      static_cast<std::size_t>(capacity - mSize),
+      format,
+      args);
+    va_end(args);
+
+    // On truncation, vsnprintf returns the length the full text would have
+    if (written > 0) {
+      mSize = std::min(mSize + written, capacity - 1);
+    }
+  }
+
+  std::string_view text() const {
+    return std::string_view{mBuffer.data(), static_cast<std::size_t>(mSize)};
+  }
+
+private:
+  std::array<char, 256> mBuffer{};
+  int mSize = 0;
+};
+
 }
 
 
-void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed) {
+void FpsDisplay::updateAndRender(
+  const engine::TimeDelta totalElapsed,
+  const std::optional<float> audioCpuLoad,
+  const std::optional<renderer::FrameTimeStatistics>& frameTimes,
+  const std::optional<std::uint64_t> heapAllocations
+) {
   mPreFilteredFrameTime = base::lerp(
     static_cast<float>(totalElapsed), mPreFilteredFrameTime, PRE_FILTER_WEIGHT);
   mFilteredFrameTime = base::lerp(
@@ -43,14 +84,30 @@ void FpsDisplay::updateAndRender(const engine::TimeDelta totalElapsed) {
 
   const auto smoothedFps = base::round(1.0f / mFilteredFrameTime);
 
-  std::stringstream statsReport;
-  statsReport
-    << smoothedFps << " FPS, "
-    << std::setw(4) << std::fixed << std::setprecision(2)
-    << totalElapsed * 1000.0 << " ms";
+  StatsReport statsReport;
+  statsReport.append(
+    "%d FPS, %4.2f ms", smoothedFps, totalElapsed * 1000.0);
+
+  if (audioCpuLoad) {
+    statsReport.append(", audio %.1f%%", *audioCpuLoad * 100.0);
+  }
+
+  if (frameTimes) {
+    statsReport.append(
+      "\nFrame times: p50 %.2f ms, p99 %.2f ms, max %.2f ms, missed %d",
+      frameTimes->mMedian * 1000.0,
+      frameTimes->mPercentile99 * 1000.0,
+      frameTimes->mMax * 1000.0,
+      frameTimes->mMissedDeadlines);
+  }
+
+  if (heapAllocations) {
+    statsReport.append(
+      "\nHeap allocations: %llu",
+      static_cast<unsigned long long>(*heapAllocations));
+  }
 
-  const auto reportString = statsReport.str();
-  drawText(reportString, 0, 0, {255, 255, 255, 255});
+  drawText(statsReport.text(), 0, 0, {255, 255, 255, 255});
 }
 
 }
@@ -17,13 +17,30 @@
 #pragma once
 
 #include "engine/timing.hpp"
+#include "renderer/fps_limiter.hpp"
+
+#include <cstdint>
+#include <optional>
 
 
 namespace rigel::ui {
 
 class FpsDisplay {
 public:
-  void updateAndRender(engine::TimeDelta elapsed);
+  /** Show frame rate and frame time, plus audio mixing load if given
+   *
+   * audioCpuLoad is the fraction of real time spent mixing audio, see
+   * engine::SoundSystem::audioCpuLoad(). If frame pacing statistics are
+   * given (see renderer::FpsLimiter), they are shown on a second line.
+   * The number of heap allocations in the previous frame is shown if given
+   * (see base::heapAllocationCount()).
+   */
+  void updateAndRender(
+    engine::TimeDelta elapsed,
+    std::optional<float> audioCpuLoad = std::nullopt,
+    const std::optional<renderer::FrameTimeStatistics>& frameTimes =
+      std::nullopt,
+    std::optional<std::uint64_t> heapAllocations = std::nullopt);
 
 
 private:
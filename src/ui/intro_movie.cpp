@@ -67,7 +67,7 @@ IntroMovie::PlaybackConfigList IntroMovie::createConfigurations(
   return {
     // Neo LA - the future
     {
-      resources.loadMovie("NUKEM2.F2"),
+      resources.openMovie("NUKEM2.F2"),
       70,
       6,
       nullptr
@@ -75,7 +75,7 @@ IntroMovie::PlaybackConfigList IntroMovie::createConfigurations(
 
     // Focus on Duke shooting at range
     {
-      resources.loadMovie("NUKEM2.F1"),
+      resources.openMovie("NUKEM2.F1"),
       14,
       10,
       [pServiceProvider = mpServiceProvider](const int frame) {
@@ -89,7 +89,7 @@ IntroMovie::PlaybackConfigList IntroMovie::createConfigurations(
 
     // Focus on target being hit
     {
-      resources.loadMovie("NUKEM2.F3"),
+      resources.openMovie("NUKEM2.F3"),
       23,
       2,
       [pServiceProvider = mpServiceProvider](const int frame) {
@@ -103,7 +103,7 @@ IntroMovie::PlaybackConfigList IntroMovie::createConfigurations(
 
     // Remainder of shooting range scene
     {
-      resources.loadMovie("NUKEM2.F4"),
+      resources.openMovie("NUKEM2.F4"),
       46,
       1,
       [pServiceProvider = mpServiceProvider](const int frame) {
@@ -224,7 +224,7 @@ bool IntroMovie::isFinished() const {
 
 
 void IntroMovie::startNextMovie() {
-  const auto& config = mMovieConfigurations[mCurrentConfiguration];
+  auto& config = mMovieConfigurations[mCurrentConfiguration];
   mMoviePlayer.playMovie(
     config.mMovie,
     config.mFrameDelay,
@@ -17,7 +17,7 @@
 #pragma once
 
 #include "common/game_mode.hpp"
-#include "data/movie.hpp"
+#include "loader/movie_loader.hpp"
 #include "ui/movie_player.hpp"
 
 #include <cstddef>
@@ -40,7 +40,7 @@ private:
   void startNextMovie();
 
   struct PlaybackConfig {
-    data::Movie mMovie;
+    loader::MovieDecoder mMovie;
 
     const int mFrameDelay;
     const int mRepetitions;
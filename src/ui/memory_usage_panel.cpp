@@ -0,0 +1,81 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "memory_usage_panel.hpp"
+
+#include "base/memory_tracking.hpp"
+#include "base/warnings.hpp"
+
+RIGEL_DISABLE_WARNINGS
+#include <imgui.h>
+RIGEL_RESTORE_WARNINGS
+
+
+namespace rigel::ui {
+
+namespace {
+
+void drawRow(const char* name, const base::MemoryStatistics& statistics) {
+  constexpr auto BYTES_PER_MB = 1024.0 * 1024.0;
+
+  ImGui::Text("%s", name);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f MB", statistics.mCurrentBytes / BYTES_PER_MB);
+  ImGui::NextColumn();
+  ImGui::Text("%.2f MB", statistics.mPeakBytes / BYTES_PER_MB);
+  ImGui::NextColumn();
+}
+
+}
+
+
+void drawMemoryUsagePanel(bool* pIsOpen) {
+  if (!ImGui::Begin("Memory usage", pIsOpen)) {
+    ImGui::End();
+    return;
+  }
+
+  ImGui::Columns(3, "memory_usage");
+  ImGui::Text("Category");
+  ImGui::NextColumn();
+  ImGui::Text("Current");
+  ImGui::NextColumn();
+  ImGui::Text("Peak");
+  ImGui::NextColumn();
+  ImGui::Separator();
+
+  for (auto i = 0; i < base::NUM_MEMORY_TAGS; ++i) {
+    const auto tag = static_cast<base::MemoryTag>(i);
+    drawRow(base::memoryTagName(tag), base::trackedMemoryUsage(tag));
+  }
+
+  if constexpr (base::HEAP_ALLOCATION_TRACKING_ENABLED) {
+    ImGui::Separator();
+    drawRow("Heap (total)", base::heapMemoryUsage());
+  }
+
+  ImGui::Columns(1);
+
+  if constexpr (!base::HEAP_ALLOCATION_TRACKING_ENABLED) {
+    ImGui::Separator();
+    ImGui::TextWrapped(
+      "Build with TRACK_HEAP_ALLOCATIONS to see total heap usage");
+  }
+
+  ImGui::End();
+}
+
+}
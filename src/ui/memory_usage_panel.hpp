@@ -0,0 +1,29 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+
+namespace rigel::ui {
+
+/** Show an ImGui window listing the memory statistics from memory_tracking.hpp
+ *
+ * Must be called between imgui_integration::beginFrame() and endFrame().
+ * pIsOpen is set to false when the user closes the window.
+ */
+void drawMemoryUsagePanel(bool* pIsOpen);
+
+}
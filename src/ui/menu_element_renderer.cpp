@@ -17,6 +17,7 @@
 #include "menu_element_renderer.hpp"
 
 #include "base/math_tools.hpp"
+#include "base/tracing.hpp"
 #include "base/warnings.hpp"
 #include "data/game_traits.hpp"
 #include "data/unit_conversions.hpp"
@@ -150,6 +151,8 @@ renderer::Texture createFontTexture(
   const loader::FontData& font,
   renderer::Renderer* pRenderer
 ) {
+  RIGEL_TRACE_SCOPE("createFontTexture");
+
   if (font.size() != 67u) {
     throw std::runtime_error("Wrong number of bitmaps in menu font");
   }
@@ -45,8 +45,6 @@ void MoviePlayer::playMovie(
   const std::optional<int>& repetitions,
   FrameCallbackFunc frameCallback
 ) {
-  assert(frameDelayInFastTicks >= 1);
-
   {
     const auto saved = mCanvas.bindAndReset();
 
@@ -60,6 +58,42 @@ void MoviePlayer::playMovie(
         renderer::Texture(mpRenderer, frame.mReplacementImage);
       return FrameData{std::move(texture), frame.mStartRow};
     });
+  mNumFrames = static_cast<int>(mAnimationFrames.size());
+  mpDecoder = nullptr;
+
+  startPlayback(frameDelayInFastTicks, repetitions, std::move(frameCallback));
+}
+
+
+void MoviePlayer::playMovie(
+  loader::MovieDecoder& decoder,
+  const int frameDelayInFastTicks,
+  const std::optional<int>& repetitions,
+  FrameCallbackFunc frameCallback
+) {
+  {
+    const auto saved = mCanvas.bindAndReset();
+
+    auto baseImage = renderer::Texture(mpRenderer, decoder.decodeBaseImage());
+    baseImage.render(0, 0);
+  }
+
+  mAnimationFrames.clear();
+  mNumFrames = decoder.numFrames();
+  mpDecoder = &decoder;
+  mStreamedFrame = {};
+  mStreamedFrameIndex = -1;
+
+  startPlayback(frameDelayInFastTicks, repetitions, std::move(frameCallback));
+}
+
+
+void MoviePlayer::startPlayback(
+  const int frameDelayInFastTicks,
+  const std::optional<int>& repetitions,
+  FrameCallbackFunc frameCallback
+) {
+  assert(frameDelayInFastTicks >= 1);
 
   mFrameCallback = std::move(frameCallback);
   mCurrentFrame = 0;
@@ -95,8 +129,7 @@ void MoviePlayer::updateAndRender(const engine::TimeDelta timeDelta) {
       // We render one frame less during the last repetition, since the first
       // (full) image is to be counted as if it was the first frame.
       const auto framesToRenderThisRepetition =
-        static_cast<int>(mAnimationFrames.size()) -
-          (repetitionsRemaining == 1 ? 1 : 0);
+        mNumFrames - (repetitionsRemaining == 1 ? 1 : 0);
 
       if (mCurrentFrame >= framesToRenderThisRepetition) {
         mCurrentFrame = 0;
@@ -104,17 +137,17 @@ void MoviePlayer::updateAndRender(const engine::TimeDelta timeDelta) {
       }
     } else {
       // Repeat forever
-      mCurrentFrame %= mAnimationFrames.size();
+      mCurrentFrame %= mNumFrames;
     }
 
     const int frameNrIncludingFirstImage =
-      (mCurrentFrame + 1) % mAnimationFrames.size();
+      (mCurrentFrame + 1) % mNumFrames;
     invokeFrameCallbackIfPresent(frameNrIncludingFirstImage);
   }
 
   {
     const auto saved = mCanvas.bindAndReset();
-    const auto& frameData = mAnimationFrames[mCurrentFrame];
+    const auto& frameData = currentFrameData();
     frameData.mImage.render(0, frameData.mStartRow);
   }
 
@@ -127,6 +160,38 @@ bool MoviePlayer::hasCompletedPlayback() const {
 }
 
 
+const MoviePlayer::FrameData& MoviePlayer::currentFrameData() {
+  if (!mpDecoder) {
+    return mAnimationFrames[mCurrentFrame];
+  }
+
+  if (mStreamedFrameIndex != mCurrentFrame) {
+    // Normally, frames are shown in order, and the decoder is already at the
+    // frame we need. But playback can also jump back to frame 0 when the
+    // last repetition ends early. The canvas still shows the frame before
+    // the jump at that point, and frames are deltas, so we apply the first
+    // frame on top of the current state instead of rewinding to the base
+    // image. This is also why we can't decode ahead: The decoder's state
+    // must always match what's on the canvas.
+    if (mCurrentFrame != mpDecoder->nextFrameIndex() % mNumFrames) {
+      if (mCurrentFrame == 0) {
+        mpDecoder->restartAnimation();
+      } else {
+        mpDecoder->seekToFrame(mCurrentFrame);
+      }
+    }
+
+    const auto frame = mpDecoder->decodeNextFrame();
+    mStreamedFrame = FrameData{
+      renderer::Texture(mpRenderer, frame.mReplacementImage),
+      frame.mStartRow};
+    mStreamedFrameIndex = mCurrentFrame;
+  }
+
+  return mStreamedFrame;
+}
+
+
 void MoviePlayer::invokeFrameCallbackIfPresent(const int frameNumber) {
   if (mFrameCallback) {
     const auto maybeNewFrameDelay = mFrameCallback(frameNumber);
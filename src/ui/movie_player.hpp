@@ -18,6 +18,7 @@
 
 #include "data/movie.hpp"
 #include "engine/timing.hpp"
+#include "loader/movie_loader.hpp"
 #include "renderer/texture.hpp"
 
 #include <functional>
@@ -43,6 +44,19 @@ public:
     const std::optional<int>& repetitions = std::nullopt,
     FrameCallbackFunc frameCallback = nullptr);
 
+  /** Play a movie by decoding it during playback
+   *
+   * Instead of uploading all frames up-front, only the frame currently on
+   * screen is kept in a texture, while the next frame is decoded ahead of
+   * time. The decoder must stay alive until playback has completed or
+   * another movie is started.
+   */
+  void playMovie(
+    loader::MovieDecoder& decoder,
+    int frameDelayInFastTicks,
+    const std::optional<int>& repetitions = std::nullopt,
+    FrameCallbackFunc frameCallback = nullptr);
+
   void updateAndRender(engine::TimeDelta timeDelta);
   bool hasCompletedPlayback() const;
 
@@ -52,12 +66,21 @@ private:
     int mStartRow;
   };
 
+  void startPlayback(
+    int frameDelayInFastTicks,
+    const std::optional<int>& repetitions,
+    FrameCallbackFunc frameCallback);
+  const FrameData& currentFrameData();
   void invokeFrameCallbackIfPresent(int whichFrame);
 
 private:
   renderer::Renderer* mpRenderer;
   renderer::RenderTargetTexture mCanvas;
   std::vector<FrameData> mAnimationFrames;
+  loader::MovieDecoder* mpDecoder = nullptr;
+  FrameData mStreamedFrame;
+  int mStreamedFrameIndex = -1;
+  int mNumFrames = 0;
   FrameCallbackFunc mFrameCallback = nullptr;
 
   bool mHasShownFirstFrame = false;
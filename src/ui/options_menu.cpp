@@ -235,6 +235,13 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt) {
       fpsLimitUi(mpOptions);
       ImGui::NewLine();
 
+      withEnabledState(
+        !mpOptions->mEnableVsync && mpOptions->mEnableFpsLimit, [this]() {
+          ImGui::Checkbox(
+            "Precise frame pacing (uses more CPU)",
+            &mpOptions->mPreciseFpsLimit);
+        });
+
       ImGui::Checkbox("Show FPS", &mpOptions->mShowFpsCounter);
       ImGui::EndTabItem();
     }
@@ -256,6 +263,11 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt) {
       ImGui::Checkbox("Sound on", &mpOptions->mSoundOn);
       ImGui::NewLine();
 
+      ImGui::Checkbox(
+        "Pre-render music (less CPU, more memory)",
+        &mpOptions->mPrerenderMusic);
+      ImGui::NewLine();
+
       ImGui::EndTabItem();
     }
 
@@ -303,6 +315,9 @@ void OptionsMenu::updateAndRender(engine::TimeDelta dt) {
 
       ImGui::Checkbox("Widescreen mode", &mpOptions->mWidescreenModeOn);
       ImGui::Checkbox("Quick saving", &mpOptions->mQuickSavingEnabled);
+      ImGui::Checkbox(
+        "Motion smoothing (adds some input lag)",
+        &mpOptions->mMotionSmoothingOn);
       ImGui::EndTabItem();
     }
 
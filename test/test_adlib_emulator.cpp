@@ -0,0 +1,84 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <loader/adlib_emulator.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <iterator>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("Sample conversion matches scalar reference") {
+  // Cover the full 16-bit range plus some values exceeding it, and various
+  // odd lengths to exercise the non-SIMD remainder handling
+  std::vector<std::int32_t> input;
+  for (auto value = -40000; value <= 40000; ++value) {
+    input.push_back(value);
+  }
+
+  const auto volumes = {0.0f, 0.1f, 0.5f, 0.75f, 1.0f, 2.0f, 3.3f};
+
+  for (const auto volume : volumes) {
+    for (const auto length : {input.size(), std::size_t{13}, std::size_t{7}}) {
+      std::vector<std::int16_t> expected(length);
+      std::vector<std::int16_t> actual(length);
+
+      loader::convertSamplesScalar(
+        input.data(), expected.data(), length, volume);
+      loader::convertSamples(input.data(), actual.data(), length, volume);
+
+      CHECK(actual == expected);
+    }
+  }
+}
+
+
+TEST_CASE("Rendering to pointer and iterator gives same result") {
+  const auto sampleRate = 44100;
+  const auto numSamples = std::size_t{3000};
+
+  loader::AdlibEmulator emulator1{sampleRate};
+  loader::AdlibEmulator emulator2{sampleRate};
+
+  // Play a simple tone on the first channel
+  for (auto pEmulator : {&emulator1, &emulator2}) {
+    pEmulator->writeRegister(0x20, 0x01);
+    pEmulator->writeRegister(0x40, 0x10);
+    pEmulator->writeRegister(0x60, 0xF0);
+    pEmulator->writeRegister(0x80, 0x77);
+    pEmulator->writeRegister(0xA0, 0x98);
+    pEmulator->writeRegister(0x23, 0x01);
+    pEmulator->writeRegister(0x63, 0xF0);
+    pEmulator->writeRegister(0x83, 0x77);
+    pEmulator->writeRegister(0xB0, 0x31);
+  }
+
+  std::vector<std::int16_t> viaPointer(numSamples);
+  emulator1.render(numSamples, viaPointer.data(), 0.8f);
+
+  std::vector<std::int16_t> viaIterator;
+  emulator2.render(numSamples, std::back_inserter(viaIterator), 0.8f);
+
+  CHECK(viaPointer == viaIterator);
+}
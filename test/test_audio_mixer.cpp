@@ -0,0 +1,138 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/audio_mixer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+
+using Samples = std::vector<data::Sample>;
+
+
+namespace {
+
+const auto SAMPLE_RATE = 44100;
+
+
+Samples mix(AudioMixer& mixer, const std::size_t numSamples) {
+  Samples result(numSamples);
+  mixer.mix(result.data(), numSamples);
+  return result;
+}
+
+}
+
+
+TEST_CASE("Audio mixer") {
+  AudioMixer::SoundData sounds;
+  sounds[0] = {100, 200, 300, 400};
+  sounds[1] = {10, 20};
+  sounds[2] = {30000, 30000, -30000, -30000};
+
+  AudioMixer mixer{sounds, nullptr, SAMPLE_RATE};
+
+  SECTION("Produces silence when nothing is playing") {
+    CHECK((mix(mixer, 3) == Samples{0, 0, 0}));
+  }
+
+  SECTION("Plays sound until its end") {
+    mixer.playSound(data::SoundId{0});
+
+    CHECK((mix(mixer, 3) == Samples{100, 200, 300}));
+    CHECK((mix(mixer, 3) == Samples{400, 0, 0}));
+    CHECK((mix(mixer, 2) == Samples{0, 0}));
+  }
+
+  SECTION("Playing the same sound again restarts it") {
+    mixer.playSound(data::SoundId{0});
+    CHECK((mix(mixer, 2) == Samples{100, 200}));
+
+    mixer.playSound(data::SoundId{0});
+    CHECK((mix(mixer, 5) == Samples{100, 200, 300, 400, 0}));
+  }
+
+  SECTION("Different sounds play simultaneously") {
+    mixer.playSound(data::SoundId{0});
+    mixer.playSound(data::SoundId{1});
+
+    CHECK((mix(mixer, 5) == Samples{110, 220, 300, 400, 0}));
+  }
+
+  SECTION("Mixed output is clamped to 16-bit range") {
+    mixer.playSound(data::SoundId{0});
+    mixer.playSound(data::SoundId{2});
+    mixer.playSound(data::SoundId{2});
+
+    CHECK((mix(mixer, 4) == Samples{30100, 30200, -29700, -29600}));
+
+    sounds[3] = {30000, 0, -30000};
+    AudioMixer clippingMixer{sounds, nullptr, SAMPLE_RATE};
+    clippingMixer.playSound(data::SoundId{2});
+    clippingMixer.playSound(data::SoundId{3});
+
+    CHECK((mix(clippingMixer, 4) == Samples{32767, 30000, -32768, -30000}));
+  }
+
+  SECTION("Stopping a sound silences it") {
+    mixer.playSound(data::SoundId{0});
+    CHECK((mix(mixer, 1) == Samples{100}));
+
+    mixer.stopSound(data::SoundId{0});
+    CHECK((mix(mixer, 2) == Samples{0, 0}));
+  }
+
+  SECTION("Sound volume is applied") {
+    mixer.setSoundVolume(0.5f);
+    mixer.playSound(data::SoundId{0});
+
+    CHECK((mix(mixer, 4) == Samples{50, 100, 150, 200}));
+
+    mixer.setSoundVolume(0.0f);
+    mixer.playSound(data::SoundId{0});
+
+    CHECK((mix(mixer, 2) == Samples{0, 0}));
+  }
+}
+
+
+TEST_CASE("Sample accumulation handles all buffer lengths") {
+  for (auto length = std::size_t{0}; length < 40; ++length) {
+    Samples input(length);
+    for (auto i = std::size_t{0}; i < length; ++i) {
+      input[i] = static_cast<data::Sample>(i % 2 == 0 ? 1000 * i : -500 * i);
+    }
+
+    std::vector<std::int32_t> accumulator(length, 256);
+    accumulateSamples(accumulator.data(), input.data(), length, 128);
+    accumulateSamples(accumulator.data(), input.data(), length, 128);
+
+    Samples output(length);
+    storeAccumulatedSamples(accumulator.data(), output.data(), length);
+
+    for (auto i = std::size_t{0}; i < length; ++i) {
+      CHECK(output[i] == input[i] + 1);
+    }
+  }
+}
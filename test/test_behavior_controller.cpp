@@ -0,0 +1,302 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/base_components.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/behavior_controller_system.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <array>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+using engine::components::Active;
+using game_logic::components::BehaviorController;
+
+namespace ex = entityx;
+
+
+namespace {
+
+struct UpdateLog {
+  std::vector<std::string> mEntries;
+};
+
+
+template <char Name>
+struct LoggingBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity entity
+  ) {
+    mpLog->mEntries.push_back(
+      std::string(1, Name) + std::to_string(entity.id().index()));
+    ++mNumUpdates;
+  }
+
+  UpdateLog* mpLog;
+  int mNumUpdates = 0;
+};
+
+
+struct DestroysOtherEntity {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+    if (mVictim.valid()) {
+      mVictim.destroy();
+    }
+  }
+
+  ex::Entity mVictim;
+};
+
+
+// Too large to be stored inline
+struct LargeBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+    ++mData[0];
+  }
+
+  std::array<int, 64> mData{};
+};
+
+
+struct PersistentBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+    ++mValue;
+  }
+
+  void writeState(loader::LeStreamWriter& writer) const {
+    writer.writeS32(mValue);
+  }
+
+  void readState(loader::LeStreamReader& reader) {
+    mValue = reader.readS32();
+  }
+
+  int mValue = 0;
+};
+
+
+struct StatelessBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+  }
+};
+
+}
+
+
+TEST_CASE("Behavior controller copy and move") {
+  UpdateLog log;
+
+  SECTION("Inline storage") {
+    BehaviorController original{LoggingBehavior<'A'>{&log}};
+    original.get<LoggingBehavior<'A'>>().mNumUpdates = 3;
+
+    auto copy = original;
+    copy.get<LoggingBehavior<'A'>>().mNumUpdates = 5;
+    CHECK(original.get<LoggingBehavior<'A'>>().mNumUpdates == 3);
+
+    auto moved = std::move(copy);
+    CHECK(moved.get<LoggingBehavior<'A'>>().mNumUpdates == 5);
+
+    moved = original;
+    CHECK(moved.get<LoggingBehavior<'A'>>().mNumUpdates == 3);
+    CHECK(moved.typeTag() == original.typeTag());
+  }
+
+  SECTION("Heap storage") {
+    BehaviorController original{LargeBehavior{}};
+    original.get<LargeBehavior>().mData[0] = 42;
+
+    auto copy = original;
+    copy.get<LargeBehavior>().mData[0] = 7;
+    CHECK(original.get<LargeBehavior>().mData[0] == 42);
+
+    auto moved = std::move(copy);
+    CHECK(moved.get<LargeBehavior>().mData[0] == 7);
+  }
+
+  SECTION("Different types have different type tags") {
+    BehaviorController a{LoggingBehavior<'A'>{&log}};
+    BehaviorController b{LoggingBehavior<'B'>{&log}};
+
+    CHECK(a.typeTag() != b.typeTag());
+  }
+}
+
+
+TEST_CASE("Behavior controller persistent state") {
+  SECTION("Behaviors opt into storing their state") {
+    CHECK(BehaviorController{PersistentBehavior{}}.hasPersistentState());
+    CHECK(!BehaviorController{LargeBehavior{}}.hasPersistentState());
+  }
+
+  SECTION("State can be written and read back") {
+    BehaviorController original{PersistentBehavior{}};
+    original.get<PersistentBehavior>().mValue = 42;
+
+    loader::LeStreamWriter writer;
+    original.writeState(writer);
+    const auto buffer = writer.takeData();
+    loader::LeStreamReader reader{buffer};
+
+    BehaviorController restored{PersistentBehavior{}};
+    restored.readState(reader);
+    CHECK(restored.get<PersistentBehavior>().mValue == 42);
+  }
+
+  SECTION("Behaviors with state leave their initial state when invoked") {
+    GlobalDependencies dependencies{};
+    GlobalState state{nullptr, nullptr, nullptr, nullptr};
+
+    BehaviorController stateful{LargeBehavior{}};
+    BehaviorController stateless{StatelessBehavior{}};
+    CHECK(stateful.isInInitialState());
+    CHECK(stateless.isInInitialState());
+
+    stateful.update(dependencies, state, true, ex::Entity{});
+    stateless.update(dependencies, state, true, ex::Entity{});
+    CHECK(!stateful.isInInitialState());
+    CHECK(stateless.isInInitialState());
+
+    const auto copy = stateful;
+    CHECK(!copy.isInInitialState());
+  }
+}
+
+
+TEST_CASE("Behavior controller system update modes") {
+  ex::EntityX entityx;
+  UpdateLog log;
+
+  BehaviorControllerSystem behaviorControllerSystem{
+    GlobalDependencies{
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      nullptr,
+      &entityx.entities,
+      &entityx.events},
+    nullptr,
+    nullptr,
+    nullptr};
+
+  auto addEntity = [&](auto behavior) {
+    auto entity = entityx.entities.create();
+    entity.assign<BehaviorController>(behavior);
+    entity.assign<Active>();
+    return entity;
+  };
+
+  auto first = addEntity(LoggingBehavior<'A'>{&log});
+  addEntity(LoggingBehavior<'B'>{&log});
+  addEntity(LoggingBehavior<'A'>{&log});
+  addEntity(LoggingBehavior<'B'>{&log});
+  auto inactive = addEntity(LoggingBehavior<'A'>{&log});
+  inactive.remove<Active>();
+
+  SECTION("Default mode updates in entity order") {
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+
+    const auto expected = std::vector<std::string>{"A0", "B1", "A2", "B3"};
+    CHECK(log.mEntries == expected);
+  }
+
+  SECTION("Grouped mode updates by type, in entity order within type") {
+    behaviorControllerSystem.setUpdateMode(
+      BehaviorControllerSystem::UpdateMode::GroupedByType);
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+
+    const auto expected = std::vector<std::string>{"A0", "A2", "B1", "B3"};
+    CHECK(log.mEntries == expected);
+  }
+
+  SECTION("Grouped mode orders types by their first active entity") {
+    first.remove<Active>();
+
+    behaviorControllerSystem.setUpdateMode(
+      BehaviorControllerSystem::UpdateMode::GroupedByType);
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+
+    const auto expected = std::vector<std::string>{"B1", "B3", "A2"};
+    CHECK(log.mEntries == expected);
+  }
+
+  SECTION("Grouped mode skips entities destroyed during the update") {
+    auto destroyer = addEntity(DestroysOtherEntity{});
+    auto victim = addEntity(LoggingBehavior<'C'>{&log});
+    addEntity(LoggingBehavior<'C'>{&log});
+    destroyer.component<BehaviorController>()
+      ->get<DestroysOtherEntity>().mVictim = victim;
+
+    behaviorControllerSystem.setUpdateMode(
+      BehaviorControllerSystem::UpdateMode::GroupedByType);
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+
+    // The destroyer's type comes first, so the victim is destroyed before
+    // its batch is updated. The remaining entity of the batch is still
+    // updated.
+    const auto expected =
+      std::vector<std::string>{"A0", "A2", "B1", "B3", "C7"};
+    CHECK(log.mEntries == expected);
+    CHECK(!victim.valid());
+  }
+
+  SECTION("Grouped mode is reproducible") {
+    behaviorControllerSystem.setUpdateMode(
+      BehaviorControllerSystem::UpdateMode::GroupedByType);
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+    const auto firstFrame = log.mEntries;
+
+    log.mEntries.clear();
+    behaviorControllerSystem.update(entityx.entities, PerFrameState{});
+
+    CHECK(log.mEntries == firstFrame);
+  }
+}
@@ -0,0 +1,71 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <game_logic/camera.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace game_logic;
+
+
+TEST_CASE("Camera interpolation") {
+  SECTION("Factor 1 gives the current position") {
+    const auto camera = interpolateCamera({0, 0}, {1, 2}, 1.0f);
+
+    CHECK(camera.mTilePosition == base::Vector(1, 2));
+    CHECK(camera.mPixelOffset == base::Vector{});
+    CHECK(camera.mSpriteOffset == base::Vector{});
+  }
+
+  SECTION("Factor 0 gives the previous position") {
+    const auto camera = interpolateCamera({0, 0}, {1, 2}, 0.0f);
+
+    CHECK(camera.mTilePosition == base::Vector(0, 0));
+    CHECK(camera.mPixelOffset == base::Vector{});
+    CHECK(camera.mSpriteOffset == base::Vector(8, 16));
+  }
+
+  SECTION("In between two tiles, the map is shifted by a pixel offset") {
+    const auto camera = interpolateCamera({4, 3}, {5, 3}, 0.25f);
+
+    CHECK(camera.mTilePosition == base::Vector(4, 3));
+    CHECK(camera.mPixelOffset == base::Vector(-2, 0));
+    CHECK(camera.mSpriteOffset == base::Vector(8, 0));
+  }
+
+  SECTION("Moving towards the origin") {
+    const auto camera = interpolateCamera({2, 6}, {1, 5}, 0.5f);
+
+    CHECK(camera.mTilePosition == base::Vector(1, 5));
+    CHECK(camera.mPixelOffset == base::Vector(-4, -4));
+    CHECK(camera.mSpriteOffset == base::Vector(0, 0));
+  }
+
+  SECTION("A stationary camera has no offsets") {
+    const auto camera = interpolateCamera({7, 7}, {7, 7}, 0.6f);
+
+    CHECK(camera.mTilePosition == base::Vector(7, 7));
+    CHECK(camera.mPixelOffset == base::Vector{});
+    CHECK(camera.mSpriteOffset == base::Vector{});
+  }
+}
@@ -24,6 +24,7 @@
 #include <data/player_model.hpp>
 #include <engine/collision_checker.hpp>
 #include <engine/entity_activation_system.hpp>
+#include <engine/event_queue.hpp>
 #include <engine/particle_system.hpp>
 #include <engine/physical_components.hpp>
 #include <engine/physics_system.hpp>
@@ -126,7 +127,8 @@ TEST_CASE("Rocket elevator") {
 
   base::Vector cameraPosition{0, 0};
   engine::ParticleSystem particleSystem{&randomGenerator, nullptr};
-  PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
+  EventQueue eventQueue{&entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &eventQueue};
   BehaviorControllerSystem behaviorControllerSystem{
     GlobalDependencies{
       &collisionChecker,
@@ -0,0 +1,61 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/entity_allocation_counter.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+
+
+TEST_CASE("Entity allocation counter") {
+  entityx::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  EntityAllocationCounter counter{&entities, entityx.events};
+
+  auto first = entities.create();
+  auto second = entities.create();
+  counter.beginFrame();
+
+  SECTION("Creations and destructions are counted per frame") {
+    CHECK(counter.lastFrame().mCreated == 2);
+    CHECK(counter.lastFrame().mDestroyed == 0);
+
+    first.destroy();
+    counter.beginFrame();
+
+    CHECK(counter.lastFrame().mCreated == 0);
+    CHECK(counter.lastFrame().mDestroyed == 1);
+    CHECK(counter.peakCreatedPerFrame() == 2);
+  }
+
+  SECTION("Reusing a destroyed entity's slot doesn't allocate") {
+    CHECK(counter.lastFrame().mSlotsAllocated >= 2);
+
+    second.destroy();
+    entities.create();
+    counter.beginFrame();
+
+    CHECK(counter.lastFrame().mCreated == 1);
+    CHECK(counter.lastFrame().mSlotsAllocated == 0);
+  }
+}
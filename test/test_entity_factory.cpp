@@ -0,0 +1,173 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils.hpp"
+
+#include <data/game_options.hpp>
+#include <data/map.hpp>
+#include <engine/random_number_generator.hpp>
+#include <engine/sprite_factory.hpp>
+#include <game_logic/all_components.hpp>
+#include <game_logic/entity_factory.hpp>
+#include <game_logic/quick_save.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace game_logic;
+
+namespace ex = entityx;
+
+
+namespace {
+
+constexpr auto HIGHEST_ACTOR_ID = 300;
+
+
+struct MockSpriteFactory : public rigel::engine::ISpriteFactory {
+  engine::components::Sprite createSprite(data::ActorID id) override {
+    static const auto dummyDrawData = []() {
+      rigel::engine::SpriteDrawData drawData;
+      drawData.mFrames.resize(32);
+      return drawData;
+    }();
+    return {&dummyDrawData, {0}};
+  }
+
+  base::Rect<int> actorFrameRect(data::ActorID id, int frame) const override {
+    return {{}, {2, 3}};
+  }
+};
+
+
+struct TestWorld {
+  explicit TestWorld(const bool useActorPrototypes) {
+    entityFactory.setActorPrototypesEnabled(useActorPrototypes);
+  }
+
+  ex::EntityX entityx;
+  MockServiceProvider mockServiceProvider;
+  engine::RandomNumberGenerator randomGenerator;
+  MockSpriteFactory mockSpriteFactory;
+  data::GameOptions options;
+  EntityFactory entityFactory{
+    &mockSpriteFactory,
+    &entityx.entities,
+    &mockServiceProvider,
+    &randomGenerator,
+    &options,
+    data::Difficulty::Medium};
+};
+
+
+bool isConfiguredIndividually(const data::ActorID id) {
+  using data::ActorID;
+
+  // Markers are resolved by the level loader, and dynamic geometry always
+  // has an assigned area, so these never go through the prototype path.
+  switch (id) {
+    case ActorID::META_Appear_only_in_med_hard_difficulty:
+    case ActorID::META_Appear_only_in_hard_difficulty:
+    case ActorID::META_Dynamic_geometry_marker_1:
+    case ActorID::META_Dynamic_geometry_marker_2:
+    case ActorID::Dynamic_geometry_1:
+    case ActorID::Dynamic_geometry_2:
+    case ActorID::Dynamic_geometry_3:
+    case ActorID::Dynamic_geometry_4:
+    case ActorID::Dynamic_geometry_5:
+    case ActorID::Dynamic_geometry_6:
+    case ActorID::Dynamic_geometry_7:
+    case ActorID::Dynamic_geometry_8:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+
+template <typename... Components>
+std::vector<bool> presentComponents(
+  ex::Entity entity,
+  TypeList<Components...>
+) {
+  return {entity.has_component<Components>()...};
+}
+
+
+std::vector<std::vector<bool>> presentComponentsOfAll(
+  ex::EntityManager& entities
+) {
+  std::vector<std::vector<bool>> result;
+  for (auto entity : entities.entities_for_debugging()) {
+    result.push_back(presentComponents(entity, AllComponents{}));
+  }
+
+  return result;
+}
+
+
+loader::ByteBuffer serializedEntities(ex::EntityManager& entities) {
+  loader::LeStreamWriter writer;
+  writeQuickSaveEntities(writer, entities, {}, ex::Entity{});
+  return writer.takeData();
+}
+
+}
+
+
+TEST_CASE("Actor prototypes produce the same entities as configureEntity") {
+  for (auto i = 0; i <= HIGHEST_ACTOR_ID; ++i) {
+    const auto id = static_cast<data::ActorID>(i);
+    if (isConfiguredIndividually(id)) {
+      continue;
+    }
+
+    INFO("Actor ID " << i);
+
+    TestWorld withPrototypes{true};
+    TestWorld withoutPrototypes{false};
+
+    // Spawn each actor twice, so that the second one is copied from an
+    // already existing prototype
+    const auto actors = data::map::ActorDescriptionList{
+      {{3, 10}, id, std::nullopt},
+      {{7, 12}, id, std::nullopt}};
+    withPrototypes.entityFactory.createEntitiesForLevel(actors);
+    withoutPrototypes.entityFactory.createEntitiesForLevel(actors);
+
+    CHECK(
+      withPrototypes.entityx.entities.size() ==
+      withoutPrototypes.entityx.entities.size());
+    CHECK(
+      withPrototypes.randomGenerator.nextNumberIndex() ==
+      withoutPrototypes.randomGenerator.nextNumberIndex());
+    CHECK(
+      presentComponentsOfAll(withPrototypes.entityx.entities) ==
+      presentComponentsOfAll(withoutPrototypes.entityx.entities));
+    CHECK(
+      serializedEntities(withPrototypes.entityx.entities) ==
+      serializedEntities(withoutPrototypes.entityx.entities));
+  }
+}
@@ -0,0 +1,85 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <game_logic/entity_tag_index.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace game_logic;
+using namespace game_logic::components;
+
+
+TEST_CASE("Entity tag index") {
+  entityx::EntityX entityx;
+  auto& entities = entityx.entities;
+
+  EntityTagIndex index{entityx.events};
+
+  auto camera1 = entities.create();
+  camera1.assign<ActorTag>(ActorTag::Type::ShootableCamera);
+  auto door = entities.create();
+  door.assign<ActorTag>(ActorTag::Type::Door);
+  auto camera2 = entities.create();
+  camera2.assign<ActorTag>(ActorTag::Type::ShootableCamera);
+  camera2.assign<AppearsOnRadar>();
+
+  SECTION("Entities are listed by tag type") {
+    const auto expected = EntityTagIndex::EntityList{camera1, camera2};
+    CHECK(index.entitiesWithTag(ActorTag::Type::ShootableCamera) == expected);
+    CHECK(index.entitiesWithTag(ActorTag::Type::Door).size() == 1);
+    CHECK(index.entitiesWithTag(ActorTag::Type::FireBomb).empty());
+    CHECK(index.entitiesOnRadar().size() == 1);
+  }
+
+  SECTION("Removing the component removes the entity from the list") {
+    camera1.remove<ActorTag>();
+
+    const auto expected = EntityTagIndex::EntityList{camera2};
+    CHECK(index.entitiesWithTag(ActorTag::Type::ShootableCamera) == expected);
+  }
+
+  SECTION("Destroyed entities are removed") {
+    camera2.destroy();
+
+    CHECK(index.entitiesWithTag(ActorTag::Type::ShootableCamera).size() == 1);
+    CHECK(index.entitiesOnRadar().empty());
+  }
+
+  SECTION("Lists stay in entity order when indices are reused") {
+    camera1.destroy();
+    auto camera3 = entities.create();
+    camera3.assign<ActorTag>(ActorTag::Type::ShootableCamera);
+
+    const auto& cameras = index.entitiesWithTag(ActorTag::Type::ShootableCamera);
+    REQUIRE(cameras.size() == 2);
+    CHECK(cameras[0].id().index() < cameras[1].id().index());
+  }
+
+  SECTION("Tile debris is tracked") {
+    auto debris = entities.create();
+    debris.assign<TileDebris>(TileDebris{42});
+    REQUIRE(index.tileDebris().size() == 1);
+
+    debris.destroy();
+    CHECK(index.tileDebris().empty());
+  }
+}
@@ -0,0 +1,160 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/event_queue.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+
+namespace ex = entityx;
+
+
+namespace {
+
+struct EntityEvent {
+  ex::Entity mEntity;
+};
+
+struct UrgentEvent {
+  int mValue;
+};
+
+
+struct Recorder : public ex::Receiver<Recorder> {
+  explicit Recorder(ex::EventManager& events) {
+    events.subscribe<EntityEvent>(*this);
+    events.subscribe<UrgentEvent>(*this);
+  }
+
+  void receive(const EntityEvent&) {
+    mReceived.push_back("entity");
+  }
+
+  void receive(const UrgentEvent& event) {
+    mReceived.push_back("urgent " + std::to_string(event.mValue));
+  }
+
+  std::vector<std::string> mReceived;
+};
+
+
+struct UrgentPoster : public ex::Receiver<UrgentPoster> {
+  UrgentPoster(ex::EventManager& events, EventQueue& queue)
+    : mpQueue(&queue)
+  {
+    events.subscribe<EntityEvent>(*this);
+  }
+
+  void receive(const EntityEvent&) {
+    if (!mHasPosted) {
+      mHasPosted = true;
+      mpQueue->post(UrgentEvent{7});
+    }
+  }
+
+  EventQueue* mpQueue;
+  bool mHasPosted = false;
+};
+
+}
+
+
+TEST_CASE("Event queue") {
+  ex::EntityX entityx;
+  Recorder recorder{entityx.events};
+
+  EventQueue queue{&entityx.events};
+  queue.registerEventType<EntityEvent>("EntityEvent");
+  queue.registerEventType<UrgentEvent>(
+    "UrgentEvent", EventQueue::Deferrable::No);
+
+  auto entity = entityx.entities.create();
+
+  SECTION("Immediate mode forwards events right away") {
+    queue.post(EntityEvent{entity});
+    CHECK(recorder.mReceived.size() == 1);
+    CHECK(!queue.hasPendingEvents());
+  }
+
+  SECTION("Deferred mode") {
+    queue.setDispatchMode(EventQueue::DispatchMode::Deferred);
+
+    SECTION("Events are buffered until dispatch") {
+      queue.post(EntityEvent{entity});
+      queue.post(EntityEvent{entity});
+      CHECK(recorder.mReceived.empty());
+      CHECK(queue.hasPendingEvents());
+
+      queue.dispatch();
+      CHECK(recorder.mReceived.size() == 2);
+      CHECK(!queue.hasPendingEvents());
+    }
+
+    SECTION("Non-deferrable events flush the buffer first") {
+      queue.post(EntityEvent{entity});
+      queue.post(UrgentEvent{42});
+
+      const auto expected =
+        std::vector<std::string>{"entity", "urgent 42"};
+      CHECK(recorder.mReceived == expected);
+    }
+
+    SECTION("Non-deferrable events posted during dispatch wait their turn") {
+      UrgentPoster poster{entityx.events, queue};
+
+      queue.post(EntityEvent{entity});
+      queue.post(EntityEvent{entity});
+      queue.dispatch();
+
+      const auto expected =
+        std::vector<std::string>{"entity", "entity", "urgent 7"};
+      CHECK(recorder.mReceived == expected);
+      CHECK(!queue.hasPendingEvents());
+    }
+
+    SECTION("Events for destroyed entities are dropped") {
+      queue.post(EntityEvent{entity});
+      entity.destroy();
+      queue.dispatch();
+
+      CHECK(recorder.mReceived.empty());
+
+      const auto stats = queue.statistics();
+      REQUIRE(stats.size() == 2);
+      CHECK(stats[0].mPostedThisFrame == 1);
+      CHECK(stats[0].mDroppedTotal == 1);
+    }
+  }
+
+  SECTION("Per-frame counters are reset by beginFrame") {
+    queue.post(UrgentEvent{1});
+    queue.post(UrgentEvent{2});
+    CHECK(queue.statistics()[1].mPostedThisFrame == 2);
+
+    queue.beginFrame();
+    CHECK(queue.statistics()[1].mPostedThisFrame == 0);
+    CHECK(queue.statistics()[1].mPostedTotal == 2);
+  }
+}
@@ -0,0 +1,121 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <renderer/fps_limiter.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <chrono>
+
+
+using namespace rigel;
+using namespace std::chrono;
+
+
+namespace {
+
+/** Simulated clock, sleeping has millisecond granularity and oversleeps */
+struct FakeFrameClock : renderer::IFrameClock {
+  base::Clock::time_point now() const override {
+    return mTime;
+  }
+
+  void sleepFor(const base::Clock::duration duration) override {
+    mTime += duration_cast<milliseconds>(duration) + microseconds{700};
+  }
+
+  void yield() override {
+    mTime += microseconds{10};
+  }
+
+  void work(const base::Clock::duration duration) {
+    mTime += duration;
+  }
+
+  base::Clock::time_point mTime = base::Clock::time_point{seconds{100}};
+};
+
+}
+
+
+TEST_CASE("FPS limiter") {
+  FakeFrameClock clock;
+
+  SECTION("Precise mode hits deadlines despite oversleeping") {
+    renderer::FpsLimiter limiter{
+      100, renderer::FpsLimiter::Mode::Precise, &clock};
+    const auto start = clock.now();
+
+    for (int i = 1; i <= 50; ++i) {
+      clock.work(microseconds{3300});
+      limiter.updateAndWait();
+
+      const auto deadline = start + milliseconds{10 * i};
+      CHECK(clock.now() >= deadline);
+      CHECK(clock.now() - deadline <= microseconds{10});
+    }
+
+    const auto stats = limiter.statistics();
+    CHECK(stats.mMissedDeadlines == 0);
+    CHECK(stats.mMedian == Approx(0.01).epsilon(0.002));
+    CHECK(stats.mMax == Approx(0.01).epsilon(0.002));
+  }
+
+  SECTION("Frames taking too long are counted as missed deadlines") {
+    renderer::FpsLimiter limiter{
+      100, renderer::FpsLimiter::Mode::Precise, &clock};
+
+    for (int i = 0; i < 10; ++i) {
+      clock.work(milliseconds{5});
+      limiter.updateAndWait();
+    }
+
+    clock.work(milliseconds{25});
+    limiter.updateAndWait();
+
+    const auto stats = limiter.statistics();
+    CHECK(stats.mMissedDeadlines == 1);
+    CHECK(stats.mMax == Approx(0.025).epsilon(0.002));
+    CHECK(stats.mMedian == Approx(0.01).epsilon(0.002));
+
+    SECTION("Limiter doesn't try to catch up after a long frame") {
+      const auto before = clock.now();
+      clock.work(milliseconds{1});
+      limiter.updateAndWait();
+
+      CHECK(clock.now() - before >= milliseconds{9});
+      CHECK(limiter.statistics().mMissedDeadlines == 1);
+    }
+  }
+
+  SECTION("Sleep mode compensates for oversleeping on average") {
+    renderer::FpsLimiter limiter{
+      100, renderer::FpsLimiter::Mode::Sleep, &clock};
+    const auto start = clock.now();
+
+    for (int i = 0; i < 100; ++i) {
+      clock.work(milliseconds{2});
+      limiter.updateAndWait();
+    }
+
+    const auto elapsed = duration<double>(clock.now() - start).count();
+    CHECK(elapsed == Approx(1.0).epsilon(0.02));
+    CHECK(limiter.statistics().mMissedDeadlines == 0);
+  }
+}
@@ -0,0 +1,75 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/frame_arena.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <cstdint>
+
+
+using namespace rigel;
+using namespace base;
+
+
+TEST_CASE("Frame arena") {
+  FrameArena arena{1024};
+
+  SECTION("Allocations are aligned") {
+    arena.allocate(1, 1);
+    const auto pMemory = arena.allocate(8, alignof(double));
+
+    CHECK(reinterpret_cast<std::uintptr_t>(pMemory) % alignof(double) == 0);
+    CHECK(arena.bytesUsed() == 16);
+  }
+
+  SECTION("Reset makes memory available again") {
+    const auto pFirst = arena.allocate(512, 1);
+    arena.reset();
+
+    CHECK(arena.bytesUsed() == 0);
+    CHECK(arena.allocate(512, 1) == pFirst);
+  }
+
+  SECTION("Allocations exceeding the capacity are still served") {
+    arena.allocate(1000, 1);
+    const auto pMemory = arena.allocate(100, 1);
+
+    CHECK(pMemory != nullptr);
+    CHECK(arena.bytesUsed() == 1100);
+    CHECK(arena.capacity() == 1024);
+
+    SECTION("Arena grows on reset") {
+      arena.reset();
+
+      CHECK(arena.capacity() >= 1100);
+    }
+  }
+
+  SECTION("Can be used with standard containers") {
+    auto numbers = makeArenaVector<int>(&arena);
+    for (auto i = 0; i < 100; ++i) {
+      numbers.push_back(i);
+    }
+
+    CHECK(numbers.size() == 100);
+    CHECK(numbers[99] == 99);
+    CHECK(arena.bytesUsed() >= 100 * sizeof(int));
+  }
+}
@@ -0,0 +1,203 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <engine/imf_player.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+
+
+namespace {
+
+constexpr auto SAMPLE_RATE = 44100;
+
+
+data::Song makeTestSong() {
+  // A few notes on channel 0, with an instrument set up on the first command
+  data::Song song{
+    {0x20, 0x01, 0},
+    {0x40, 0x10, 0},
+    {0x60, 0xF0, 0},
+    {0x80, 0x77, 0},
+    {0x23, 0x01, 0},
+    {0x43, 0x00, 0},
+    {0x63, 0xF0, 0},
+    {0x83, 0x77, 0},
+  };
+
+  const auto notes = {0x98, 0x20, 0x45, 0xB0};
+  for (const auto note : notes) {
+    song.push_back({0xA0, static_cast<std::uint8_t>(note), 0});
+    song.push_back({0xB0, 0x31, 20});
+    song.push_back({0xB0, 0x11, 10});
+  }
+
+  return song;
+}
+
+
+std::vector<std::int16_t> renderLive(
+  engine::ImfPlayer& player,
+  const std::size_t numSamples
+) {
+  std::vector<std::int16_t> result(numSamples);
+  player.render(result.data(), numSamples);
+  return result;
+}
+
+}
+
+
+TEST_CASE("Pre-rendered songs match live playback") {
+  const auto song = makeTestSong();
+  const auto rendered = engine::renderSong(song, SAMPLE_RATE);
+
+  REQUIRE(!rendered.mSamples.empty());
+  CHECK(rendered.mSamples.size() == rendered.mLoopStart * 2);
+
+  engine::ImfPlayer player{SAMPLE_RATE};
+  player.playSong(data::Song{song});
+
+  SECTION("Live playback produces identical samples") {
+    const auto live = renderLive(player, rendered.mSamples.size());
+    CHECK(live == rendered.mSamples);
+  }
+
+  SECTION("Playback loops back to the second pass") {
+    renderLive(player, rendered.mSamples.size());
+    const auto afterLoop = renderLive(player, 1000);
+
+    const auto iLoopStart = rendered.mSamples.begin() + rendered.mLoopStart;
+    const auto expected = std::vector<std::int16_t>(
+      iLoopStart, iLoopStart + 1000);
+    CHECK(afterLoop == expected);
+  }
+}
+
+
+TEST_CASE("Commands take effect at the next render call") {
+  const auto song = makeTestSong();
+  const auto rendered = engine::renderSong(song, SAMPLE_RATE);
+  REQUIRE(rendered.mSamples.size() > 3000);
+
+  engine::ImfPlayer player{SAMPLE_RATE};
+
+  const auto expectedSlice = [&](const std::size_t start) {
+    const auto iStart = rendered.mSamples.begin() + start;
+    return std::vector<std::int16_t>(iStart, iStart + 1000);
+  };
+  const auto silence = std::vector<std::int16_t>(1000, 0);
+
+  SECTION("Nothing is played before playSong") {
+    CHECK(renderLive(player, 1000) == silence);
+  }
+
+  player.playSong(data::Song{song});
+
+  SECTION("Stopping produces silence") {
+    CHECK(renderLive(player, 1000) == expectedSlice(0));
+
+    player.stop();
+    CHECK(renderLive(player, 1000) == silence);
+  }
+
+  SECTION("Muting keeps playback going") {
+    CHECK(renderLive(player, 1000) == expectedSlice(0));
+
+    player.setVolume(0.0f, 0.0);
+    CHECK(renderLive(player, 1000) == silence);
+
+    player.setVolume(1.0f, 0.0);
+    CHECK(renderLive(player, 1000) == expectedSlice(2000));
+  }
+}
+
+
+TEST_CASE("Submitting commands doesn't block if render isn't called") {
+  const auto song = makeTestSong();
+  const auto rendered = engine::renderSong(song, SAMPLE_RATE);
+  REQUIRE(rendered.mSamples.size() > 2000);
+
+  engine::ImfPlayer player{SAMPLE_RATE};
+  player.playSong(data::Song{song});
+
+  // More commands than fit into the queue. The last ones are kept back.
+  for (auto i = 0; i < 40; ++i) {
+    player.setVolume(0.0f, 0.0);
+  }
+
+  CHECK(renderLive(player, 1000) == std::vector<std::int16_t>(1000, 0));
+
+  // Deferred commands are delivered before this one
+  player.setVolume(1.0f, 0.0);
+
+  const auto iStart = rendered.mSamples.begin() + 1000;
+  const auto expected = std::vector<std::int16_t>(iStart, iStart + 1000);
+  CHECK(renderLive(player, 1000) == expected);
+}
+
+
+TEST_CASE("Commands kept back are delivered by update()") {
+  const auto song = makeTestSong();
+  const auto rendered = engine::renderSong(song, SAMPLE_RATE);
+  REQUIRE(rendered.mSamples.size() > 3000);
+
+  engine::ImfPlayer player{SAMPLE_RATE};
+  player.playSong(data::Song{song});
+
+  for (auto i = 0; i < 40; ++i) {
+    player.setVolume(0.0f, 0.0);
+  }
+  player.setVolume(1.0f, 0.0);
+
+  CHECK(renderLive(player, 1000) == std::vector<std::int16_t>(1000, 0));
+
+  // Nothing else has been submitted, so the last command is still kept back
+  CHECK(renderLive(player, 1000) == std::vector<std::int16_t>(1000, 0));
+
+  player.update();
+
+  const auto iStart = rendered.mSamples.begin() + 2000;
+  const auto expected = std::vector<std::int16_t>(iStart, iStart + 1000);
+  CHECK(renderLive(player, 1000) == expected);
+}
+
+
+TEST_CASE("Switching to pre-rendered playback is seamless") {
+  const auto song = makeTestSong();
+  const auto rendered = engine::renderSong(song, SAMPLE_RATE);
+
+  engine::ImfPlayer player{SAMPLE_RATE};
+  player.setPrerenderingEnabled(true);
+  player.playSong(data::Song{song});
+
+  // Render a bit of audio while pre-rendering is possibly still in progress,
+  // then wait for it to finish. The next render call switches over.
+  auto output = renderLive(player, 512);
+  player.waitForPrerendering();
+
+  const auto remainder = renderLive(player, rendered.mSamples.size() - 512);
+  output.insert(output.end(), remainder.begin(), remainder.end());
+
+  CHECK(output == rendered.mSamples);
+}
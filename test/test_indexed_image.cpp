@@ -0,0 +1,95 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/image.hpp>
+#include <loader/ega_image_decoder.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace data;
+
+
+TEST_CASE("Indexed image") {
+  const auto red = Pixel{255, 0, 0, 255};
+  const auto green = Pixel{0, 255, 0, 255};
+  const auto transparent = Pixel{0, 0, 0, 0};
+
+  SECTION("Converts to RGBA using the palette") {
+    const auto image =
+      IndexedImage{IndexedPixelBuffer{0, 1, 1, 0}, 2, 2, Palette{red, green}};
+    const auto rgbaImage = image.toRgbaImage();
+
+    const auto expected = PixelBuffer{red, green, green, red};
+    CHECK(rgbaImage.pixelData() == expected);
+    CHECK(rgbaImage.width() == 2);
+    CHECK(rgbaImage.height() == 2);
+  }
+
+  SECTION("Rejects indices outside of the palette") {
+    CHECK_THROWS_AS(
+      IndexedImage(IndexedPixelBuffer{0, 2}, 2, 1, Palette{red, green}),
+      const std::invalid_argument&);
+  }
+
+  SECTION("Images with a matching palette can be inserted") {
+    auto target = IndexedImage{3, 2, Palette{red, green, transparent}};
+    const auto source =
+      IndexedImage{IndexedPixelBuffer{1, 1}, 1, 2, Palette{red, green}};
+
+    target.insertImage(2, 0, source);
+
+    const auto expected = IndexedPixelBuffer{0, 0, 1, 0, 0, 1};
+    CHECK(target.pixelData() == expected);
+  }
+
+  SECTION("Images with a different palette can't be inserted") {
+    auto target = IndexedImage{2, 2, Palette{red, green}};
+    const auto source = IndexedImage{1, 1, Palette{green}};
+
+    CHECK_THROWS_AS(
+      target.insertImage(0, 0, source), const std::invalid_argument&);
+  }
+}
+
+
+TEST_CASE("Masked tiled images use a transparent palette entry") {
+  // One tile: Mask plane followed by 4 color planes, 8 bytes each. The first
+  // row is fully masked, all other rows use color 15.
+  auto data =
+    loader::ByteBuffer(GameTraits::bytesPerTile(TileImageType::Masked));
+  for (auto row = 0; row < GameTraits::tileSize; ++row) {
+    const auto rowStart = row * 5;
+    data[rowStart] = row == 0 ? 0xFF : 0x00;
+    for (auto plane = 1; plane <= 4; ++plane) {
+      data[rowStart + plane] = 0xFF;
+    }
+  }
+
+  const auto image = loader::loadTiledImage(
+    data, 1, loader::INGAME_PALETTE, TileImageType::Masked);
+
+  REQUIRE(image.palette().size() == 17);
+  CHECK(image.palette()[loader::MASKED_PIXEL_INDEX].a == 0);
+
+  CHECK(image.pixelData()[0] == loader::MASKED_PIXEL_INDEX);
+  CHECK(image.pixelData()[GameTraits::tileSize] == 15);
+  CHECK(image.pixelAt(3, 4) == loader::INGAME_PALETTE[15]);
+}
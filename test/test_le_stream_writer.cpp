@@ -0,0 +1,59 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace loader;
+
+
+TEST_CASE("LeStreamWriter writes little-endian data") {
+  LeStreamWriter writer;
+
+  SECTION("Byte order") {
+    writer.writeU8(0x12);
+    writer.writeU16(0x3456);
+    writer.writeU32(0x789ABCDE);
+
+    const auto expected = ByteBuffer{
+      0x12, 0x56, 0x34, 0xDE, 0xBC, 0x9A, 0x78};
+    CHECK(writer.data() == expected);
+  }
+
+  SECTION("Round trip via LeStreamReader") {
+    writer.writeS8(-5);
+    writer.writeS16(-1234);
+    writer.writeS32(-123456789);
+    writer.writeU16(65535);
+    writer.writeU32(4000000000u);
+
+    const auto data = writer.takeData();
+    LeStreamReader reader(data);
+
+    CHECK(reader.readS8() == -5);
+    CHECK(reader.readS16() == -1234);
+    CHECK(reader.readS32() == -123456789);
+    CHECK(reader.readU16() == 65535);
+    CHECK(reader.readU32() == 4000000000u);
+    CHECK(!reader.hasData());
+  }
+}
@@ -0,0 +1,98 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <vector>
+
+
+using namespace rigel;
+using namespace data::map;
+
+
+TEST_CASE("Map tile rows") {
+  Map map{4, 3, TileAttributeDict{}};
+  map.setTileAt(0, 1, 2, 5);
+  map.setTileAt(0, 2, 2, 6);
+  map.setTileAt(1, 3, 2, 7);
+
+  SECTION("Rows reflect the map's contents") {
+    const auto row = map.tileRow(0, 2);
+    const auto expected = std::vector<TileIndex>{0, 5, 6, 0};
+    CHECK(std::vector<TileIndex>(row.begin(), row.end()) == expected);
+
+    const auto partialRow = map.tileRow(1, 2, 2, 4);
+    const auto expectedPartial = std::vector<TileIndex>{0, 7};
+    CHECK(
+      std::vector<TileIndex>(partialRow.begin(), partialRow.end()) ==
+      expectedPartial);
+  }
+
+  SECTION("Unchecked access matches checked access") {
+    CHECK(map.tileAtUnchecked(0, 2, 2) == map.tileAt(0, 2, 2));
+    CHECK(map.tileAtUnchecked(1, 3, 2) == 7);
+  }
+
+  SECTION("Row ranges outside of the map are rejected") {
+    CHECK_THROWS_AS(map.tileRow(2, 0), const std::invalid_argument&);
+    CHECK_THROWS_AS(map.tileRow(0, 3), const std::invalid_argument&);
+    CHECK_THROWS_AS(map.tileRow(0, -1), const std::invalid_argument&);
+    CHECK_THROWS_AS(map.tileRow(0, 0, -1, 2), const std::invalid_argument&);
+    CHECK_THROWS_AS(map.tileRow(0, 0, 2, 5), const std::invalid_argument&);
+    CHECK_THROWS_AS(map.tileRow(0, 0, 3, 2), const std::invalid_argument&);
+  }
+
+  SECTION("Empty ranges are allowed") {
+    CHECK(map.tileRow(0, 0, 4, 4).empty());
+  }
+}
+
+
+TEST_CASE("Clipping sections to the map") {
+  Map map{10, 8, TileAttributeDict{}};
+
+  SECTION("Sections inside the map are unchanged") {
+    const auto section = base::Rect<int>{{2, 3}, {4, 2}};
+    CHECK(map.clipToMap(section) == section);
+  }
+
+  SECTION("Sections are clipped on all sides") {
+    const auto clipped = map.clipToMap({{-2, -1}, {20, 20}});
+    const auto expected = base::Rect<int>{{0, 0}, {10, 8}};
+    CHECK(clipped == expected);
+  }
+
+  SECTION("Sections outside the map become empty") {
+    const auto clipped = map.clipToMap({{12, 2}, {3, 3}});
+    const auto expected = base::Rect<int>{{10, 2}, {0, 3}};
+    CHECK(clipped == expected);
+
+    const auto clippedBelow = map.clipToMap({{2, 9}, {3, 3}});
+    const auto expectedBelow = base::Rect<int>{{2, 8}, {3, 0}};
+    CHECK(clippedBelow == expectedBelow);
+  }
+
+  SECTION("Empty clipped sections are valid row ranges") {
+    const auto clipped = map.clipToMap({{12, 2}, {3, 3}});
+    const auto endCol = clipped.left() + clipped.size.width;
+    CHECK(map.tileRow(0, clipped.top(), clipped.left(), endCol).empty());
+  }
+}
@@ -0,0 +1,86 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <engine/map_renderer.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <tuple>
+#include <vector>
+
+
+using namespace rigel;
+using namespace data::map;
+
+
+namespace {
+
+using VisitedTile = std::tuple<TileIndex, int, int>;
+
+
+std::vector<VisitedTile> visitedTiles(
+  const Map& map,
+  const base::Vector& sectionStart,
+  const base::Extents& sectionSize
+) {
+  std::vector<VisitedTile> result;
+  engine::forEachTileInSection(
+    map,
+    sectionStart,
+    sectionSize,
+    [&](const TileIndex index, const int x, const int y) {
+      result.emplace_back(index, x, y);
+    });
+  return result;
+}
+
+}
+
+
+TEST_CASE("Visiting map tiles for rendering") {
+  Map map{4, 3, TileAttributeDict{}};
+  map.setTileAt(0, 3, 2, 5);
+  map.setTileAt(1, 3, 2, 6);
+
+  SECTION("Tile positions are relative to the section start") {
+    const auto tiles = visitedTiles(map, {3, 2}, {2, 2});
+    const auto expected = std::vector<VisitedTile>{{5, 0, 0}, {6, 0, 0}};
+    CHECK(tiles == expected);
+  }
+
+  SECTION("Sections partially outside the map are clipped") {
+    const auto tiles = visitedTiles(map, {-1, -1}, {3, 2});
+    CHECK(tiles.size() == 2 * 2 * 1);
+    CHECK(std::get<1>(tiles.front()) == 1);
+    CHECK(std::get<2>(tiles.front()) == 1);
+  }
+
+  SECTION("Sections right of or below the map visit nothing") {
+    CHECK_NOTHROW(visitedTiles(map, {6, 0}, {3, 3}));
+    CHECK(visitedTiles(map, {6, 0}, {3, 3}).empty());
+    CHECK(visitedTiles(map, {0, 5}, {3, 3}).empty());
+    CHECK(visitedTiles(map, {6, 5}, {3, 3}).empty());
+  }
+
+  SECTION("Sections left of or above the map visit nothing") {
+    CHECK(visitedTiles(map, {-5, 0}, {3, 3}).empty());
+    CHECK(visitedTiles(map, {0, -5}, {3, 3}).empty());
+  }
+}
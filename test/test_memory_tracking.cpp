@@ -0,0 +1,104 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/memory_tracking.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <sstream>
+#include <utility>
+
+
+using namespace rigel;
+using namespace base;
+
+
+TEST_CASE("Tracked memory") {
+  const auto tag = MemoryTag::Movies;
+  const auto initialUsage = trackedMemoryUsage(tag).mCurrentBytes;
+
+  auto currentUsage = [&]() {
+    return trackedMemoryUsage(tag).mCurrentBytes - initialUsage;
+  };
+
+  SECTION("Bytes are accounted while the object exists") {
+    {
+      TrackedMemory memory{tag, 1000};
+      CHECK(currentUsage() == 1000);
+    }
+
+    CHECK(currentUsage() == 0);
+  }
+
+  SECTION("Size can be changed") {
+    TrackedMemory memory{tag, 1000};
+    memory.setSize(200);
+
+    CHECK(currentUsage() == 200);
+    CHECK(memory.size() == 200);
+  }
+
+  SECTION("Peak value is kept") {
+    {
+      TrackedMemory memory{tag, 1000};
+      memory.setSize(5000000);
+    }
+
+    CHECK(trackedMemoryUsage(tag).mPeakBytes >= initialUsage + 5000000);
+  }
+
+  SECTION("Copies are accounted separately") {
+    TrackedMemory memory{tag, 100};
+    auto copy = memory;
+
+    CHECK(currentUsage() == 200);
+
+    copy.setSize(0);
+    CHECK(currentUsage() == 100);
+  }
+
+  SECTION("Moving transfers ownership of the bytes") {
+    TrackedMemory memory{tag, 100};
+    auto moved = std::move(memory);
+
+    CHECK(currentUsage() == 100);
+    CHECK(moved.size() == 100);
+  }
+
+  SECTION("Assignment replaces the previous bytes") {
+    TrackedMemory memory{tag, 100};
+    TrackedMemory other{tag, 300};
+    memory = other;
+
+    CHECK(currentUsage() == 600);
+
+    memory = TrackedMemory{tag, 50};
+    CHECK(currentUsage() == 350);
+  }
+
+  SECTION("Report lists all tags") {
+    std::stringstream report;
+    printMemoryReport(report);
+
+    for (auto i = 0; i < NUM_MEMORY_TAGS; ++i) {
+      const auto name = memoryTagName(static_cast<MemoryTag>(i));
+      CHECK(report.str().find(name) != std::string::npos);
+    }
+  }
+}
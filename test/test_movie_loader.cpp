@@ -0,0 +1,240 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/warnings.hpp>
+#include <loader/file_utils.hpp>
+#include <loader/movie_loader.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+
+using namespace rigel;
+using namespace loader;
+
+
+namespace {
+
+constexpr auto WIDTH = 4;
+constexpr auto HEIGHT = 2;
+
+
+struct FrameRow {
+  std::uint8_t mSkip;
+  std::vector<std::uint8_t> mLiteralPixels;
+};
+
+
+struct TestFrame {
+  std::uint16_t mStartRow;
+  std::vector<std::vector<FrameRow>> mRows;
+};
+
+
+void writeChunkHeader(LeStreamWriter& writer, const std::uint16_t numSubChunks)
+{
+  writer.writeU32(0);
+  writer.writeU16(0xF1FA);
+  writer.writeU16(numSubChunks);
+  writer.writeU32(0);
+  writer.writeU32(0);
+}
+
+
+ByteBuffer makeMovieFile(const std::vector<TestFrame>& frames) {
+  LeStreamWriter writer;
+
+  // File header, the file size is patched in at the end
+  writer.writeU32(0);
+  writer.writeU16(0xAF11);
+  writer.writeU16(static_cast<std::uint16_t>(frames.size()));
+  writer.writeU16(WIDTH);
+  writer.writeU16(HEIGHT);
+  for (auto i = 0; i < 4 + 4 + 108; ++i) {
+    writer.writeU8(0);
+  }
+
+  writeChunkHeader(writer, 2);
+
+  // Palette
+  writer.writeU32(778);
+  writer.writeU16(0xB);
+  writer.writeU32(1);
+  for (auto i = 0; i < 256; ++i) {
+    writer.writeU8(static_cast<std::uint8_t>(i % 64));
+    writer.writeU8(static_cast<std::uint8_t>(i / 4 % 64));
+    writer.writeU8(static_cast<std::uint8_t>(63 - i % 64));
+  }
+
+  // Base image: each row is a single run of its row number + 1
+  writer.writeU32(0);
+  writer.writeU16(0xF);
+  for (auto row = 0; row < HEIGHT; ++row) {
+    writer.writeU8(1);
+    writer.writeS8(WIDTH);
+    writer.writeU8(static_cast<std::uint8_t>(row + 1));
+  }
+
+  for (const auto& frame : frames) {
+    writeChunkHeader(writer, 1);
+    writer.writeU32(0);
+    writer.writeU16(0xC);
+    writer.writeU16(frame.mStartRow);
+    writer.writeU16(static_cast<std::uint16_t>(frame.mRows.size()));
+
+    for (const auto& row : frame.mRows) {
+      writer.writeU8(static_cast<std::uint8_t>(row.size()));
+      for (const auto& word : row) {
+        writer.writeU8(word.mSkip);
+
+        // Animation frames store inverted RLE markers, so a positive value
+        // means literal pixels
+        writer.writeS8(static_cast<std::int8_t>(word.mLiteralPixels.size()));
+        for (const auto pixel : word.mLiteralPixels) {
+          writer.writeU8(pixel);
+        }
+      }
+    }
+  }
+
+  auto data = writer.takeData();
+  const auto size = static_cast<std::uint32_t>(data.size());
+  for (auto i = 0; i < 4; ++i) {
+    data[i] = static_cast<std::uint8_t>(size >> (i * 8));
+  }
+
+  return data;
+}
+
+
+/** Applies a frame from loadMovie() on top of the given image
+ *
+ * Pixels that aren't replaced by the frame are transparent.
+ */
+void applyFrame(data::Image& canvas, const data::MovieFrame& frame) {
+  const auto& image = frame.mReplacementImage;
+  for (auto y = 0u; y < image.height(); ++y) {
+    for (auto x = 0u; x < image.width(); ++x) {
+      const auto pixel = image.pixelData()[x + y * image.width()];
+      if (pixel.a != 0) {
+        canvas.insertImage(
+          x, y + frame.mStartRow, data::PixelBuffer{pixel}, 1);
+      }
+    }
+  }
+}
+
+
+bool rowsMatch(const data::Image& canvas, const data::MovieFrame& frame) {
+  const auto& image = frame.mReplacementImage;
+  if (image.width() != canvas.width()) {
+    return false;
+  }
+
+  const auto iFirst =
+    canvas.pixelData().begin() + frame.mStartRow * canvas.width();
+  return std::equal(
+    image.pixelData().begin(), image.pixelData().end(), iFirst);
+}
+
+}
+
+
+TEST_CASE("Movie decoder matches fully loaded movie") {
+  const auto file = makeMovieFile({
+    TestFrame{0, {{FrameRow{1, {5, 6}}}}},
+    TestFrame{1, {{FrameRow{2, {7}}}}},
+    TestFrame{0, {{FrameRow{0, {8}}, FrameRow{1, {9, 10}}}, {}}},
+  });
+
+  const auto movie = loadMovie(file);
+  REQUIRE(movie.mFrames.size() == 3);
+
+  MovieDecoder decoder{file};
+  REQUIRE(decoder.numFrames() == 3);
+  REQUIRE(decoder.width() == WIDTH);
+  REQUIRE(decoder.height() == HEIGHT);
+
+  const auto baseImage = decoder.decodeBaseImage();
+  CHECK(baseImage.pixelData() == movie.mBaseImage.pixelData());
+
+  SECTION("Each frame matches, including wrap-around") {
+    auto canvas = movie.mBaseImage;
+
+    for (auto i = 0; i < 2 * decoder.numFrames(); ++i) {
+      const auto& expectedFrame = movie.mFrames[i % movie.mFrames.size()];
+      applyFrame(canvas, expectedFrame);
+
+      const auto frame = decoder.decodeNextFrame();
+      CHECK(frame.mStartRow == expectedFrame.mStartRow);
+      CHECK(
+        frame.mReplacementImage.height() ==
+        expectedFrame.mReplacementImage.height());
+      CHECK(rowsMatch(canvas, frame));
+    }
+  }
+
+  SECTION("Seeking to a frame") {
+    auto canvas = movie.mBaseImage;
+    applyFrame(canvas, movie.mFrames[0]);
+    applyFrame(canvas, movie.mFrames[1]);
+    applyFrame(canvas, movie.mFrames[2]);
+
+    // Advance past the target first to make sure seeking resets the state
+    decoder.decodeNextFrame();
+    decoder.decodeNextFrame();
+    decoder.decodeNextFrame();
+
+    decoder.seekToFrame(2);
+    CHECK(decoder.nextFrameIndex() == 2);
+    CHECK(rowsMatch(canvas, decoder.decodeNextFrame()));
+
+    decoder.seekToFrame(0);
+    auto expected = movie.mBaseImage;
+    applyFrame(expected, movie.mFrames[0]);
+    CHECK(rowsMatch(expected, decoder.decodeNextFrame()));
+  }
+
+  SECTION("Restarting the animation keeps the current state") {
+    // This is what happens during the last repetition of a movie, which ends
+    // one frame early. Here, the second repetition is the last one.
+    auto canvas = movie.mBaseImage;
+    for (const auto frameIndex : {0, 1, 2, 0, 1}) {
+      applyFrame(canvas, movie.mFrames[frameIndex]);
+      decoder.decodeNextFrame();
+    }
+    applyFrame(canvas, movie.mFrames[0]);
+
+    decoder.restartAnimation();
+    CHECK(decoder.nextFrameIndex() == 0);
+
+    const auto frame = decoder.decodeNextFrame();
+    CHECK(frame.mStartRow == movie.mFrames[0].mStartRow);
+    CHECK(rowsMatch(canvas, frame));
+  }
+
+  SECTION("Seeking out of range throws") {
+    CHECK_THROWS_AS(decoder.seekToFrame(3), const std::invalid_argument&);
+    CHECK_THROWS_AS(decoder.seekToFrame(-1), const std::invalid_argument&);
+  }
+}
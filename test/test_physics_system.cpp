@@ -19,6 +19,7 @@
 
 #include <data/map.hpp>
 #include <engine/collision_checker.hpp>
+#include <engine/event_queue.hpp>
 #include <engine/physical_components.hpp>
 #include <engine/physics_system.hpp>
 #include <engine/timing.hpp>
@@ -44,7 +45,8 @@ TEST_CASE("Physics system works as expected") {
   data::map::Map map{100, 100, data::map::TileAttributeDict{{0x0, 0xF}}};
 
   CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
-  PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
+  EventQueue eventQueue{&entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &eventQueue};
 
   auto physicalObject = entities.create();
   physicalObject.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
@@ -414,4 +416,40 @@ TEST_CASE("Physics system works as expected") {
       CHECK(collectedPositions == expectedPositions);
     }
   }
+
+
+  SECTION("Objects spawned after phase 1 are processed in phase 2") {
+    body.mGravityAffected = false;
+    body.mVelocity.x = 1.0f;
+
+    const auto spawnObject = [&entities](const int x) {
+      auto entity = entities.create();
+      entity.assign<BoundingBox>(BoundingBox{{0, 0}, {2, 2}});
+      entity.assign<MovingBody>(MovingBody{{1.0f, 0.0f}, false});
+      entity.assign<WorldPosition>(WorldPosition{x, 4});
+      entity.assign<Active>();
+      return entity;
+    };
+
+    physicsSystem.updatePhase1(entities);
+    CHECK(position.x == 1);
+
+    auto spawned = spawnObject(10);
+    auto removed = spawnObject(20);
+    auto destroyed = spawnObject(30);
+    removed.remove<MovingBody>();
+    destroyed.destroy();
+
+    physicsSystem.updatePhase2(entities);
+
+    CHECK(position.x == 1);
+    CHECK(spawned.component<WorldPosition>()->x == 11);
+    CHECK(removed.component<WorldPosition>()->x == 20);
+
+    SECTION("Objects spawned after phase 2 aren't collected") {
+      auto lateSpawned = spawnObject(40);
+      physicsSystem.updatePhase2(entities);
+      CHECK(lateSpawned.component<WorldPosition>()->x == 40);
+    }
+  }
 }
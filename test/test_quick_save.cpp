@@ -0,0 +1,351 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "utils.hpp"
+
+#include <base/spatial_types_printing.hpp>
+#include <data/game_options.hpp>
+#include <data/map.hpp>
+#include <engine/base_components.hpp>
+#include <engine/collision_checker.hpp>
+#include <engine/life_time_components.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/random_number_generator.hpp>
+#include <engine/visual_components.hpp>
+#include <game_logic/behavior_controller.hpp>
+#include <game_logic/collectable_components.hpp>
+#include <game_logic/enemies/spike_ball.hpp>
+#include <game_logic/entity_factory.hpp>
+#include <game_logic/global_dependencies.hpp>
+#include <game_logic/interactive/item_container.hpp>
+#include <game_logic/quick_save.hpp>
+#include <game_logic/spawn_origin.hpp>
+#include <loader/file_utils.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <algorithm>
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+using namespace game_logic;
+
+
+namespace ex = entityx;
+
+using game_logic::components::BehaviorController;
+using game_logic::components::CollectableItem;
+using game_logic::components::ItemBounceEffect;
+using game_logic::components::ItemContainer;
+using game_logic::components::SpawnOrigin;
+
+
+namespace {
+
+struct MockSpriteFactory : public rigel::engine::ISpriteFactory {
+  engine::components::Sprite createSprite(data::ActorID id) override {
+    static const auto dummyDrawData = []() {
+      rigel::engine::SpriteDrawData drawData;
+      drawData.mFrames.resize(32);
+      return drawData;
+    }();
+    return {&dummyDrawData, {0}};
+  }
+
+  base::Rect<int> actorFrameRect(data::ActorID id, int frame) const override {
+    return {{}, {2, 2}};
+  }
+};
+
+
+// Has state, but can't store it in a quick save
+struct CountingBehavior {
+  void update(
+    GlobalDependencies&,
+    GlobalState&,
+    bool,
+    ex::Entity
+  ) {
+    ++mNumUpdates;
+  }
+
+  int mNumUpdates = 0;
+};
+
+
+struct TestWorld {
+  TestWorld() {
+    levelEntities = {
+      entityFactory.spawnActor(data::ActorID::Bouncing_spike_ball, {2, 20}),
+      entityFactory.spawnActor(data::ActorID::Bouncing_spike_ball, {8, 20}),
+      entityFactory.spawnActor(data::ActorID::White_box_rapid_fire, {12, 20}),
+    };
+  }
+
+  ex::EntityX entityx;
+  MockServiceProvider mockServiceProvider;
+  engine::RandomNumberGenerator randomGenerator;
+  MockSpriteFactory mockSpriteFactory;
+  data::GameOptions options;
+  EntityFactory entityFactory{
+    &mockSpriteFactory,
+    &entityx.entities,
+    &mockServiceProvider,
+    &randomGenerator,
+    &options,
+    data::Difficulty::Medium};
+  std::vector<ex::Entity> levelEntities;
+};
+
+
+std::string describe(ex::Entity entity) {
+  std::stringstream stream;
+
+  if (entity.has_component<WorldPosition>()) {
+    stream << "pos " << *entity.component<WorldPosition>() << ' ';
+  }
+
+  if (entity.has_component<BoundingBox>()) {
+    const auto& bbox = *entity.component<BoundingBox>();
+    stream << "bbox " << bbox.topLeft << ' ' << bbox.size.width << ' '
+      << bbox.size.height << ' ';
+  }
+
+  if (entity.has_component<MovingBody>()) {
+    const auto& body = *entity.component<MovingBody>();
+    stream << "body " << body.mVelocity << ' ' << body.mGravityAffected << ' ';
+  }
+
+  if (entity.has_component<Sprite>()) {
+    const auto& sprite = *entity.component<Sprite>();
+    stream << "sprite";
+    for (const auto& slot : sprite.mFramesToRender) {
+      stream << ' ' << slot.mFrame;
+    }
+    stream << ' ' << sprite.mShow << ' ';
+  }
+
+  if (entity.has_component<AutoDestroy>()) {
+    stream << "autoDestroy " << entity.component<AutoDestroy>()->mFramesToLive
+      << ' ';
+  }
+
+  if (entity.has_component<ItemBounceEffect>()) {
+    stream << "bounce " << entity.component<ItemBounceEffect>()->mFramesElapsed
+      << ' ';
+  }
+
+  if (entity.has_component<CollectableItem>()) {
+    stream << "collectable ";
+  }
+
+  if (entity.has_component<ItemContainer>()) {
+    stream << "container ";
+  }
+
+  if (entity.has_component<SpawnOrigin>()) {
+    const auto& origin = *entity.component<SpawnOrigin>();
+    stream << "origin " << static_cast<int>(origin.mType) << ' '
+      << static_cast<int>(origin.mActorId) << ' '
+      << origin.mContainerDepth;
+  }
+
+  return stream.str();
+}
+
+
+std::vector<std::string> describeAll(ex::EntityManager& entities) {
+  std::vector<std::string> result;
+  for (auto entity : entities.entities_for_debugging()) {
+    result.push_back(describe(entity));
+  }
+
+  // Entity IDs are not preserved when restoring, so the order of iteration
+  // may differ between the original and the restored world
+  std::sort(result.begin(), result.end());
+  return result;
+}
+
+}
+
+
+TEST_CASE("Quick save restores level and spawned entities") {
+  TestWorld original;
+
+  data::map::Map map{100, 100, data::map::TileAttributeDict{{0x0, 0xF}}};
+  CollisionChecker collisionChecker{
+    &map, original.entityx.entities, original.entityx.events};
+  ItemContainerSystem itemContainerSystem{
+    &original.entityx.entities, &collisionChecker, original.entityx.events};
+
+  auto& entities = original.entityx.entities;
+  auto movedBall = original.levelEntities[0];
+  auto destroyedBall = original.levelEntities[1];
+  auto box = original.levelEntities[2];
+
+  // Modify the world in various ways
+  movedBall.component<WorldPosition>()->x += 5;
+  movedBall.component<MovingBody>()->mVelocity.y = 2.0f;
+  destroyedBall.destroy();
+
+  box.component<ItemContainer>()->mHasBeenShot = true;
+  for (auto i = 0; i < 4 && box.valid(); ++i) {
+    itemContainerSystem.update(entities);
+  }
+  REQUIRE(!box.valid());
+
+  original.entityFactory.spawnActor(data::ActorID::Red_box_cola, {30, 40});
+  original.entityFactory.spawnProjectile(
+    ProjectileType::Normal, {4, 4}, ProjectileDirection::Right);
+  spawnOneShotSprite(
+    original.entityFactory, data::ActorID::Shot_impact_FX, {7, 7});
+
+  // Helper entities without a spawn origin are not persisted
+  auto helper = entities.create();
+  helper.assign<WorldPosition>(1, 1);
+
+  const auto expected = [&]() {
+    auto descriptions = describeAll(entities);
+    const auto helperDescription = describe(helper);
+    descriptions.erase(std::find(
+      descriptions.begin(), descriptions.end(), helperDescription));
+    return descriptions;
+  }();
+
+  loader::LeStreamWriter writer;
+  writeQuickSaveEntities(
+    writer, entities, original.levelEntities, ex::Entity{});
+
+  TestWorld restored;
+  const auto buffer = writer.takeData();
+  loader::LeStreamReader reader{buffer};
+  restoreQuickSaveEntities(
+    reader, restored.entityFactory, restored.levelEntities, ex::Entity{});
+
+  CHECK(describeAll(restored.entityx.entities) == expected);
+  CHECK(reader.hasData() == false);
+}
+
+
+TEST_CASE("Quick save rejects invalid sprite frames") {
+  TestWorld original;
+
+  original.levelEntities[0].component<Sprite>()->mFramesToRender[0] = 40;
+
+  loader::LeStreamWriter writer;
+  writeQuickSaveEntities(
+    writer,
+    original.entityx.entities,
+    original.levelEntities,
+    ex::Entity{});
+
+  TestWorld restored;
+  const auto buffer = writer.takeData();
+  loader::LeStreamReader reader{buffer};
+  CHECK_THROWS_AS(
+    restoreQuickSaveEntities(
+      reader, restored.entityFactory, restored.levelEntities, ex::Entity{}),
+    const std::runtime_error&);
+}
+
+
+TEST_CASE("Quick save stores behavior state") {
+  TestWorld original;
+
+  auto& originalBall = original.levelEntities[0]
+    .component<BehaviorController>()->get<behaviors::SpikeBall>();
+  originalBall.mJumpBackCooldown = 7;
+  originalBall.mInitialized = true;
+
+  loader::LeStreamWriter writer;
+  writeQuickSaveEntities(
+    writer,
+    original.entityx.entities,
+    original.levelEntities,
+    ex::Entity{});
+
+  TestWorld restored;
+  const auto buffer = writer.takeData();
+  loader::LeStreamReader reader{buffer};
+  restoreQuickSaveEntities(
+    reader, restored.entityFactory, restored.levelEntities, ex::Entity{});
+
+  const auto& restoredBall = restored.levelEntities[0]
+    .component<BehaviorController>()->get<behaviors::SpikeBall>();
+  CHECK(restoredBall.mJumpBackCooldown == 7);
+  CHECK(restoredBall.mInitialized);
+  CHECK(reader.hasData() == false);
+}
+
+
+TEST_CASE("Quick save refuses behaviors which can't store their state") {
+  TestWorld original;
+
+  auto entity = original.levelEntities[0];
+  entity.replace<BehaviorController>(CountingBehavior{});
+
+  auto save = [&]() {
+    loader::LeStreamWriter writer;
+    writeQuickSaveEntities(
+      writer,
+      original.entityx.entities,
+      original.levelEntities,
+      ex::Entity{});
+  };
+
+  SECTION("Behavior which hasn't run yet can be stored") {
+    CHECK_NOTHROW(save());
+  }
+
+  SECTION("Behavior which has run can't be stored") {
+    GlobalDependencies dependencies{};
+    GlobalState state{nullptr, nullptr, nullptr, nullptr};
+    entity.component<BehaviorController>()->update(
+      dependencies, state, true, entity);
+
+    CHECK_THROWS_AS(save(), const std::runtime_error&);
+  }
+}
+
+
+TEST_CASE("Quick save rejects behaviors which don't match the level") {
+  TestWorld original;
+
+  original.levelEntities[0].replace<BehaviorController>(CountingBehavior{});
+
+  loader::LeStreamWriter writer;
+  writeQuickSaveEntities(
+    writer,
+    original.entityx.entities,
+    original.levelEntities,
+    ex::Entity{});
+
+  TestWorld restored;
+  const auto buffer = writer.takeData();
+  loader::LeStreamReader reader{buffer};
+  CHECK_THROWS_AS(
+    restoreQuickSaveEntities(
+      reader, restored.entityFactory, restored.levelEntities, ex::Entity{}),
+    const std::runtime_error&);
+}
@@ -0,0 +1,68 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <frontend/simulation_thread.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <stdexcept>
+#include <thread>
+
+
+using namespace rigel;
+
+
+TEST_CASE("Simulation thread") {
+  SimulationThread simulationThread;
+
+  SECTION("Jobs run on a different thread") {
+    std::thread::id jobThreadId;
+    simulationThread.start([&]() { jobThreadId = std::this_thread::get_id(); });
+    simulationThread.wait();
+
+    CHECK(jobThreadId != std::thread::id{});
+    CHECK(jobThreadId != std::this_thread::get_id());
+  }
+
+  SECTION("Results of a job are visible after waiting") {
+    auto counter = 0;
+    for (int i = 0; i < 100; ++i) {
+      simulationThread.start([&]() { ++counter; });
+      simulationThread.wait();
+    }
+
+    CHECK(counter == 100);
+  }
+
+  SECTION("Waiting without a job in flight returns immediately") {
+    simulationThread.wait();
+  }
+
+  SECTION("Exceptions thrown by a job are rethrown when waiting") {
+    simulationThread.start([]() { throw std::runtime_error("failure"); });
+    CHECK_THROWS_AS(simulationThread.wait(), std::runtime_error);
+
+    SECTION("Thread remains usable afterwards") {
+      auto jobRan = false;
+      simulationThread.start([&]() { jobRan = true; });
+      CHECK_NOTHROW(simulationThread.wait());
+      CHECK(jobRan);
+    }
+  }
+}
@@ -24,6 +24,7 @@
 #include <engine/base_components.hpp>
 #include <engine/collision_checker.hpp>
 #include <engine/entity_activation_system.hpp>
+#include <engine/event_queue.hpp>
 #include <engine/particle_system.hpp>
 #include <engine/physical_components.hpp>
 #include <engine/physics_system.hpp>
@@ -88,7 +89,8 @@ TEST_CASE("Spike ball") {
     entityFactory.spawnActor(data::ActorID::Bouncing_spike_ball, {2, 20});
 
   CollisionChecker collisionChecker{&map, entityx.entities, entityx.events};
-  PhysicsSystem physicsSystem{&collisionChecker, &map, &entityx.events};
+  EventQueue eventQueue{&entityx.events};
+  PhysicsSystem physicsSystem{&collisionChecker, &map, &eventQueue};
 
   auto playerEntity = entityx.entities.create();
   playerEntity.assign<WorldPosition>(6, 100);
@@ -0,0 +1,124 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <base/spatial_types_printing.hpp>
+#include <base/warnings.hpp>
+#include <engine/base_components.hpp>
+#include <engine/sprite_rendering_system.hpp>
+#include <engine/visual_components.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+
+using namespace rigel;
+using namespace engine;
+using namespace engine::components;
+
+
+namespace {
+
+constexpr auto VIEW_PORT_SIZE = base::Extents{32, 20};
+constexpr auto CAMERA_POSITION = base::Vector{0, 0};
+
+}
+
+
+TEST_CASE("Sprite rendering system") {
+  entityx::EntityX entityx;
+
+  SpriteDrawData drawData;
+  drawData.mFrames = {SpriteFrame{0, {0, 0}, {2, 2}}};
+
+  auto entity = entityx.entities.create();
+  entity.assign<WorldPosition>(10, 10);
+  entity.assign<Sprite>(Sprite{&drawData, {0}});
+
+  SpriteRenderingSystem spriteRenderingSystem{nullptr, nullptr};
+
+  const auto update = [&](const bool motionSmoothingOn = true) {
+    spriteRenderingSystem.update(
+      entityx.entities, VIEW_PORT_SIZE, CAMERA_POSITION, motionSmoothingOn);
+    return spriteRenderingSystem.drawList().mSprites;
+  };
+
+  const auto motionAfterUpdate = [&]() {
+    const auto sprites = update();
+    REQUIRE(sprites.size() == 1);
+    return sprites[0].mMotion;
+  };
+
+  auto& position = *entity.component<WorldPosition>();
+
+  SECTION("Motion is zero for newly seen sprites") {
+    CHECK(motionAfterUpdate() == base::Vector{});
+  }
+
+  SECTION("Motion is the distance moved since the previous update") {
+    update();
+    position = {11, 9};
+
+    CHECK(motionAfterUpdate() == base::Vector(8, -8));
+    CHECK(motionAfterUpdate() == base::Vector{});
+  }
+
+  SECTION("Sprites moving too far are not interpolated") {
+    update();
+    position.x += 5;
+
+    CHECK(motionAfterUpdate() == base::Vector{});
+  }
+
+  SECTION("Positions are tracked while sprites are hidden") {
+    update();
+    entity.component<Sprite>()->mShow = false;
+    position.x += 1;
+    update();
+
+    entity.component<Sprite>()->mShow = true;
+    position.x += 1;
+    CHECK(motionAfterUpdate() == base::Vector(8, 0));
+  }
+
+  SECTION("Entities reusing a slot don't inherit motion") {
+    update();
+    entity.destroy();
+
+    auto newEntity = entityx.entities.create();
+    REQUIRE(newEntity.id().index() == 0);
+    newEntity.assign<WorldPosition>(12, 10);
+    newEntity.assign<Sprite>(Sprite{&drawData, {0}});
+
+    CHECK(motionAfterUpdate() == base::Vector{});
+  }
+
+  SECTION("Forgetting previous positions resets motion") {
+    update();
+    position.x += 1;
+    spriteRenderingSystem.forgetPreviousPositions();
+
+    CHECK(motionAfterUpdate() == base::Vector{});
+  }
+
+  SECTION("Culling margin only applies with motion smoothing") {
+    position = {VIEW_PORT_SIZE.width + 1, 10};
+
+    CHECK(update(true).size() == 1);
+    CHECK(update(false).empty());
+  }
+}
@@ -0,0 +1,117 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/spsc_queue.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <memory>
+#include <thread>
+#include <vector>
+
+
+using namespace rigel;
+
+
+TEST_CASE("SPSC queue") {
+  base::SpscQueue<int, 3> queue;
+
+  SECTION("New queue is empty") {
+    CHECK(queue.empty());
+    CHECK(!queue.full());
+    CHECK(queue.front() == nullptr);
+  }
+
+  SECTION("Elements come out in insertion order") {
+    CHECK(queue.tryPush(1));
+    CHECK(queue.tryPush(2));
+
+    REQUIRE(queue.front());
+    CHECK(*queue.front() == 1);
+    queue.pop();
+
+    REQUIRE(queue.front());
+    CHECK(*queue.front() == 2);
+    queue.pop();
+
+    CHECK(queue.empty());
+  }
+
+  SECTION("Push fails when capacity is reached") {
+    CHECK(queue.tryPush(1));
+    CHECK(queue.tryPush(2));
+    CHECK(queue.tryPush(3));
+    CHECK(queue.full());
+    CHECK(!queue.tryPush(4));
+
+    queue.pop();
+    CHECK(!queue.full());
+    CHECK(queue.tryPush(4));
+
+    std::vector<int> remaining;
+    while (auto pValue = queue.front()) {
+      remaining.push_back(*pValue);
+      queue.pop();
+    }
+
+    CHECK(remaining == (std::vector<int>{2, 3, 4}));
+  }
+}
+
+
+TEST_CASE("SPSC queue releases popped elements") {
+  base::SpscQueue<std::shared_ptr<int>, 2> queue;
+
+  auto pValue = std::make_shared<int>(42);
+  queue.tryPush(std::shared_ptr<int>{pValue});
+  CHECK(pValue.use_count() == 2);
+
+  queue.pop();
+  CHECK(pValue.use_count() == 1);
+}
+
+
+TEST_CASE("SPSC queue transfers all elements between threads") {
+  constexpr auto NUM_ELEMENTS = 10000;
+  base::SpscQueue<int, 16> queue;
+
+  std::thread producer([&queue]() {
+    for (int i = 0; i < NUM_ELEMENTS; ++i) {
+      while (!queue.tryPush(int{i})) {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  std::vector<int> received;
+  while (received.size() < NUM_ELEMENTS) {
+    if (auto pValue = queue.front()) {
+      received.push_back(*pValue);
+      queue.pop();
+    }
+  }
+
+  producer.join();
+
+  auto expected = std::vector<int>(NUM_ELEMENTS);
+  for (int i = 0; i < NUM_ELEMENTS; ++i) {
+    expected[i] = i;
+  }
+  CHECK(received == expected);
+}
@@ -0,0 +1,189 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/warnings.hpp>
+#include <data/map.hpp>
+#include <data/player_model.hpp>
+#include <engine/base_components.hpp>
+#include <engine/physical_components.hpp>
+#include <engine/random_number_generator.hpp>
+#include <game_logic/damage_components.hpp>
+#include <game_logic/state_hash.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+
+using namespace rigel;
+using namespace engine::components;
+using namespace engine::components::parameter_aliases;
+using namespace game_logic;
+
+using game_logic::components::Shootable;
+
+
+namespace {
+
+StateHash makeHash(const std::uint64_t seed) {
+  StateHash hash;
+  hash.mPositions = seed;
+  hash.mVelocities = seed + 1;
+  hash.mHealth = seed + 2;
+  hash.mMapTiles = seed + 3;
+  hash.mPlayerModel = seed + 4;
+  hash.mRandomNumberIndex = seed % 256;
+  return hash;
+}
+
+
+
+struct TestState {
+  TestState() {
+    map.setTileAt(0, 3, 4, 1);
+
+    auto enemy = entityx.entities.create();
+    enemy.assign<WorldPosition>(10, 20);
+    enemy.assign<MovingBody>(Velocity{1.0f, 0.5f}, GravityAffected{true});
+    enemy.assign<Shootable>(3);
+
+    auto decoration = entityx.entities.create();
+    decoration.assign<WorldPosition>(4, 5);
+  }
+
+  StateHash hash() {
+    return computeStateHash(
+      entityx.entities, map, randomGenerator, playerModel);
+  }
+
+  entityx::EntityX entityx;
+  data::map::Map map{16, 8, data::map::TileAttributeDict{{0x0, 0xF}}};
+  engine::RandomNumberGenerator randomGenerator;
+  data::PlayerModel playerModel;
+};
+
+
+entityx::Entity firstEntity(entityx::EntityManager& entities) {
+  return *entities.entities_for_debugging().begin();
+}
+
+}
+
+
+TEST_CASE("State hash computation") {
+  TestState state;
+  TestState other;
+
+  SECTION("Identical states have the same hash") {
+    CHECK(state.hash() == other.hash());
+    CHECK(state.hash() == state.hash());
+  }
+
+  SECTION("A changed position only affects positions") {
+    firstEntity(other.entityx.entities).component<WorldPosition>()->x += 1;
+
+    const auto expected = std::vector<std::string>{"positions"};
+    CHECK(differingComponents(state.hash(), other.hash()) == expected);
+  }
+
+  SECTION("A changed velocity only affects velocities") {
+    firstEntity(other.entityx.entities)
+      .component<MovingBody>()->mVelocity.y = 0.25f;
+
+    const auto expected = std::vector<std::string>{"velocities"};
+    CHECK(differingComponents(state.hash(), other.hash()) == expected);
+  }
+
+  SECTION("A changed health value only affects health") {
+    firstEntity(other.entityx.entities).component<Shootable>()->mHealth = 2;
+
+    const auto expected = std::vector<std::string>{"health"};
+    CHECK(differingComponents(state.hash(), other.hash()) == expected);
+  }
+
+  SECTION("A changed tile only affects map tiles") {
+    other.map.setTileAt(1, 0, 0, 1);
+
+    const auto expected = std::vector<std::string>{"mapTiles"};
+    CHECK(differingComponents(state.hash(), other.hash()) == expected);
+  }
+
+  SECTION("Player model and random number generator are covered") {
+    other.playerModel.giveScore(100);
+    other.randomGenerator.gen();
+
+    const auto expected =
+      std::vector<std::string>{"playerModel", "randomNumberIndex"};
+    CHECK(differingComponents(state.hash(), other.hash()) == expected);
+  }
+}
+
+
+TEST_CASE("State hash traces") {
+  const auto trace = std::vector<StateHash>{
+    makeHash(0),
+    makeHash(0xFEDCBA9876543210),
+    makeHash(42)};
+
+  SECTION("Trace survives writing and reading back") {
+    std::stringstream stream;
+    writeStateHashTrace(stream, trace);
+
+    CHECK(readStateHashTrace(stream) == trace);
+  }
+
+  SECTION("Malformed trace is rejected") {
+    std::stringstream stream{"0123 4567\n"};
+
+    CHECK_THROWS_AS(
+      readStateHashTrace(stream), const std::invalid_argument&);
+  }
+
+  SECTION("Identical traces don't have a mismatch") {
+    CHECK(!findFirstMismatch(trace, trace));
+  }
+
+  SECTION("First mismatching frame and components are reported") {
+    auto modified = trace;
+    modified[1].mHealth = 0;
+    modified[1].mMapTiles = 0;
+    modified[2].mPositions = 0;
+
+    const auto mismatch = findFirstMismatch(trace, modified);
+
+    const auto expectedComponents =
+      std::vector<std::string>{"health", "mapTiles"};
+    REQUIRE(mismatch);
+    CHECK(mismatch->mFrame == 1);
+    CHECK(mismatch->mComponents == expectedComponents);
+  }
+
+  SECTION("Traces of different length don't match") {
+    auto shorter = trace;
+    shorter.pop_back();
+
+    const auto mismatch = findFirstMismatch(trace, shorter);
+
+    const auto expectedComponents = std::vector<std::string>{"frameCount"};
+    REQUIRE(mismatch);
+    CHECK(mismatch->mFrame == 2);
+    CHECK(mismatch->mComponents == expectedComponents);
+  }
+}
@@ -0,0 +1,114 @@
+/* Copyright (C) 2021, Nikolai Wuttke. All rights reserved.
+ *
+ *  This program is free software: you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation, either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <base/tracing.hpp>
+#include <base/warnings.hpp>
+
+RIGEL_DISABLE_WARNINGS
+#include <catch.hpp>
+#include <nlohmann/json.hpp>
+RIGEL_RESTORE_WARNINGS
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+
+using namespace rigel;
+
+namespace fs = std::filesystem;
+
+
+namespace {
+
+nlohmann::json writeAndReadBackTrace() {
+  const auto path = fs::temp_directory_path() / "rigel_test_trace.json";
+  base::tracing::writeTraceFile(path);
+
+  nlohmann::json trace;
+  {
+    std::ifstream file(path);
+    file >> trace;
+  }
+
+  fs::remove(path);
+  return trace;
+}
+
+
+const nlohmann::json* findEvent(
+  const nlohmann::json& trace,
+  const std::string& name
+) {
+  for (const auto& event : trace["traceEvents"]) {
+    if (event["name"] == name) {
+      return &event;
+    }
+  }
+
+  return nullptr;
+}
+
+}
+
+
+TEST_CASE("Tracing") {
+  SECTION("Nothing is recorded while tracing is disabled") {
+    {
+      RIGEL_TRACE_SCOPE("test event before enabling");
+    }
+
+    base::tracing::enable();
+
+    const auto trace = writeAndReadBackTrace();
+    CHECK(findEvent(trace, "test event before enabling") == nullptr);
+  }
+
+  SECTION("Scoped events are recorded with their thread") {
+    base::tracing::enable();
+
+    {
+      RIGEL_TRACE_SCOPE("test event on main thread");
+    }
+
+    std::thread otherThread{[]() {
+      base::tracing::setCurrentThreadName("Test thread");
+      RIGEL_TRACE_SCOPE("test event on other thread");
+    }};
+    otherThread.join();
+
+    const auto trace = writeAndReadBackTrace();
+    const auto pMainEvent = findEvent(trace, "test event on main thread");
+    const auto pOtherEvent = findEvent(trace, "test event on other thread");
+    const auto pThreadName = findEvent(trace, "thread_name");
+
+    REQUIRE(pMainEvent != nullptr);
+    REQUIRE(pOtherEvent != nullptr);
+    REQUIRE(pThreadName != nullptr);
+
+    CHECK((*pMainEvent)["ph"] == "X");
+    CHECK((*pMainEvent)["dur"].get<double>() >= 0.0);
+    CHECK((*pMainEvent)["tid"] != (*pOtherEvent)["tid"]);
+    CHECK(
+      (*pOtherEvent)["ts"].get<double>() >=
+      (*pMainEvent)["ts"].get<double>());
+
+    CHECK((*pThreadName)["ph"] == "M");
+    CHECK((*pThreadName)["tid"] == (*pOtherEvent)["tid"]);
+    CHECK((*pThreadName)["args"]["name"] == "Test thread");
+  }
+}